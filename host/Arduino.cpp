@@ -0,0 +1,160 @@
+#include "Arduino.h"
+#include "esp_timer.h"
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+HostSerial Serial;
+
+size_t HostSerial::printf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  int n = vprintf(format, args);
+  va_end(args);
+  return n < 0 ? 0 : (size_t)n;
+}
+
+// ---- Clock ----
+
+static bool manualClock = false;
+static uint64_t manualNowUs = 0;
+
+static uint64_t hostNowUs() {
+  if (manualClock) return manualNowUs;
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+// ---- esp_timer ----
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void* arg;
+  bool armed;
+  uint64_t dueUs;
+  uint64_t periodUs;  // 0 = one-shot
+};
+
+static std::vector<esp_timer*> timers;
+
+// Fire every timer that is due at or before untilUs, earliest first
+static void runTimers(uint64_t untilUs) {
+  for (;;) {
+    esp_timer* next = nullptr;
+    for (esp_timer* t : timers) {
+      if (t->armed && t->dueUs <= untilUs && (!next || t->dueUs < next->dueUs)) next = t;
+    }
+    if (!next) return;
+
+    if (manualClock && next->dueUs > manualNowUs) manualNowUs = next->dueUs;
+    if (next->periodUs) {
+      next->dueUs += next->periodUs;
+    } else {
+      next->armed = false;
+    }
+    next->callback(next->arg);
+  }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle) {
+  if (!args || !args->callback || !out_handle) return ESP_FAIL;
+  esp_timer* t = new esp_timer{args->callback, args->arg, false, 0, 0};
+  timers.push_back(t);
+  *out_handle = t;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  timer->armed = true;
+  timer->dueUs = hostNowUs() + timeout_us;
+  timer->periodUs = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+  timer->armed = true;
+  timer->dueUs = hostNowUs() + period;
+  timer->periodUs = period;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  timer->armed = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  for (size_t i = 0; i < timers.size(); i++) {
+    if (timers[i] == timer) {
+      timers.erase(timers.begin() + i);
+      break;
+    }
+  }
+  delete timer;
+  return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)hostNowUs();
+}
+
+// ---- Time ----
+
+unsigned long millis() { return (unsigned long)(hostNowUs() / 1000); }
+unsigned long micros() { return (unsigned long)hostNowUs(); }
+
+void delay(unsigned long ms) {
+  if (manualClock) {
+    hostAdvanceMicros((uint64_t)ms * 1000);
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    runTimers(hostNowUs());
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (manualClock) {
+    hostAdvanceMicros(us);
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+void yield() {}
+
+void hostUseManualClock(bool manual) {
+  if (manual && !manualClock) manualNowUs = hostNowUs();
+  manualClock = manual;
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  uint64_t target = hostNowUs() + us;
+  runTimers(target);
+  if (manualClock) manualNowUs = target;
+}
+
+// ---- GPIO ----
+
+static uint8_t pinLevels[64];
+static HostPinWriteHook pinWriteHook = nullptr;
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < sizeof(pinLevels)) pinLevels[pin] = level ? HIGH : LOW;
+  if (pinWriteHook) pinWriteHook(pin, level ? HIGH : LOW, hostNowUs());
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+uint8_t hostPinLevel(uint8_t pin) {
+  return (uint8_t)digitalRead(pin);
+}
+
+void hostOnPinWrite(HostPinWriteHook hook) {
+  pinWriteHook = hook;
+}
@@ -0,0 +1,249 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * Arduino.h - Host (Linux) shim for the native PlatformIO environment
+ *
+ * Provides the small part of the Arduino-ESP32 API used by the
+ * hardware-independent modules in src/ (String, Serial, Stream, millis/micros,
+ * GPIO, FreeRTOS critical sections), so they compile and run off-device
+ * for unit tests and micro-benchmarks.
+ *
+ * Time comes from the host monotonic clock. Calling hostUseManualClock(true)
+ * switches to a simulated clock that only advances through delay(),
+ * hostAdvanceMicros() - which also fires due esp_timer callbacks.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define ZAPBOX_HOST 1
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+#define IRAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// ---- FreeRTOS critical sections (single-threaded on host) ----
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+// ---- String ----
+
+class String {
+public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int value, unsigned char base = 10) : s_(format((long long)value, base)) {}
+  explicit String(unsigned int value, unsigned char base = 10) : s_(formatUnsigned(value, base)) {}
+  explicit String(long value, unsigned char base = 10) : s_(format((long long)value, base)) {}
+  explicit String(unsigned long value, unsigned char base = 10) : s_(formatUnsigned(value, base)) {}
+  explicit String(long long value, unsigned char base = 10) : s_(format(value, base)) {}
+  explicit String(unsigned long long value, unsigned char base = 10) : s_(formatUnsigned(value, base)) {}
+  explicit String(float value, unsigned int decimals = 2) : s_(formatFloat(value, decimals)) {}
+  explicit String(double value, unsigned int decimals = 2) : s_(formatFloat(value, decimals)) {}
+
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  const char* c_str() const { return s_.c_str(); }
+  void reserve(unsigned int size) { s_.reserve(size); }
+
+  char charAt(unsigned int index) const { return index < s_.size() ? s_[index] : '\0'; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return s_[index]; }
+
+  String& operator+=(const String& rhs) { s_ += rhs.s_; return *this; }
+  String& operator+=(const char* rhs) { s_ += rhs ? rhs : ""; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(int v) { return *this += String(v); }
+  String& operator+=(unsigned int v) { return *this += String(v); }
+  String& operator+=(long v) { return *this += String(v); }
+  String& operator+=(unsigned long v) { return *this += String(v); }
+  String& operator+=(float v) { return *this += String(v); }
+  String& operator+=(double v) { return *this += String(v); }
+  bool concat(const String& rhs) { s_ += rhs.s_; return true; }
+
+  bool equals(const String& rhs) const { return s_ == rhs.s_; }
+  bool equalsIgnoreCase(const String& rhs) const { return strcasecmp(c_str(), rhs.c_str()) == 0; }
+  bool operator==(const String& rhs) const { return s_ == rhs.s_; }
+  bool operator==(const char* rhs) const { return s_ == (rhs ? rhs : ""); }
+  bool operator!=(const String& rhs) const { return !(*this == rhs); }
+  bool operator!=(const char* rhs) const { return !(*this == rhs); }
+  bool operator<(const String& rhs) const { return s_ < rhs.s_; }
+
+  bool startsWith(const String& prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+  bool endsWith(const String& suffix) const {
+    return s_.size() >= suffix.s_.size() && s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const { return toIndex(s_.find(c, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return toIndex(s_.find(str.s_, from)); }
+  int lastIndexOf(char c) const { return toIndex(s_.rfind(c)); }
+  int lastIndexOf(const String& str) const { return toIndex(s_.rfind(str.s_)); }
+
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, to - from));
+  }
+
+  void replace(const String& find, const String& repl) {
+    if (find.s_.empty()) return;
+    size_t pos = 0;
+    while ((pos = s_.find(find.s_, pos)) != std::string::npos) {
+      s_.replace(pos, find.s_.size(), repl.s_);
+      pos += repl.s_.size();
+    }
+  }
+  void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+  void trim() {
+    size_t begin = s_.find_first_not_of(" \t\r\n");
+    size_t end = s_.find_last_not_of(" \t\r\n");
+    s_ = (begin == std::string::npos) ? std::string() : s_.substr(begin, end - begin + 1);
+  }
+  void toUpperCase() { for (auto& c : s_) c = (char)toupper((unsigned char)c); }
+  void toLowerCase() { for (auto& c : s_) c = (char)tolower((unsigned char)c); }
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return (float)atof(s_.c_str()); }
+  double toDouble() const { return atof(s_.c_str()); }
+
+private:
+  std::string s_;
+
+  static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char buf[72];
+    int pos = sizeof(buf) - 1;
+    buf[pos] = '\0';
+    do {
+      int digit = (int)(value % base);
+      buf[--pos] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+      value /= base;
+    } while (value && pos > 0);
+    return std::string(buf + pos);
+  }
+  static std::string format(long long value, unsigned char base) {
+    if (value < 0 && base == 10) return "-" + formatUnsigned((unsigned long long)(-value), base);
+    return formatUnsigned((unsigned long long)value, base);
+  }
+  static std::string formatFloat(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    return std::string(buf);
+  }
+};
+
+inline String operator+(const String& lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, const char* rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const char* lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, char rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, int rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, unsigned int rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, long rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, unsigned long rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, float rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String& lhs, double rhs) { String r(lhs); r += rhs; return r; }
+
+// ---- Serial ----
+
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  void setRxBufferSize(size_t) {}
+  void flush() { fflush(stdout); }
+  int available() { return 0; }
+  int read() { return -1; }
+  size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+
+  size_t print(const String& s) { return fputs(s.c_str(), stdout) < 0 ? 0 : s.length(); }
+  size_t print(const char* s) { return print(String(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned int v) { return print(String(v)); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+
+  size_t println() { return print("\n"); }
+  template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  operator bool() const { return true; }
+};
+
+extern HostSerial Serial;
+
+// ---- Stream ----
+
+// Read side of the Arduino Stream interface (ArduinoJson reads it through
+// read()/readBytes(), like an HTTP body on the device)
+class Stream {
+public:
+  virtual ~Stream() {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = read();
+      if (c < 0) break;
+      buffer[count++] = (char)c;
+    }
+    return count;
+  }
+};
+
+// ---- Time ----
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// ---- GPIO ----
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+
+// ---- Host-only controls ----
+
+// Switch between the host monotonic clock (default) and a simulated clock
+void hostUseManualClock(bool manual);
+
+// Advance the simulated clock, firing due esp_timer callbacks in order
+void hostAdvanceMicros(uint64_t us);
+
+// Current level of a pin as last written by digitalWrite()
+uint8_t hostPinLevel(uint8_t pin);
+
+// Called on every digitalWrite() with the time in microseconds (nullptr = none)
+typedef void (*HostPinWriteHook)(uint8_t pin, uint8_t level, uint64_t timeUs);
+void hostOnPinWrite(HostPinWriteHook hook);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,102 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string>
+#include "ApiResponse.h"
+
+/**
+ * bench_api_response.cpp - Host benchmark of the LNbits response parser
+ *
+ * Compares the previous approach (whole body in a String, unfiltered
+ * JsonDocument) with parseSwitchLabels() (filtered, straight from the
+ * stream) for 4, 16 and 64 switches. Peak heap is the body copy plus the
+ * JSON allocations counted by apiResponseAllocator().
+ *   .pio/build/native/program --bench-json
+ */
+
+static const int BENCH_ITERATIONS = 200;
+
+// In-memory body, read like an HTTP stream
+class BodyStream : public Stream {
+public:
+  explicit BodyStream(const std::string& body) : body_(body) {}
+  int available() override { return (int)(body_.size() - position_); }
+  int read() override { return position_ < body_.size() ? (uint8_t)body_[position_++] : -1; }
+  int peek() override { return position_ < body_.size() ? (uint8_t)body_[position_] : -1; }
+
+private:
+  const std::string& body_;
+  size_t position_ = 0;
+};
+
+// Response shaped like /bitcoinswitch/api/v1/public/<id>
+static std::string buildSwitchResponse(int switchCount) {
+  static const int pins[] = {12, 13, 10, 11, 14, 21};
+  std::string body = "{\"id\":\"AbCdEfGhIjKlMnOpQrStUv\",\"title\":\"ZapBox bench\","
+                     "\"wallet\":\"0123456789abcdef0123456789abcdef\",\"currency\":\"eur\",\"switches\":[";
+  for (int i = 0; i < switchCount; i++) {
+    char entry[512];
+    snprintf(entry, sizeof(entry),
+             "%s{\"amount\":%d.5,\"duration\":%d,\"pin\":%d,\"comment\":false,\"variable\":false,"
+             "\"label\":\"Coffee %d EUR\",\"lnurl\":\"LNURL1DP68GURN8GHJ7MRWW4EXCTNXD9SHG6NPVCHXXMMD9AKXUATJDSKHQCTE8AEK2UMND9HKU0TYV4EHGETJDSKHQCTE8AEK2UMND9HKU0F4XQCRQVPSXQCRQVPSXQCRQVPSXQCRQVPSX\"}",
+             i ? "," : "", i + 1, 1000 + i, pins[i % 6], i + 1);
+    body += entry;
+  }
+  body += "],\"key\":\"0123456789abcdef0123456789abcdef\"}";
+  return body;
+}
+
+struct BenchResult {
+  size_t peakBytes;
+  unsigned long timeUs;
+};
+
+static BenchResult benchFullDocument(const std::string& body) {
+  BenchResult result = {0, 0};
+  unsigned long start = micros();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    apiResponseResetPeak();
+    String payload(body);  // http.getString()
+    JsonDocument doc(apiResponseAllocator());
+    deserializeJson(doc, payload.c_str());
+    size_t peak = payload.length() + 1 + apiResponsePeakBytes();
+    if (peak > result.peakBytes) result.peakBytes = peak;
+  }
+  result.timeUs = (micros() - start) / BENCH_ITERATIONS;
+  return result;
+}
+
+static BenchResult benchStreamFiltered(const std::string& body, SwitchLabelsResponse& response) {
+  BenchResult result = {0, 0};
+  unsigned long start = micros();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    apiResponseResetPeak();
+    BodyStream stream(body);
+    parseSwitchLabels(stream, response);
+    if (apiResponsePeakBytes() > result.peakBytes) result.peakBytes = apiResponsePeakBytes();
+  }
+  result.timeUs = (micros() - start) / BENCH_ITERATIONS;
+  return result;
+}
+
+int runApiResponseBenchmark() {
+  static const int switchCounts[] = {4, 16, 64};
+
+  Serial.printf("%-9s %-8s %-24s %-24s\n", "switches", "body", "String+full doc", "stream+filter");
+  for (int switchCount : switchCounts) {
+    std::string body = buildSwitchResponse(switchCount);
+    SwitchLabelsResponse response;
+    BenchResult full = benchFullDocument(body);
+    BenchResult filtered = benchStreamFiltered(body, response);
+
+    // Pin 12 repeats every 6 switches; the last one's label is kept
+    char expectedLabel[32];
+    snprintf(expectedLabel, sizeof(expectedLabel), "Coffee %d EUR", (switchCount - 1) / 6 * 6 + 1);
+    if (response.switchCount != switchCount || strcmp(response.labels[getPinIndex(12)], expectedLabel) != 0) {
+      Serial.printf("parse check failed for %d switches\n", switchCount);
+      return 1;
+    }
+    Serial.printf("%-9d %-8u %6u B %6lu us        %6u B %6lu us\n", switchCount, (unsigned)body.size(),
+                  (unsigned)full.peakBytes, full.timeUs, (unsigned)filtered.peakBytes, filtered.timeUs);
+  }
+  return 0;
+}
@@ -0,0 +1,144 @@
+#include <Arduino.h>
+#include <vector>
+#include "Bech32.h"
+
+/**
+ * bench_bech32.cpp - Host benchmark of the LNURL bech32 encoder
+ *
+ * Compares the previous encoder (std::vector per step, String output,
+ * copied verbatim below) with bech32Encode() for typical LNURL lengths and
+ * checks that both produce the same string.
+ *   .pio/build/native/program --bench-bech32
+ */
+
+static const int BENCH_ITERATIONS = 20000;
+
+// Last characters of all outputs, keeps the loops from being optimized away
+static volatile uint32_t benchSink = 0;
+
+// ---- Previous encoder ----
+
+static const char* LEGACY_CHARSET = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+static uint32_t legacyPolymod(const std::vector<uint8_t>& values) {
+  uint32_t chk = 1;
+  for (size_t i = 0; i < values.size(); ++i) {
+    uint8_t top = chk >> 25;
+    chk = (chk & 0x1ffffff) << 5 ^ values[i];
+    if (top & 1) chk ^= 0x3b6a57b2;
+    if (top & 2) chk ^= 0x26508e6d;
+    if (top & 4) chk ^= 0x1ea119fa;
+    if (top & 8) chk ^= 0x3d4233dd;
+    if (top & 16) chk ^= 0x2a1462b3;
+  }
+  return chk;
+}
+
+static std::vector<uint8_t> legacyHrpExpand(const String& hrp) {
+  std::vector<uint8_t> ret;
+  ret.reserve(hrp.length() * 2 + 1);
+  for (size_t i = 0; i < hrp.length(); ++i) {
+    ret.push_back(hrp[i] >> 5);
+  }
+  ret.push_back(0);
+  for (size_t i = 0; i < hrp.length(); ++i) {
+    ret.push_back(hrp[i] & 31);
+  }
+  return ret;
+}
+
+static std::vector<uint8_t> legacyConvertBits(const uint8_t* data, size_t len, int frombits, int tobits, bool pad) {
+  std::vector<uint8_t> ret;
+  int acc = 0;
+  int bits = 0;
+  int maxv = (1 << tobits) - 1;
+  for (size_t i = 0; i < len; i++) {
+    int value = data[i];
+    acc = (acc << frombits) | value;
+    bits += frombits;
+    while (bits >= tobits) {
+      bits -= tobits;
+      ret.push_back((acc >> bits) & maxv);
+    }
+  }
+  if (pad) {
+    if (bits > 0) {
+      ret.push_back((acc << (tobits - bits)) & maxv);
+    }
+  } else if (bits >= frombits || ((acc << (tobits - bits)) & maxv)) {
+    return std::vector<uint8_t>();
+  }
+  return ret;
+}
+
+static String legacyEncodeBech32(const String& data) {
+  String hrp = "lnurl";
+  std::vector<uint8_t> dataBytes;
+  for (size_t i = 0; i < data.length(); i++) {
+    dataBytes.push_back((uint8_t)data[i]);
+  }
+  std::vector<uint8_t> data5bit = legacyConvertBits(dataBytes.data(), dataBytes.size(), 8, 5, true);
+  if (data5bit.empty()) {
+    return "";
+  }
+  std::vector<uint8_t> combined = legacyHrpExpand(hrp);
+  combined.insert(combined.end(), data5bit.begin(), data5bit.end());
+  combined.insert(combined.end(), 6, 0);
+  uint32_t polymod = legacyPolymod(combined) ^ 1;
+  std::vector<uint8_t> checksum;
+  for (int i = 0; i < 6; ++i) {
+    checksum.push_back((polymod >> (5 * (5 - i))) & 31);
+  }
+  String result = hrp + "1";
+  for (size_t i = 0; i < data5bit.size(); i++) {
+    result += LEGACY_CHARSET[data5bit[i]];
+  }
+  for (size_t i = 0; i < checksum.size(); i++) {
+    result += LEGACY_CHARSET[checksum[i]];
+  }
+  result.toUpperCase();
+  return result;
+}
+
+// ---- Benchmark ----
+
+int runBech32Benchmark() {
+  static const char* urls[] = {
+    "https://demo.lnbits.com/bitcoinswitch/api/v1/lnurl/AbCdEfGhIjKlMnOpQrStUv?pin=12",
+    "https://legend.lnbits.com/bitcoinswitch/api/v1/lnurl/AbCdEfGhIjKlMnOpQrStUv?pin=12&duration=5000&amount=21",
+    "https://my-own-lnbits-server.example.org:5000/bitcoinswitch/api/v1/lnurl/AbCdEfGhIjKlMnOpQrStUv?pin=12&variable=true",
+  };
+
+  Serial.printf("%-6s %-14s %-14s %s\n", "url", "old encoder", "bech32Encode", "speedup");
+  for (const char* url : urls) {
+    String data(url);
+    size_t dataLen = strlen(url);
+    char out[512];
+
+    String legacy = legacyEncodeBech32(data);
+    size_t length = bech32Encode("lnurl", (const uint8_t*)url, dataLen, out, sizeof(out));
+    if (length == 0 || legacy != out) {
+      Serial.printf("output mismatch for %s\n", url);
+      return 1;
+    }
+
+    uint32_t sink = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+      String encoded = legacyEncodeBech32(data);
+      sink += (uint8_t)encoded[encoded.length() - 1];
+    }
+    double legacyNs = (micros() - start) * 1000.0 / BENCH_ITERATIONS;
+
+    start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+      length = bech32Encode("lnurl", (const uint8_t*)url, dataLen, out, sizeof(out));
+      sink += (uint8_t)out[length - 1];
+    }
+    double newNs = (micros() - start) * 1000.0 / BENCH_ITERATIONS;
+
+    benchSink = benchSink + sink;
+    Serial.printf("%3u ch %8.0f ns    %8.0f ns    %5.1fx\n", (unsigned)dataLen, legacyNs, newNs, legacyNs / newNs);
+  }
+  return 0;
+}
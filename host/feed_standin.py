@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+feed_standin.py - Local stand-in for the mempool.space WebSocket feed
+
+Speaks just enough of the /api/v1/ws protocol for MarketFeed.cpp: accepts
+{"action":"want",...}, then pushes {"block":{"height":n}} every --interval
+seconds and a {"conversions":{...}} price table with every block. With
+--drop-after the connection is closed after that many pushes, to watch the
+ticker fall back to polling and the feed reconnect.
+
+Build the firmware with
+  -DMARKET_FEED_ENABLED=1 -DMARKET_FEED_HOST='"<this machine>"' -DMARKET_FEED_PORT=8999 -DMARKET_FEED_TLS=0
+
+Usage: host/feed_standin.py [--port 8999] [--interval 20] [--height 900000] [--drop-after N]
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import random
+import struct
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+async def read_frame(reader):
+    """Return (opcode, payload) of the next client frame (always masked)."""
+    header = await reader.readexactly(2)
+    opcode = header[0] & 0x0F
+    length = header[1] & 0x7F
+    if length == 126:
+        length = struct.unpack(">H", await reader.readexactly(2))[0]
+    elif length == 127:
+        length = struct.unpack(">Q", await reader.readexactly(8))[0]
+    mask = await reader.readexactly(4) if header[1] & 0x80 else b"\0\0\0\0"
+    data = await reader.readexactly(length)
+    return opcode, bytes(b ^ mask[i % 4] for i, b in enumerate(data))
+
+
+def frame(opcode, payload):
+    """Server frames are not masked."""
+    length = len(payload)
+    if length < 126:
+        header = struct.pack(">BB", 0x80 | opcode, length)
+    elif length < 65536:
+        header = struct.pack(">BBH", 0x80 | opcode, 126, length)
+    else:
+        header = struct.pack(">BBQ", 0x80 | opcode, 127, length)
+    return header + payload
+
+
+async def handshake(reader, writer):
+    request = (await reader.readuntil(b"\r\n\r\n")).decode("latin-1")
+    key = ""
+    for line in request.split("\r\n"):
+        if line.lower().startswith("sec-websocket-key:"):
+            key = line.split(":", 1)[1].strip()
+    accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+    writer.write(("HTTP/1.1 101 Switching Protocols\r\n"
+                  "Upgrade: websocket\r\n"
+                  "Connection: Upgrade\r\n"
+                  f"Sec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+    await writer.drain()
+    return request.split(" ", 2)[1]
+
+
+def conversions(base_usd):
+    rates = {"USD": 1.0, "EUR": 0.92, "GBP": 0.79, "CAD": 1.36, "CHF": 0.88, "AUD": 1.52, "JPY": 151.0}
+    usd = base_usd * random.uniform(0.995, 1.005)
+    return {"time": 0, **{code: round(usd * rate) for code, rate in rates.items()}}
+
+
+async def client(reader, writer, args, state):
+    peer = writer.get_extra_info("peername")
+    path = await handshake(reader, writer)
+    print(f"{peer}: connected ({path})")
+
+    async def receive():
+        while True:
+            opcode, payload = await read_frame(reader)
+            if opcode == 0x8:  # Close
+                return
+            if opcode == 0x9:  # Ping -> Pong
+                writer.write(frame(0xA, payload))
+                await writer.drain()
+            elif opcode == 0x1:
+                print(f"{peer}: <- {payload.decode(errors='replace')}")
+
+    receiver = asyncio.ensure_future(receive())
+    pushes = 0
+    try:
+        while not receiver.done():
+            await asyncio.wait([receiver], timeout=args.interval)
+            if receiver.done():
+                break
+            state["height"] += 1
+            message = {"block": {"height": state["height"], "id": "00" * 32, "tx_count": 1},
+                       "conversions": conversions(args.usd)}
+            writer.write(frame(0x1, json.dumps(message).encode()))
+            await writer.drain()
+            pushes += 1
+            print(f"{peer}: -> block {state['height']}")
+            if args.drop_after and pushes >= args.drop_after:
+                print(f"{peer}: dropping connection")
+                break
+    except (ConnectionError, asyncio.IncompleteReadError):
+        pass
+    finally:
+        receiver.cancel()
+        writer.close()
+        print(f"{peer}: closed")
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8999)
+    parser.add_argument("--interval", type=float, default=20.0, help="seconds between pushed blocks")
+    parser.add_argument("--height", type=int, default=900000, help="height before the first push")
+    parser.add_argument("--usd", type=float, default=100000.0, help="base BTC/USD price")
+    parser.add_argument("--drop-after", type=int, default=0, help="close the connection after N pushes")
+    args = parser.parse_args()
+
+    state = {"height": args.height}
+    server = await asyncio.start_server(lambda r, w: client(r, w, args, state), "0.0.0.0", args.port)
+    print(f"Feed stand-in listening on port {args.port}")
+    async with server:
+        await server.serve_forever()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,27 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+/**
+ * FreeRTOS.h - Host shim of the FreeRTOS types used by src/
+ *
+ * The host build is single-threaded: critical sections are no-ops
+ * (see Arduino.h).
+ */
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdTRUE  ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// Core of the calling "task" (see hostRunAs() in task.h)
+BaseType_t xPortGetCoreID();
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,24 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+/**
+ * task.h - Host shim of the FreeRTOS task functions used by src/
+ *
+ * The host build runs everything in one thread. Tests can make the code
+ * under test believe it runs in another task, on another core, with
+ * hostRunAs() (e.g. a button callback of Task1 on core 0).
+ */
+
+#include "FreeRTOS.h"
+
+typedef struct HostTask* TaskHandle_t;
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+/**
+ * Pretend to run as task (0 = the main task, which runs setup()/loop())
+ * on core until the next call.
+ */
+void hostRunAs(uint8_t task, BaseType_t core);
+
+#endif // HOST_FREERTOS_TASK_H
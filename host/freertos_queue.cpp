@@ -0,0 +1,45 @@
+#include "freertos/queue.h"
+#include <string.h>
+#include <vector>
+
+struct HostQueue {
+  std::vector<uint8_t> storage;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue* queue = new HostQueue();
+  queue->storage.resize(length * itemSize);
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->head = 0;
+  queue->count = 0;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+  if (!queue || queue->count >= queue->length) return pdFALSE;
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  memcpy(&queue->storage[tail * queue->itemSize], item, queue->itemSize);
+  queue->count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t) {
+  if (!queue || queue->count == 0) return pdFALSE;
+  memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue ? queue->count : 0;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
@@ -0,0 +1,22 @@
+#include "freertos/task.h"
+
+struct HostTask {
+  uint8_t id;
+};
+
+static HostTask tasks[4] = {{0}, {1}, {2}, {3}};
+static HostTask* currentTask = &tasks[0];
+static BaseType_t currentCore = 1;   // setup() and loop() run on core 1
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return currentTask;
+}
+
+BaseType_t xPortGetCoreID() {
+  return currentCore;
+}
+
+void hostRunAs(uint8_t task, BaseType_t core) {
+  currentTask = &tasks[task % 4];
+  currentCore = core;
+}
@@ -0,0 +1,56 @@
+#include <Arduino.h>
+#include "GlobalState.h"
+#include "Payment.h"
+#include "DeviceState.h"
+
+/**
+ * host_main.cpp - Entry point of the native build
+ *
+ * Provides the globals that live in main.cpp on the device and
+ * prints the QR payloads of all product pins for a given switch, e.g.
+ *   .pio/build/native/program legend.lnbits.com AbCdEfGhIjKlMnOpQrStUv [bech32|lud17]
+ * or runs a benchmark (--bench-json, see bench_api_response.cpp;
+ * --bench-bech32, see bench_bech32.cpp) or the reconnect simulation
+ * (--sim-reconnect, see sim_ws_reconnect.cpp).
+ * Declared weak so a unit test runner can supply its own main().
+ */
+
+String lnbitsServer;
+String deviceId;
+QrFormat qrFormat = QrFormat::BECH32;
+String currency = "USD";
+StateManager deviceState;
+
+int runApiResponseBenchmark();
+int runBech32Benchmark();
+int runWsReconnectSimulation();
+
+__attribute__((weak)) int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--bench-json") == 0) {
+    return runApiResponseBenchmark();
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-bech32") == 0) {
+    return runBech32Benchmark();
+  }
+  if (argc > 1 && strcmp(argv[1], "--sim-reconnect") == 0) {
+    return runWsReconnectSimulation();
+  }
+  if (argc < 3) {
+    Serial.println("usage: program <lnbits-server> <device-id> [bech32|lud17]");
+    Serial.println("       program --bench-json");
+    Serial.println("       program --bench-bech32");
+    Serial.println("       program --sim-reconnect");
+    return 1;
+  }
+  lnbitsServer = argv[1];
+  deviceId = argv[2];
+  if (argc > 3 && strcmp(argv[3], qrFormatValues[(uint8_t)QrFormat::LUD17]) == 0) qrFormat = QrFormat::LUD17;
+
+  rebuildLnurlCache();
+  static const int productPins[] = {12, 13, 10, 11};
+  for (int pin : productPins) {
+    const char* payload = getCachedLnurl(pin);
+    Serial.printf("pin %d: %s\n", pin, payload ? payload : "(none)");
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+logdecode.py - Turn binary log records back into text
+
+Firmware built with -DLOG_BINARY_OUTPUT=1 prints LOG_REC_* records as
+  #L <time ms> <level> <tag id> <format id> [<arg> ...]   (all hex)
+This script replaces those lines with the same text the device prints in
+normal mode, using the tag/format tables from include/LogFormats.def.
+Every other line is passed through unchanged.
+
+Usage: host/logdecode.py [capture.txt] [--formats include/LogFormats.def]
+       pio device monitor | host/logdecode.py
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+LEVELS = ["ERROR", "WARN", "INFO", "DEBUG"]
+SPEC = re.compile(r"%([-+ #0]*[0-9]*(?:\.[0-9]+)?)(?:hh|h|ll|l)?([diuxXcfFeEgG%])")
+
+
+def load_tables(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    # Drop comments so the examples in the header are not picked up
+    text = re.sub(r"(?m)^\s*//[^\n]*", "", text)
+    tags = re.findall(r'LOG_TAG\(\s*\w+\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', text)
+    formats = re.findall(r'LOG_FORMAT\(\s*\w+\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', text)
+    return tags, formats
+
+
+def format_record(fmt, args):
+    values = iter(args)
+
+    def expand(match):
+        flags, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = next(values, 0)
+        if conversion in "di":
+            value = struct.unpack("<i", struct.pack("<I", value))[0]
+            conversion = "d"
+        elif conversion in "fFeEgG":
+            value = struct.unpack("<f", struct.pack("<I", value))[0]
+        elif conversion == "u":
+            conversion = "d"
+        elif conversion == "c":
+            value = chr(value & 0xFF)
+        return ("%" + flags + conversion) % value
+
+    return SPEC.sub(expand, fmt)
+
+
+def decode_line(line, tags, formats):
+    fields = line.split()
+    if len(fields) < 5 or fields[0] != "#L":
+        return line
+    try:
+        time_ms, level, tag, fmt_id = (int(x, 16) for x in fields[1:5])
+        args = [int(x, 16) for x in fields[5:]]
+    except ValueError:
+        return line
+    level_name = LEVELS[level] if level < len(LEVELS) else "INFO"
+    tag_name = tags[tag] if tag < len(tags) else "?"
+    fmt = formats[fmt_id] if fmt_id < len(formats) else "(unknown format %d)" % fmt_id
+    return "[%s][%s] [+%d.%ds] %s" % (level_name, tag_name, time_ms // 1000,
+                                      (time_ms % 1000) // 100, format_record(fmt, args))
+
+
+def main():
+    default_formats = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                   "..", "include", "LogFormats.def")
+    parser = argparse.ArgumentParser(description="Decode ZapBox binary log records")
+    parser.add_argument("capture", nargs="?", help="serial capture (default: stdin)")
+    parser.add_argument("--formats", default=default_formats, help="path to LogFormats.def")
+    options = parser.parse_args()
+
+    tags, formats = load_tables(options.formats)
+    source = open(options.capture, encoding="utf-8", errors="replace") if options.capture else sys.stdin
+    with source:
+        for line in source:
+            print(decode_line(line.rstrip("\r\n"), tags, formats))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,154 @@
+#include <Arduino.h>
+#include "WsReconnect.h"
+
+/**
+ * sim_ws_reconnect.cpp - Host simulation of the WebSocket reconnect manager
+ *
+ * Drives WsReconnect with a fake socket through a server outage on a
+ * simulated clock and checks that the manager never attempts while the
+ * network is down, that the backoff grows up to WS_RECONNECT_MAX_MS, that
+ * it reconnects once the server is back, and how far a fleet of devices
+ * spreads out when the server returns.
+ *   .pio/build/native/program --sim-reconnect
+ */
+
+static const unsigned long TICK_MS = 10;
+static const int FLEET_SIZE = 200;
+
+// Connects CONNECT_DELAY_MS after connect() while the server is reachable
+// and accepting WebSocket connections
+class FakeSocket : public ReconnectTarget {
+public:
+  static const unsigned long CONNECT_DELAY_MS = 300;
+
+  bool reachable = true;   // WiFi + TCP port (what the probe task reports)
+  bool accepting = true;   // WebSocket upgrade succeeds
+  bool connected = false;
+  bool connecting = false;
+  unsigned long connectAt = 0;
+  unsigned long now = 0;
+  uint32_t connects = 0;
+
+  bool isConnected() override { return connected; }
+
+  void connect() override {
+    connects++;
+    connecting = true;
+    connectAt = now + CONNECT_DELAY_MS;
+  }
+
+  void disconnect() override {
+    connected = false;
+    connecting = false;
+  }
+
+  // What webSocket.loop() would do
+  void service() {
+    if (!reachable || !accepting) {
+      connected = false;
+      connecting = false;
+    } else if (connecting && (long)(now - connectAt) >= 0) {
+      connecting = false;
+      connected = true;
+    }
+  }
+};
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+  Serial.printf("  %-58s %s\n", what, condition ? "ok" : "FAILED");
+  if (!condition) failures++;
+}
+
+// Advance one device to until; returns the first time it is connected (0 = never)
+static unsigned long run(FakeSocket& socket, unsigned long until) {
+  unsigned long connectedAt = 0;
+  for (; socket.now < until; socket.now += TICK_MS) {
+    wsReconnectTick(socket.now, socket.reachable);
+    if (wsReconnectSocketActive()) socket.service();
+    if (connectedAt == 0 && socket.connected) connectedAt = socket.now;
+  }
+  return connectedAt;
+}
+
+static void simulateOutage() {
+  Serial.println("Single device:");
+  FakeSocket socket;
+  socket.connected = true;
+  wsReconnectBegin(&socket, 0x5eed1234, socket.now);
+  run(socket, 60000);
+  expect(wsReconnectStats().attempts == 0, "no attempts while connected");
+
+  // LNbits refuses the WebSocket for 10 minutes (port still open)
+  socket.accepting = false;
+  socket.connected = false;
+  run(socket, socket.now + 10UL * 60UL * 1000UL);
+  WsReconnectStats stats = wsReconnectStats();
+  Serial.printf("  10 min refused: attempts %lu, failures %lu, last delay %lu ms\n",
+                (unsigned long)stats.attempts, (unsigned long)stats.failures, stats.nextDelayMs);
+  expect(stats.attempts < 20, "backoff keeps attempts low (< 20 in 10 min)");
+  expect(stats.nextDelayMs >= WS_RECONNECT_MAX_MS / 2 && stats.nextDelayMs <= WS_RECONNECT_MAX_MS,
+         "delay capped in [MAX/2, MAX]");
+  expect(stats.consecutiveFailures >= WS_RECONNECT_ERROR_AFTER, "error screen threshold reached");
+
+  // Network down for 5 minutes: no attempts, no failures
+  socket.reachable = false;
+  uint32_t connectsBefore = socket.connects;
+  run(socket, socket.now + 5UL * 60UL * 1000UL);
+  expect(socket.connects == connectsBefore, "no attempts while the network is down");
+  expect(wsReconnectStats().failures == stats.failures, "held attempts are not failures");
+
+  // Everything back: reconnect within the pending delay
+  socket.reachable = true;
+  socket.accepting = true;
+  unsigned long backAt = socket.now;
+  unsigned long connectedAt = run(socket, backAt + 5UL * 60UL * 1000UL);
+  Serial.printf("  reconnected %lu ms after the network came back\n", connectedAt - backAt);
+  expect(connectedAt != 0 && connectedAt - backAt <= WS_RECONNECT_MAX_MS + FakeSocket::CONNECT_DELAY_MS,
+         "reconnects within one capped delay");
+  expect(wsReconnectStats().state == WS_RECONNECT_CONNECTED && wsReconnectStats().consecutiveFailures == 0,
+         "CONNECTED, failure streak reset");
+}
+
+// Devices that lost the server at the same moment: when do they come back?
+static void simulateFleet() {
+  Serial.printf("Fleet of %d devices, WebSocket refused for 5 minutes:\n", FLEET_SIZE);
+  static unsigned long reconnectAt[FLEET_SIZE];
+  const unsigned long outageEnd = 5UL * 60UL * 1000UL;
+
+  for (int device = 0; device < FLEET_SIZE; device++) {
+    FakeSocket socket;
+    socket.connected = true;
+    wsReconnectBegin(&socket, 0x9e3779b9u * (device + 1), 0);
+    socket.connected = false;
+    socket.accepting = false;
+    run(socket, outageEnd);
+    socket.accepting = true;
+    reconnectAt[device] = run(socket, outageEnd + 10UL * 60UL * 1000UL) - outageEnd;
+  }
+
+  // Busiest second after the server recovered
+  unsigned long last = 0;
+  for (int device = 0; device < FLEET_SIZE; device++) {
+    if (reconnectAt[device] > last) last = reconnectAt[device];
+  }
+  int peak = 0;
+  for (unsigned long second = 0; second <= last / 1000; second++) {
+    int count = 0;
+    for (int device = 0; device < FLEET_SIZE; device++) {
+      if (reconnectAt[device] / 1000 == second) count++;
+    }
+    if (count > peak) peak = count;
+  }
+  Serial.printf("  all reconnected within %lu s, peak %d reconnects/s\n", last / 1000, peak);
+  expect(peak < FLEET_SIZE / 10, "no lockstep (peak < 10% of the fleet per second)");
+  expect(last <= WS_RECONNECT_MAX_MS + WS_RECONNECT_ATTEMPT_MS, "everyone back within one capped delay");
+}
+
+int runWsReconnectSimulation() {
+  simulateOutage();
+  simulateFleet();
+  Serial.printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? 1 : 0;
+}
@@ -2,6 +2,7 @@
 #define LOG_HELPER_H
 
 #include <Arduino.h>
+#include <string.h>
 
 namespace Log {
   enum Level {
@@ -19,6 +20,11 @@ namespace Log {
 #define LOG_LEVEL Log::INFO
 #endif
 
+// True if messages of this level are compiled in. The condition is a
+// constant, so disabled LOG_* calls (including their String arguments)
+// are removed by the compiler.
+#define LOG_LEVEL_ENABLED(LVL) (LOG_ENABLE && (int)(LVL) <= (int)(LOG_LEVEL))
+
   inline const char* levelName(Level lvl) {
     switch (lvl) {
       case ERROR: return "ERROR";
@@ -29,37 +35,109 @@ namespace Log {
     }
   }
 
-  // Core print function
-  inline void print(Level lvl, const char* tag, const String& message, bool showTime = true) {
-#if LOG_ENABLE
-    if ((int)lvl <= (int)LOG_LEVEL) {
-      String out;
-      out += "[";
-      out += levelName(lvl);
-      out += "]";
-      if (tag && *tag) {
-        out += "[";
-        out += tag;
-        out += "] ";
-      } else {
-        out += " ";
-      }
-      if (showTime) {
-        out += "[+";
-        out += String(millis() / 1000.0, 1);
-        out += "s] ";
-      }
-      out += message;
-      Serial.println(out);
-    }
-#endif
+  // ==========================================================================
+  // Binary log records (LOG_REC_* macros)
+  //
+  // A record stores a timestamp, a tag id, a format id (LogFormats.def) and
+  // up to LOG_RECORD_MAX_ARGS numeric arguments. Logging only copies these
+  // into a lock-free ring buffer; formatting and the Serial write happen
+  // later in a low-priority drain task (LogBuffer.cpp), so LOG_REC_* is safe
+  // and cheap from both cores, timer callbacks and the WebSocket handler.
+  // Text messages share the ring buffer (see pushText() below).
+  // ==========================================================================
+
+  static constexpr int LOG_RECORD_MAX_ARGS = 4;
+
+  enum TagId : uint8_t {
+#define LOG_TAG(id, name) TAG_##id,
+#include "LogFormats.def"
+    TAG_COUNT
+  };
+
+  enum FormatId : uint16_t {
+#define LOG_FORMAT(id, format) FMT_##id,
+#include "LogFormats.def"
+    FMT_COUNT
+  };
+
+  /**
+   * Copy one record into the ring buffer. Never blocks; if the buffer is
+   * full the record is counted as dropped.
+   */
+  void pushRecord(Level lvl, TagId tag, FormatId format, const uint32_t* args, uint8_t argCount);
+
+  /**
+   * Start the drain task that prints buffered records to Serial.
+   * Records logged before this call are kept until the task runs.
+   */
+  void beginRecordDrain();
+
+  /**
+   * Print all buffered records now (used by the host build and before
+   * restarts/deep sleep so nothing is lost).
+   */
+  void drainRecords();
+
+  // Arguments are stored as raw 32 bit words; floats keep their bit pattern
+  inline uint32_t toArg(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+  inline uint32_t toArg(double value) { return toArg((float)value); }
+  template <typename T>
+  inline uint32_t toArg(T value) { return (uint32_t)value; }
+
+  template <typename... Args>
+  inline void record(Level lvl, TagId tag, FormatId format, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_RECORD_MAX_ARGS, "too many arguments for a log record");
+    const uint32_t values[] = {0, toArg(args)...};
+    pushRecord(lvl, tag, format, values + 1, (uint8_t)sizeof...(Args));
+  }
+
+  // ==========================================================================
+  // Text messages (LOG_ERROR/WARN/INFO/DEBUG and the printf-style LOG_*F)
+  //
+  // The text is copied into one of LOG_TEXT_SLOTS fixed slots and a record
+  // referring to it goes through the same ring buffer and drain task as the
+  // binary records, so both come out in the order they were logged. Text
+  // longer than LOG_TEXT_LENGTH is cut off.
+  // ==========================================================================
+
+  /**
+   * Queue one text message. Never blocks; if no text slot or record is free
+   * the message is counted as dropped.
+   */
+  void pushText(Level lvl, const char* tag, const char* message);
+
+  /**
+   * printf-style pushText(); formats straight into the text slot.
+   */
+  void printFormat(Level lvl, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+  inline void print(Level lvl, const char* tag, const String& message) {
+    pushText(lvl, tag, message.c_str());
   }
 }
 
 // Convenience macros
-#define LOG_ERROR(TAG, MSG) Log::print(Log::ERROR, TAG, String(MSG))
-#define LOG_WARN(TAG, MSG)  Log::print(Log::WARN,  TAG, String(MSG))
-#define LOG_INFO(TAG, MSG)  Log::print(Log::INFO,  TAG, String(MSG))
-#define LOG_DEBUG(TAG, MSG) Log::print(Log::DEBUG, TAG, String(MSG))
+#define LOG_ERROR(TAG, MSG) do { if (LOG_LEVEL_ENABLED(Log::ERROR)) Log::print(Log::ERROR, TAG, String(MSG)); } while (0)
+#define LOG_WARN(TAG, MSG)  do { if (LOG_LEVEL_ENABLED(Log::WARN))  Log::print(Log::WARN,  TAG, String(MSG)); } while (0)
+#define LOG_INFO(TAG, MSG)  do { if (LOG_LEVEL_ENABLED(Log::INFO))  Log::print(Log::INFO,  TAG, String(MSG)); } while (0)
+#define LOG_DEBUG(TAG, MSG) do { if (LOG_LEVEL_ENABLED(Log::DEBUG)) Log::print(Log::DEBUG, TAG, String(MSG)); } while (0)
+
+// printf-style text, e.g. LOG_INFOF("STARTUP", "Ready after %.1f s", seconds);
+#define LOG_ERRORF(TAG, FMT, ...) do { if (LOG_LEVEL_ENABLED(Log::ERROR)) Log::printFormat(Log::ERROR, TAG, FMT, ##__VA_ARGS__); } while (0)
+#define LOG_WARNF(TAG, FMT, ...)  do { if (LOG_LEVEL_ENABLED(Log::WARN))  Log::printFormat(Log::WARN,  TAG, FMT, ##__VA_ARGS__); } while (0)
+#define LOG_INFOF(TAG, FMT, ...)  do { if (LOG_LEVEL_ENABLED(Log::INFO))  Log::printFormat(Log::INFO,  TAG, FMT, ##__VA_ARGS__); } while (0)
+#define LOG_DEBUGF(TAG, FMT, ...) do { if (LOG_LEVEL_ENABLED(Log::DEBUG)) Log::printFormat(Log::DEBUG, TAG, FMT, ##__VA_ARGS__); } while (0)
+
+// Binary records: TAG and FMT are ids from LogFormats.def without prefix,
+// e.g. LOG_REC_INFO(Relay, RELAY_ON, pin, durationMs);
+#define LOG_REC(LVL, TAG, FMT, ...) do { if (LOG_LEVEL_ENABLED(LVL)) Log::record(LVL, Log::TAG_##TAG, Log::FMT_##FMT, ##__VA_ARGS__); } while (0)
+#define LOG_REC_ERROR(TAG, FMT, ...) LOG_REC(Log::ERROR, TAG, FMT, ##__VA_ARGS__)
+#define LOG_REC_WARN(TAG, FMT, ...)  LOG_REC(Log::WARN,  TAG, FMT, ##__VA_ARGS__)
+#define LOG_REC_INFO(TAG, FMT, ...)  LOG_REC(Log::INFO,  TAG, FMT, ##__VA_ARGS__)
+#define LOG_REC_DEBUG(TAG, FMT, ...) LOG_REC(Log::DEBUG, TAG, FMT, ##__VA_ARGS__)
 
 #endif // LOG_HELPER_H
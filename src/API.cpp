@@ -1,8 +1,12 @@
 #include "API.h"
 #include "GlobalState.h"
 #include "DeviceState.h"
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
+#include "HttpsPool.h"
+#include "ApiResponse.h"
+#include "MarketData.h"
+#include "MarketFeed.h"
+#include "RelayScheduler.h"
+#include "Log.h"
 
 // External references to main.cpp
 extern StateManager deviceState;
@@ -28,148 +32,134 @@ static bool btcDataHasError = false; // Track if last BTC fetch had errors
 extern void btctickerScreen();
 extern void updateBtctickerValues(); // Partial update function
 
+/**
+ * True while the ticker screen is on the display and may be redrawn.
+ * ACTION TIME stays up (and btcTickerActive stays set) while a relay runs.
+ */
+static bool tickerOnScreen()
+{
+  return multiChannelConfig.btcTickerActive && !relayAnyActive() &&
+         !deviceState.isInState(DeviceState::ERROR_RECOVERABLE) && !deviceState.isInState(DeviceState::CONFIG_MODE) &&
+         !deviceState.isInState(DeviceState::HELP_SCREEN) && !deviceState.isInState(DeviceState::REPORT_SCREEN) &&
+         !deviceState.isInState(DeviceState::SCREENSAVER) &&
+         !deviceState.isInState(DeviceState::DEEP_SLEEP) && !deviceState.isInState(DeviceState::PRODUCT_SELECTION);
+}
+
 /**
  * Fetch switch labels and configuration from LNbits server.
  */
 void fetchSwitchLabels()
 {
   if (lnbitsServer.length() == 0 || deviceId.length() == 0) {
-    Serial.println("[LABELS] Cannot fetch labels - server or deviceId not configured");
+    LOG_INFO("LABELS", "Cannot fetch labels - server or deviceId not configured");
     return;
   }
 
   // Update last attempt time to prevent rapid retries
   lastFetchAttempt = millis();
 
-  HTTPClient http;
-  String url = "https://" + lnbitsServer + "/bitcoinswitch/api/v1/public/" + deviceId;
+  String path = "/bitcoinswitch/api/v1/public/" + deviceId;
   
-  Serial.println("[LABELS] Fetching switch configurations from: " + url);
-  http.begin(url);
-  http.setTimeout(5000); // 5 second timeout
-  
-  int httpCode = http.GET();
+  LOG_INFO("LABELS", "Fetching switch configurations from: https://" + lnbitsServer + path);
+  int httpCode = httpsGet(HTTPS_HOST_LNBITS, lnbitsServer.c_str(), path.c_str(), 5000);
   
   if (httpCode == 200) {
-    String payload = http.getString();
-    Serial.println("[LABELS] Received response: " + payload);
-    
-    // Parse JSON response
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
+    // Parse the stream through a filter: only currency and pin/label are kept
+    SwitchLabelsResponse response;
+    apiResponseResetPeak();
+    unsigned long parseStart = micros();
+    bool parsed = parseSwitchLabels(httpsBody(HTTPS_HOST_LNBITS), response);
+    LOG_INFOF("LABELS", "Parsed %u switches in %lu us, peak JSON heap %u bytes",
+                  (unsigned)response.switchCount, micros() - parseStart, (unsigned)apiResponsePeakBytes());
     
-    if (!error) {
+    if (parsed) {
       // Extract currency from response
-      const char* currencyChar = doc["currency"];
-      Serial.print("[LABELS] DEBUG - currency field from API: ");
-      if (currencyChar != nullptr) {
-        Serial.println(String(currencyChar));
+      if (response.currency[0] != '\0') {
         String oldCurrency = currency;
-        currency = String(currencyChar);
+        currency = response.currency;
         currency.toUpperCase(); // Ensure uppercase for display and API calls
-        Serial.println("[LABELS] Currency changed from '" + oldCurrency + "' to '" + currency + "'");
+        LOG_INFO("LABELS", "Currency changed from '" + oldCurrency + "' to '" + currency + "'");
       } else {
-        Serial.println("NULL - field not found in response");
         // Keep currency from config (don't override with USD)
-        Serial.println("[LABELS] No currency in API response, keeping config value: " + currency);
-      }
-      
-      // Clear existing labels
-      for (int i = 0; i < 4; i++) {
-        productLabels.labels[i] = "";
+        LOG_INFO("LABELS", "No currency in API response, keeping config value: " + currency);
       }
       
-      // Extract labels from switches array
-      JsonArray switches = doc["switches"];
-      for (JsonObject switchObj : switches) {
-        int pin = switchObj["pin"];
-        const char* labelChar = switchObj["label"];
-        String labelStr = (labelChar != nullptr) ? String(labelChar) : "";
-        
-        // Store label based on pin number using array index
-        int pinIndex = getPinIndex(pin);
-        if (pinIndex >= 0 && pinIndex < 4) {
-          productLabels.labels[pinIndex] = labelStr;
-          Serial.println("[LABELS] Pin " + String(pin) + " label: " + labelStr);
+      // Replace all labels (pins missing in the response are cleared)
+      memcpy(productLabels.labels, response.labels, sizeof(productLabels.labels));
+      static const int productPins[] = {12, 13, 10, 11};
+      for (int pin : productPins) {
+        const char* label = productLabels.labels[getPinIndex(pin)];
+        if (label[0] != '\0') {
+          LOG_INFO("LABELS", "Pin " + String(pin) + " label: " + label);
         }
       }
       
-      Serial.println("[LABELS] Successfully fetched and cached all labels");
+      LOG_INFO("LABELS", "Successfully fetched and cached all labels");
       labelsLoadedSuccessfully = true; // Mark labels as successfully loaded
       productLabels.lastUpdate = millis(); // Update timestamp
       
+      // Finish this response (the connection stays open for the next refresh)
+      httpsEnd(HTTPS_HOST_LNBITS);
+      
       // Always fetch Bitcoin data with the correct currency (not just when ticker is active)
       // This ensures data is ready when ticker is activated
-      Serial.println("[LABELS] Currency received - fetching Bitcoin data with correct currency");
+      LOG_INFO("LABELS", "Currency received - fetching Bitcoin data with correct currency");
       fetchBitcoinData();
       
       // If ticker is currently active, redraw screen to show new currency
-      if (multiChannelConfig.btcTickerActive) {
-        Serial.println("[LABELS] Ticker active - refreshing display");
+      if (tickerOnScreen()) {
+        LOG_INFO("LABELS", "Ticker active - refreshing display");
         btctickerScreen();
       }
-    } else {
-      Serial.println("[LABELS] JSON parsing failed: " + String(error.c_str()));
+      return;
     }
   } else {
-    Serial.printf("[LABELS] HTTP request failed with code: %d\n", httpCode);
+    LOG_WARNF("LABELS", "HTTP request failed with code: %d", httpCode);
   }
   
-  http.end();
+  httpsEnd(HTTPS_HOST_LNBITS);
 }
 
 /**
- * Fetch Bitcoin price and block height from external APIs (sequential).
+ * Copy the cached market data into bitcoinData.
  */
-void fetchBitcoinData()
+static void showMarketData()
 {
-  Serial.println("[BTC] Fetching Bitcoin data...");
+  // Show the newest usable values - an older price beats "Error" until it expires
+  MarketValue price = marketDataPrice(currency.c_str());
+  MarketValue height = marketDataBlockHeight();
+  bitcoinData.price = price.valid ? String((int)price.value) : String("Error");
+  bitcoinData.blockHigh = height.valid ? String((uint32_t)height.value) : String("Error");
+  
+  LOG_INFO("BTC", "Price: " + bitcoinData.price + " " + currency + " (age " + String(price.ageMs / 1000) + " s)");
+  LOG_INFO("BTC", "Block height: " + bitcoinData.blockHigh + " (age " + String(height.ageMs / 1000) + " s)");
+}
+
+/**
+ * Fetch Bitcoin price and block height through the market data service.
+ */
+void fetchBitcoinData(bool updateTimestamp)
+{
+  LOG_INFO("BTC", "Fetching Bitcoin data...");
   
   // Update last fetch attempt time for backoff
   lastFetchAttempt = millis();
   
-  HTTPClient http;
-  String currencyLower = currency;
-  currencyLower.toLowerCase();
+  // The block height is pushed while the feed is connected
+  bool refreshed = marketFeedLive() ? marketDataRefreshPrices(currency.c_str()) : marketDataRefresh(currency.c_str());
+  httpsPoolLogStats();
   
-  // Fetch BTC price from CoinGecko
-  bitcoinData.price = "Error";
-  String apiUrl = "https://api.coingecko.com/api/v3/simple/price?ids=bitcoin&vs_currencies=" + currencyLower;
-  http.begin(apiUrl);
-  http.setTimeout(5000);
+  showMarketData();
   
-  if (http.GET() == 200) {
-    JsonDocument doc;
-    if (!deserializeJson(doc, http.getString()) && doc["bitcoin"].is<JsonObject>()) {
-      float price = doc["bitcoin"][currencyLower];
-      bitcoinData.price = String((int)price);
-    }
-  }
-  http.end();
-  
-  delay(200); // SSL cleanup delay
-  
-  // Fetch block height from Mempool
-  bitcoinData.blockHigh = "Error";
-  http.begin("https://mempool.space/api/blocks/tip/height");
-  http.setTimeout(5000);
-  
-  if (http.GET() == 200) {
-    bitcoinData.blockHigh = http.getString();
-    bitcoinData.blockHigh.trim();
-  }
-  http.end();
-  
-  Serial.println("[BTC] Price: " + bitcoinData.price + " " + currency);
-  Serial.println("[BTC] Block height: " + bitcoinData.blockHigh);
-  
-  // Check if any data failed to load
-  btcDataHasError = (bitcoinData.price == "Error" || bitcoinData.blockHigh == "Error");
+  // Retry sooner while a value could not be refreshed (even if a cached one is shown)
+  btcDataHasError = !refreshed;
   if (btcDataHasError) {
-    Serial.println("[BTC] ERROR detected - will retry in 1 minute instead of 5 minutes");
+    LOG_WARN("BTC", "Error detected - will retry in 1 minute instead of 5 minutes");
   }
   
-  bitcoinData.lastUpdate = millis();
+  if (updateTimestamp) {
+    bitcoinData.lastUpdate = millis();
+  }
 }
 
 /**
@@ -177,8 +167,23 @@ void fetchBitcoinData()
  */
 void updateBitcoinTicker()
 {
-  // Only update if ticker is active and not in error/config/help modes
-  if (!multiChannelConfig.btcTickerActive || deviceState.isInState(DeviceState::ERROR_RECOVERABLE) || deviceState.isInState(DeviceState::CONFIG_MODE) || deviceState.isInState(DeviceState::HELP_SCREEN)) {
+  // Values pushed by the feed: shown right away, the polling timer keeps running
+  if (marketFeedTakeUpdate()) {
+    showMarketData();
+    if (tickerOnScreen()) {
+      updateBtctickerValues();
+      LOG_INFO("BTC", "Values updated from the feed");
+    }
+  }
+
+  // Only update if ticker is active and not in error/config/help/report modes
+  if (!multiChannelConfig.btcTickerActive || deviceState.isInState(DeviceState::ERROR_RECOVERABLE) || deviceState.isInState(DeviceState::CONFIG_MODE) || deviceState.isInState(DeviceState::HELP_SCREEN) ||
+      deviceState.isInState(DeviceState::REPORT_SCREEN)) {
+    return;
+  }
+
+  // No blocking fetch while a relay runs - the update is picked up afterwards
+  if (relayAnyActive()) {
     return;
   }
 
@@ -194,14 +199,14 @@ void updateBitcoinTicker()
       return; // Too soon - skip this attempt
     }
     
-    Serial.println("[BTC] Update interval reached, fetching new data...");
+    LOG_INFO("BTC", "Update interval reached, fetching new data...");
     fetchBitcoinData();
 
     // Refresh the display ONLY if we're STILL on the ticker screen
     // Use partial update to reduce flicker (only updates values, not full redraw)
-    if (multiChannelConfig.btcTickerActive && !deviceState.isInState(DeviceState::SCREENSAVER) && !deviceState.isInState(DeviceState::DEEP_SLEEP) && !deviceState.isInState(DeviceState::PRODUCT_SELECTION)) {
+    if (tickerOnScreen()) {
       updateBtctickerValues(); // Partial update instead of btctickerScreen()
-      Serial.println("[BTC] Values updated (partial refresh - reduced flicker)");
+      LOG_INFO("BTC", "Values updated (partial refresh - reduced flicker)");
     }
   }
 }
@@ -211,8 +216,14 @@ void updateBitcoinTicker()
  */
 void updateSwitchLabels()
 {
-  // Skip if in error/config/help modes
-  if (deviceState.isInState(DeviceState::ERROR_RECOVERABLE) || deviceState.isInState(DeviceState::CONFIG_MODE) || deviceState.isInState(DeviceState::HELP_SCREEN)) {
+  // Skip if in error/config/help/report modes
+  if (deviceState.isInState(DeviceState::ERROR_RECOVERABLE) || deviceState.isInState(DeviceState::CONFIG_MODE) || deviceState.isInState(DeviceState::HELP_SCREEN) ||
+      deviceState.isInState(DeviceState::REPORT_SCREEN)) {
+    return;
+  }
+
+  // No blocking fetch while a relay runs - the update is picked up afterwards
+  if (relayAnyActive()) {
     return;
   }
 
@@ -226,9 +237,9 @@ void updateSwitchLabels()
     }
     
     if (!labelsLoadedSuccessfully) {
-      Serial.println("[LABELS] Labels not loaded successfully, retrying...");
+      LOG_INFO("LABELS", "Labels not loaded successfully, retrying...");
     } else {
-      Serial.println("[LABELS] Periodic update interval reached, fetching labels...");
+      LOG_INFO("LABELS", "Periodic update interval reached, fetching labels...");
     }
     fetchSwitchLabels();
   }
@@ -6,9 +6,11 @@
 /**
  * API.h - Server Communication Module
  * 
- * This module handles all external API calls:
+ * This module handles all external API calls (sent over the kept-alive
+ * connections of HttpsPool.h, parsed with the streaming parsers in
+ * ApiResponse.h):
  * - Switch label fetching from LNbits server
- * - Bitcoin price and block height from CoinGecko/Mempool.space
+ * - Bitcoin price and block height (via MarketData.h)
  * - Periodic updates for labels and BTC data
  */
 
@@ -20,17 +22,20 @@
 void fetchSwitchLabels();
 
 /**
- * Fetch Bitcoin price and block height from external APIs.
- * - Price from CoinGecko (uses configured currency)
- * - Block height from mempool.space
- * Updates bitcoinData global struct.
+ * Fetch Bitcoin price and block height (MarketData.h: all tracked
+ * currencies in one request, fallback sources, cached values).
+ * Updates bitcoinData global struct; a failed refresh keeps showing the
+ * last good values until they expire.
+ * @param updateTimestamp false keeps bitcoinData.lastUpdate, so an extra
+ *        fetch (e.g. after Internet recovery) does not shift the regular cycle
  */
-void fetchBitcoinData();
+void fetchBitcoinData(bool updateTimestamp = true);
 
 /**
  * Periodically update Bitcoin ticker display.
  * Only updates if ticker is active and update interval has passed.
- * Calls fetchBitcoinData() and refreshes display.
+ * Calls fetchBitcoinData() and refreshes display; values pushed by the
+ * market feed (MarketFeed.h) are shown as soon as they arrive.
  */
 void updateBitcoinTicker();
 
@@ -0,0 +1,156 @@
+#include "ApiResponse.h"
+#include "Log.h"
+#include <stddef.h>
+
+// Allocation header, keeps the returned block aligned like malloc()
+static constexpr size_t HEADER_SIZE = alignof(max_align_t) > sizeof(size_t) ? alignof(max_align_t) : sizeof(size_t);
+
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+  void* allocate(size_t size) override {
+    uint8_t* block = (uint8_t*)malloc(size + HEADER_SIZE);
+    if (!block) return nullptr;
+    *(size_t*)block = size;
+    add(size);
+    return block + HEADER_SIZE;
+  }
+
+  void deallocate(void* ptr) override {
+    if (!ptr) return;
+    uint8_t* block = (uint8_t*)ptr - HEADER_SIZE;
+    liveBytes -= *(size_t*)block;
+    free(block);
+  }
+
+  void* reallocate(void* ptr, size_t newSize) override {
+    if (!ptr) return allocate(newSize);
+    uint8_t* block = (uint8_t*)ptr - HEADER_SIZE;
+    size_t oldSize = *(size_t*)block;
+    uint8_t* resized = (uint8_t*)realloc(block, newSize + HEADER_SIZE);
+    if (!resized) return nullptr;
+    *(size_t*)resized = newSize;
+    liveBytes -= oldSize;
+    add(newSize);
+    return resized + HEADER_SIZE;
+  }
+
+  size_t liveBytes = 0;
+  size_t peakBytes = 0;
+
+private:
+  void add(size_t size) {
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+  }
+};
+
+static CountingAllocator allocator;
+
+ArduinoJson::Allocator* apiResponseAllocator() {
+  return &allocator;
+}
+
+size_t apiResponsePeakBytes() {
+  return allocator.peakBytes;
+}
+
+void apiResponseResetPeak() {
+  allocator.peakBytes = allocator.liveBytes;
+}
+
+// Copy text into a fixed buffer, cutting at a UTF-8 character boundary
+static void copyText(char* out, size_t outSize, const char* text) {
+  size_t length = text ? strlen(text) : 0;
+  if (length >= outSize) {
+    length = outSize - 1;
+    while (length > 0 && ((uint8_t)text[length] & 0xC0) == 0x80) length--;
+  }
+  if (length > 0) memcpy(out, text, length);
+  out[length] = '\0';
+}
+
+bool parseSwitchLabels(Stream& input, SwitchLabelsResponse& out) {
+  memset(&out, 0, sizeof(out));
+
+  JsonDocument filter(&allocator);
+  filter["currency"] = true;
+  filter["switches"][0]["pin"] = true;
+  filter["switches"][0]["label"] = true;
+
+  JsonDocument doc(&allocator);
+  DeserializationError error = deserializeJson(doc, input, DeserializationOption::Filter(filter));
+  if (error) {
+    LOG_WARN("LABELS", String("JSON parsing failed: ") + error.c_str());
+    return false;
+  }
+
+  copyText(out.currency, sizeof(out.currency), doc["currency"] | "");
+
+  for (JsonObject switchObj : doc["switches"].as<JsonArray>()) {
+    out.switchCount++;
+    int pinIndex = getPinIndex(switchObj["pin"] | -1);
+    if (pinIndex >= 0) {
+      copyText(out.labels[pinIndex], sizeof(out.labels[pinIndex]), switchObj["label"] | "");
+    }
+  }
+  return true;
+}
+
+uint8_t parseBitcoinPrices(Stream& input, const char* objectKey, const char* const currencies[],
+                           uint8_t count, float prices[]) {
+  JsonDocument filter(&allocator);
+  JsonObject filterPrices = objectKey ? filter[objectKey].to<JsonObject>() : filter.to<JsonObject>();
+  for (uint8_t i = 0; i < count; i++) {
+    filterPrices[currencies[i]] = true;
+    prices[i] = NAN;
+  }
+
+  JsonDocument doc(&allocator);
+  DeserializationError error = deserializeJson(doc, input, DeserializationOption::Filter(filter));
+  if (error) {
+    LOG_WARN("BTC", String("Price JSON parsing failed: ") + error.c_str());
+    return 0;
+  }
+
+  JsonObject table = objectKey ? doc[objectKey].as<JsonObject>() : doc.as<JsonObject>();
+  uint8_t found = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    JsonVariant value = table[currencies[i]];
+    if (value.is<float>() && value.as<float>() > 0) {
+      prices[i] = value.as<float>();
+      found++;
+    }
+  }
+  return found;
+}
+
+bool parseMarketFeedMessage(const char* json, size_t length, const char* const currencies[], uint8_t count,
+                            uint32_t& blockHeight, float prices[]) {
+  blockHeight = 0;
+  JsonDocument filter(&allocator);
+  filter["block"]["height"] = true;
+  filter["blocks"][0]["height"] = true;
+  for (uint8_t i = 0; i < count; i++) {
+    filter["conversions"][currencies[i]] = true;
+    prices[i] = NAN;
+  }
+
+  JsonDocument doc(&allocator);
+  DeserializationError error = deserializeJson(doc, json, length, DeserializationOption::Filter(filter));
+  if (error) {
+    LOG_WARN("FEED", String("JSON parsing failed: ") + error.c_str());
+    return false;
+  }
+
+  blockHeight = doc["block"]["height"] | 0u;
+  for (JsonObject block : doc["blocks"].as<JsonArray>()) {
+    uint32_t height = block["height"] | 0u;
+    if (height > blockHeight) blockHeight = height;
+  }
+  JsonObject conversions = doc["conversions"].as<JsonObject>();
+  for (uint8_t i = 0; i < count; i++) {
+    JsonVariant value = conversions[currencies[i]];
+    if (value.is<float>() && value.as<float>() > 0) prices[i] = value.as<float>();
+  }
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef API_RESPONSE_H
+#define API_RESPONSE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "GlobalState.h"
+
+/**
+ * ApiResponse.h - Streaming parsers for the JSON HTTP responses
+ *
+ * The responses are deserialized straight from the HTTP stream through an
+ * ArduinoJson filter, so neither the payload String nor the fields the
+ * device ignores (LNbits switch amounts, durations, comments...) are ever
+ * allocated. Results are copied into fixed-size structs.
+ *
+ * All JSON memory comes from a counting allocator, so the peak heap of a
+ * parse can be logged on the device and measured in the host benchmark.
+ */
+
+// LNbits /bitcoinswitch/api/v1/public/<id>
+struct SwitchLabelsResponse {
+  char currency[8];                     // Empty if the response has none
+  char labels[4][PRODUCT_LABEL_SIZE];   // Indexed with getPinIndex(pin)
+  uint8_t switchCount;                  // Switches in the response (incl. unknown pins)
+};
+
+/**
+ * Parse a switch configuration response, keeping only currency and
+ * switches[].pin / switches[].label.
+ * @param input Body stream (httpsBody())
+ * @return false on a JSON error (logged); out is then undefined
+ */
+bool parseSwitchLabels(Stream& input, SwitchLabelsResponse& out);
+
+/**
+ * Parse the BTC prices of several currencies from one response:
+ * - CoinGecko simple/price {"bitcoin":{"usd":p,"eur":p}}: objectKey "bitcoin"
+ * - mempool.space /api/v1/prices {"USD":p,"EUR":p,...}: objectKey nullptr
+ * @param currencies Keys exactly as in the response (case matters)
+ * @param prices Price per currency, NAN if missing or not positive
+ * @return Number of currencies with a price (0 on a JSON error)
+ */
+uint8_t parseBitcoinPrices(Stream& input, const char* objectKey, const char* const currencies[],
+                           uint8_t count, float prices[]);
+
+/**
+ * Parse one message of the mempool.space WebSocket feed (/api/v1/ws):
+ * {"block":{"height":n,...}}, {"blocks":[{"height":n,...},...]} and
+ * {"conversions":{"USD":p,...}}; everything else is filtered out.
+ * @param currencies Conversion keys (upper case)
+ * @param blockHeight Highest block height in the message, 0 if none
+ * @param prices Price per currency, NAN if not in the message
+ * @return false on a JSON error
+ */
+bool parseMarketFeedMessage(const char* json, size_t length, const char* const currencies[], uint8_t count,
+                            uint32_t& blockHeight, float prices[]);
+
+/**
+ * Allocator used for all parser documents (counts live and peak bytes).
+ * Not thread-safe: parse from one task at a time.
+ */
+ArduinoJson::Allocator* apiResponseAllocator();
+
+/**
+ * Highest number of bytes allocated at once since the last reset.
+ */
+size_t apiResponsePeakBytes();
+void apiResponseResetPeak();
+
+#endif // API_RESPONSE_H
@@ -0,0 +1,67 @@
+#include "Bech32.h"
+#include <string.h>
+
+static inline uint32_t bech32PolymodStep(uint32_t chk, uint8_t value) {
+  uint8_t top = chk >> 25;
+  chk = ((chk & 0x1ffffff) << 5) ^ value;
+  if (top & 1) chk ^= 0x3b6a57b2;
+  if (top & 2) chk ^= 0x26508e6d;
+  if (top & 4) chk ^= 0x1ea119fa;
+  if (top & 8) chk ^= 0x3d4233dd;
+  if (top & 16) chk ^= 0x2a1462b3;
+  return chk;
+}
+
+size_t bech32Encode(const char* hrp, const uint8_t* data, size_t dataLen, char* out, size_t outSize) {
+  size_t hrpLen = strlen(hrp);
+  size_t total = bech32EncodedLength(hrpLen, dataLen);
+  if (hrpLen == 0 || total + 1 > outSize) {
+    return 0;
+  }
+
+  // Checksum over the expanded (lowercase) hrp
+  uint32_t chk = 1;
+  for (size_t i = 0; i < hrpLen; i++) {
+    chk = bech32PolymodStep(chk, (uint8_t)bech32ToLower(hrp[i]) >> 5);
+  }
+  chk = bech32PolymodStep(chk, 0);
+  for (size_t i = 0; i < hrpLen; i++) {
+    chk = bech32PolymodStep(chk, (uint8_t)bech32ToLower(hrp[i]) & 31);
+  }
+
+  size_t pos = 0;
+  for (size_t i = 0; i < hrpLen; i++) {
+    out[pos++] = bech32ToUpper(hrp[i]);
+  }
+  out[pos++] = '1';
+
+  // Convert 8-bit to 5-bit groups (padded), feeding checksum and output together
+  uint32_t acc = 0;
+  int bits = 0;
+  for (size_t i = 0; i < dataLen; i++) {
+    acc = ((acc << 8) | data[i]) & 0xfff;
+    bits += 8;
+    while (bits >= 5) {
+      bits -= 5;
+      uint8_t value = (acc >> bits) & 31;
+      chk = bech32PolymodStep(chk, value);
+      out[pos++] = BECH32_CHARSET_UPPER[value];
+    }
+  }
+  if (bits > 0) {
+    uint8_t value = (acc << (5 - bits)) & 31;
+    chk = bech32PolymodStep(chk, value);
+    out[pos++] = BECH32_CHARSET_UPPER[value];
+  }
+
+  for (int i = 0; i < 6; i++) {
+    chk = bech32PolymodStep(chk, 0);
+  }
+  chk ^= 1;  // Bech32 constant (not Bech32m)
+  for (int i = 0; i < 6; i++) {
+    out[pos++] = BECH32_CHARSET_UPPER[(chk >> (5 * (5 - i))) & 31];
+  }
+
+  out[pos] = '\0';
+  return pos;
+}
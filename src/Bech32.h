@@ -0,0 +1,45 @@
+#ifndef BECH32_H
+#define BECH32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Bech32.h - Allocation-free bech32 encoder (BIP-173)
+ *
+ * Encodes straight into a caller-supplied buffer: the 8-to-5 bit
+ * conversion, checksum and character mapping run in a single pass without
+ * intermediate vectors or Strings. Output is uppercase as required for
+ * LNURL QR codes (uppercase gives a smaller alphanumeric QR).
+ */
+
+// BIP-173 charset, stored uppercase so no case conversion is needed on output
+static constexpr char BECH32_CHARSET_UPPER[33] = "QPZRY9X8GF2TVDW0S3JN54KHCE6MUA7L";
+
+constexpr char bech32ToUpper(char c) {
+  return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+}
+
+constexpr char bech32ToLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+/**
+ * Number of characters (without terminator) bech32Encode() writes.
+ */
+constexpr size_t bech32EncodedLength(size_t hrpLen, size_t dataLen) {
+  return hrpLen + 1 + (dataLen * 8 + 4) / 5 + 6;
+}
+
+/**
+ * Encode data as uppercase bech32 into out.
+ * @param hrp Human readable part (e.g. "lnurl"), any case
+ * @param data Bytes to encode
+ * @param dataLen Number of bytes
+ * @param out Destination buffer, null-terminated on success
+ * @param outSize Size of out in bytes
+ * @return Number of characters written, or 0 if out is too small
+ */
+size_t bech32Encode(const char* hrp, const uint8_t* data, size_t dataLen, char* out, size_t outSize);
+
+#endif // BECH32_H
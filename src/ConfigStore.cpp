@@ -0,0 +1,370 @@
+#include "ConfigStore.h"
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include "FFat.h"
+#include "GlobalState.h"
+#include "Log.h"
+#include <stddef.h>
+
+// NVS location of the blob
+static const char* NVS_NAMESPACE = "zapbox";
+static const char* NVS_KEY = "config";
+static constexpr uint32_t CONFIG_MAGIC = 0x46434258; // "XBCF"
+
+enum ConfigType : uint8_t {
+  CONFIG_STRING,
+  CONFIG_FLOAT,
+  CONFIG_INT,
+  CONFIG_BOOL,    // "yes" / "no"
+  CONFIG_CHOICE   // Index into the field's choices (stored as uint8_t enum)
+};
+
+// String normalization applied on import
+enum : uint8_t {
+  CONFIG_TRIM  = 1,
+  CONFIG_LOWER = 2,
+  CONFIG_UPPER = 4
+};
+
+typedef void (*ConfigNormalizer)(char* value, size_t size);
+
+struct ConfigField {
+  const char* key;          // "name" of the entry in config.json
+  uint8_t legacyIndex;      // Position of the entry in the config.json array
+  ConfigType type;
+  uint8_t flags;
+  uint16_t offset;          // Location in ConfigData
+  uint16_t size;
+  float min;                // Numbers: value range (clamped), strings: length range, choices: 0
+  float max;                //   choices: index of the last choice
+  const char* defaultValue; // Used when the key is missing or invalid
+  ConfigNormalizer normalize;
+  const char* const* choices;
+};
+
+// Map installer variants ("Always on", "when selecting", ...) to always/selecting/off
+static void normalizeTickerMode(char* value, size_t size) {
+  char letters[32];
+  size_t count = 0;
+  for (const char* p = value; *p && count < sizeof(letters) - 1; p++) {
+    if (*p >= 'a' && *p <= 'z') letters[count++] = *p;
+  }
+  letters[count] = '\0';
+
+  if (strstr(letters, "always")) {
+    strlcpy(value, "always", size);
+  } else if (strstr(letters, "select")) {
+    strlcpy(value, "selecting", size);
+  } else if (strcmp(letters, "off") == 0) {
+    strlcpy(value, "off", size);
+  } // else keep original (unknown value)
+}
+
+#define CONFIG_FIELD(member, key, index, type, flags, min, max, def, normalize) \
+  { key, index, type, flags, (uint16_t)offsetof(ConfigData, member), (uint16_t)sizeof(ConfigData::member), min, max, def, normalize, nullptr }
+
+#define CONFIG_CHOICE_FIELD(member, key, index, flags, choices, def, normalize) \
+  { key, index, CONFIG_CHOICE, flags, (uint16_t)offsetof(ConfigData, member), (uint16_t)sizeof(ConfigData::member), \
+    0, (float)(sizeof(choices) / sizeof(choices[0]) - 1), def, normalize, choices }
+
+static const ConfigField schema[] = {
+  //           member           key               idx  type           flags                       min   max    default     normalize
+  CONFIG_FIELD(ssid,            "ssid",            0,  CONFIG_STRING, 0,                          0,    32,    "",         nullptr),
+  CONFIG_FIELD(wifiPassword,    "wifipassword",    1,  CONFIG_STRING, 0,                          0,    64,    "",         nullptr),
+  CONFIG_FIELD(switchStr,       "socket",          2,  CONFIG_STRING, CONFIG_TRIM,                0,    199,   "",         nullptr),
+  CONFIG_FIELD(theme,           "theme",           5,  CONFIG_STRING, CONFIG_TRIM,                1,    23,    "zapbox",   nullptr),
+  CONFIG_FIELD(thresholdKey,    "thresholdKey",    6,  CONFIG_STRING, CONFIG_TRIM,                0,    63,    "",         nullptr),
+  CONFIG_FIELD(thresholdAmount, "thresholdAmount", 7,  CONFIG_STRING, CONFIG_TRIM,                0,    11,    "",         nullptr),
+  CONFIG_FIELD(thresholdPin,    "thresholdPin",    8,  CONFIG_STRING, CONFIG_TRIM,                0,    3,     "",         nullptr),
+  CONFIG_FIELD(thresholdTime,   "thresholdTime",   9,  CONFIG_STRING, CONFIG_TRIM,                0,    11,    "",         nullptr),
+  CONFIG_FIELD(thresholdLnurl,  "thresholdLnurl",  10, CONFIG_STRING, CONFIG_TRIM,                0,    289,   "",         nullptr),
+  CONFIG_FIELD(frequency,       "frequency",       12, CONFIG_FLOAT,  0,                          0.1f, 10.0f, "1.0",      nullptr),
+  CONFIG_FIELD(dutyCycleRatio,  "dutyCycleRatio",  13, CONFIG_FLOAT,  0,                          0.1f, 10.0f, "1.0",      nullptr),
+  CONFIG_FIELD(activationTime,  "activationTime",  16, CONFIG_INT,    0,                          1,    120,   "5",        nullptr),
+  CONFIG_FIELD(currency,        "currency",        19, CONFIG_STRING, CONFIG_TRIM | CONFIG_UPPER, 1,    3,     "USD",      nullptr),
+  CONFIG_FIELD(externalButton,  "externalButton",  20, CONFIG_BOOL,   CONFIG_TRIM | CONFIG_LOWER, 0,    1,     "no",       nullptr),
+
+  //                  member          key              idx  flags                       choices             default     normalize
+  CONFIG_CHOICE_FIELD(qrFormat,       "qrFormat",      3,   CONFIG_TRIM | CONFIG_LOWER, qrFormatValues,     "bech32",   nullptr),
+  CONFIG_CHOICE_FIELD(orientation,    "orientation",   4,   CONFIG_TRIM | CONFIG_LOWER, orientationValues,  "h",        nullptr),
+  CONFIG_CHOICE_FIELD(specialMode,    "specialMode",   11,  CONFIG_TRIM | CONFIG_LOWER, specialModeValues,  "standard", nullptr),
+  CONFIG_CHOICE_FIELD(screensaver,    "screensaver",   14,  CONFIG_TRIM | CONFIG_LOWER, screensaverValues,  "off",      nullptr),
+  CONFIG_CHOICE_FIELD(deepSleep,      "deepSleep",     15,  CONFIG_TRIM | CONFIG_LOWER, deepSleepValues,    "off",      nullptr),
+  CONFIG_CHOICE_FIELD(multiControl,   "multiControl",  17,  CONFIG_TRIM | CONFIG_LOWER, channelModeValues,  "off",      nullptr),
+  CONFIG_CHOICE_FIELD(btcTicker,      "btcTicker",     18,  CONFIG_TRIM | CONFIG_LOWER, tickerModeValues,   "off",      normalizeTickerMode),
+  CONFIG_CHOICE_FIELD(channelPolicy,  "channelPolicy", 21,  CONFIG_TRIM | CONFIG_LOWER, relayPolicyValues,  "extend",   nullptr),
+};
+
+struct ConfigBlob {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+  ConfigData data;
+};
+
+static ConfigBlob blob;
+static unsigned long lastLoadTimeUs = 0;
+
+// CRC-32 (IEEE 802.3), 16-entry table
+static uint32_t crc32(const uint8_t* data, size_t length) {
+  static const uint32_t table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0x0F];
+    crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0x0F];
+  }
+  return ~crc;
+}
+
+// Normalize raw and store it in the field. Returns false (and stores the
+// default) if the value is missing or outside the allowed range.
+static bool setField(ConfigData& data, const ConfigField& field, const char* raw) {
+  uint8_t* target = (uint8_t*)&data + field.offset;
+  bool valid = raw != nullptr;
+
+  char value[300];
+  strlcpy(value, valid ? raw : field.defaultValue, sizeof(value));
+
+  if (field.flags & CONFIG_TRIM) {
+    char* start = value;
+    while (*start == ' ' || *start == '\t' || *start == '\r' || *start == '\n') start++;
+    size_t length = strlen(start);
+    while (length > 0 && (start[length - 1] == ' ' || start[length - 1] == '\t' || start[length - 1] == '\r' || start[length - 1] == '\n')) length--;
+    memmove(value, start, length);
+    value[length] = '\0';
+  }
+  for (char* p = value; *p; p++) {
+    if (field.flags & CONFIG_LOWER) *p = tolower((unsigned char)*p);
+    if (field.flags & CONFIG_UPPER) *p = toupper((unsigned char)*p);
+  }
+  if (field.normalize) field.normalize(value, sizeof(value));
+
+  switch (field.type) {
+    case CONFIG_STRING: {
+      size_t length = strlen(value);
+      if (length < field.min || length > field.max || length >= field.size) {
+        if (valid) LOG_WARN("Config", String(field.key) + ": invalid length " + String(length) + " - using default '" + field.defaultValue + "'");
+        strlcpy(value, field.defaultValue, sizeof(value));
+        valid = false;
+      }
+      strlcpy((char*)target, value, field.size);
+      break;
+    }
+    case CONFIG_FLOAT: {
+      char* end;
+      float number = strtof(value, &end);
+      if (end == value) {
+        number = strtof(field.defaultValue, nullptr);
+        valid = false;
+      }
+      if (number < field.min) number = field.min;
+      if (number > field.max) number = field.max;
+      memcpy(target, &number, sizeof(number));
+      break;
+    }
+    case CONFIG_INT: {
+      char* end;
+      int32_t number = strtol(value, &end, 10);
+      if (end == value) {
+        number = strtol(field.defaultValue, nullptr, 10);
+        valid = false;
+      }
+      if (number < (int32_t)field.min) number = (int32_t)field.min;
+      if (number > (int32_t)field.max) number = (int32_t)field.max;
+      memcpy(target, &number, sizeof(number));
+      break;
+    }
+    case CONFIG_BOOL:
+      *target = (strcmp(value, "yes") == 0) ? 1 : 0;
+      break;
+    case CONFIG_CHOICE: {
+      int count = (int)field.max + 1;
+      int index = -1;
+      for (int i = 0; i < count && index < 0; i++) {
+        if (strcmp(value, field.choices[i]) == 0) index = i;
+      }
+      if (index < 0) {
+        if (valid) LOG_WARN("Config", String(field.key) + ": unknown value '" + value + "' - using default '" + field.defaultValue + "'");
+        for (int i = 0; i < count && index < 0; i++) {
+          if (strcmp(field.defaultValue, field.choices[i]) == 0) index = i;
+        }
+        valid = false;
+      }
+      *target = (uint8_t)(index < 0 ? 0 : index);
+      break;
+    }
+  }
+  return valid;
+}
+
+// Values that depend on several fields - computed once per import
+static void deriveFields(ConfigData& data) {
+  // Special mode presets override frequency/ratio
+  if (data.specialMode == (uint8_t)SpecialMode::BLINK) {
+    data.frequency = 1.0;
+    data.dutyCycleRatio = 1.0;
+  } else if (data.specialMode == (uint8_t)SpecialMode::PULSE) {
+    data.frequency = 2.0;
+    data.dutyCycleRatio = 0.25; // 1:4
+  } else if (data.specialMode == (uint8_t)SpecialMode::FAST_BLINK) {
+    data.frequency = 5.0;
+    data.dutyCycleRatio = 1.0;
+  }
+
+  // switchStr: wss://<server>/api/v1/ws/<22 character device id>
+  data.lnbitsServer[0] = '\0';
+  data.deviceId[0] = '\0';
+  const char* protocol = strstr(data.switchStr, "://");
+  const char* domainEnd = protocol ? strchr(protocol + 3, '/') : nullptr;
+  if (!domainEnd) {
+    if (data.switchStr[0] != '\0') LOG_ERROR("Config", String("Invalid switchStr: ") + data.switchStr);
+  } else {
+    size_t serverLength = domainEnd - (protocol + 3);
+    if (serverLength >= sizeof(data.lnbitsServer)) serverLength = sizeof(data.lnbitsServer) - 1;
+    memcpy(data.lnbitsServer, protocol + 3, serverLength);
+    data.lnbitsServer[serverLength] = '\0';
+
+    const size_t uidLength = sizeof(data.deviceId) - 1;
+    size_t switchLength = strlen(data.switchStr);
+    strlcpy(data.deviceId, data.switchStr + (switchLength > uidLength ? switchLength - uidLength : 0), sizeof(data.deviceId));
+  }
+
+  // Threshold QR always uses a lowercase "lightning:" prefix
+  data.thresholdQr[0] = '\0';
+  if (data.thresholdLnurl[0] != '\0') {
+    const char* lnurl = data.thresholdLnurl;
+    if (strncasecmp(lnurl, "lightning:", 10) == 0) lnurl += 10;
+    snprintf(data.thresholdQr, sizeof(data.thresholdQr), "lightning:%s", lnurl);
+  }
+}
+
+static void setDefaults(ConfigData& data) {
+  memset(&data, 0, sizeof(data));
+  for (const ConfigField& field : schema) {
+    setField(data, field, nullptr);
+  }
+  deriveFields(data);
+}
+
+// Older installers wrote some entries with "key" instead of "name"
+static const char* entryName(JsonVariantConst entry) {
+  const char* name = entry["name"];
+  return name ? name : entry["key"].as<const char*>();
+}
+
+// Entry of a schema key: at its legacy position if the name matches, else searched by name
+static JsonVariantConst findEntry(JsonArrayConst entries, const ConfigField& field) {
+  JsonVariantConst entry = entries[field.legacyIndex];
+  const char* name = entryName(entry);
+  if (!entry.isNull() && (!name || strcmp(name, field.key) == 0)) return entry;
+
+  for (JsonVariantConst candidate : entries) {
+    const char* candidateName = entryName(candidate);
+    if (candidateName && strcmp(candidateName, field.key) == 0) return candidate;
+  }
+  return JsonVariantConst();
+}
+
+static bool importJson(const char* jsonPath, ConfigData& data) {
+  File file = FFat.open(jsonPath, "r");
+  if (!file) return false;
+
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error || !doc.is<JsonArrayConst>()) {
+    LOG_ERROR("Config", String("Cannot parse ") + jsonPath + ": " + error.c_str());
+    return false;
+  }
+
+  JsonArrayConst entries = doc.as<JsonArrayConst>();
+  memset(&data, 0, sizeof(data));
+  for (const ConfigField& field : schema) {
+    JsonVariantConst value = findEntry(entries, field)["value"];
+    char number[24];
+    const char* raw = nullptr;
+    if (value.is<const char*>()) {
+      raw = value.as<const char*>();
+    } else if (value.is<float>()) {
+      // Hand-edited files may contain plain numbers
+      snprintf(number, sizeof(number), "%g", value.as<float>());
+      raw = number;
+    }
+    if (!setField(data, field, raw) && !raw) {
+      LOG_DEBUG("Config", String(field.key) + " not found in config - using default: " + field.defaultValue);
+    }
+  }
+  deriveFields(data);
+  return true;
+}
+
+static bool loadBlob() {
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+  size_t length = prefs.getBytes(NVS_KEY, &blob, sizeof(blob));
+  prefs.end();
+
+  if (length != sizeof(blob) || blob.magic != CONFIG_MAGIC || blob.version != CONFIG_SCHEMA_VERSION || blob.size != sizeof(ConfigData)) {
+    return false;
+  }
+  if (blob.crc != crc32((const uint8_t*)&blob.data, sizeof(blob.data))) {
+    LOG_WARN("Config", "Stored config CRC mismatch - re-importing");
+    return false;
+  }
+  return true;
+}
+
+static void saveBlob() {
+  blob.magic = CONFIG_MAGIC;
+  blob.version = CONFIG_SCHEMA_VERSION;
+  blob.size = sizeof(ConfigData);
+  blob.crc = crc32((const uint8_t*)&blob.data, sizeof(blob.data));
+
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) {
+    LOG_ERROR("Config", "Cannot open NVS - config will be imported again on next boot");
+    return;
+  }
+  if (prefs.putBytes(NVS_KEY, &blob, sizeof(blob)) != sizeof(blob)) {
+    LOG_ERROR("Config", "Writing config blob to NVS failed");
+  }
+  prefs.end();
+}
+
+ConfigSource configStoreLoad(const char* jsonPath) {
+  unsigned long start = micros();
+  ConfigSource source;
+
+  if (loadBlob()) {
+    source = CONFIG_SOURCE_BLOB;
+  } else if (importJson(jsonPath, blob.data)) {
+    saveBlob();
+    source = CONFIG_SOURCE_JSON;
+  } else {
+    setDefaults(blob.data);
+    source = CONFIG_SOURCE_DEFAULTS;
+  }
+
+  lastLoadTimeUs = micros() - start;
+  return source;
+}
+
+const ConfigData& configStoreData() {
+  return blob.data;
+}
+
+void configStoreInvalidate() {
+  Preferences prefs;
+  if (prefs.begin(NVS_NAMESPACE, false)) {
+    prefs.remove(NVS_KEY);
+    prefs.end();
+  }
+}
+
+unsigned long configStoreLoadTimeUs() {
+  return lastLoadTimeUs;
+}
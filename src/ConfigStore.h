@@ -0,0 +1,86 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+/**
+ * ConfigStore.h - Schema-driven binary configuration store
+ *
+ * Every setting is described once in the schema table (ConfigStore.cpp):
+ * installer key, legacy config.json position, type, allowed range and
+ * default. The validated settings are kept as one fixed-size ConfigData
+ * blob in NVS together with a schema version and a CRC32, so a normal
+ * boot is a single nvs_get_blob() into static memory - no file read, no
+ * JSON document, no string normalization.
+ *
+ * /config.json written by the installer stays the source of truth: the
+ * serial commands that change it invalidate the blob, and the next boot
+ * imports the JSON once (normalizing all values) and stores a new blob.
+ */
+
+// Bump when ConfigData or the schema changes - old blobs are re-imported
+static constexpr uint16_t CONFIG_SCHEMA_VERSION = 2;
+
+// Choice settings are stored as their GlobalState.h enum values
+struct ConfigData {
+  // Installer settings (see schema table)
+  char ssid[33];
+  char wifiPassword[65];
+  char switchStr[200];
+  uint8_t qrFormat;           // QrFormat
+  uint8_t orientation;        // Orientation
+  char theme[24];
+  char thresholdKey[64];
+  char thresholdAmount[12];
+  char thresholdPin[4];
+  char thresholdTime[12];
+  char thresholdLnurl[290];
+  uint8_t specialMode;        // SpecialMode
+  float frequency;
+  float dutyCycleRatio;
+  uint8_t screensaver;        // ScreensaverMode
+  uint8_t deepSleep;          // DeepSleepMode
+  int32_t activationTime;     // Minutes
+  uint8_t multiControl;       // ChannelMode
+  uint8_t btcTicker;          // TickerMode
+  char currency[4];
+  uint8_t externalButton;
+  uint8_t channelPolicy;      // RelayPolicy
+
+  // Derived at import time
+  char lnbitsServer[64];      // Host part of switchStr
+  char deviceId[23];          // Last 22 characters of switchStr
+  char thresholdQr[300];      // thresholdLnurl with "lightning:" prefix
+};
+
+enum ConfigSource {
+  CONFIG_SOURCE_BLOB,       // Valid blob loaded from NVS
+  CONFIG_SOURCE_JSON,       // Imported from config.json (blob rewritten)
+  CONFIG_SOURCE_DEFAULTS    // No usable configuration - schema defaults
+};
+
+/**
+ * Load the configuration: the NVS blob if its version and CRC match,
+ * otherwise import jsonPath once and store the result as new blob.
+ * @param jsonPath Path of the installer config on FFat (e.g. "/config.json")
+ * @return Where the configuration came from
+ */
+ConfigSource configStoreLoad(const char* jsonPath);
+
+/**
+ * The loaded configuration (valid after configStoreLoad()).
+ */
+const ConfigData& configStoreData();
+
+/**
+ * Drop the stored blob so the next boot re-imports config.json.
+ * Called whenever the installer modifies config.json.
+ */
+void configStoreInvalidate();
+
+/**
+ * Duration of the last configStoreLoad() in microseconds.
+ */
+unsigned long configStoreLoadTimeUs();
+
+#endif // CONFIG_STORE_H
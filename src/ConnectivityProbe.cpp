@@ -0,0 +1,120 @@
+#include "ConnectivityProbe.h"
+#include <WiFi.h>
+#include <atomic>
+#include "Network.h"
+#include "Log.h"
+
+static const unsigned long PROBE_TICK_MS = 500;
+static const unsigned long DNS_SETTLE_MS = 2000;         // After WiFi connect
+static const unsigned long INTERNET_INTERVAL_MS = 30000;
+static const unsigned long SERVER_INTERVAL_MS = 5000;    // While the WebSocket is down
+
+// Probe results, written only by the probe task. Readers use the sequence
+// counter (seqlock): odd while an update is in progress, and a reader that
+// saw it change retries its copy.
+static ConnectivitySnapshot published = {};
+static std::atomic<uint32_t> publishSequence(0);
+
+// Written by the WebSocket event handler (loop task)
+static std::atomic<bool> websocketConnected(false);
+static std::atomic<unsigned long> websocketChangedMs(0);
+
+static std::atomic<bool> probeRequested(false);
+
+static void publish(const ConnectivitySnapshot& state) {
+  uint32_t sequence = publishSequence.load(std::memory_order_relaxed);
+  publishSequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  published = state;
+  publishSequence.store(sequence + 2, std::memory_order_release);
+}
+
+ConnectivitySnapshot connectivitySnapshot() {
+  ConnectivitySnapshot copy;
+  uint32_t before, after;
+  do {
+    before = publishSequence.load(std::memory_order_acquire);
+    copy = published;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = publishSequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+
+  copy.websocket = websocketConnected.load(std::memory_order_acquire);
+  copy.websocketChangedMs = websocketChangedMs.load(std::memory_order_relaxed);
+  return copy;
+}
+
+void connectivityProbeRequest() {
+  probeRequested.store(true, std::memory_order_release);
+}
+
+void connectivityReportWebSocket(bool connected) {
+  websocketChangedMs.store(millis(), std::memory_order_relaxed);
+  websocketConnected.store(connected, std::memory_order_release);
+}
+
+static bool isDue(unsigned long now, unsigned long dueMs) {
+  return (long)(now - dueMs) >= 0;
+}
+
+static void probeTask(void* parameter) {
+  ConnectivitySnapshot state = {};
+  unsigned long nextInternetMs = 0;
+  unsigned long nextServerMs = 0;
+
+  while (true) {
+    unsigned long now = millis();
+
+    // WiFi
+    bool wifi = (WiFi.status() == WL_CONNECTED);
+    if (wifi != state.wifi) {
+      state.wifi = wifi;
+      if (wifi) {
+        nextInternetMs = now + DNS_SETTLE_MS;
+      } else {
+        // Nothing behind WiFi is reachable while it is down
+        state.internet = false;
+        state.server = false;
+        state.internetCheckedMs = now;
+        state.serverCheckedMs = now;
+      }
+    }
+    state.wifiCheckedMs = now;
+
+    // Internet (blocking HTTP check - only this task waits)
+    bool requested = probeRequested.exchange(false, std::memory_order_acq_rel);
+    if (wifi && (isDue(now, nextInternetMs) || requested)) {
+      state.internet = checkInternetConnectivity();
+      state.internetCheckedMs = millis();
+      nextInternetMs = state.internetCheckedMs + INTERNET_INTERVAL_MS;
+      if (state.internet) {
+        nextServerMs = state.internetCheckedMs;  // Probe the server right after
+      } else {
+        state.server = false;
+        state.serverCheckedMs = state.internetCheckedMs;
+      }
+      publish(state);
+    }
+
+    // Server (TCP connect) - the connected WebSocket already proves it
+    if (websocketConnected.load(std::memory_order_acquire)) {
+      if (!state.server) {
+        state.server = true;
+        state.serverCheckedMs = millis();
+      }
+    } else if (wifi && state.internet && isDue(millis(), nextServerMs)) {
+      state.server = checkServerReachability();
+      state.serverCheckedMs = millis();
+      nextServerMs = state.serverCheckedMs + SERVER_INTERVAL_MS;
+    }
+
+    publish(state);
+    vTaskDelay(pdMS_TO_TICKS(PROBE_TICK_MS));
+  }
+}
+
+void connectivityProbeBegin() {
+  // Core 0 next to the WiFi stack, just above idle: never delays the loop on core 1
+  xTaskCreatePinnedToCore(probeTask, "ConnProbe", 8192, nullptr, tskIDLE_PRIORITY + 1, nullptr, 0);
+  LOG_INFO("Network", "Connectivity probe task started");
+}
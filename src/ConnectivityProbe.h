@@ -0,0 +1,56 @@
+#ifndef CONNECTIVITY_PROBE_H
+#define CONNECTIVITY_PROBE_H
+
+#include <Arduino.h>
+
+/**
+ * ConnectivityProbe.h - Background WiFi / Internet / server health probing
+ *
+ * The blocking probes (checkInternetConnectivity() up to ~10 s,
+ * checkServerReachability() up to 2 s) run in a low-priority task on
+ * core 0. Each result is published with its timestamp into a snapshot that
+ * the main loop, the report screen and the button task read without
+ * locking, so payment handling and input are never stalled by a probe.
+ *
+ * Probe schedule:
+ * - WiFi:     every PROBE_TICK_MS (WiFi.status(), non-blocking)
+ * - Internet: 2 s after WiFi comes up (DNS/DHCP settle), then every 30 s
+ * - Server:   every 5 s while Internet is up and the WebSocket is down
+ * - WebSocket: reported by the WebSocket event handler (the socket belongs
+ *              to the loop task and is never touched by the probe task)
+ */
+
+struct ConnectivitySnapshot {
+  bool wifi;
+  bool internet;
+  bool server;
+  bool websocket;
+  // millis() when each result was published (0 = not probed yet)
+  unsigned long wifiCheckedMs;
+  unsigned long internetCheckedMs;
+  unsigned long serverCheckedMs;
+  unsigned long websocketChangedMs;
+};
+
+/**
+ * Start the probe task (call once after WiFi.begin()).
+ */
+void connectivityProbeBegin();
+
+/**
+ * Latest published results. Lock-free, safe from any task.
+ */
+ConnectivitySnapshot connectivitySnapshot();
+
+/**
+ * Ask the probe task to re-check Internet (and the server) right away,
+ * e.g. after a WiFi reconnect or when leaving config mode.
+ */
+void connectivityProbeRequest();
+
+/**
+ * Record the WebSocket state (called from the WebSocket event handler).
+ */
+void connectivityReportWebSocket(bool connected);
+
+#endif // CONNECTIVITY_PROBE_H
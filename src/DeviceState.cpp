@@ -0,0 +1,222 @@
+#include "DeviceState.h"
+#include "Log.h"
+
+// ============================================================================
+// Transition Table
+// ============================================================================
+
+#define STATE_BIT(s) (1u << (int)DeviceState::s)
+
+static constexpr uint16_t ANY_STATE = (1u << DEVICE_STATE_COUNT) - 1;
+
+// Row = from-state, bit = allowed to-state. Lookup is a single shift and mask.
+//  - ERROR_CRITICAL can only be left via INITIALIZING
+//  - DEEP_SLEEP can only be left via INITIALIZING, or to READY after a light sleep wake-up
+//  - DEEP_SLEEP can only be entered from READY or SCREENSAVER
+//  - CONNECTING_WIFI cannot be entered from CONFIG_MODE
+static constexpr uint16_t transitionTable[DEVICE_STATE_COUNT] = {
+    /* INITIALIZING      */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* CONNECTING_WIFI   */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* READY             */ ANY_STATE,
+    /* RECEIVING_PAYMENT */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* SCREENSAVER       */ ANY_STATE,
+    /* HELP_SCREEN       */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* REPORT_SCREEN     */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* CONFIG_MODE       */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP) & ~STATE_BIT(CONNECTING_WIFI),
+    /* ERROR_CRITICAL    */ STATE_BIT(INITIALIZING),
+    /* ERROR_RECOVERABLE */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* DEEP_SLEEP        */ STATE_BIT(INITIALIZING) | STATE_BIT(READY),
+    /* PRODUCT_SELECTION */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+    /* BTC_TICKER        */ ANY_STATE & ~STATE_BIT(DEEP_SLEEP),
+};
+
+static inline bool isValidTransition(DeviceState from, DeviceState to) {
+    return (transitionTable[(int)from] >> (int)to) & 1u;
+}
+
+// Event reaction per state: target state, or -1 = event ignored in this state
+static constexpr int8_t IGNORE = -1;
+#define TO(s) ((int8_t)DeviceState::s)
+// Same target in every state; the transition table still decides whether it is allowed
+#define ALWAYS_TO(s) { TO(s), TO(s), TO(s), TO(s), TO(s), TO(s), TO(s), \
+                       TO(s), TO(s), TO(s), TO(s), TO(s), TO(s) }
+
+static constexpr int8_t eventTable[DEVICE_EVENT_COUNT][DEVICE_STATE_COUNT] = {
+    // WIFI_LOST
+    { IGNORE, IGNORE, TO(CONNECTING_WIFI), TO(CONNECTING_WIFI), IGNORE, IGNORE, IGNORE,
+      IGNORE, IGNORE, IGNORE, IGNORE, IGNORE, TO(CONNECTING_WIFI) },
+    // WIFI_RESTORED
+    { IGNORE, TO(READY), IGNORE, IGNORE, IGNORE, IGNORE, IGNORE,
+      IGNORE, IGNORE, IGNORE, IGNORE, IGNORE, IGNORE },
+    // SHOW_READY
+    ALWAYS_TO(READY),
+    // SHOW_PRODUCT_SELECTION
+    ALWAYS_TO(PRODUCT_SELECTION),
+    // OPEN_HELP
+    ALWAYS_TO(HELP_SCREEN),
+    // OPEN_REPORT
+    ALWAYS_TO(REPORT_SCREEN),
+    // OPEN_CONFIG
+    ALWAYS_TO(CONFIG_MODE),
+    // IDLE_TIMEOUT
+    ALWAYS_TO(SCREENSAVER),
+    // SLEEP_TIMEOUT
+    ALWAYS_TO(DEEP_SLEEP),
+    // CONNECTION_LOST
+    ALWAYS_TO(ERROR_RECOVERABLE),
+};
+
+#undef ALWAYS_TO
+#undef TO
+#undef STATE_BIT
+
+// ============================================================================
+// StateManager
+// ============================================================================
+
+// Queue item: the event and the core of the task that raised it
+struct QueuedEvent {
+    uint8_t event;
+    uint8_t core;
+};
+
+void StateManager::begin() {
+    if (!eventQueue) {
+        eventQueue = xQueueCreate(STATE_EVENT_QUEUE_LENGTH, sizeof(QueuedEvent));
+        consumerTask = xTaskGetCurrentTaskHandle();
+    }
+}
+
+bool StateManager::enqueue(DeviceEvent event) {
+    if (!eventQueue) return false;
+    QueuedEvent item = { (uint8_t)event, (uint8_t)xPortGetCoreID() };
+    if (xQueueSend(eventQueue, &item, 0) != pdTRUE) {
+        LOG_ERRORF("STATE", "Event queue full - %s dropped", getDeviceEventName(event));
+        return false;
+    }
+    return true;
+}
+
+bool StateManager::dispatch(DeviceEvent event) {
+    uint8_t core = (uint8_t)xPortGetCoreID();
+
+    // Before begin() there is only the setup() task
+    if (!eventQueue) {
+        return applyEvent(event, core);
+    }
+
+    // Other tasks: loop() applies it; waiting here would stall buttons and
+    // touch for as long as loop() is stuck in a fetch
+    if (xTaskGetCurrentTaskHandle() != consumerTask) {
+        return enqueue(event);
+    }
+
+    // loop()'s task: apply behind anything already queued, then what the handlers posted
+    if (processing) return enqueue(event);
+    processEvents();
+    processing = true;
+    bool applied = applyEvent(event, core);
+    processing = false;
+    processEvents();
+    return applied;
+}
+
+void StateManager::processEvents() {
+    if (!eventQueue || processing) return;
+    processing = true;
+    QueuedEvent item;
+    while (xQueueReceive(eventQueue, &item, 0) == pdTRUE) {
+        if (item.event >= DEVICE_EVENT_COUNT) continue;
+        applyEvent((DeviceEvent)item.event, item.core);
+    }
+    processing = false;
+}
+
+bool StateManager::applyEvent(DeviceEvent event, uint8_t core) {
+    int8_t target = eventTable[(int)event][(int)currentState];
+    if (target == IGNORE) {
+        LOG_INFOF("STATE", "%s ignored in %s",
+                  getDeviceEventName(event),
+                  getDeviceStateName(currentState));
+        return false;
+    }
+    return applyTransition((DeviceState)target, (int)event, core);
+}
+
+bool StateManager::applyTransition(DeviceState newState, int event, uint8_t core) {
+    DeviceState from;
+
+    portENTER_CRITICAL(&lock);
+    from = currentState;
+    // No-op if already in this state
+    if (from == newState) {
+        portEXIT_CRITICAL(&lock);
+        return true;
+    }
+    bool valid = isValidTransition(from, newState);
+    if (valid) {
+        previousState = from;
+        currentState = newState;
+        stateEnteredTime = millis();
+    }
+    recordTrace(from, newState, event, core, valid);
+    portEXIT_CRITICAL(&lock);
+
+    if (!valid) {
+        LOG_ERRORF("STATE", "Invalid transition: %s -> %s",
+                   getDeviceStateName(from),
+                   getDeviceStateName(newState));
+        return false;
+    }
+
+    LOG_INFOF("STATE", "%s -> %s",
+              getDeviceStateName(from),
+              getDeviceStateName(newState));
+
+    // Exit handler of the previous state, then entry handler of the new one
+    if (exitHandlers[(int)from]) {
+        exitHandlers[(int)from](from);
+    }
+    if (enterHandlers[(int)newState]) {
+        enterHandlers[(int)newState](newState);
+    }
+    return true;
+}
+
+void StateManager::recordTrace(DeviceState from, DeviceState to, int event, uint8_t core, bool accepted) {
+    StateTraceEntry& entry = trace[traceNext];
+    entry.timeMs = millis();
+    entry.from = from;
+    entry.to = to;
+    entry.event = (int8_t)event;
+    entry.core = core;
+    entry.accepted = accepted;
+    traceNext = (traceNext + 1) % STATE_TRACE_LENGTH;
+    if (traceCount < STATE_TRACE_LENGTH) traceCount++;
+}
+
+uint8_t StateManager::copyTrace(StateTraceEntry* out) {
+    portENTER_CRITICAL(&lock);
+    uint8_t count = traceCount;
+    uint8_t first = (traceNext + STATE_TRACE_LENGTH - traceCount) % STATE_TRACE_LENGTH;
+    for (uint8_t i = 0; i < count; i++) {
+        out[i] = trace[(first + i) % STATE_TRACE_LENGTH];
+    }
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
+
+void StateManager::printTrace() {
+    StateTraceEntry copy[STATE_TRACE_LENGTH];
+    uint8_t count = copyTrace(copy);
+
+    LOG_INFOF("STATE", "Last %u transitions:", count);
+    for (uint8_t i = 0; i < count; i++) {
+        const StateTraceEntry& e = copy[i];
+        LOG_INFOF("STATE", "%8lu ms core%u %s -> %s [%s]%s",
+                  e.timeMs, e.core,
+                  getDeviceStateName(e.from), getDeviceStateName(e.to),
+                  getDeviceEventName((DeviceEvent)e.event),
+                  e.accepted ? "" : " REJECTED");
+    }
+}
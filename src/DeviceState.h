@@ -2,6 +2,10 @@
 #define DEVICE_STATE_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "Log.h"
 
 // ============================================================================
 // Device Operating States
@@ -32,18 +36,68 @@ enum class WiFiState {
     ERROR                   // Connection error
 };
 
+// ============================================================================
+// Device Events - posted from any task, applied by loop() on core 1
+// Every state change is caused by one of these events.
+// ============================================================================
+enum class DeviceEvent {
+    WIFI_LOST,              // WiFi dropped (READY/RECEIVING_PAYMENT/BTC_TICKER -> CONNECTING_WIFI)
+    WIFI_RESTORED,          // WiFi back (CONNECTING_WIFI -> READY)
+    SHOW_READY,             // Payment screen shown, overlay/error closed or woken up (-> READY)
+    SHOW_PRODUCT_SELECTION, // Product selection screen shown (-> PRODUCT_SELECTION)
+    OPEN_HELP,              // Help button (-> HELP_SCREEN)
+    OPEN_REPORT,            // Report button (-> REPORT_SCREEN)
+    OPEN_CONFIG,            // Config button or no WiFi configured (-> CONFIG_MODE)
+    IDLE_TIMEOUT,           // No activity, screensaver configured (-> SCREENSAVER)
+    SLEEP_TIMEOUT,          // No activity, deep sleep configured (-> DEEP_SLEEP)
+    CONNECTION_LOST,        // WiFi/Internet/server error screen shown (-> ERROR_RECOVERABLE)
+    EVENT_COUNT
+};
+
+static constexpr int DEVICE_STATE_COUNT = (int)DeviceState::BTC_TICKER + 1;
+static constexpr int DEVICE_EVENT_COUNT = (int)DeviceEvent::EVENT_COUNT;
+
+// Capacity of the event queue and of the transition trace
+static constexpr int STATE_EVENT_QUEUE_LENGTH = 16;
+static constexpr int STATE_TRACE_LENGTH = 32;
+
+// Entry/exit handler, runs in loop() (the task that applies events)
+typedef void (*StateHandler)(DeviceState state);
+
+// One entry of the transition trace
+struct StateTraceEntry {
+    unsigned long timeMs;   // millis() of the transition attempt
+    DeviceState from;
+    DeviceState to;
+    int8_t event;           // DeviceEvent that caused it
+    uint8_t core;           // Core of the task that raised the event
+    bool accepted;          // false = rejected by the transition table
+};
+
 // ============================================================================
 // State Manager - Central State Machine Handler
 // ============================================================================
 class StateManager {
 private:
-    DeviceState currentState;
-    DeviceState previousState;
-    unsigned long stateEnteredTime;
+    volatile DeviceState currentState;
+    volatile DeviceState previousState;
+    volatile unsigned long stateEnteredTime;
     
-    WiFiState wifiState;
+    volatile WiFiState wifiState;
     unsigned long wifiStateChangedTime;
 
+    StateHandler enterHandlers[DEVICE_STATE_COUNT] = {};
+    StateHandler exitHandlers[DEVICE_STATE_COUNT] = {};
+
+    StateTraceEntry trace[STATE_TRACE_LENGTH] = {};
+    uint8_t traceNext = 0;
+    uint8_t traceCount = 0;
+
+    QueueHandle_t eventQueue = nullptr;
+    TaskHandle_t consumerTask = nullptr;    // Task that called begin() (loop() runs in it)
+    bool processing = false;                // processEvents() is running (consumer task only)
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
 public:
     StateManager() 
         : currentState(DeviceState::INITIALIZING),
@@ -52,45 +106,59 @@ public:
           wifiState(WiFiState::DISCONNECTED),
           wifiStateChangedTime(millis()) {}
 
+    /**
+     * Create the event queue. Call once from setup() before any task posts events;
+     * the calling task (the one running setup() and loop()) applies all events.
+     */
+    void begin();
+
     // ========================================================================
     // Main State Management
     // ========================================================================
 
     /**
-     * Transition to new device state with validation and callbacks
-     * @param newState Target device state
-     * @return true if transition successful, false if invalid
+     * Raise an event. In loop()'s task it is applied right away (behind the
+     * queued events), so the caller sees the new state afterwards; from an
+     * entry/exit handler it is applied after the handler returns. Other
+     * tasks (buttons, touch) only queue it and never wait for loop(), which
+     * may be busy in a blocking fetch: their state reads lag until loop()
+     * has applied it.
+     * @return in loop()'s task: true if applied (or the state already was its
+     *         target); otherwise true once queued
      */
-    bool transition(DeviceState newState) {
-        // No-op if already in this state
-        if (currentState == newState) return true;
-
-        // Validate transition
-        if (!isValidTransition(currentState, newState)) {
-            Serial.printf("[STATE_ERROR] Invalid transition: %s -> %s\n",
-                         getDeviceStateName(currentState),
-                         getDeviceStateName(newState));
-            return false;
-        }
+    bool dispatch(DeviceEvent event);
 
-        // Log transition
-        Serial.printf("[STATE_TRANSITION] %s -> %s\n",
-                     getDeviceStateName(currentState),
-                     getDeviceStateName(newState));
+    /**
+     * Queue an event for loop(). Never blocks; safe from any task.
+     * @return false if the queue is full (event dropped)
+     */
+    bool postEvent(DeviceEvent event) { return enqueue(event); }
 
-        // Execute exit callback for previous state
-        onStateExit(currentState);
+    /**
+     * Apply all queued events in order. Called from loop() on core 1.
+     */
+    void processEvents();
 
-        // Update state
-        previousState = currentState;
-        currentState = newState;
-        stateEnteredTime = millis();
+    /**
+     * Register the entry and/or exit handler of a state (nullptr = none).
+     * Handlers own the screen/hardware work of entering or leaving a state.
+     */
+    void setStateHandlers(DeviceState state, StateHandler onEnter, StateHandler onExit) {
+        enterHandlers[(int)state] = onEnter;
+        exitHandlers[(int)state] = onExit;
+    }
 
-        // Execute entry callback for new state
-        onStateEnter(currentState);
+    /**
+     * Copy the most recent transitions (oldest first) into out.
+     * @param out Room for STATE_TRACE_LENGTH entries
+     * @return Number of entries copied
+     */
+    uint8_t copyTrace(StateTraceEntry* out);
 
-        return true;
-    }
+    /**
+     * Log the most recent transitions (oldest first).
+     */
+    void printTrace();
 
     /**
      * Get current device state
@@ -134,43 +202,51 @@ public:
         }
     }
 
+    /**
+     * Get human-readable event name for logging
+     */
+    const char* getDeviceEventName(DeviceEvent event) const {
+        switch (event) {
+            case DeviceEvent::WIFI_LOST:           return "WIFI_LOST";
+            case DeviceEvent::WIFI_RESTORED:       return "WIFI_RESTORED";
+            case DeviceEvent::SHOW_READY:          return "SHOW_READY";
+            case DeviceEvent::SHOW_PRODUCT_SELECTION: return "SHOW_PRODUCT_SELECTION";
+            case DeviceEvent::OPEN_HELP:           return "OPEN_HELP";
+            case DeviceEvent::OPEN_REPORT:         return "OPEN_REPORT";
+            case DeviceEvent::OPEN_CONFIG:         return "OPEN_CONFIG";
+            case DeviceEvent::IDLE_TIMEOUT:        return "IDLE_TIMEOUT";
+            case DeviceEvent::SLEEP_TIMEOUT:       return "SLEEP_TIMEOUT";
+            case DeviceEvent::CONNECTION_LOST:     return "CONNECTION_LOST";
+            default:                               return "UNKNOWN";
+        }
+    }
+
     // ========================================================================
     // WiFi State Management (Orthogonal to Device State)
     // ========================================================================
 
     /**
      * Update WiFi connection state
-     * Automatically triggers device state transitions on connection loss/gain
+     * Posts WIFI_LOST/WIFI_RESTORED; the resulting device state change is
+     * applied by processEvents() in loop(), not in the calling task.
      */
     void updateWiFiState(WiFiState newWiFiState) {
         if (wifiState == newWiFiState) return;
 
-        Serial.printf("[WiFi] %s -> %s\n",
-                     getWiFiStateName(wifiState),
-                     getWiFiStateName(newWiFiState));
+        LOG_INFOF("WiFi", "%s -> %s",
+                  getWiFiStateName(wifiState),
+                  getWiFiStateName(newWiFiState));
 
         wifiState = newWiFiState;
         wifiStateChangedTime = millis();
 
-        // WiFi lost during critical states
         if (newWiFiState == WiFiState::DISCONNECTED ||
             newWiFiState == WiFiState::ERROR) {
-
-            if (currentState == DeviceState::READY ||
-                currentState == DeviceState::RECEIVING_PAYMENT ||
-                currentState == DeviceState::BTC_TICKER) {
-
-                Serial.println("[STATE] WiFi lost - transitioning to CONNECTING_WIFI");
-                transition(DeviceState::CONNECTING_WIFI);
-            }
+            postEvent(DeviceEvent::WIFI_LOST);
         }
 
-        // WiFi restored
         if (newWiFiState == WiFiState::CONNECTED) {
-            if (currentState == DeviceState::CONNECTING_WIFI) {
-                Serial.println("[STATE] WiFi reconnected - returning to READY");
-                transition(DeviceState::READY);
-            }
+            postEvent(DeviceEvent::WIFI_RESTORED);
         }
     }
 
@@ -208,137 +284,24 @@ public:
     unsigned long wifiStateAge() const { return millis() - wifiStateChangedTime; }
 
 private:
-    // ========================================================================
-    // Transition Validation
-    // ========================================================================
-
     /**
-     * Define valid transitions between states
-     * Prevents invalid state changes
+     * Queue an event together with the core of the calling task (for the trace).
      */
-    bool isValidTransition(DeviceState from, DeviceState to) const {
-        // Can't transition FROM these states at all
-        if (from == DeviceState::DEEP_SLEEP) {
-            // Can only wake from deep sleep via initialization
-            return to == DeviceState::INITIALIZING;
-        }
-
-        // Can't transition TO DEEP_SLEEP except from READY or SCREENSAVER
-        if (to == DeviceState::DEEP_SLEEP) {
-            return from == DeviceState::READY || from == DeviceState::SCREENSAVER;
-        }
-
-        // WiFi failure can jump to CONNECTING_WIFI from most states
-        if (to == DeviceState::CONNECTING_WIFI) {
-            // But NOT from CONFIG_MODE, ERROR_CRITICAL, or DEEP_SLEEP
-            return from != DeviceState::CONFIG_MODE &&
-                   from != DeviceState::ERROR_CRITICAL &&
-                   from != DeviceState::DEEP_SLEEP;
-        }
-
-        // Can't escape ERROR_CRITICAL except via transition to INITIALIZING
-        if (from == DeviceState::ERROR_CRITICAL) {
-            return to == DeviceState::INITIALIZING;
-        }
-
-        // Most other transitions are valid
-        return true;
-    }
-
-    // ========================================================================
-    // State Callbacks - Execute on State Entry/Exit
-    // ========================================================================
+    bool enqueue(DeviceEvent event);
 
     /**
-     * Called when exiting a state
-     * Used for cleanup and state-specific shutdown
+     * Look up the event in the event table and perform the transition.
+     * @param core Core of the task that raised the event
+     * @return true if applied (or already in the target state)
      */
-    void onStateExit(DeviceState state) {
-        switch (state) {
-            case DeviceState::CONFIG_MODE:
-                // Config mode cleanup handled by handleConfigExitButtons()
-                Serial.println("[STATE_EXIT] CONFIG_MODE");
-                break;
-
-            case DeviceState::SCREENSAVER:
-                Serial.println("[STATE_EXIT] SCREENSAVER");
-                break;
-
-            case DeviceState::DEEP_SLEEP:
-                Serial.println("[STATE_EXIT] DEEP_SLEEP");
-                break;
-
-            case DeviceState::HELP_SCREEN:
-                Serial.println("[STATE_EXIT] HELP_SCREEN");
-                break;
-
-            case DeviceState::REPORT_SCREEN:
-                Serial.println("[STATE_EXIT] REPORT_SCREEN");
-                break;
-
-            default:
-                break;
-        }
-    }
+    bool applyEvent(DeviceEvent event, uint8_t core);
 
     /**
-     * Called when entering a new state
-     * Used for state-specific initialization
-     * Actual hardware operations (display update, etc.) must be called from main.cpp
+     * Validate and perform a transition, record it in the trace and run handlers.
      */
-    void onStateEnter(DeviceState state) {
-        switch (state) {
-            case DeviceState::READY:
-                Serial.println("[STATE_ENTRY] READY - display QR code");
-                // Actual display update done in main loop
-                break;
-
-            case DeviceState::CONFIG_MODE:
-                Serial.println("[STATE_ENTRY] CONFIG_MODE - showing config screen");
-                break;
-
-            case DeviceState::HELP_SCREEN:
-                Serial.println("[STATE_ENTRY] HELP_SCREEN - showing help pages");
-                break;
-
-            case DeviceState::CONNECTING_WIFI:
-                Serial.println("[STATE_ENTRY] CONNECTING_WIFI - showing connection screen");
-                break;
-
-            case DeviceState::SCREENSAVER:
-                Serial.println("[STATE_ENTRY] SCREENSAVER - display off");
-                break;
-
-            case DeviceState::DEEP_SLEEP:
-                Serial.println("[STATE_ENTRY] DEEP_SLEEP - entering deep sleep");
-                break;
-
-            case DeviceState::ERROR_CRITICAL:
-            case DeviceState::ERROR_RECOVERABLE:
-                Serial.println("[STATE_ENTRY] ERROR - showing error screen");
-                break;
-
-            case DeviceState::PRODUCT_SELECTION:
-                Serial.println("[STATE_ENTRY] PRODUCT_SELECTION");
-                break;
-
-            case DeviceState::BTC_TICKER:
-                Serial.println("[STATE_ENTRY] BTC_TICKER");
-                break;
-
-            case DeviceState::REPORT_SCREEN:
-                Serial.println("[STATE_ENTRY] REPORT_SCREEN");
-                break;
-
-            case DeviceState::RECEIVING_PAYMENT:
-                Serial.println("[STATE_ENTRY] RECEIVING_PAYMENT");
-                break;
-
-            default:
-                Serial.printf("[STATE_ENTRY] %s\n", getDeviceStateName(state));
-                break;
-        }
-    }
+    bool applyTransition(DeviceState newState, int event, uint8_t core);
+
+    void recordTrace(DeviceState from, DeviceState to, int event, uint8_t core, bool accepted);
 };
 
 #endif // DEVICE_STATE_H
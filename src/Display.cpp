@@ -5,8 +5,15 @@
 #include <esp_task_wdt.h>
 #include <driver/rtc_io.h>
 #include "display.h"
+#include "DisplayScene.h"
+#include "DisplayTask.h"
+#include "FrameBuffer.h"
+#include "GlyphCache.h"
+#include "ScreenCache.h"
+#include "SpanBitmap.h"
 #include "PinConfig.h"
 #include "GlobalState.h"
+#include "Log.h"
 
 TFT_eSPI tft = TFT_eSPI();
 #define GFXFF 1
@@ -52,16 +59,39 @@ int y;
 // External variables not in GlobalState
 extern String currency;
 
-// Helper function to draw scaled bitmap
+// Screen ids of the render task commands, also the ScreenCache slots
+enum DisplayScreen : uint8_t {
+  SCREEN_BLANK,
+  SCREEN_STARTUP,
+  SCREEN_BTCTICKER,
+  SCREEN_BTCTICKER_VALUES,
+  SCREEN_INITIALIZATION,
+  SCREEN_BOOT_UP,
+  SCREEN_CONFIG_MODE,
+  SCREEN_ERROR_REPORT,
+  SCREEN_RECONNECT_REPORT,
+  SCREEN_WIFI_RECONNECT,
+  SCREEN_INTERNET_RECONNECT,
+  SCREEN_SERVER_RECONNECT,
+  SCREEN_WEBSOCKET_RECONNECT,
+  SCREEN_STEP_ONE,
+  SCREEN_STEP_TWO,
+  SCREEN_STEP_THREE,
+  SCREEN_ACTION_TIME,
+  SCREEN_THANK_YOU,
+  SCREEN_THRESHOLD_QR,
+  SCREEN_PRODUCT_QR,
+  SCREEN_PRODUCT_SELECTION,
+  SCREEN_BENCHMARK,
+  SCREEN_PAYMENT_ERROR
+};
+
+static void renderCommand(const DisplayCommand &command);
+static void buildScreenCache();
+
+// Helper function to draw scaled bitmap: one fill per run of set pixels
 void drawScaledBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint8_t scale) {
-  for (int16_t j = 0; j < h; j++) {
-    for (int16_t i = 0; i < w; i++) {
-      if (bitmap[j * ((w + 7) / 8) + i / 8] & (128 >> (i & 7))) {
-        // Draw scaled pixel as a block
-        tft.fillRect(x + i * scale, y + j * scale, scale, scale, color);
-      }
-    }
-  }
+  spanBitmapDraw(*canvas, bitmap, x, y, w, h, color, scale);
 }
 
 // Theme colors - will be set based on displayConfig.theme selection
@@ -115,33 +145,117 @@ const ThemeConfig themeConfigs[] = {
 // Safe fillScreen wrapper to stabilize TFT refresh after heavy screen changes
 // Adds a small delay to prevent controller glitches that can cause stripes/black screens
 // ZAPBOX theme uses direct fillScreen without delay to avoid display corruption
+// With the frame buffer the panel only gets whole frames: no delay needed
 inline void safeFillScreen(uint16_t color)
 {
-  tft.fillScreen(color);
+  frameAcquire();
+  canvas->fillScreen(color);
+  sceneInvalidate();
+  frameDamageAll();
   // ZAPBOX theme: No delay to prevent display controller corruption
   // Other themes: Small delay for stability
-  if (displayConfig.theme != "zapbox" && displayConfig.theme != "btcorange-black") {
+  if (!displayConfig.palette.invertedQr && !frameBuffered()) {
     delay(5);
   }
 }
 
+// Full clear for screens drawn directly (not through DisplayScene): the next
+// scene frame has to redraw everything
+static void clearScreen(uint16_t color)
+{
+  frameAcquire();
+  canvas->fillScreen(color);
+  sceneInvalidate();
+  frameDamageAll();
+}
+
+// Inverted themes need a clear/delay sequence on the panel when the
+// background flips between dark and light; not when the background stays
+// (scene update) or the frame buffer presents the new screen in one transfer
+static bool needsInversionClears(uint16_t background)
+{
+  return displayConfig.palette.invertedQr && !frameBuffered() &&
+         (!sceneValid() || sceneBackground() != background);
+}
+
 void setThemeColors()
 {
+  ThemePalette &palette = displayConfig.palette;
+
   // Default fallback (used if theme name not found in table)
-  themeForeground = TFT_BLACK;
-  themeBackground = TFT_WHITE;
-  
-  // Linear search through theme lookup table
-  // O(n) complexity with n=16 is negligible and much cleaner than if-else chains
+  palette = ThemePalette();
+
+  // Linear search through theme lookup table, done once at startup
   // Can be easily extended with new themes by adding entries to themeConfigs[]
   for (const auto& config : themeConfigs) {
     if (displayConfig.theme == config.name) {
-      themeForeground = config.foreground;
-      themeBackground = config.background;
-      return;
+      palette.foreground = config.foreground;
+      palette.background = config.background;
+      break;
     }
   }
-  // If not found, defaults are already set above
+
+  // Light-on-black themes show product QR codes dark-on-light for scanners
+  palette.invertedQr = (displayConfig.theme == "zapbox" || displayConfig.theme == "btcorange-black");
+  if (palette.invertedQr) {
+    palette.productForeground = palette.background;
+    palette.productBackground = palette.foreground;
+  } else {
+    palette.productForeground = palette.foreground;
+    palette.productBackground = palette.background;
+  }
+
+  themeForeground = palette.foreground;
+  themeBackground = palette.background;
+}
+
+// Screen coordinates for the configured orientation, resolved once so the
+// screens do not compare orientation strings on every redraw
+static void resolveDisplayLayout()
+{
+  DisplayLayout &layout = displayConfig.layout;
+  layout = DisplayLayout(); // h = horizontal (button right)
+
+  switch (displayConfig.orientation) {
+    case Orientation::VERTICAL: // button bottom
+      layout.rotation = 0;
+      layout.vertical = true;
+      layout.centerX = 85;
+      layout.centerY = 160;
+      layout.helpLabel = {120, 310};
+      layout.nextLabel = {5, 310};
+      layout.touchHelp = {87, 312};
+      break;
+    case Orientation::VERTICAL_INVERSE: // button top, mirrored labels
+      layout.rotation = 2;
+      layout.vertical = true;
+      layout.inverse = true;
+      layout.centerX = 85;
+      layout.centerY = 160;
+      layout.qr = {12, 19};
+      layout.tickerShift = 10;
+      layout.qrBoxY = 175;
+      layout.helpLabel = {5, 10};
+      layout.nextLabel = {120, 10};
+      layout.touchHelp = {87, 10};
+      break;
+    case Orientation::HORIZONTAL_INVERSE: // button left, mirrored labels
+      layout.rotation = 3;
+      layout.inverse = true;
+      layout.qr = {20, 12};
+      layout.tickerShift = 5;
+      layout.thresholdBoxX = 173;
+      layout.thresholdTextX = 185;
+      layout.productBoxX = 171;
+      layout.productTextX = 185;
+      layout.helpLabel = {5, 163};
+      layout.nextLabel = {5, 9};
+      layout.touchHelp = {11, 55};
+      break;
+    case Orientation::HORIZONTAL:
+    default:
+      break;
+  }
 }
 
 void initDisplay()
@@ -149,803 +263,797 @@ void initDisplay()
   tft.init();
   setThemeColors(); // Set displayConfig.theme colors based on configuration
   
-  // Screen displayConfig.orientation mapping:
-  // h = horizontal (button right)
-  // v = vertical (button bottom)
-  // hi = horizontal inverse (button left)
-  // vi = vertical inverse (button top)
-  if (displayConfig.orientation == "v"){
-    tft.setRotation(0);
-    x = 85;
-    y = 160;
-  } else if (displayConfig.orientation == "vi") {
-    tft.setRotation(2);
-    x = 85;
-    y = 160;
-  } else if (displayConfig.orientation == "hi") {
-    tft.setRotation(3);
-    x = 160;
-    y = 85;
-  } else {
-    // Default: h (horizontal)
-    tft.setRotation(1);
-    x = 160;
-    y = 85;
+  resolveDisplayLayout();
+  tft.setRotation(displayConfig.layout.rotation);
+  frameBufferBegin(tft);
+  sceneInvalidate();
+  x = displayConfig.layout.centerX;
+  y = displayConfig.layout.centerY;
+  buildScreenCache();
+  // Ticker values: price and block height ticks only redraw changed digits
+  glyphCachePrepare("0123456789,.", displayConfig.layout.vertical ? 3 : 2, themeForeground, themeBackground);
+  displayTaskBegin(renderCommand);
+}
+
+// HELP/NEXT labels next to the buttons: HELP at the touch button (stacked
+// letters in horizontal layouts), otherwise HELP and NEXT at the two
+// physical buttons unless an external button is used. Part of the current
+// scene frame, or drawn right away on direct screens
+static void drawButtonLabels(uint16_t color)
+{
+  const DisplayLayout &layout = displayConfig.layout;
+  if (touchState.available) {
+    if (layout.vertical) {
+      sceneText("HELP", layout.touchHelp.x, layout.touchHelp.y, MC_DATUM, 2, color);
+    } else {
+      static const char* const letters[] = {"H", "E", "L", "P"};
+      for (int i = 0; i < 4; i++) {
+        sceneText(letters[i], layout.touchHelp.x, layout.touchHelp.y + 20 * i, MC_DATUM, 2, color);
+      }
+    }
+  } else if (!externalButtonState.enabled) {
+    sceneText("HELP", layout.helpLabel.x, layout.helpLabel.y, ML_DATUM, 2, color);
+    sceneText("NEXT", layout.nextLabel.x, layout.nextLabel.y, ML_DATUM, 2, color);
   }
 }
 
 // Startup
-void startupScreen()
+static void drawStartupScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.setTextSize(2);
-    tft.drawString("", x + 5, y - 95, GFXFF);
-    tft.setTextSize(8);
-    tft.drawString("ZAP", x + 5, y - 70, GFXFF);
-    tft.drawString("BOX", x + 5, y - 20, GFXFF);
-    tft.setTextSize(2);
-    tft.drawString("", x + 5, y + 15, GFXFF);
-    tft.drawString("Firmware", x + 5, y + 35, GFXFF);
-    tft.drawString(VERSION, x + 5, y + 55, GFXFF);
-    tft.setTextSize(1);
-    tft.drawString("", x + 5, y + 70, GFXFF);
-    tft.setTextSize(2);
-    tft.drawString("Powered", x + 5, y + 80, GFXFF);
-    tft.drawString("by LNbits", x + 5, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->setTextSize(2);
+    canvas->drawString("", x + 5, y - 95, GFXFF);
+    canvas->setTextSize(8);
+    canvas->drawString("ZAP", x + 5, y - 70, GFXFF);
+    canvas->drawString("BOX", x + 5, y - 20, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("", x + 5, y + 15, GFXFF);
+    canvas->drawString("Firmware", x + 5, y + 35, GFXFF);
+    canvas->drawString(VERSION, x + 5, y + 55, GFXFF);
+    canvas->setTextSize(1);
+    canvas->drawString("", x + 5, y + 70, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("Powered", x + 5, y + 80, GFXFF);
+    canvas->drawString("by LNbits", x + 5, y + 100, GFXFF);
+  } else {
+    canvas->setTextSize(6);
+    canvas->drawString("ZAPBOX", x + 5, y - 15, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("Firmware " VERSION, x, y + 25, GFXFF);
+    canvas->drawString("Powered by LNbits", x, y + 45, GFXFF);
+  }
+  framePresent();
+}
+
+// Sats per currency unit for the ticker, "0" without a valid price
+static String satsPerCurrencyUnit(const char *price)
+{
+  float priceFloat = atof(price);
+  if (priceFloat > 0) {
+    long satsValue = (long)((1.0 / priceFloat) * 100000000.0);
+    return String(satsValue);
+  }
+  return "0";
+}
+
+// Ticker widgets; a refresh only pushes the values that changed
+static void tickerScene(const DisplayTickerValues &values)
+{
+  sceneBegin(themeBackground);
+  String unit = values.currency;
+  String satsPerCurrency = satsPerCurrencyUnit(values.price);
+
+  if (displayConfig.layout.vertical){
+    // Slight vertical offset for inverse orientation to lower logo and data
+    int yOffset = displayConfig.layout.tickerShift;
+    // VERTICAL LAYOUT
+    // Bitcoin logo (64x64) at the top
+    sceneBitmap(bitcoin_logo, x - 32, y - 135 + yOffset, 64, 64, themeForeground);
+
+    // Currency/BTC label and price (larger)
+    sceneText(unit + "/BTC", x + 5, y - 50 + yOffset, MC_DATUM, 2, themeForeground);
+    sceneText(values.price, x + 5, y - 20 + yOffset, MC_DATUM, 3, themeForeground);
+
+    // sats/Currency label and value
+    sceneText("SAT/" + unit, x + 5, y + 15 + yOffset, MC_DATUM, 2, themeForeground);
+    sceneText(satsPerCurrency, x + 5, y + 45 + yOffset, MC_DATUM, 3, themeForeground);
+
+    // Block label and height (same size as price and sats)
+    sceneText("Block", x + 5, y + 80 + yOffset, MC_DATUM, 2, themeForeground);
+    sceneText(values.blockHeight, x + 5, y + 110 + yOffset, MC_DATUM, 3, themeForeground);
   } else {
-    tft.setTextSize(6);
-    tft.drawString("ZAPBOX", x + 5, y - 15, GFXFF);
-    tft.setTextSize(2);
-    tft.drawString("Firmware " VERSION, x, y + 25, GFXFF);
-    tft.drawString("Powered by LNbits", x, y + 45, GFXFF);
+    // HORIZONTAL LAYOUT
+    // Left third: Bitcoin logo (64x64) vertically centered
+    int logoX = 20 + displayConfig.layout.tickerShift;
+    sceneBitmap(bitcoin_logo, logoX, y - 32, 64, 64, themeForeground);
+
+    // Right side (2/3): one line each for price, sats and block height
+    int textX = x + 25 + displayConfig.layout.tickerShift;
+    sceneText(unit + "/BTC: " + values.price, textX, y - 40, MC_DATUM, 2, themeForeground);
+    sceneText("SAT/" + unit + ": " + satsPerCurrency, textX, y, MC_DATUM, 2, themeForeground);
+    sceneText("Block: " + String(values.blockHeight), textX, y + 40, MC_DATUM, 2, themeForeground);
   }
+
+  // Button labels (touch or physical buttons)
+  drawButtonLabels(themeForeground);
+  sceneEnd();
+  framePresent();
 }
 
 // Bitcoin Ticker Screen
-void btctickerScreen()
+static void drawBtctickerScreen(const DisplayTickerValues &values)
 {
   // ZAPBOX/BTCORANGE theme color inversion fix
   // Problem: Inverted QR has YELLOW/ORANGE background, ticker has BLACK background
-  // Need careful transition for color inversion (YELLOW/ORANGE -> BLACK)
-  if (displayConfig.theme == "zapbox" || displayConfig.theme == "btcorange-black") {
+  // Need careful transition for color inversion (YELLOW/ORANGE -> BLACK); only
+  // when the background actually changes, the scene redraws in full then
+  if (needsInversionClears(themeBackground)) {
     // Transition from inverted QR (yellow/orange) to ticker (black)
-    tft.fillScreen(themeBackground);  // Clear to black
+    canvas->fillScreen(themeBackground);  // Clear to black
     delay(30);
-    tft.fillScreen(themeBackground);  // Second clear for stability
+    canvas->fillScreen(themeBackground);  // Second clear for stability
     delay(20);
   }
-  
-  safeFillScreen(themeBackground);
-  
-  // Explicitly clear QR code area to prevent ghosting when switching screens
-  // QR code is typically drawn at (12, 12) with size ~72x72 pixels
-  tft.fillRect(12, 12, 80, 80, themeBackground);
-  
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(themeForeground);
 
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    // Slight vertical offset for inverse orientation to lower logo and data
-    int yOffset = (displayConfig.orientation == "vi") ? 10 : 0;
-    // VERTICAL LAYOUT
-    // Draw Bitcoin logo (64x64) moved up by 30 pixels more
-    tft.drawBitmap(x - 32, y - 135 + yOffset, bitcoin_logo, 64, 64, themeForeground);
-    
-    // First line: Currency/BTC (closer to logo) - moved down 5 pixels
-    tft.setTextSize(2);
-    tft.drawString(currency + "/BTC", x + 5, y - 50 + yOffset, GFXFF);
-    
-    // Price (larger) - moved down 5 pixels
-    tft.setTextSize(3);
-    tft.drawString(bitcoinData.price, x + 5, y - 20 + yOffset, GFXFF);
-    
-    // Calculate sats per currency unit
-    float priceFloat = bitcoinData.price.toFloat();
-    String satsPerCurrency = "";
-    if (priceFloat > 0) {
-      long satsValue = (long)((1.0 / priceFloat) * 100000000.0);
-      satsPerCurrency = String(satsValue);
-    } else {
-      satsPerCurrency = "0";
-    }
-    
-    // New line: sats/Currency - moved down 5 pixels
-    tft.setTextSize(2);
-    tft.drawString("SAT/" + currency, x + 5, y + 15 + yOffset, GFXFF);
-    
-    // Sats value (larger) - moved down 5 pixels
-    tft.setTextSize(3);
-    tft.drawString(satsPerCurrency, x + 5, y + 45 + yOffset, GFXFF);
-    
-    // Block info at bottom (same spacing as above) - moved down 5 pixels
-    tft.setTextSize(2);
-    tft.drawString("Block", x + 5, y + 80 + yOffset, GFXFF);
-    
-    // Block number (larger, same size as price and sats) - moved down 5 pixels
-    tft.setTextSize(3);
-    tft.drawString(bitcoinData.blockHigh, x + 5, y + 110 + yOffset, GFXFF);
-    
-    // Button labels - different layout for touch vs non-touch
-    tft.setTextSize(2);
-    tft.setTextColor(themeForeground);
-    
-    if (touchState.available) {
-      // Touch version: HELP centered on bottom/top depending on displayConfig.orientation
-      tft.setTextDatum(MC_DATUM);
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 2, 312, GFXFF); // Bottom (button at bottom)
-      } else {
-        tft.drawString("HELP", x + 2, 10, GFXFF); // Top for vi (button at top)
-      }
-    } else if (!externalButtonState.enabled) {
-      // Non-touch version: mirror labels for inverse displayConfig.orientation (only if external button is NOT enabled)
-      tft.setTextDatum(ML_DATUM);
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 35, y + 150, GFXFF); // Right side bottom
-        tft.drawString("NEXT", 5, y + 150, GFXFF); // Left side bottom
-      } else {
-        // vi: Mirror positions to top AND swap sides
-        tft.drawString("HELP", 5, 10, GFXFF); // Left side top
-        tft.drawString("NEXT", x + 35, 10, GFXFF); // Right side top
-      }
-    }
-  } else {
-    // HORIZONTAL LAYOUT
-    // Left third: Bitcoin logo (64x64) vertically centered - moved 10 pixels right
-    int logoX = (displayConfig.orientation == "hi") ? 25 : 20; // +5px for hi
-    int logoY = y - 32;
-    
-    // Draw Bitcoin logo at normal size
-    tft.drawBitmap(logoX, logoY, bitcoin_logo, 64, 64, themeForeground);
-    
-    // Right side (2/3): Text content - moved 20 more pixels to the left
-    int textX = (displayConfig.orientation == "hi") ? x + 30 : x + 25; // +5px for hi
-    
-    // Calculate sats per currency unit
-    float priceFloat = bitcoinData.price.toFloat();
-    String satsPerCurrency = "";
-    if (priceFloat > 0) {
-      long satsValue = (long)((1.0 / priceFloat) * 100000000.0);
-      satsPerCurrency = String(satsValue);
-    } else {
-      satsPerCurrency = "0";
-    }
-    
-    // Top: Currency/BTC with price - label size 2, value size 3
-    tft.setTextSize(2);
-    String topLabel = currency + "/BTC: ";
-    tft.drawString(topLabel + bitcoinData.price, textX, y - 40, GFXFF);
-    
-    // Middle: SAT per currency - label size 2, value size 3
-    tft.setTextSize(2);
-    String midLabel = "SAT/" + currency + ": ";
-    tft.drawString(midLabel + satsPerCurrency, textX, y, GFXFF);
-    
-    // Bottom: Block height - label size 2, value size 3
-    tft.setTextSize(2);
-    tft.drawString("Block: " + bitcoinData.blockHigh, textX, y + 40, GFXFF);
-    
-    // Button labels - different layout for touch vs non-touch
-    
-    if (touchState.available) {
-      // Touch version: HELP as vertical stacked letters on right/left side
-      tft.setTextDatum(MC_DATUM);
-      if (displayConfig.orientation == "h") {
-        // Right side, top to bottom (button at right)
-        tft.drawString("H", 311, y - 30, GFXFF);
-        tft.drawString("E", 311, y - 10, GFXFF);
-        tft.drawString("L", 311, y + 10, GFXFF);
-        tft.drawString("P", 311, y + 30, GFXFF);
-      } else {
-        // Left side - same order as h
-        tft.drawString("H", 11, y - 30, GFXFF);
-        tft.drawString("E", 11, y - 10, GFXFF);
-        tft.drawString("L", 11, y + 10, GFXFF);
-        tft.drawString("P", 11, y + 30, GFXFF);
-      }
-    } else if (!externalButtonState.enabled) {
-      // Non-touch version: mirror labels for inverse displayConfig.orientation (only if external button is NOT enabled)
-      tft.setTextDatum(ML_DATUM);
-      if (displayConfig.orientation == "h") {
-        tft.drawString("HELP", x + 110, 9, GFXFF); // Top right
-        tft.drawString("NEXT", x + 110, 163, GFXFF); // Bottom right
-      } else {
-        // hi: Mirror positions to left side AND swap top/bottom
-        tft.drawString("HELP", 5, 163, GFXFF); // Bottom left
-        tft.drawString("NEXT", 5, 9, GFXFF); // Top left
-      }
-    }
-  }
+  tickerScene(values);
 }
 
 // Partial update of BTC ticker values - reduces flicker during auto-updates
-// Only updates the dynamic values (price, sats, block) without redrawing the entire screen
-void updateBtctickerValues()
+// Same scene as drawBtctickerScreen(): only the changed values are redrawn
+static void drawBtctickerValues(const DisplayTickerValues &values)
 {
-  // Only update text areas, don't redraw logo or buttons
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    int yOffset = (displayConfig.orientation == "vi") ? 10 : 0;
-    
-    // Calculate sats per currency
-    float priceFloat = bitcoinData.price.toFloat();
-    String satsPerCurrency = "";
-    if (priceFloat > 0) {
-      long satsValue = (long)((1.0 / priceFloat) * 100000000.0);
-      satsPerCurrency = String(satsValue);
-    } else {
-      satsPerCurrency = "0";
-    }
-    
-    // Clear and redraw price area
-    tft.fillRect(0, y - 35 + yOffset, 170, 30, themeBackground);
-    tft.setTextSize(3);
-    tft.drawString(bitcoinData.price, x + 5, y - 20 + yOffset, GFXFF);
-    
-    // Clear and redraw sats area
-    tft.fillRect(0, y + 30 + yOffset, 170, 30, themeBackground);
-    tft.setTextSize(3);
-    tft.drawString(satsPerCurrency, x + 5, y + 45 + yOffset, GFXFF);
-    
-    // Clear and redraw block area
-    tft.fillRect(0, y + 95 + yOffset, 170, 30, themeBackground);
-    tft.setTextSize(3);
-    tft.drawString(bitcoinData.blockHigh, x + 5, y + 110 + yOffset, GFXFF);
-    
-  } else {
-    // HORIZONTAL LAYOUT
-    int textX = (displayConfig.orientation == "hi") ? x + 30 : x + 25;
-    
-    // Calculate sats per currency
-    float priceFloat = bitcoinData.price.toFloat();
-    String satsPerCurrency = "";
-    if (priceFloat > 0) {
-      long satsValue = (long)((1.0 / priceFloat) * 100000000.0);
-      satsPerCurrency = String(satsValue);
-    } else {
-      satsPerCurrency = "0";
-    }
-    
-    // Clear and redraw price line
-    tft.fillRect(textX - 10, y - 55, 200, 30, themeBackground);
-    tft.setTextSize(2);
-    String topLabel = currency + "/BTC: ";
-    tft.drawString(topLabel + bitcoinData.price, textX, y - 40, GFXFF);
-    
-    // Clear and redraw sats line
-    tft.fillRect(textX - 10, y - 15, 200, 30, themeBackground);
-    tft.setTextSize(2);
-    String midLabel = "SAT/" + currency + ": ";
-    tft.drawString(midLabel + satsPerCurrency, textX, y, GFXFF);
-    
-    // Clear and redraw block line
-    tft.fillRect(textX - 10, y + 25, 200, 30, themeBackground);
-    tft.setTextSize(2);
-    tft.drawString("Block: " + bitcoinData.blockHigh, textX, y + 40, GFXFF);
-  }
+  tickerScene(values);
 }
 
 // Initialization Screen (shown during connection setup)
-void initializationScreen()
+static void drawInitializationScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.setTextSize(2);
-    tft.drawString("", x + 5, y - 95, GFXFF);
-    tft.setTextSize(8);
-    tft.drawString("ZAP", x + 5, y - 70, GFXFF);
-    tft.drawString("BOX", x + 5, y - 20, GFXFF);
-    tft.setTextSize(2);
-    tft.drawString("", x + 5, y + 15, GFXFF);
-    tft.drawString("Initializ.", x + 5, y + 35, GFXFF);
-    tft.drawString("in", x + 5, y + 55, GFXFF);
-    tft.setTextSize(1);
-    tft.drawString("", x + 5, y + 70, GFXFF);
-    tft.setTextSize(2);
-    tft.drawString("progress", x + 5, y + 80, GFXFF);
-    tft.drawString("...", x + 5, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->setTextSize(2);
+    canvas->drawString("", x + 5, y - 95, GFXFF);
+    canvas->setTextSize(8);
+    canvas->drawString("ZAP", x + 5, y - 70, GFXFF);
+    canvas->drawString("BOX", x + 5, y - 20, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("", x + 5, y + 15, GFXFF);
+    canvas->drawString("Initializ.", x + 5, y + 35, GFXFF);
+    canvas->drawString("in", x + 5, y + 55, GFXFF);
+    canvas->setTextSize(1);
+    canvas->drawString("", x + 5, y + 70, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("progress", x + 5, y + 80, GFXFF);
+    canvas->drawString("...", x + 5, y + 100, GFXFF);
   } else {
-    tft.setTextSize(6);
-    tft.drawString("ZAPBOX", x + 5, y - 15, GFXFF);
-    tft.setTextSize(2);
-    tft.drawString("Initialization in", x, y + 25, GFXFF);
-    tft.drawString("progress...", x, y + 45, GFXFF);
+    canvas->setTextSize(6);
+    canvas->drawString("ZAPBOX", x + 5, y - 15, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("Initialization in", x, y + 25, GFXFF);
+    canvas->drawString("progress...", x, y + 45, GFXFF);
   }
+  framePresent();
 }
 
 // Boot-Up Screen (shown when waking from deep sleep or restarting)
-void bootUpScreen()
+static void drawBootUpScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("BOOT", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("STATUS", x - 55, y + 40, GFXFF);
-    tft.drawString("BOOT", x - 55, y + 70, GFXFF);
-    tft.drawString("UP", x - 55, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("BOOT", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("STATUS", x - 55, y + 40, GFXFF);
+    canvas->drawString("BOOT", x - 55, y + 70, GFXFF);
+    canvas->drawString("UP", x - 55, y + 100, GFXFF);
   } else {
-    tft.drawString("BOOT", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("STATUS", x + 20, y - 30, GFXFF);
-    tft.drawString("BOOT", x + 20, y, GFXFF);
-    tft.drawString("UP", x + 20, y + 30, GFXFF);
+    canvas->drawString("BOOT", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("STATUS", x + 20, y - 30, GFXFF);
+    canvas->drawString("BOOT", x + 20, y, GFXFF);
+    canvas->drawString("UP", x + 20, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Config Mode Screen
-void configModeScreen()
+static void drawConfigModeScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("CONF", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("SERIAL", x - 55, y + 40, GFXFF);
-    tft.drawString("CONFIG", x - 55, y + 70, GFXFF);
-    tft.drawString("MODE", x - 55, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("CONF", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("SERIAL", x - 55, y + 40, GFXFF);
+    canvas->drawString("CONFIG", x - 55, y + 70, GFXFF);
+    canvas->drawString("MODE", x - 55, y + 100, GFXFF);
   } else {
-    tft.drawString("CONF", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("SERIAL", x + 20, y - 30, GFXFF);
-    tft.drawString("CONFIG", x + 20, y, GFXFF);
-    tft.drawString("MODE", x + 20, y + 30, GFXFF);
+    canvas->drawString("CONF", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("SERIAL", x + 20, y - 30, GFXFF);
+    canvas->drawString("CONFIG", x + 20, y, GFXFF);
+    canvas->drawString("MODE", x + 20, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Error Report Screen
-void errorReportScreen(uint8_t wifiCount, uint8_t internetCount, uint8_t serverCount, uint8_t websocketCount)
+static void drawErrorReportScreen(uint8_t wifiCount, uint8_t internetCount, uint8_t serverCount, uint8_t websocketCount)
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("REPORT", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(2); // Reduced from 3 to 2 for 2-digit numbers
-    tft.setTextColor(themeBackground);
-    tft.drawString(String(wifiCount) + " x NW", x - 55, y + 25, GFXFF);
-    tft.drawString(String(internetCount) + " x NI", x - 55, y + 55, GFXFF);
-    tft.drawString(String(serverCount) + " x NS", x - 55, y + 85, GFXFF);
-    tft.drawString(String(websocketCount) + " x NWS", x - 55, y + 115, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("REPORT", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(2); // Reduced from 3 to 2 for 2-digit numbers
+    canvas->setTextColor(themeBackground);
+    canvas->drawString(String(wifiCount) + " x NW", x - 55, y + 25, GFXFF);
+    canvas->drawString(String(internetCount) + " x NI", x - 55, y + 55, GFXFF);
+    canvas->drawString(String(serverCount) + " x NS", x - 55, y + 85, GFXFF);
+    canvas->drawString(String(websocketCount) + " x NWS", x - 55, y + 115, GFXFF);
   } else {
-    tft.drawString("REPORT", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(2); // Reduced from 3 to 2 for 2-digit numbers
-    tft.setTextColor(themeBackground);
-    tft.drawString(String(wifiCount) + " x NW", x + 20, y - 45, GFXFF);
-    tft.drawString(String(internetCount) + " x NI", x + 20, y - 15, GFXFF);
-    tft.drawString(String(serverCount) + " x NS", x + 20, y + 15, GFXFF);
-    tft.drawString(String(websocketCount) + " x NWS", x + 20, y + 45, GFXFF);
+    canvas->drawString("REPORT", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(2); // Reduced from 3 to 2 for 2-digit numbers
+    canvas->setTextColor(themeBackground);
+    canvas->drawString(String(wifiCount) + " x NW", x + 20, y - 45, GFXFF);
+    canvas->drawString(String(internetCount) + " x NI", x + 20, y - 15, GFXFF);
+    canvas->drawString(String(serverCount) + " x NS", x + 20, y + 15, GFXFF);
+    canvas->drawString(String(websocketCount) + " x NWS", x + 20, y + 45, GFXFF);
   }
+  framePresent();
+}
+
+// WebSocket reconnect counters (attempts, failed, reconnected, current backoff)
+static void drawReconnectReportScreen(uint32_t attempts, uint32_t failures, uint32_t reconnects, unsigned long backoffMs)
+{
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  String waitLine = String((backoffMs + 500) / 1000) + " s WAIT";
+  if (displayConfig.layout.vertical){
+    canvas->drawString("RETRY", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(2);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString(String(attempts) + " x TRY", x - 55, y + 25, GFXFF);
+    canvas->drawString(String(failures) + " x FAIL", x - 55, y + 55, GFXFF);
+    canvas->drawString(String(reconnects) + " x OK", x - 55, y + 85, GFXFF);
+    canvas->drawString(waitLine, x - 55, y + 115, GFXFF);
+  } else {
+    canvas->drawString("RETRY", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(2);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString(String(attempts) + " x TRY", x + 20, y - 45, GFXFF);
+    canvas->drawString(String(failures) + " x FAIL", x + 20, y - 15, GFXFF);
+    canvas->drawString(String(reconnects) + " x OK", x + 20, y + 15, GFXFF);
+    canvas->drawString(waitLine, x + 20, y + 45, GFXFF);
+  }
+  framePresent();
 }
 
 // WiFi Reconnect Screen
-void wifiReconnectScreen()
+static void drawWifiReconnectScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("FAULT", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x - 55, y + 40, GFXFF);
-    tft.drawString("WIFI", x - 55, y + 70, GFXFF);
-    tft.drawString("", x - 55, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("FAULT", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x - 55, y + 40, GFXFF);
+    canvas->drawString("WIFI", x - 55, y + 70, GFXFF);
+    canvas->drawString("", x - 55, y + 100, GFXFF);
   } else {
-    tft.drawString("FAULT", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x + 20, y - 30, GFXFF);
-    tft.drawString("WIFI", x + 20, y, GFXFF);
-    tft.drawString("", x + 20, y + 30, GFXFF);
+    canvas->drawString("FAULT", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x + 20, y - 30, GFXFF);
+    canvas->drawString("WIFI", x + 20, y, GFXFF);
+    canvas->drawString("", x + 20, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Internet/Server Reconnect Screen
-void internetReconnectScreen()
+static void drawInternetReconnectScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("FAULT", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x - 55, y + 40, GFXFF);
-    tft.drawString("INTER", x - 55, y + 70, GFXFF);
-    tft.drawString("NET", x - 55, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("FAULT", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x - 55, y + 40, GFXFF);
+    canvas->drawString("INTER", x - 55, y + 70, GFXFF);
+    canvas->drawString("NET", x - 55, y + 100, GFXFF);
   } else {
-    tft.drawString("FAULT", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x + 20, y - 30, GFXFF);
-    tft.drawString("INTER", x + 20, y, GFXFF);
-    tft.drawString("NET", x + 20, y + 30, GFXFF);
+    canvas->drawString("FAULT", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x + 20, y - 30, GFXFF);
+    canvas->drawString("INTER", x + 20, y, GFXFF);
+    canvas->drawString("NET", x + 20, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // WebSocket Reconnect Screen
-void serverReconnectScreen()
+static void drawServerReconnectScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("FAULT", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x - 55, y + 40, GFXFF);
-    tft.drawString("SERVER", x - 55, y + 85, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("FAULT", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x - 55, y + 40, GFXFF);
+    canvas->drawString("SERVER", x - 55, y + 85, GFXFF);
   } else {
-    tft.drawString("FAULT", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x + 20, y - 15, GFXFF);
-    tft.drawString("SERVER", x + 20, y + 15, GFXFF);
+    canvas->drawString("FAULT", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x + 20, y - 15, GFXFF);
+    canvas->drawString("SERVER", x + 20, y + 15, GFXFF);
   }
+  framePresent();
 }
 
-void websocketReconnectScreen()
+static void drawWebsocketReconnectScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(4);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("FAULT", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x - 55, y + 40, GFXFF);
-    tft.drawString("WEB", x - 55, y + 70, GFXFF);
-    tft.drawString("SOCKET", x - 55, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(4);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("FAULT", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x - 55, y + 40, GFXFF);
+    canvas->drawString("WEB", x - 55, y + 70, GFXFF);
+    canvas->drawString("SOCKET", x - 55, y + 100, GFXFF);
   } else {
-    tft.drawString("FAULT", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("NO", x + 20, y - 30, GFXFF);
-    tft.drawString("WEB", x + 20, y, GFXFF);
-    tft.drawString("SOCKET", x + 20, y + 30, GFXFF);
+    canvas->drawString("FAULT", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("NO", x + 20, y - 30, GFXFF);
+    canvas->drawString("WEB", x + 20, y, GFXFF);
+    canvas->drawString("SOCKET", x + 20, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Step one
-void stepOneScreen()
+static void drawStepOneScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(10);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("1", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("SELECT", x - 58, y + 40, GFXFF);
-    tft.drawString("YOUR", x - 58, y + 70, GFXFF);
-    tft.drawString("PRODUCT", x - 58, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(10);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("1", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("SELECT", x - 58, y + 40, GFXFF);
+    canvas->drawString("YOUR", x - 58, y + 70, GFXFF);
+    canvas->drawString("PRODUCT", x - 58, y + 100, GFXFF);
   } else {
-    tft.drawString("1", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("SELECT", x + 17, y - 30, GFXFF);
-    tft.drawString("YOUR", x + 17, y, GFXFF);
-    tft.drawString("PRODUCT", x + 17, y + 30, GFXFF);
+    canvas->drawString("1", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("SELECT", x + 17, y - 30, GFXFF);
+    canvas->drawString("YOUR", x + 17, y, GFXFF);
+    canvas->drawString("PRODUCT", x + 17, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Step two
-void stepTwoScreen()
+static void drawStepTwoScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(10);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("2", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("SCAN", x - 58, y + 40, GFXFF);
-    tft.drawString("QR", x - 58, y + 70, GFXFF);
-    tft.drawString("CODE", x - 58, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(10);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("2", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("SCAN", x - 58, y + 40, GFXFF);
+    canvas->drawString("QR", x - 58, y + 70, GFXFF);
+    canvas->drawString("CODE", x - 58, y + 100, GFXFF);
   } else {
-    tft.drawString("2", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("SCAN", x + 17, y - 30, GFXFF);
-    tft.drawString("QR", x + 17, y, GFXFF);
-    tft.drawString("CODE", x + 17, y + 30, GFXFF);
+    canvas->drawString("2", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("SCAN", x + 17, y - 30, GFXFF);
+    canvas->drawString("QR", x + 17, y, GFXFF);
+    canvas->drawString("CODE", x + 17, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Step three
-void stepThreeScreen()
+static void drawStepThreeScreen()
 {
-  tft.fillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(10);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("3", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("PAY", x - 58, y + 40, GFXFF);
-    tft.drawString("IN-", x - 58, y + 70, GFXFF);
-    tft.drawString("VOICE", x - 58, y + 100, GFXFF);
+  clearScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(10);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->drawString("3", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("PAY", x - 58, y + 40, GFXFF);
+    canvas->drawString("IN-", x - 58, y + 70, GFXFF);
+    canvas->drawString("VOICE", x - 58, y + 100, GFXFF);
   } else {
-    tft.drawString("3", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("PAY", x + 17, y - 30, GFXFF);
-    tft.drawString("IN-", x + 17, y, GFXFF);
-    tft.drawString("VOICE", x + 17, y + 30, GFXFF);
+    canvas->drawString("3", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("PAY", x + 17, y - 30, GFXFF);
+    canvas->drawString("IN-", x + 17, y, GFXFF);
+    canvas->drawString("VOICE", x + 17, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Switched ON screen
-void actionTimeScreen()
+static void drawActionTimeScreen()
 {
   // ZAPBOX theme color inversion fix: Reset display controller with double-clear
-  if (displayConfig.theme == "zapbox" || displayConfig.theme == "btcorange-black") {
-    tft.fillScreen(TFT_BLACK);
+  if (displayConfig.palette.invertedQr && !frameBuffered()) {
+    canvas->fillScreen(TFT_BLACK);
     delay(10);
-    tft.fillScreen(TFT_BLACK);
+    canvas->fillScreen(TFT_BLACK);
     delay(5);
   }
   safeFillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(themeForeground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.setTextSize(4);
-    tft.drawString("A", x + 5, y - 105, GFXFF);
-    tft.drawString("C", x + 5, y - 70, GFXFF);
-    tft.drawString("T", x + 5, y - 35, GFXFF);
-    tft.drawString("I", x + 5, y, GFXFF);
-    tft.drawString("O", x + 5, y + 35, GFXFF);
-    tft.drawString("N", x + 5, y + 70, GFXFF);
-    tft.setTextSize(3);
-    tft.drawString("TIME", x + 3, y + 105, GFXFF);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextColor(themeForeground);
+
+  if (displayConfig.layout.vertical){
+    canvas->setTextSize(4);
+    canvas->drawString("A", x + 5, y - 105, GFXFF);
+    canvas->drawString("C", x + 5, y - 70, GFXFF);
+    canvas->drawString("T", x + 5, y - 35, GFXFF);
+    canvas->drawString("I", x + 5, y, GFXFF);
+    canvas->drawString("O", x + 5, y + 35, GFXFF);
+    canvas->drawString("N", x + 5, y + 70, GFXFF);
+    canvas->setTextSize(3);
+    canvas->drawString("TIME", x + 3, y + 105, GFXFF);
   } else {
-    tft.setTextSize(6);
-    tft.drawString("ACTION", x + 5, y - 15, GFXFF);
-    tft.setTextSize(4);
-    tft.drawString("TIME", x + 3, y + 30, GFXFF);
+    canvas->setTextSize(6);
+    canvas->drawString("ACTION", x + 5, y - 15, GFXFF);
+    canvas->setTextSize(4);
+    canvas->drawString("TIME", x + 3, y + 30, GFXFF);
   }
+  framePresent();
+}
+
+// Paid activation could not be started (relay queue full / no free slot)
+static void drawPaymentErrorScreen()
+{
+  safeFillScreen(themeBackground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextColor(themeForeground);
+  if (displayConfig.layout.vertical){
+    canvas->setTextSize(4);
+    canvas->drawString("ERROR", x + 5, y - 35, GFXFF);
+    canvas->setTextSize(3);
+    canvas->drawString("RELAY", x + 3, y + 15, GFXFF);
+    canvas->drawString("BUSY", x + 3, y + 45, GFXFF);
+  } else {
+    canvas->setTextSize(6);
+    canvas->drawString("ERROR", x + 5, y - 15, GFXFF);
+    canvas->setTextSize(3);
+    canvas->drawString("RELAY BUSY", x + 3, y + 30, GFXFF);
+  }
+  framePresent();
 }
 
 // Thank you
-void thankYouScreen()
+static void drawThankYouScreen()
 {
   safeFillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextSize(10);
-  tft.setTextColor(themeForeground);
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    tft.drawString("ty", x + 5, y - 70, GFXFF);
-    tft.fillRect(15, 165, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("ENJOY", x - 55, y + 40, GFXFF);
-    tft.drawString("YOUR", x - 55, y + 70, GFXFF);
-    tft.drawString("DAY", x - 55, y + 100, GFXFF);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextSize(10);
+  canvas->setTextColor(themeForeground);
+  if (displayConfig.layout.vertical){
+    canvas->drawString("ty", x + 5, y - 70, GFXFF);
+    canvas->fillRect(15, 165, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("ENJOY", x - 55, y + 40, GFXFF);
+    canvas->drawString("YOUR", x - 55, y + 70, GFXFF);
+    canvas->drawString("DAY", x - 55, y + 100, GFXFF);
   } else {
-      tft.drawString("ty", x - 70, y, GFXFF);
-    tft.fillRect(165, 15, 140, 135, themeForeground);
-    tft.setTextDatum(ML_DATUM);
-    tft.setTextSize(3);
-    tft.setTextColor(themeBackground);
-    tft.drawString("ENJOY", x + 20, y - 30, GFXFF);
-    tft.drawString("YOUR", x + 20, y, GFXFF);
-    tft.drawString("DAY", x + 20, y + 30, GFXFF);
+      canvas->drawString("ty", x - 70, y, GFXFF);
+    canvas->fillRect(165, 15, 140, 135, themeForeground);
+    canvas->setTextDatum(ML_DATUM);
+    canvas->setTextSize(3);
+    canvas->setTextColor(themeBackground);
+    canvas->drawString("ENJOY", x + 20, y - 30, GFXFF);
+    canvas->drawString("YOUR", x + 20, y, GFXFF);
+    canvas->drawString("DAY", x + 20, y + 30, GFXFF);
   }
+  framePresent();
 }
 
 // Show QR for ZAP action - uses product label from backend if available
 void showQRScreen()
 {
   int pinIndex = getPinIndex(12);
-  String label = (pinIndex >= 0 && productLabels.labels[pinIndex].length() > 0) ? productLabels.labels[pinIndex] : "READY 4 ZAP ACTION";
+  String label = (pinIndex >= 0 && productLabels.labels[pinIndex][0] != '\0') ? productLabels.labels[pinIndex] : "READY 4 ZAP ACTION";
   showProductQRScreen(label, 12);
 }
 
-void drawQRCode()
+// QR code layout: version 8 = 49x49 modules, 3 px per module
+#define QR_VERSION 8
+#define QR_MODULE_SCALE 3
+
+// Encoded module matrices keyed by payload: one entry per product pin plus one
+// for threshold/other payloads, so navigating between products never re-encodes
+#define QR_CACHE_ENTRIES 5
+
+struct QRCacheEntry {
+  QRCode qr;
+  uint8_t data[qrcode_getBufferSize(QR_VERSION)];
+  char payload[sizeof(lightningConfig.lightning)];
+  bool valid;
+};
+
+static QRCacheEntry qrCache[QR_CACHE_ENTRIES];
+static uint8_t qrCacheNextEvict = 0;
+
+static const QRCode &getCachedQRCode(const char *payload)
 {
-  // Calculate offset for inverse orientations
-  int offsetX = 12;
-  int offsetY = 12;
-  
-  // Shift QR code 8 pixels right for horizontal inverse only
-  if (displayConfig.orientation == "hi") {
-    offsetX = 20;
-  }
-  
-  // Shift QR code 7 pixels down for vertical inverse only
-  if (displayConfig.orientation == "vi") {
-    offsetY = 19;
+  for (auto &entry : qrCache) {
+    if (entry.valid && strcmp(entry.payload, payload) == 0) {
+      return entry.qr;
+    }
   }
-  
-  QRCode qrcoded;
-  uint8_t qrcodeData[qrcode_getBufferSize(20)];
-  qrcode_initText(&qrcoded, qrcodeData, 8, 0, lightningConfig.lightning);
-
-  for (uint8_t y = 0; y < qrcoded.size; y++)
-  {
-    // Each horizontal module
-    for (uint8_t x = 0; x < qrcoded.size; x++)
-    {
-      if (qrcode_getModule(&qrcoded, x, y))
-      {
-          tft.fillRect(offsetX + 3 * x, offsetY + 3 * y, 3, 3, themeForeground);
-      }
-      else
-      {
-          tft.fillRect(offsetX + 3 * x, offsetY + 3 * y, 3, 3, themeBackground);
-      }
+
+  // Miss: prefer an empty entry, otherwise replace round-robin
+  QRCacheEntry *target = nullptr;
+  for (auto &entry : qrCache) {
+    if (!entry.valid) {
+      target = &entry;
+      break;
     }
   }
+  if (!target) {
+    target = &qrCache[qrCacheNextEvict];
+    qrCacheNextEvict = (qrCacheNextEvict + 1) % QR_CACHE_ENTRIES;
+  }
+
+  unsigned long encodeStart = micros();
+  qrcode_initText(&target->qr, target->data, QR_VERSION, 0, payload);
+  strncpy(target->payload, payload, sizeof(target->payload) - 1);
+  target->payload[sizeof(target->payload) - 1] = '\0';
+  target->valid = true;
+  LOG_REC_DEBUG(Display, QR_ENCODED, target->qr.size, micros() - encodeStart);
+  return target->qr;
 }
 
-// Draw QRCode using explicit foreground/background colors (used for special themes)
-void drawQRCodeWithColors(uint16_t fg, uint16_t bg)
+// Encode a payload ahead of time so its first draw needs no encoding
+void precacheQRCode(const char *payload)
 {
-  int offsetX = 12;
-  int offsetY = 12;
-  if (displayConfig.orientation == "hi") {
-    offsetX = 20;
+  if (payload && payload[0] != '\0') {
+    getCachedQRCode(payload);
   }
-  if (displayConfig.orientation == "vi") {
-    offsetY = 19;
+}
+
+// Drop all cached matrices (config change)
+void clearQRCodeCache()
+{
+  for (auto &entry : qrCache) {
+    entry.valid = false;
   }
+  qrCacheNextEvict = 0;
+}
 
-  QRCode qrcoded;
-  uint8_t qrcodeData[qrcode_getBufferSize(20)];
-  qrcode_initText(&qrcoded, qrcodeData, 8, 0, lightningConfig.lightning);
+static void getQROffset(int &offsetX, int &offsetY)
+{
+  // hi is shifted 8 pixels right, vi 7 pixels down (see resolveDisplayLayout)
+  offsetX = displayConfig.layout.qr.x;
+  offsetY = displayConfig.layout.qr.y;
+}
 
-  for (uint8_t y = 0; y < qrcoded.size; y++) {
-    for (uint8_t x = 0; x < qrcoded.size; x++) {
-      uint16_t color = qrcode_getModule(&qrcoded, x, y) ? fg : bg;
-      tft.fillRect(offsetX + 3 * x, offsetY + 3 * y, 3, 3, color);
+#ifdef QR_FRAME_BENCHMARK
+// Previous renderer (one fillRect per module), kept only for before/after timing
+static void drawQRModulesPerRect(const QRCode &qr, int offsetX, int offsetY, uint16_t fg, uint16_t bg)
+{
+  for (uint8_t y = 0; y < qr.size; y++) {
+    for (uint8_t x = 0; x < qr.size; x++) {
+      uint16_t color = qrcode_getModule((QRCode *)&qr, x, y) ? fg : bg;
+      canvas->fillRect(offsetX + QR_MODULE_SCALE * x, offsetY + QR_MODULE_SCALE * y, QR_MODULE_SCALE, QR_MODULE_SCALE, color);
     }
   }
 }
+#endif
 
-void showThresholdQRScreen()
+// Draw the whole matrix in one address window; each scaled row is streamed as color runs.
+// The frame buffer has no address window: runs become (cheap, in-memory) fillRects there
+static void drawQRModules(const QRCode &qr, int offsetX, int offsetY, uint16_t fg, uint16_t bg)
 {
-  tft.setTextDatum(ML_DATUM);
-  safeFillScreen(themeBackground);
-  tft.setTextSize(3);
-  tft.setTextColor(themeBackground);
-
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    int boxY = (displayConfig.orientation == "vi") ? 175 : 168;
-    tft.fillRect(15, boxY, 140, 132, themeForeground);
-    tft.drawString("READY", x - 55, y + 40, GFXFF);
-    tft.drawString("4 TH", x - 55, y + 70, GFXFF);
-    tft.drawString("ACTION", x - 55, y + 100, GFXFF);
-    tft.setTextSize(2);
-    tft.setTextColor(themeForeground);
-    if (!touchState.available && !externalButtonState.enabled) {
-      // Only show HELP if not touch and external button not enabled
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 35, y + 150, GFXFF); // Right side bottom
-      } else {
-        tft.drawString("HELP", 5, 10, GFXFF); // Left side top for vi
+  const int sizePx = qr.size * QR_MODULE_SCALE;
+  const bool buffered = frameBuffered();
+
+  if (!buffered) {
+    canvas->startWrite();
+    canvas->setAddrWindow(offsetX, offsetY, sizePx, sizePx);
+  }
+  for (uint8_t y = 0; y < qr.size; y++) {
+    for (uint8_t line = 0; line < QR_MODULE_SCALE; line++) {
+      uint8_t x = 0;
+      while (x < qr.size) {
+        bool dark = qrcode_getModule((QRCode *)&qr, x, y);
+        uint8_t run = 1;
+        while (x + run < qr.size && qrcode_getModule((QRCode *)&qr, x + run, y) == dark) {
+          run++;
+        }
+        if (buffered) {
+          canvas->fillRect(offsetX + x * QR_MODULE_SCALE, offsetY + y * QR_MODULE_SCALE + line,
+                           run * QR_MODULE_SCALE, 1, dark ? fg : bg);
+        } else {
+          canvas->pushBlock(dark ? fg : bg, run * QR_MODULE_SCALE);
+        }
+        x += run;
       }
     }
+  }
+  if (!buffered) {
+    canvas->endWrite();
+  }
+  frameDamage(offsetX, offsetY, sizePx, sizePx);
+}
+
+// Scene image callback: data is the payload
+static void drawQRWidget(const void *data, int16_t offsetX, int16_t offsetY, uint16_t fg, uint16_t bg)
+{
+  const QRCode &qr = getCachedQRCode((const char *)data);
+
+#ifdef QR_FRAME_BENCHMARK
+  unsigned long legacyStart = micros();
+  drawQRModulesPerRect(qr, offsetX, offsetY, fg, bg);
+  LOG_INFOF("QR", "Frame time per-module fillRect: %lu us", micros() - legacyStart);
+
+  unsigned long frameStart = micros();
+  drawQRModules(qr, offsetX, offsetY, fg, bg);
+  LOG_INFOF("QR", "Frame time: %lu us", micros() - frameStart);
+#else
+  drawQRModules(qr, offsetX, offsetY, fg, bg);
+#endif
+}
+
+// Payload as a scene widget; only redrawn when the payload or colors change
+static void sceneQRCode(const char *payload, uint16_t fg, uint16_t bg)
+{
+  int offsetX, offsetY;
+  getQROffset(offsetX, offsetY);
+
+  const int sizePx = getCachedQRCode(payload).size * QR_MODULE_SCALE;
+  sceneImage(offsetX, offsetY, sizePx, sizePx, sceneHash(payload, strlen(payload)), drawQRWidget, payload, fg, bg);
+}
+
+static void drawThresholdQRScreen(const char *payload)
+{
+  sceneBegin(themeBackground);
+
+  if (displayConfig.layout.vertical){
+    int boxY = displayConfig.layout.qrBoxY;
+    sceneBox(15, boxY, 140, 132, themeForeground);
+    sceneText("READY", x - 55, y + 40, ML_DATUM, 3, themeBackground);
+    sceneText("4 TH", x - 55, y + 70, ML_DATUM, 3, themeBackground);
+    sceneText("ACTION", x - 55, y + 100, ML_DATUM, 3, themeBackground);
   } else {
-    int boxX = (displayConfig.orientation == "hi") ? 173 : 168;
-    tft.fillRect(boxX, 18, 140, 135, themeForeground);
-    int textOffset = (displayConfig.orientation == "hi") ? 25 : 20;
-    tft.drawString("READY", x + textOffset, y - 30, GFXFF);
-    tft.drawString("4 TH", x + textOffset, y, GFXFF);
-    tft.drawString("ACTION", x + textOffset, y + 30, GFXFF);
-    tft.setTextSize(2);
-    tft.setTextColor(themeForeground);
-    if (!touchState.available && !externalButtonState.enabled) {
-      // Only show HELP if not touch and external button not enabled
-      if (displayConfig.orientation == "h") {
-        tft.drawString("HELP", x + 110, 9, GFXFF); // Top right
-      } else {
-        tft.drawString("HELP", 5, 163, GFXFF); // Bottom left for hi
-      }
-    }
+    int textX = displayConfig.layout.thresholdTextX;
+    sceneBox(displayConfig.layout.thresholdBoxX, 18, 140, 135, themeForeground);
+    sceneText("READY", textX, y - 30, ML_DATUM, 3, themeBackground);
+    sceneText("4 TH", textX, y, ML_DATUM, 3, themeBackground);
+    sceneText("ACTION", textX, y + 30, ML_DATUM, 3, themeBackground);
+  }
+  if (!touchState.available && !externalButtonState.enabled) {
+    // Only show HELP if not touch and external button not enabled
+    sceneText("HELP", displayConfig.layout.helpLabel.x, displayConfig.layout.helpLabel.y, ML_DATUM, 2, themeForeground);
   }
 
-  drawQRCode();
+  sceneQRCode(payload, themeForeground, themeBackground);
+  sceneEnd();
+  framePresent();
 }
 
 void showSpecialModeQRScreen()
 {
   int pinIndex = getPinIndex(12);
-  String label = (pinIndex >= 0 && productLabels.labels[pinIndex].length() > 0) ? productLabels.labels[pinIndex] : "READY 4 SP ACTION";
+  String label = (pinIndex >= 0 && productLabels.labels[pinIndex][0] != '\0') ? productLabels.labels[pinIndex] : "READY 4 SP ACTION";
   showProductQRScreen(label, 12);
 }
 
 // Multi-Channel-Control Product QR Screen - displays label text and QR code
 // Label can contain 1-3 words separated by spaces
-void showProductQRScreen(String label, int pin)
+static void drawProductQRScreen(String label, int pin, const char *payload)
 {
-  // Select colors; invert for "zapbox" theme only on product QR screens
-  uint16_t fg = themeForeground;
-  uint16_t bg = themeBackground;
-  if (displayConfig.theme == "zapbox") {
-    fg = TFT_BLACK;
-    bg = 0xFEA0;
-  } else if (displayConfig.theme == "btcorange-black") {
-    fg = TFT_BLACK;
-    bg = 0xFCC0;
-  }
+  // Product QR screens use inverted colors for zapbox/btcorange-black (see setThemeColors)
+  uint16_t fg = displayConfig.palette.productForeground;
+  uint16_t bg = displayConfig.palette.productBackground;
 
   // Replace currency symbols with text abbreviations for better compatibility
   // GFXFF fonts only support ASCII, so we use standard abbreviations
@@ -994,242 +1102,376 @@ void showProductQRScreen(String label, int pin)
     wordCount = 1;
   }
 
-  // Now do all display operations - COMPLETE refresh like help screens
   // ZAPBOX/BTCORANGE theme color inversion fix
   // Problem: Ticker has BLACK background, inverted QR has YELLOW/ORANGE background
-  // Display controller needs careful transition sequence for this complete color inversion
-  if (displayConfig.theme == "zapbox" || displayConfig.theme == "btcorange-black") {
+  // Display controller needs careful transition sequence for this complete color
+  // inversion; product to product keeps the background and only redraws label and QR
+  if (needsInversionClears(bg)) {
     // Step 1: Clear to BLACK (ensures clean starting point from ticker)
-    tft.fillScreen(TFT_BLACK);
+    canvas->fillScreen(TFT_BLACK);
     delay(20);
     
     // Step 2: Transition to target background color (yellow or orange)
-    tft.fillScreen(bg);
+    canvas->fillScreen(bg);
     delay(30);
     
     // Step 3: Confirm with second fill of target color
-    tft.fillScreen(bg);
+    canvas->fillScreen(bg);
     delay(20);
   }
   
-  safeFillScreen(bg);
-  
-  // Draw QR code immediately after screen clear, before anything else
-  if (displayConfig.theme == "zapbox" || displayConfig.theme == "btcorange-black") {
-    drawQRCodeWithColors(fg, bg);
+  sceneBegin(bg);
+
+  // QR code first, as it is the largest widget
+  sceneQRCode(payload, fg, bg);
+
+  int textX, startY;
+  if (displayConfig.layout.vertical){
+    sceneBox(15, displayConfig.layout.qrBoxY, 140, 132, fg);
+    textX = x - 58;
+    startY = y + 40;
   } else {
-    drawQRCode();
+    sceneBox(displayConfig.layout.productBoxX, 18, 137, 135, fg);
+    textX = displayConfig.layout.productTextX;
+    startY = y - 30;
   }
-  
-  tft.setTextDatum(ML_DATUM);
-  tft.setTextColor(fg);
 
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
-    int boxY = (displayConfig.orientation == "vi") ? 175 : 168;
-    tft.fillRect(15, boxY, 140, 132, fg);
-    
-    // Display up to 3 lines of text
-    tft.setTextSize(3);
-    tft.setTextColor(bg);
-    int startY = y + 40; // Starting Y position
-    if (wordCount == 1) {
-      tft.drawString(words[0], x - 58, startY + 30, GFXFF);
-    } else if (wordCount == 2) {
-      tft.drawString(words[0], x - 58, startY + 15, GFXFF);
-      tft.drawString(words[1], x - 58, startY + 45, GFXFF);
-    } else { // 3 words
-      tft.drawString(words[0], x - 58, startY, GFXFF);
-      tft.drawString(words[1], x - 58, startY + 30, GFXFF);
-      tft.setTextSize(2); // Smaller font for third line (currency text)
-      tft.drawString(words[2], x - 58, startY + 60, GFXFF);
-    }
-    
-    // Button labels - different layout for touch vs non-touch
-    tft.setTextSize(2);
-    tft.setTextColor(fg);
-    
-    if (touchState.available) {
-      // Touch version: HELP on bottom for v, top for vi (where touch button is)
-      tft.setTextDatum(MC_DATUM);
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 2, 312, GFXFF);
-      } else {
-        tft.drawString("HELP", x + 2, 10, GFXFF);
-      }
-    } else if (!externalButtonState.enabled) {
-      // Non-touch version: mirror labels for inverse displayConfig.orientation (only if external button is NOT enabled)
-      tft.setTextDatum(ML_DATUM);
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 35, y + 150, GFXFF);
-        tft.drawString("NEXT", 5, y + 150, GFXFF);
-      } else {
-        tft.drawString("HELP", 5, 10, GFXFF);
-        tft.drawString("NEXT", x + 35, 10, GFXFF);
-      }
-    }
-  } else {
-    int boxX = (displayConfig.orientation == "hi") ? 171 : 163;
-    tft.fillRect(boxX, 18, 137, 135, fg);
-    
-    // Display up to 3 lines of text
-    tft.setTextSize(3);
-    tft.setTextColor(bg);
-    int startY = y - 30; // Starting Y position
-    int textOffset = (displayConfig.orientation == "hi") ? 25 : 17;
-    if (wordCount == 1) {
-      tft.drawString(words[0], x + textOffset, startY + 30, GFXFF);
-    } else if (wordCount == 2) {
-      tft.drawString(words[0], x + textOffset, startY + 15, GFXFF);
-      tft.drawString(words[1], x + textOffset, startY + 45, GFXFF);
-    } else { // 3 words
-      tft.drawString(words[0], x + textOffset, startY, GFXFF);
-      tft.drawString(words[1], x + textOffset, startY + 30, GFXFF);
-      tft.setTextSize(2); // Smaller font for third line (currency text)
-      tft.drawString(words[2], x + textOffset, startY + 60, GFXFF);
-    }
-    
-    // Button labels - different layout for touch vs non-touch
-    tft.setTextSize(2);
-    tft.setTextColor(fg);
-    
-    if (touchState.available) {
-      // Touch version: HELP as vertical stacked letters on right/left side
-      tft.setTextDatum(MC_DATUM);
-      if (displayConfig.orientation == "h") {
-        // Right side, top to bottom (button at right)
-        tft.drawString("H", 311, y - 30, GFXFF);
-        tft.drawString("E", 311, y - 10, GFXFF);
-        tft.drawString("L", 311, y + 10, GFXFF);
-        tft.drawString("P", 311, y + 30, GFXFF);
-      } else {
-        // Left side - same order as h
-        tft.drawString("H", 11, y - 30, GFXFF);
-        tft.drawString("E", 11, y - 10, GFXFF);
-        tft.drawString("L", 11, y + 10, GFXFF);
-        tft.drawString("P", 11, y + 30, GFXFF);
-      }
-    } else if (!externalButtonState.enabled) {
-      // Non-touch version: mirror labels for inverse displayConfig.orientation (only if external button is NOT enabled)
-      tft.setTextDatum(ML_DATUM);
-      if (displayConfig.orientation == "h") {
-        tft.drawString("HELP", x + 110, 9, GFXFF);
-        tft.drawString("NEXT", x + 110, 163, GFXFF);
-      } else {
-        tft.drawString("HELP", 5, 163, GFXFF);
-        tft.drawString("NEXT", 5, 9, GFXFF);
-      }
-    }
+  // Display up to 3 lines of text
+  if (wordCount == 1) {
+    sceneText(words[0], textX, startY + 30, ML_DATUM, 3, bg);
+  } else if (wordCount == 2) {
+    sceneText(words[0], textX, startY + 15, ML_DATUM, 3, bg);
+    sceneText(words[1], textX, startY + 45, ML_DATUM, 3, bg);
+  } else { // 3 words
+    sceneText(words[0], textX, startY, ML_DATUM, 3, bg);
+    sceneText(words[1], textX, startY + 30, ML_DATUM, 3, bg);
+    // Smaller font for third line (currency text)
+    sceneText(words[2], textX, startY + 60, ML_DATUM, 2, bg);
   }
+
+  // Button labels (touch or physical buttons)
+  drawButtonLabels(fg);
+  sceneEnd();
+  framePresent();
 }
 
 // Product Selection Screen - shown after 5 seconds of QR screen
-void productSelectionScreen()
+static void drawProductSelectionScreen()
 {
   safeFillScreen(themeBackground);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(themeForeground);
+  canvas->setTextDatum(MC_DATUM);
+  canvas->setTextColor(themeForeground);
 
-  if (displayConfig.orientation == "v" || displayConfig.orientation == "vi"){
+  if (displayConfig.layout.vertical){
     // Vertical displayConfig.orientation
-    tft.setTextSize(2);
-    tft.drawString("SELECT", x, y - 40, GFXFF);
-    tft.drawString("PRODUCT", x, y - 20, GFXFF);
+    canvas->setTextSize(2);
+    canvas->drawString("SELECT", x, y - 40, GFXFF);
+    canvas->drawString("PRODUCT", x, y - 20, GFXFF);
     
     // Draw navigation arrows
-    tft.setTextSize(4);
-    tft.drawString("<->", x, y + 30, GFXFF);
+    canvas->setTextSize(4);
+    canvas->drawString("<->", x, y + 30, GFXFF);
     
     // Draw instruction text
-    tft.setTextSize(2);
-    tft.drawString("NEXT", x, y + 60, GFXFF);
-    
-    // Button labels - different layout for touch vs non-touch
-    tft.setTextSize(2);
+    canvas->setTextSize(2);
+    canvas->drawString("NEXT", x, y + 60, GFXFF);
     
-    if (touchState.available) {
-      // Touch version: HELP on bottom for v, top for vi (where touch button is)
-      tft.setTextDatum(MC_DATUM);
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 2, 312, GFXFF); // Bottom (button at bottom)
-      } else {
-        tft.drawString("HELP", x + 2, 10, GFXFF); // Top for vi (button at top)
-      }
-    } else if (!externalButtonState.enabled) {
-      // Non-touch version: mirror labels for inverse displayConfig.orientation (only if external button is NOT enabled)
-      tft.setTextDatum(ML_DATUM);
-      if (displayConfig.orientation == "v") {
-        tft.drawString("HELP", x + 35, y + 150, GFXFF); // Right side bottom
-        tft.drawString("NEXT", 5, y + 150, GFXFF); // Left side bottom
-      } else {
-        // vi: Mirror positions to top AND swap sides (180° rotation)
-        tft.drawString("HELP", 5, 10, GFXFF); // Left side top
-        tft.drawString("NEXT", x + 35, 10, GFXFF); // Right side top
-      }
-    }
+    // Button labels (touch or physical buttons)
+    drawButtonLabels(themeForeground);
     
   } else {
     // Horizontal displayConfig.orientation
-    tft.setTextSize(3);
-    tft.drawString("SELECT", x, y - 30, GFXFF);
-    tft.drawString("PRODUCT", x, y, GFXFF);
+    canvas->setTextSize(3);
+    canvas->drawString("SELECT", x, y - 30, GFXFF);
+    canvas->drawString("PRODUCT", x, y, GFXFF);
     
     // Draw navigation arrows
-    tft.setTextSize(3);
-    tft.drawString("<-NEXT->", x, y + 40, GFXFF);
+    canvas->setTextSize(3);
+    canvas->drawString("<-NEXT->", x, y + 40, GFXFF);
     
-    // Button labels - different layout for touch vs non-touch
-    tft.setTextSize(2);
-    
-    if (touchState.available) {
-      // Touch version: HELP as vertical stacked letters on right/left side
-      tft.setTextDatum(MC_DATUM);
-      if (displayConfig.orientation == "h") {
-        // Right side, top to bottom (button at right)
-        tft.drawString("H", 311, y - 30, GFXFF);
-        tft.drawString("E", 311, y - 10, GFXFF);
-        tft.drawString("L", 311, y + 10, GFXFF);
-        tft.drawString("P", 311, y + 30, GFXFF);
-      } else {
-        // Left side - same order as h
-        tft.drawString("H", 11, y - 30, GFXFF);
-        tft.drawString("E", 11, y - 10, GFXFF);
-        tft.drawString("L", 11, y + 10, GFXFF);
-        tft.drawString("P", 11, y + 30, GFXFF);
+    // Button labels (touch or physical buttons)
+    drawButtonLabels(themeForeground);
+  }
+  framePresent();
+}
+
+// Screens that only depend on theme and orientation, kept pre-rendered
+struct StaticScreen {
+  DisplayScreen screen;
+  ScreenDrawFn draw;
+};
+
+static const StaticScreen staticScreens[] = {
+  {SCREEN_WIFI_RECONNECT, drawWifiReconnectScreen},
+  {SCREEN_INTERNET_RECONNECT, drawInternetReconnectScreen},
+  {SCREEN_SERVER_RECONNECT, drawServerReconnectScreen},
+  {SCREEN_WEBSOCKET_RECONNECT, drawWebsocketReconnectScreen},
+  {SCREEN_STEP_ONE, drawStepOneScreen},
+  {SCREEN_STEP_TWO, drawStepTwoScreen},
+  {SCREEN_STEP_THREE, drawStepThreeScreen},
+  {SCREEN_ACTION_TIME, drawActionTimeScreen},
+  {SCREEN_THANK_YOU, drawThankYouScreen},
+};
+
+// Render the static screens once per theme and orientation (after
+// initDisplay() has set both); unchanged images are kept
+static void buildScreenCache()
+{
+  const uint16_t key[] = {themeForeground, themeBackground, displayConfig.layout.rotation};
+  if (!screenCacheBegin(tft, sceneHash(key, sizeof(key)))) {
+    return;
+  }
+  unsigned long start = millis();
+  uint8_t built = 0;
+  for (const StaticScreen &entry : staticScreens) {
+    if (screenCacheBuild(entry.screen, entry.draw)) built++;
+  }
+  LOG_INFO("DISPLAY", "Screen cache: " + String(built) + " static screens in PSRAM (" + String(millis() - start) + " ms)");
+}
+
+// One copy of the pre-rendered image, or drawn as usual without it
+static void drawCachedScreen(DisplayScreen screen, ScreenDrawFn draw)
+{
+  if (!screenCacheShow(screen)) {
+    draw();
+    return;
+  }
+  sceneInvalidate();
+  framePresent();
+}
+
+#ifdef DISPLAY_FRAME_BENCHMARK
+// Previous bitmap path: one fillRect per set pixel
+static void drawScaledBitmapPerPixel(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint8_t scale)
+{
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (bitmap[j * ((w + 7) / 8) + i / 8] & (128 >> (i & 7))) {
+        canvas->fillRect(x + i * scale, y + j * scale, scale, scale, color);
       }
-    } else if (!externalButtonState.enabled) {
-      // Non-touch version: mirror labels for inverse displayConfig.orientation (only if external button is NOT enabled)
-      tft.setTextDatum(ML_DATUM);
-      if (displayConfig.orientation == "h") {
-        tft.drawString("HELP", x + 110, 9, GFXFF); // Top right
-        tft.drawString("NEXT", x + 110, 163, GFXFF); // Bottom right
-      } else {
-        // hi: Mirror positions to left side AND swap top/bottom (180° rotation)
-        tft.drawString("HELP", 5, 163, GFXFF); // Bottom left
-        tft.drawString("NEXT", 5, 9, GFXFF); // Top left
+    }
+  }
+}
+
+// bitcoin_logo at scale 1-3: per-pixel fills against one fill per run
+static void benchmarkBitmap()
+{
+  static const int rounds = 10;
+  const SpanBitmap *logo = spanBitmapFor(bitcoin_logo, 64, 64);
+  LOG_INFOF("DISPLAY", "bitcoin_logo: %u runs", logo ? logo->runCount : 0);
+  for (uint8_t scale = 1; scale <= 3; scale++) {
+    clearScreen(themeBackground);
+    unsigned long start = micros();
+    for (int i = 0; i < rounds; i++) drawScaledBitmapPerPixel(0, 0, bitcoin_logo, 64, 64, themeForeground, scale);
+    unsigned long perPixelUs = (micros() - start) / rounds;
+    start = micros();
+    for (int i = 0; i < rounds; i++) drawScaledBitmap(0, 0, bitcoin_logo, 64, 64, themeForeground, scale);
+    unsigned long runsUs = (micros() - start) / rounds;
+    LOG_INFOF("DISPLAY", "logo x%u: per pixel %6lu us, runs %6lu us", scale, perPixelUs, runsUs);
+  }
+  clearScreen(themeBackground);
+  framePresent();
+}
+
+// Draw every screen a few times and log the average frame time (drawing plus
+// present) and, with the frame buffer, the present part alone. The pixels
+// pushed by scene screens are logged per frame (SCENE_FRAME). Product 1 -> 2
+// and the ticker refresh show the scene updates; build once with and once
+// without DISPLAY_FRAMEBUFFER to compare. Runs in the render task, with
+// fixed ticker values and the QR payload copied when it was requested.
+static DisplayTickerValues benchTicker;
+static const char *benchPayload = "";
+
+static void runFrameBenchmark(const char *payload)
+{
+  struct BenchScreen {
+    const char *name;
+    void (*draw)();
+  };
+  static const BenchScreen screens[] = {
+    {"startup", drawStartupScreen},
+    {"initialization", drawInitializationScreen},
+    {"bootUp", drawBootUpScreen},
+    {"configMode", drawConfigModeScreen},
+    {"errorReport", [] { drawErrorReportScreen(1, 2, 3, 4); }},
+    {"reconnectReport", [] { drawReconnectReportScreen(12, 3, 9, 30000); }},
+    {"wifiReconnect", drawWifiReconnectScreen},
+    {"internetReconnect", drawInternetReconnectScreen},
+    {"serverReconnect", drawServerReconnectScreen},
+    {"websocketReconnect", drawWebsocketReconnectScreen},
+    {"stepOne", drawStepOneScreen},
+    {"stepTwo", drawStepTwoScreen},
+    {"stepThree", drawStepThreeScreen},
+    {"actionTime", drawActionTimeScreen},
+    {"thankYou", drawThankYouScreen},
+    {"actionTime (cached)", [] { drawCachedScreen(SCREEN_ACTION_TIME, drawActionTimeScreen); }},
+    {"thankYou (cached)", [] { drawCachedScreen(SCREEN_THANK_YOU, drawThankYouScreen); }},
+    {"btcticker", [] { drawBtctickerScreen(benchTicker); }},
+    {"btcticker refresh", [] { drawBtctickerValues(benchTicker); }},
+    {"productSelection", drawProductSelectionScreen},
+    {"thresholdQR", [] { drawThresholdQRScreen(benchPayload); }},
+    {"product 1", [] { drawProductQRScreen("COFFEE 2.50 EUR", 12, benchPayload); }},
+    {"product 1 -> 2", [] { drawProductQRScreen("TEA 1.80 EUR", 13, benchPayload); }},
+  };
+  static const int rounds = 3;
+  benchTicker = {"90000", "900000", "EUR"};
+  benchPayload = payload;
+
+  LOG_INFOF("DISPLAY", "Frame benchmark, frame buffer %s", frameBuffered() ? "on" : "off");
+  for (const auto &screen : screens) {
+    unsigned long totalUs = 0;
+    unsigned long presentUs = 0;
+    for (int i = 0; i < rounds; i++) {
+      // Transitions are measured from the screen shown before them
+      if (strcmp(screen.name, "product 1") == 0) {
+        drawBtctickerScreen(benchTicker);
+      } else if (strcmp(screen.name, "product 1 -> 2") == 0) {
+        drawProductQRScreen("COFFEE 2.50 EUR", 12, benchPayload);
+      } else if (strcmp(screen.name, "btcticker refresh") == 0) {
+        drawBtctickerScreen(benchTicker);
+        snprintf(benchTicker.price, sizeof(benchTicker.price), "%d", 90000 + i * 37);
       }
+      unsigned long start = micros();
+      screen.draw();
+      totalUs += micros() - start;
+      presentUs += frameBuffered() ? frameLastPresentUs() : 0;
     }
+    LOG_INFOF("DISPLAY", "%-20s %7lu us (present %6lu us)", screen.name, totalUs / rounds, presentUs / rounds);
   }
+  benchmarkBitmap();
+}
+#endif
+
+// Render task dispatch: the public screen functions below only post a
+// command; everything is drawn by the render task (DisplayTask.h)
+static void renderCommand(const DisplayCommand &command)
+{
+  const uint32_t *args = command.args;
+  switch (command.screen) {
+    case SCREEN_BLANK:
+      clearScreen(TFT_BLACK);
+      framePresent();
+      frameAcquire();
+      break;
+    case SCREEN_STARTUP: drawStartupScreen(); break;
+    case SCREEN_BTCTICKER: drawBtctickerScreen(command.ticker); break;
+    case SCREEN_BTCTICKER_VALUES: drawBtctickerValues(command.ticker); break;
+    case SCREEN_INITIALIZATION: drawInitializationScreen(); break;
+    case SCREEN_BOOT_UP: drawBootUpScreen(); break;
+    case SCREEN_CONFIG_MODE: drawConfigModeScreen(); break;
+    case SCREEN_ERROR_REPORT: drawErrorReportScreen(args[0], args[1], args[2], args[3]); break;
+    case SCREEN_RECONNECT_REPORT: drawReconnectReportScreen(args[0], args[1], args[2], args[3]); break;
+    case SCREEN_WIFI_RECONNECT: drawCachedScreen(SCREEN_WIFI_RECONNECT, drawWifiReconnectScreen); break;
+    case SCREEN_INTERNET_RECONNECT: drawCachedScreen(SCREEN_INTERNET_RECONNECT, drawInternetReconnectScreen); break;
+    case SCREEN_SERVER_RECONNECT: drawCachedScreen(SCREEN_SERVER_RECONNECT, drawServerReconnectScreen); break;
+    case SCREEN_WEBSOCKET_RECONNECT: drawCachedScreen(SCREEN_WEBSOCKET_RECONNECT, drawWebsocketReconnectScreen); break;
+    case SCREEN_STEP_ONE: drawCachedScreen(SCREEN_STEP_ONE, drawStepOneScreen); break;
+    case SCREEN_STEP_TWO: drawCachedScreen(SCREEN_STEP_TWO, drawStepTwoScreen); break;
+    case SCREEN_STEP_THREE: drawCachedScreen(SCREEN_STEP_THREE, drawStepThreeScreen); break;
+    case SCREEN_ACTION_TIME: drawCachedScreen(SCREEN_ACTION_TIME, drawActionTimeScreen); break;
+    case SCREEN_THANK_YOU: drawCachedScreen(SCREEN_THANK_YOU, drawThankYouScreen); break;
+    case SCREEN_THRESHOLD_QR: drawThresholdQRScreen(command.payload); break;
+    case SCREEN_PRODUCT_QR: drawProductQRScreen(command.label, (int)args[0], command.payload); break;
+    case SCREEN_PRODUCT_SELECTION: drawProductSelectionScreen(); break;
+#ifdef DISPLAY_FRAME_BENCHMARK
+    case SCREEN_BENCHMARK: runFrameBenchmark(command.payload); break;
+#endif
+    case SCREEN_PAYMENT_ERROR: drawPaymentErrorScreen(); break;
+    default: break;
+  }
+}
+
+static_assert(sizeof(lightningConfig.lightning) <= DISPLAY_PAYLOAD_SIZE, "QR payload does not fit a display command");
+
+static void postScreen(DisplayScreen screen, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0,
+                       const char *label = nullptr)
+{
+  DisplayCommand command = {};
+  command.screen = screen;
+  command.args[0] = a0;
+  command.args[1] = a1;
+  command.args[2] = a2;
+  command.args[3] = a3;
+  if (label) strlcpy(command.label, label, sizeof(command.label));
+
+  // Copy the values the screen shows now; the render task draws this copy
+  switch (screen) {
+    case SCREEN_BTCTICKER:
+    case SCREEN_BTCTICKER_VALUES:
+      strlcpy(command.ticker.price, bitcoinData.price.c_str(), sizeof(command.ticker.price));
+      strlcpy(command.ticker.blockHeight, bitcoinData.blockHigh.c_str(), sizeof(command.ticker.blockHeight));
+      strlcpy(command.ticker.currency, currency.c_str(), sizeof(command.ticker.currency));
+      break;
+    case SCREEN_THRESHOLD_QR:
+    case SCREEN_PRODUCT_QR:
+#ifdef DISPLAY_FRAME_BENCHMARK
+    case SCREEN_BENCHMARK:
+#endif
+      strlcpy(command.payload, lightningConfig.lightning, sizeof(command.payload));
+      break;
+    default:
+      break;
+  }
+  displayPost(command);
+}
+
+void startupScreen() { postScreen(SCREEN_STARTUP); }
+void btctickerScreen() { postScreen(SCREEN_BTCTICKER); }
+void updateBtctickerValues() { postScreen(SCREEN_BTCTICKER_VALUES); }
+void initializationScreen() { postScreen(SCREEN_INITIALIZATION); }
+void bootUpScreen() { postScreen(SCREEN_BOOT_UP); }
+void configModeScreen() { postScreen(SCREEN_CONFIG_MODE); }
+void wifiReconnectScreen() { postScreen(SCREEN_WIFI_RECONNECT); }
+void internetReconnectScreen() { postScreen(SCREEN_INTERNET_RECONNECT); }
+void serverReconnectScreen() { postScreen(SCREEN_SERVER_RECONNECT); }
+void websocketReconnectScreen() { postScreen(SCREEN_WEBSOCKET_RECONNECT); }
+void stepOneScreen() { postScreen(SCREEN_STEP_ONE); }
+void stepTwoScreen() { postScreen(SCREEN_STEP_TWO); }
+void stepThreeScreen() { postScreen(SCREEN_STEP_THREE); }
+void actionTimeScreen() { postScreen(SCREEN_ACTION_TIME); }
+void thankYouScreen() { postScreen(SCREEN_THANK_YOU); }
+void paymentErrorScreen() { postScreen(SCREEN_PAYMENT_ERROR); }
+void showThresholdQRScreen() { postScreen(SCREEN_THRESHOLD_QR); }
+void productSelectionScreen() { postScreen(SCREEN_PRODUCT_SELECTION); }
+
+void errorReportScreen(uint8_t wifiCount, uint8_t internetCount, uint8_t serverCount, uint8_t websocketCount)
+{
+  postScreen(SCREEN_ERROR_REPORT, wifiCount, internetCount, serverCount, websocketCount);
 }
 
+void reconnectReportScreen(uint32_t attempts, uint32_t failures, uint32_t reconnects, unsigned long backoffMs)
+{
+  postScreen(SCREEN_RECONNECT_REPORT, attempts, failures, reconnects, backoffMs);
+}
+
+void showProductQRScreen(String label, int pin)
+{
+  postScreen(SCREEN_PRODUCT_QR, pin, 0, 0, 0, label.c_str());
+}
+
+#ifdef DISPLAY_FRAME_BENCHMARK
+void displayFrameBenchmark()
+{
+  postScreen(SCREEN_BENCHMARK);
+  displaySync();
+}
+#endif
+
 // Screensaver management
 static bool screensaverIsActive = false;
-static String screensaverMode = "off";
+static ScreensaverMode screensaverMode = ScreensaverMode::OFF;
 
-void activateScreensaver(String mode)
+void activateScreensaver(ScreensaverMode mode)
 {
-  Serial.println("[SCREENSAVER] Activating powerConfig.screensaver mode: " + mode);
+  LOG_INFO("SCREENSAVER", String("Activating powerConfig.screensaver mode: ") + screensaverValues[(uint8_t)mode]);
   screensaverIsActive = true;
   screensaverMode = mode;
 
-  if (mode == "black") {
-    // Black screen - display stays on but shows black
-    tft.fillScreen(TFT_BLACK);
-    Serial.println("[SCREENSAVER] Black screen activated");
-  } else if (mode == "backlight") {
+  if (mode == ScreensaverMode::BACKLIGHT) {
     // Turn off backlight (most efficient while keeping display controller running)
     pinMode(PIN_LCD_BL, OUTPUT);
     digitalWrite(PIN_LCD_BL, LOW);
-    Serial.println("[SCREENSAVER] Backlight turned off");
+    LOG_INFO("SCREENSAVER", "Backlight turned off");
   }
 }
 
@@ -1239,17 +1481,17 @@ void deactivateScreensaver()
     return;
   }
 
-  Serial.println("[SCREENSAVER] Deactivating powerConfig.screensaver mode: " + screensaverMode);
+  LOG_INFO("SCREENSAVER", String("Deactivating powerConfig.screensaver mode: ") + screensaverValues[(uint8_t)screensaverMode]);
   
-  if (screensaverMode == "backlight") {
+  if (screensaverMode == ScreensaverMode::BACKLIGHT) {
     // Turn backlight back on
     pinMode(PIN_LCD_BL, OUTPUT);
     digitalWrite(PIN_LCD_BL, HIGH);
-    Serial.println("[SCREENSAVER] Backlight turned on");
+    LOG_INFO("SCREENSAVER", "Backlight turned on");
   }
   
   screensaverIsActive = false;
-  screensaverMode = "off";
+  screensaverMode = ScreensaverMode::OFF;
   
   // Screen will be redrawn by main loop
 }
@@ -1261,40 +1503,41 @@ bool isScreensaverActive()
 
 // Deep Sleep management
 static bool deepSleepIsActive = false;
-static String deepSleepMode = "off";
+static DeepSleepMode deepSleepMode = DeepSleepMode::OFF;
 
 void prepareDeepSleep()
 {
-  Serial.println("[DEEP_SLEEP] Preparing for deep sleep...");
+  LOG_INFO("DEEP_SLEEP", "Preparing for deep sleep...");
   
   // Disable watchdog timers to prevent reset during sleep preparation
   esp_task_wdt_delete(NULL);
-  Serial.println("[DEEP_SLEEP] Watchdog disabled");
+  LOG_INFO("DEEP_SLEEP", "Watchdog disabled");
   
-  // Fill screen with black before sleep
-  tft.fillScreen(TFT_BLACK);
-  Serial.println("[DEEP_SLEEP] Screen cleared");
+  // Fill screen with black before sleep, wait until the render task is done
+  postScreen(SCREEN_BLANK);
+  displaySync();
+  LOG_INFO("DEEP_SLEEP", "Screen cleared");
   
   // Turn off backlight to save power during sleep
   pinMode(PIN_LCD_BL, OUTPUT);
   digitalWrite(PIN_LCD_BL, LOW);
-  Serial.println("[DEEP_SLEEP] Backlight turned OFF");
+  LOG_INFO("DEEP_SLEEP", "Backlight turned OFF");
   
   // Longer delay to ensure all operations complete
   delay(500);
   
-  Serial.println("[DEEP_SLEEP] Display prepared, ready for sleep");
+  LOG_INFO("DEEP_SLEEP", "Display prepared, ready for sleep");
 }
 
-void setupDeepSleepWakeup(String mode)
+void setupDeepSleepWakeup(DeepSleepMode mode)
 {
-  Serial.println("[DEEP_SLEEP] Setting up wake-up sources, mode: " + mode);
+  LOG_INFO("DEEP_SLEEP", String("Setting up wake-up sources, mode: ") + deepSleepValues[(uint8_t)mode]);
   
   deepSleepIsActive = true;
   deepSleepMode = mode;
   
   // Configure power domain settings based on mode
-  if (mode == "light") {
+  if (mode == DeepSleepMode::LIGHT) {
     // Light sleep: CPU pauses, RAM active, faster wake-up than freeze
     // WiFi disconnects but reconnects faster than full reboot
     // NO payment processing possible during sleep (CPU is paused)
@@ -1308,26 +1551,28 @@ void setupDeepSleepWakeup(String mode)
     // Enable GPIO wake-up
     esp_sleep_enable_gpio_wakeup();
     
-    Serial.println("[DEEP_SLEEP] Light Sleep mode configured");
-    Serial.println("[DEEP_SLEEP] Wake-up sources: BOOT (GPIO 0) and IO14 (GPIO 14)");
-    Serial.println("[DEEP_SLEEP] Display OFF, WiFi reconnects after wake");
-    Serial.println("[DEEP_SLEEP] Power consumption: ~0.8-3mA");
-    Serial.println("[DEEP_SLEEP] Wake-up time: ~1-2 seconds");
-    Serial.println("[DEEP_SLEEP] NO payment processing during sleep");
-    Serial.println("[DEEP_SLEEP] Press BOOT or IO14 button to wake up");
-    Serial.println("[DEEP_SLEEP] Entering Light Sleep now...");
+    LOG_INFO("DEEP_SLEEP", "Light Sleep mode configured");
+    LOG_INFO("DEEP_SLEEP", "Wake-up sources: BOOT (GPIO 0) and IO14 (GPIO 14)");
+    LOG_INFO("DEEP_SLEEP", "Display OFF, WiFi reconnects after wake");
+    LOG_INFO("DEEP_SLEEP", "Power consumption: ~0.8-3mA");
+    LOG_INFO("DEEP_SLEEP", "Wake-up time: ~1-2 seconds");
+    LOG_INFO("DEEP_SLEEP", "NO payment processing during sleep");
+    LOG_INFO("DEEP_SLEEP", "Press BOOT or IO14 button to wake up");
+    LOG_INFO("DEEP_SLEEP", "Entering Light Sleep now...");
+    Log::drainRecords();
+    Serial.flush();
     
     esp_light_sleep_start();
     
     // Execution continues here after wake-up
-    Serial.println("[WAKE_UP] Device woke from light sleep");
+    LOG_INFO("WAKE_UP", "Device woke from light sleep");
     
   } 
-  else if (mode == "freeze") {
+  else if (mode == DeepSleepMode::FREEZE) {
     // Deep sleep/Freeze: CPU off, only RTC active
     // WiFi/Bluetooth will be disconnected
     
-    Serial.println("[DEEP_SLEEP] Configuring RTC GPIOs for wake-up...");
+    LOG_INFO("DEEP_SLEEP", "Configuring RTC GPIOs for wake-up...");
     
     // Initialize GPIO 0 (BOOT button) as RTC GPIO
     rtc_gpio_init(GPIO_NUM_0);
@@ -1347,28 +1592,28 @@ void setupDeepSleepWakeup(String mode)
     // Check current GPIO states
     int gpio0_state = rtc_gpio_get_level(GPIO_NUM_0);
     int gpio14_state = rtc_gpio_get_level(GPIO_NUM_14);
-    Serial.printf("[DEEP_SLEEP] GPIO 0 (BOOT) level: %s\n", gpio0_state ? "HIGH" : "LOW");
-    Serial.printf("[DEEP_SLEEP] GPIO 14 (HELP) level: %s\n", gpio14_state ? "HIGH" : "LOW");
+    LOG_INFOF("DEEP_SLEEP", "GPIO 0 (BOOT) level: %s", gpio0_state ? "HIGH" : "LOW");
+    LOG_INFOF("DEEP_SLEEP", "GPIO 14 (HELP) level: %s", gpio14_state ? "HIGH" : "LOW");
     
     if (gpio0_state == 0) {
-      Serial.println("[DEEP_SLEEP] ERROR: BOOT button is pressed! Aborting.");
+      LOG_ERROR("DEEP_SLEEP", "BOOT button is pressed! Aborting.");
       rtc_gpio_deinit(GPIO_NUM_0);
       rtc_gpio_deinit(GPIO_NUM_14);
       return;
     }
     if (gpio14_state == 0) {
-      Serial.println("[DEEP_SLEEP] ERROR: HELP button is pressed! Aborting.");
+      LOG_ERROR("DEEP_SLEEP", "HELP button is pressed! Aborting.");
       rtc_gpio_deinit(GPIO_NUM_0);
       rtc_gpio_deinit(GPIO_NUM_14);
       return;
     }
     
     // Configure EXT0 wake-up for GPIO 0 (BOOT button) - wake on LOW
-    Serial.println("[DEEP_SLEEP] Setting EXT0 wake-up: GPIO 0 (BOOT), trigger on LOW");
+    LOG_INFO("DEEP_SLEEP", "Setting EXT0 wake-up: GPIO 0 (BOOT), trigger on LOW");
     esp_sleep_enable_ext0_wakeup(GPIO_NUM_0, 0);
     
     // Configure EXT1 wake-up for GPIO 14 (HELP button) - wake on LOW
-    Serial.println("[DEEP_SLEEP] Setting EXT1 wake-up: GPIO 14 (HELP), trigger on LOW");
+    LOG_INFO("DEEP_SLEEP", "Setting EXT1 wake-up: GPIO 14 (HELP), trigger on LOW");
     esp_sleep_enable_ext1_wakeup(BIT64(GPIO_NUM_14), ESP_EXT1_WAKEUP_ANY_LOW);
     
     // Disable most power domains for maximum savings
@@ -1376,12 +1621,13 @@ void setupDeepSleepWakeup(String mode)
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
     
-    Serial.println("[DEEP_SLEEP] Wake-up sources: BOOT button (GPIO 0) OR HELP button (GPIO 14)");
-    Serial.println("[DEEP_SLEEP] WiFi will be disconnected");
-    Serial.println("[DEEP_SLEEP] Entering Deep Sleep/Freeze (~0.01-0.15mA)");
-    Serial.println("[DEEP_SLEEP] Press BOOT or HELP button to wake up (device will restart)");
+    LOG_INFO("DEEP_SLEEP", "Wake-up sources: BOOT button (GPIO 0) OR HELP button (GPIO 14)");
+    LOG_INFO("DEEP_SLEEP", "WiFi will be disconnected");
+    LOG_INFO("DEEP_SLEEP", "Entering Deep Sleep/Freeze (~0.01-0.15mA)");
+    LOG_INFO("DEEP_SLEEP", "Press BOOT or HELP button to wake up (device will restart)");
     
     // Add delay and flush serial before deep sleep
+    Log::drainRecords();
     Serial.flush();
     delay(200);
     
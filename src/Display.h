@@ -1,5 +1,7 @@
 #pragma once
 
+#include "GlobalState.h"
+
 void initDisplay();
 void startupScreen();
 void btctickerScreen();
@@ -8,6 +10,7 @@ void initializationScreen();
 void bootUpScreen();
 void configModeScreen();
 void errorReportScreen(uint8_t wifiCount, uint8_t internetCount, uint8_t serverCount, uint8_t websocketCount);
+void reconnectReportScreen(uint32_t attempts, uint32_t failures, uint32_t reconnects, unsigned long backoffMs);
 void wifiReconnectScreen();
 void internetReconnectScreen();
 void serverReconnectScreen();
@@ -17,15 +20,21 @@ void stepTwoScreen();
 void stepThreeScreen();
 void actionTimeScreen();
 void thankYouScreen();
-void drawQRCode();
+void paymentErrorScreen();
+void precacheQRCode(const char *payload); // Encode QR matrix ahead of first draw
+void clearQRCodeCache();
 void showQRScreen();
 void showThresholdQRScreen();
 void showSpecialModeQRScreen();
 void showProductQRScreen(String label, int pin);
 void productSelectionScreen();
-void activateScreensaver(String mode);
+void activateScreensaver(ScreensaverMode mode);
 void deactivateScreensaver();
 bool isScreensaverActive();
 void prepareDeepSleep();
-void setupDeepSleepWakeup(String mode);
-bool isDeepSleepActive();
\ No newline at end of file
+void setupDeepSleepWakeup(DeepSleepMode mode);
+bool isDeepSleepActive();
+
+#ifdef DISPLAY_FRAME_BENCHMARK
+void displayFrameBenchmark(); // Draw every screen and log its frame time
+#endif
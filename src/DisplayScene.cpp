@@ -0,0 +1,362 @@
+#include "DisplayScene.h"
+#include "FrameBuffer.h"
+#include "GlyphCache.h"
+#include "Log.h"
+#include "SpanBitmap.h"
+
+// GLCD font, scaled by the text size (same as GFXFF in Display.cpp)
+#define SCENE_FONT 1
+
+// Widgets per frame and dirty rectangles per update; more than that is drawn in full
+static const uint8_t SCENE_MAX_WIDGETS = 24;
+static const uint8_t SCENE_MAX_DIRTY = 8;
+static const uint8_t SCENE_TEXT_SIZE = 40;
+// Changed characters redrawn as single cells per update
+static const uint8_t SCENE_MAX_CELLS = 16;
+
+enum WidgetKind : uint8_t {
+  WIDGET_TEXT,
+  WIDGET_BOX,
+  WIDGET_BITMAP,
+  WIDGET_IMAGE
+};
+
+struct Rect {
+  int16_t x, y, w, h;
+};
+
+// One changed character of a text widget
+struct Cell {
+  uint8_t widget;
+  uint8_t index;
+};
+
+struct Widget {
+  WidgetKind kind;
+  Rect bounds;                // Pixels the widget may touch
+  uint16_t fg, bg;
+  uint32_t key;               // Content hash; with kind, bounds and colors decides "changed"
+  int16_t drawX, drawY;
+  uint8_t datum, size;
+  char text[SCENE_TEXT_SIZE];
+  const uint8_t* bitmap;
+  SceneDrawFn draw;
+  const void* data;
+};
+
+// Previous and current frame, swapped by sceneEnd()
+static Widget frames[2][SCENE_MAX_WIDGETS];
+static uint8_t frameCount[2] = {0, 0};
+static uint8_t current = 0;
+static bool building = false;
+static bool overflow = false;
+static bool valid = false;
+static uint16_t background = 0;
+static uint16_t previousBackground = 0;
+static SceneStats stats = {};
+
+uint32_t sceneHash(const void* data, size_t length, uint32_t seed) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint32_t hash = seed;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static bool intersects(const Rect& a, const Rect& b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static bool contains(const Rect& outer, const Rect& inner) {
+  return inner.x >= outer.x && inner.y >= outer.y &&
+         inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+static Rect unite(const Rect& a, const Rect& b) {
+  int16_t x0 = min(a.x, b.x);
+  int16_t y0 = min(a.y, b.y);
+  int16_t x1 = max(a.x + a.w, b.x + b.w);
+  int16_t y1 = max(a.y + a.h, b.y + b.h);
+  return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+static bool sameWidget(const Widget& a, const Widget& b) {
+  return a.kind == b.kind && a.key == b.key && a.fg == b.fg && a.bg == b.bg &&
+         a.bounds.x == b.bounds.x && a.bounds.y == b.bounds.y &&
+         a.bounds.w == b.bounds.w && a.bounds.h == b.bounds.h;
+}
+
+static void drawWidget(const Widget& w) {
+  switch (w.kind) {
+  case WIDGET_TEXT:
+    canvas->setTextDatum(w.datum);
+    canvas->setTextSize(w.size);
+    canvas->setTextColor(w.fg);
+    canvas->drawString(w.text, w.drawX, w.drawY, SCENE_FONT);
+    break;
+  case WIDGET_BOX:
+    canvas->fillRect(w.bounds.x, w.bounds.y, w.bounds.w, w.bounds.h, w.fg);
+    break;
+  case WIDGET_BITMAP:
+    spanBitmapDraw(*canvas, w.bitmap, w.bounds.x, w.bounds.y, w.bounds.w, w.bounds.h, w.fg);
+    break;
+  case WIDGET_IMAGE:
+    w.draw(w.data, w.bounds.x, w.bounds.y, w.fg, w.bg);
+    break;
+  }
+}
+
+// Next slot of the frame being built, or a scratch widget (drawn right away
+// outside a frame, dropped if the frame is full)
+static Widget* nextWidget() {
+  static Widget immediate;
+  if (!building) return &immediate;
+  if (frameCount[current] >= SCENE_MAX_WIDGETS) {
+    overflow = true;
+    return &immediate;
+  }
+  return &frames[current][frameCount[current]++];
+}
+
+static void commit(Widget* w) {
+  if (!building) {
+    drawWidget(*w);
+  }
+}
+
+void sceneBegin(uint16_t bg) {
+  frameAcquire();
+  building = true;
+  overflow = false;
+  background = bg;
+  frameCount[current] = 0;
+}
+
+void sceneText(const String& text, int16_t x, int16_t y, uint8_t datum, uint8_t size, uint16_t color) {
+  if (text.length() == 0) return;
+  Widget* w = nextWidget();
+  w->kind = WIDGET_TEXT;
+  strncpy(w->text, text.c_str(), sizeof(w->text) - 1);
+  w->text[sizeof(w->text) - 1] = '\0';
+  w->drawX = x;
+  w->drawY = y;
+  w->datum = datum;
+  w->size = size;
+  w->fg = color;
+  w->bg = color;
+
+  canvas->setTextSize(size);
+  int16_t width = canvas->textWidth(w->text, SCENE_FONT);
+  int16_t height = canvas->fontHeight(SCENE_FONT);
+  // Datums 0-8: column = datum % 3 (left, centre, right), row = datum / 3 (top, middle, bottom)
+  uint8_t column = datum <= BR_DATUM ? datum % 3 : 0;
+  uint8_t row = datum <= BR_DATUM ? datum / 3 : 2;
+  int16_t left = x - (column == 1 ? width / 2 : column == 2 ? width : 0);
+  int16_t top = y - (row == 1 ? height / 2 : row == 2 ? height : 0);
+  // One pixel margin for rounding in the datum arithmetic of drawString()
+  w->bounds = {(int16_t)(left - 1), (int16_t)(top - 1), (int16_t)(width + 2), (int16_t)(height + 2)};
+
+  uint8_t params[2] = {datum, size};
+  w->key = sceneHash(w->text, strlen(w->text), sceneHash(params, sizeof(params)));
+  commit(w);
+}
+
+void sceneBox(int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color) {
+  Widget* w = nextWidget();
+  w->kind = WIDGET_BOX;
+  w->bounds = {x, y, width, height};
+  w->fg = color;
+  w->bg = color;
+  w->key = 0;
+  commit(w);
+}
+
+void sceneBitmap(const uint8_t* bitmap, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color) {
+  Widget* w = nextWidget();
+  w->kind = WIDGET_BITMAP;
+  w->bounds = {x, y, width, height};
+  w->bitmap = bitmap;
+  w->fg = color;
+  w->bg = color;
+  w->key = (uint32_t)(uintptr_t)bitmap;
+  commit(w);
+}
+
+void sceneImage(int16_t x, int16_t y, int16_t width, int16_t height, uint32_t contentKey,
+                SceneDrawFn draw, const void* data, uint16_t fg, uint16_t bg) {
+  Widget* w = nextWidget();
+  w->kind = WIDGET_IMAGE;
+  w->bounds = {x, y, width, height};
+  w->draw = draw;
+  w->data = data;
+  w->fg = fg;
+  w->bg = bg;
+  w->key = contentKey;
+  commit(w);
+}
+
+// Same text layout, only characters differ: the GLCD font is fixed width,
+// so the unchanged characters stay in place
+static bool sameTextLayout(const Widget& a, const Widget& b) {
+  return a.kind == WIDGET_TEXT && b.kind == WIDGET_TEXT && a.fg == b.fg && a.datum == b.datum &&
+         a.size == b.size && a.bounds.x == b.bounds.x && a.bounds.y == b.bounds.y &&
+         a.bounds.w == b.bounds.w && a.bounds.h == b.bounds.h && strlen(a.text) == strlen(b.text);
+}
+
+// Changed characters of widget i as cells; false if the widget needs a
+// dirty rectangle instead (overlaps another widget, too many cells)
+static bool addCells(const Widget* next, uint8_t nextCount, const Widget& prev, uint8_t i,
+                     Cell* cells, uint8_t& cellCount) {
+  for (uint8_t j = 0; j < nextCount; j++) {
+    if (j != i && intersects(next[j].bounds, next[i].bounds)) return false;
+  }
+  uint8_t count = cellCount;
+  for (uint8_t c = 0; next[i].text[c]; c++) {
+    if (next[i].text[c] == prev.text[c]) continue;
+    if (count >= SCENE_MAX_CELLS) return false;
+    cells[count++] = {i, c};
+  }
+  cellCount = count;
+  return true;
+}
+
+// Add a rectangle, merging it with every dirty rectangle it overlaps
+static bool addDirty(Rect* dirty, uint8_t& count, Rect r) {
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (uint8_t i = 0; i < count; i++) {
+      if (intersects(dirty[i], r)) {
+        r = unite(dirty[i], r);
+        dirty[i] = dirty[--count];
+        merged = true;
+        break;
+      }
+    }
+  }
+  if (count >= SCENE_MAX_DIRTY) return false;
+  dirty[count++] = r;
+  return true;
+}
+
+// Clip to the panel; false if nothing is left
+static bool clipToScreen(Rect& r) {
+  int16_t x1 = min<int16_t>(r.x + r.w, canvas->width());
+  int16_t y1 = min<int16_t>(r.y + r.h, canvas->height());
+  r.x = max<int16_t>(r.x, 0);
+  r.y = max<int16_t>(r.y, 0);
+  r.w = x1 - r.x;
+  r.h = y1 - r.y;
+  return r.w > 0 && r.h > 0;
+}
+
+uint32_t sceneEnd() {
+  const Widget* next = frames[current];
+  const Widget* prev = frames[current ^ 1];
+  uint8_t nextCount = frameCount[current];
+  uint8_t prevCount = frameCount[current ^ 1];
+  building = false;
+
+  Rect dirty[SCENE_MAX_DIRTY];
+  uint8_t dirtyCount = 0;
+  Cell cells[SCENE_MAX_CELLS];
+  uint8_t cellCount = 0;
+  uint8_t changed = 0;
+  bool full = overflow || !valid || background != previousBackground;
+
+  for (uint8_t i = 0; !full && i < max(prevCount, nextCount); i++) {
+    if (i < prevCount && i < nextCount && sameWidget(prev[i], next[i])) continue;
+    changed++;
+    if (i < prevCount && i < nextCount && sameTextLayout(prev[i], next[i]) &&
+        addCells(next, nextCount, prev[i], i, cells, cellCount)) {
+      continue;
+    }
+    if (i < prevCount) full |= !addDirty(dirty, dirtyCount, prev[i].bounds);
+    if (i < nextCount) full |= !addDirty(dirty, dirtyCount, next[i].bounds);
+  }
+
+  // An opaque image is drawn whole: grow the dirty area over every image it touches
+  bool grown = true;
+  while (!full && grown) {
+    grown = false;
+    for (uint8_t i = 0; i < nextCount && !full; i++) {
+      if (next[i].kind != WIDGET_IMAGE) continue;
+      for (uint8_t d = 0; d < dirtyCount; d++) {
+        if (intersects(dirty[d], next[i].bounds) && !contains(dirty[d], next[i].bounds)) {
+          full |= !addDirty(dirty, dirtyCount, next[i].bounds);
+          grown = true;
+          break;
+        }
+      }
+    }
+  }
+
+  uint32_t pixels = 0;
+  uint32_t screenPixels = (uint32_t)canvas->width() * canvas->height();
+  if (full) {
+    if (overflow) {
+      LOG_WARN("DISPLAY", "Scene has more than " + String(SCENE_MAX_WIDGETS) + " widgets - rest dropped");
+    }
+    canvas->fillScreen(background);
+    for (uint8_t i = 0; i < nextCount; i++) drawWidget(next[i]);
+    frameDamageAll();
+    pixels = screenPixels;
+    changed = nextCount;
+    dirtyCount = 1;
+    stats.fullRedraws++;
+  } else {
+    for (uint8_t d = 0; d < dirtyCount; d++) {
+      Rect r = dirty[d];
+      if (!clipToScreen(r)) continue;
+      // Clip everything drawn below to this rectangle (absolute coordinates)
+      canvas->setViewport(r.x, r.y, r.w, r.h, false);
+      canvas->fillRect(r.x, r.y, r.w, r.h, background);
+      for (uint8_t i = 0; i < nextCount; i++) {
+        if (intersects(r, next[i].bounds)) drawWidget(next[i]);
+      }
+      canvas->resetViewport();
+      frameDamage(r.x, r.y, r.w, r.h);
+      pixels += (uint32_t)r.w * r.h;
+    }
+    // Changed characters: one cached cell each. Text bounds have a 1 px margin
+    for (uint8_t c = 0; c < cellCount; c++) {
+      const Widget& w = next[cells[c].widget];
+      Rect r = {(int16_t)(w.bounds.x + 1 + cells[c].index * glyphWidth(w.size)), (int16_t)(w.bounds.y + 1),
+                glyphWidth(w.size), glyphHeight(w.size)};
+      glyphDraw(*canvas, w.text[cells[c].index], r.x, r.y, w.size, w.fg, background);
+      if (!clipToScreen(r)) continue;
+      frameDamage(r.x, r.y, r.w, r.h);
+      pixels += (uint32_t)r.w * r.h;
+    }
+    dirtyCount += cellCount;
+  }
+
+  valid = true;
+  previousBackground = background;
+  current ^= 1;
+
+  stats.frames++;
+  stats.lastPixels = pixels;
+  stats.lastChanged = changed;
+  stats.totalPixels += pixels;
+  LOG_REC_INFO(Display, SCENE_FRAME, changed, dirtyCount, pixels, screenPixels ? pixels * 100 / screenPixels : 0);
+  return pixels;
+}
+
+void sceneInvalidate() {
+  valid = false;
+}
+
+bool sceneValid() {
+  return valid;
+}
+
+uint16_t sceneBackground() {
+  return previousBackground;
+}
+
+SceneStats sceneStats() {
+  return stats;
+}
@@ -0,0 +1,95 @@
+#ifndef DISPLAY_SCENE_H
+#define DISPLAY_SCENE_H
+
+#include <Arduino.h>
+
+/**
+ * DisplayScene.h - Retained-mode widget layer with dirty rectangles
+ *
+ * A screen declares its widgets (text, box, bitmap, opaque image such as
+ * a QR code) between sceneBegin() and sceneEnd() instead of drawing them.
+ * sceneEnd() compares the frame with the previous one - widget by widget,
+ * in declaration order - and only clears and redraws the rectangles whose
+ * widgets changed, appeared or disappeared. Screens that share a layout
+ * (product 1 -> product 2, ticker refresh) therefore push only the label
+ * and QR code instead of the whole 170x320 panel. A text that keeps its
+ * length, size and position (ticker price, block height) is updated per
+ * character: only the changed cells are drawn, from GlyphCache.
+ *
+ * The first frame, a new background color or a frame after
+ * sceneInvalidate() (any screen drawn directly with tft) is drawn in full.
+ * The pixels pushed per frame are logged (LOG_REC Display SCENE_FRAME)
+ * and kept in sceneStats().
+ *
+ * Outside sceneBegin()/sceneEnd() the scene* calls draw immediately, so
+ * shared helpers (button labels) work for both kinds of screens.
+ */
+
+/**
+ * Draws an opaque image into its full rectangle (x, y, w, h).
+ * @param data Pointer passed to sceneImage(), must stay valid until the next frame
+ */
+typedef void (*SceneDrawFn)(const void* data, int16_t x, int16_t y, uint16_t fg, uint16_t bg);
+
+struct SceneStats {
+  uint32_t frames;            // sceneEnd() calls
+  uint32_t fullRedraws;       // Frames drawn in full
+  uint32_t lastPixels;        // Pixels pushed by the last frame
+  uint32_t lastChanged;       // Widgets changed in the last frame
+  uint64_t totalPixels;       // Pixels pushed by all frames
+};
+
+/**
+ * Start a frame on the given background color.
+ */
+void sceneBegin(uint16_t background);
+
+/**
+ * Text with tft datum and GLCD text size (font 1).
+ */
+void sceneText(const String& text, int16_t x, int16_t y, uint8_t datum, uint8_t size, uint16_t color);
+
+/**
+ * Filled rectangle.
+ */
+void sceneBox(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+/**
+ * 1 bit bitmap (set bits in color, others transparent).
+ * @param bitmap Must stay valid (PROGMEM constant)
+ */
+void sceneBitmap(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+/**
+ * Opaque image covering (x, y, w, h); redrawn in full whenever any part of
+ * it is dirty. contentKey identifies what draw() renders (e.g. a payload
+ * hash): the image is only redrawn if the key, colors or rectangle change.
+ */
+void sceneImage(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t contentKey,
+                SceneDrawFn draw, const void* data, uint16_t fg, uint16_t bg);
+
+/**
+ * Push the changes since the previous frame to the panel.
+ * @return Pixels pushed
+ */
+uint32_t sceneEnd();
+
+/**
+ * The panel was drawn outside the scene: the next frame is drawn in full.
+ */
+void sceneInvalidate();
+
+/**
+ * Background of the last frame; only meaningful while the scene is valid.
+ */
+bool sceneValid();
+uint16_t sceneBackground();
+
+/**
+ * FNV-1a hash for sceneImage() content keys.
+ */
+uint32_t sceneHash(const void* data, size_t length, uint32_t seed = 2166136261u);
+
+SceneStats sceneStats();
+
+#endif // DISPLAY_SCENE_H
@@ -0,0 +1,110 @@
+#include "DisplayTask.h"
+#include <atomic>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "Log.h"
+
+static const UBaseType_t QUEUE_LENGTH = 8;
+// Sync markers handled per frame
+static const uint8_t MAX_SYNCS = 4;
+
+static QueueHandle_t commandQueue = nullptr;
+static TaskHandle_t renderTask = nullptr;
+static DisplayRenderFn renderFn = nullptr;
+// Producers take it for the send / drop-oldest / send sequence, so two
+// posters on a full queue cannot drop each other's command
+static SemaphoreHandle_t postMutex = nullptr;
+
+static std::atomic<uint32_t> postedCount(0);
+static std::atomic<uint32_t> frameCount(0);
+static std::atomic<uint32_t> mergedCount(0);
+static std::atomic<uint32_t> overflowCount(0);
+
+static void renderTaskCode(void *parameter) {
+  TickType_t lastFrame = xTaskGetTickCount();
+  DisplayCommand command;
+
+  for (;;) {
+    xQueueReceive(commandQueue, &command, portMAX_DELAY);
+
+    // Let the rest of the frame's requests arrive
+    TickType_t frameTicks = pdMS_TO_TICKS(DISPLAY_FRAME_MS);
+    TickType_t elapsed = xTaskGetTickCount() - lastFrame;
+    if (elapsed < frameTicks) vTaskDelay(frameTicks - elapsed);
+
+    // Merge: the last screen wins, sync markers are answered after drawing
+    DisplayCommand screen;
+    bool haveScreen = false;
+    SemaphoreHandle_t syncs[MAX_SYNCS];
+    uint8_t syncCount = 0;
+    do {
+      if (command.done) {
+        if (syncCount < MAX_SYNCS) {
+          syncs[syncCount++] = command.done;
+        } else {
+          xSemaphoreGive(command.done);  // Too many waiters this frame - release early
+        }
+        continue;
+      }
+      if (haveScreen) mergedCount.fetch_add(1, std::memory_order_relaxed);
+      screen = command;
+      haveScreen = true;
+    } while (xQueueReceive(commandQueue, &command, 0) == pdTRUE);
+
+    if (haveScreen) {
+      renderFn(screen);
+      frameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    lastFrame = xTaskGetTickCount();
+    for (uint8_t i = 0; i < syncCount; i++) xSemaphoreGive(syncs[i]);
+  }
+}
+
+void displayTaskBegin(DisplayRenderFn render) {
+  renderFn = render;
+  if (renderTask) return;
+  commandQueue = xQueueCreate(QUEUE_LENGTH, sizeof(DisplayCommand));
+  postMutex = xSemaphoreCreateMutex();
+  // Core 1 next to loop(), same priority: drawing never stalls WiFi on core 0
+  xTaskCreatePinnedToCore(renderTaskCode, "Render", 8192, nullptr, 1, &renderTask, 1);
+  LOG_INFO("DISPLAY", "Render task started");
+}
+
+void displayPost(const DisplayCommand &command) {
+  if (!renderTask) {
+    if (!command.done) renderFn(command);
+    return;
+  }
+  postedCount.fetch_add(1, std::memory_order_relaxed);
+  // Held only for a few queue copies; the render task never takes it
+  xSemaphoreTake(postMutex, portMAX_DELAY);
+  if (xQueueSend(commandQueue, &command, 0) != pdTRUE) {
+    // Full: the oldest request would be merged away anyway
+    DisplayCommand dropped;
+    if (xQueueReceive(commandQueue, &dropped, 0) == pdTRUE) {
+      overflowCount.fetch_add(1, std::memory_order_relaxed);
+      if (dropped.done) xSemaphoreGive(dropped.done);
+    }
+    xQueueSend(commandQueue, &command, 0);
+  }
+  xSemaphoreGive(postMutex);
+}
+
+void displaySync() {
+  if (!renderTask || xTaskGetCurrentTaskHandle() == renderTask) return;
+  StaticSemaphore_t buffer;
+  DisplayCommand marker = {};
+  marker.done = xSemaphoreCreateBinaryStatic(&buffer);
+  displayPost(marker);
+  xSemaphoreTake(marker.done, portMAX_DELAY);
+  vSemaphoreDelete(marker.done);
+}
+
+DisplayTaskStats displayTaskStats() {
+  DisplayTaskStats stats;
+  stats.posted = postedCount.load(std::memory_order_relaxed);
+  stats.frames = frameCount.load(std::memory_order_relaxed);
+  stats.merged = mergedCount.load(std::memory_order_relaxed);
+  stats.overflows = overflowCount.load(std::memory_order_relaxed);
+  return stats;
+}
@@ -0,0 +1,79 @@
+#ifndef DISPLAY_TASK_H
+#define DISPLAY_TASK_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * DisplayTask.h - Render task with a display command queue
+ *
+ * loop(), the button task and the WebSocket callback all request screens.
+ * Instead of drawing on the shared tft from whichever core they run on,
+ * they post a command here and return at once; one render task (core 1)
+ * is the only code that touches the display.
+ *
+ * The task renders at most one frame per DISPLAY_FRAME_MS: all commands
+ * that arrive within a frame are merged, only the last screen requested is
+ * drawn (a screen replaces everything before it).
+ */
+
+// Minimum time between two rendered frames; requests within it are merged
+#ifndef DISPLAY_FRAME_MS
+#define DISPLAY_FRAME_MS 20
+#endif
+
+static constexpr uint8_t DISPLAY_LABEL_SIZE = 48;
+static constexpr size_t DISPLAY_PAYLOAD_SIZE = 300;
+
+// Ticker values as they were when the screen was requested
+struct DisplayTickerValues {
+  char price[24];
+  char blockHeight[16];
+  char currency[8];
+};
+
+/**
+ * Everything a screen shows is copied into the command by the task that
+ * posts it: the render task never reads state that other tasks update.
+ */
+struct DisplayCommand {
+  uint8_t screen;                   // Screen id, interpreted by the render function
+  uint32_t args[4];                 // Screen arguments (counts, pin, ...)
+  char label[DISPLAY_LABEL_SIZE];   // Text argument (product label)
+  union {
+    DisplayTickerValues ticker;             // Ticker screens
+    char payload[DISPLAY_PAYLOAD_SIZE];     // QR screens: the encoded text
+  };
+  SemaphoreHandle_t done;           // Set: sync marker, given once everything before it is drawn
+};
+
+struct DisplayTaskStats {
+  uint32_t posted;            // Commands posted
+  uint32_t frames;            // Frames rendered
+  uint32_t merged;            // Screen commands replaced by a later one in the same frame
+  uint32_t overflows;         // Oldest command dropped because the queue was full
+};
+
+typedef void (*DisplayRenderFn)(const DisplayCommand &command);
+
+/**
+ * Start the render task; render() draws one screen command.
+ */
+void displayTaskBegin(DisplayRenderFn render);
+
+/**
+ * Queue a screen command (any task, never blocks on the render task).
+ * Before the task is started the command is drawn right away.
+ */
+void displayPost(const DisplayCommand &command);
+
+/**
+ * Wait until every command posted so far has been drawn (deep sleep,
+ * restart). Returns at once when called from the render task.
+ */
+void displaySync();
+
+DisplayTaskStats displayTaskStats();
+
+#endif // DISPLAY_TASK_H
@@ -0,0 +1,217 @@
+#include "FrameBuffer.h"
+#include "LcdI80.h"
+#include "Log.h"
+
+extern TFT_eSPI tft;
+
+TFT_eSPI *canvas = &tft;
+
+#if DISPLAY_I80_DMA
+#include <esp_heap_caps.h>
+
+// TFT_eSprite with its pixels at an aligned PSRAM address, so the i80 DMA
+// can read row ranges straight from the frame. The frame is never deleted.
+class FrameSprite : public TFT_eSprite {
+public:
+  using TFT_eSprite::TFT_eSprite;
+
+  bool createAligned(int16_t width, int16_t height) {
+    if (createSprite(width, height) == nullptr) return false;
+    void *aligned = heap_caps_aligned_calloc(LCD_I80_PSRAM_ALIGN, (size_t)width * height, sizeof(uint16_t),
+                                             MALLOC_CAP_SPIRAM);
+    if (aligned) {
+      free(_img8_1);
+      _img8 = _img8_1 = _img8_2 = (uint8_t *)aligned;
+      _img = (uint16_t *)aligned;
+    }
+    return true;
+  }
+};
+#else
+class FrameSprite : public TFT_eSprite {
+public:
+  using TFT_eSprite::TFT_eSprite;
+
+  bool createAligned(int16_t width, int16_t height) {
+    return createSprite(width, height) != nullptr;
+  }
+};
+#endif
+
+static TFT_eSPI *panelTarget = &tft;
+static FrameSprite *frame = nullptr;
+static bool dmaPresent = false;
+
+// Bounding box of the damage since the last present (valid while damaged)
+static int32_t damageX0 = 0, damageY0 = 0, damageX1 = 0, damageY1 = 0;
+static bool damaged = false;
+static unsigned long lastPresentUs = 0;
+// Canvas to restore after a capture (nullptr: not capturing)
+static TFT_eSPI *capturedCanvas = nullptr;
+
+#ifdef DISPLAY_FRAME_BENCHMARK
+static const int BENCH_FRAMES = 20;
+
+static void logThroughput(const char *backend, unsigned long totalUs, unsigned long cpuUs) {
+  float bytes = (float)frame->width() * frame->height() * sizeof(uint16_t) * BENCH_FRAMES;
+  LOG_INFOF("DISPLAY", "%s: %.2f MB/s, %.1f full frames/s, CPU busy %lu us per frame", backend,
+                bytes / totalUs, BENCH_FRAMES * 1000000.0f / totalUs, cpuUs / BENCH_FRAMES);
+}
+
+// Full-frame presents through TFT_eSPI (CPU toggles WR per byte)
+static void benchmarkCpuPresent() {
+  unsigned long start = micros();
+  for (int i = 0; i < BENCH_FRAMES; i++) {
+    frame->pushSprite(0, 0);
+  }
+  unsigned long totalUs = micros() - start;
+  logThroughput("TFT_eSPI parallel", totalUs, totalUs);
+}
+
+#if DISPLAY_I80_DMA
+// Full-frame presents by DMA; CPU time is the time spent queueing
+static void benchmarkDmaPresent() {
+  const uint16_t *pixels = (const uint16_t *)frame->getPointer();
+  unsigned long cpuUs = 0;
+  unsigned long start = micros();
+  for (int i = 0; i < BENCH_FRAMES; i++) {
+    lcdI80Wait();
+    unsigned long queued = micros();
+    lcdI80Push(0, frame->height(), pixels);
+    cpuUs += micros() - queued;
+  }
+  lcdI80Wait();
+  logThroughput("i80 DMA", micros() - start, cpuUs);
+}
+#endif
+#endif
+
+bool frameBufferBegin(TFT_eSPI &panel) {
+  panelTarget = &panel;
+  canvas = &panel;
+
+#if DISPLAY_FRAMEBUFFER
+  if (!frame) {
+    frame = new FrameSprite(&panel);
+    frame->setColorDepth(16);
+    // TFT_eSprite allocates from PSRAM when it is available
+    if (!psramFound() || !frame->createAligned(panel.width(), panel.height())) {
+      LOG_WARN("DISPLAY", "No PSRAM for the frame buffer - drawing to the panel directly");
+      delete frame;
+      frame = nullptr;
+    }
+  }
+  if (frame) {
+    canvas = frame;
+    LOG_INFO("DISPLAY", "Frame buffer " + String(frame->width()) + "x" + String(frame->height()) + " in PSRAM");
+  }
+#endif
+
+#if DISPLAY_I80_DMA
+  if (frame && !dmaPresent) {
+#ifdef DISPLAY_FRAME_BENCHMARK
+    // Before the i80 bus takes the pins from TFT_eSPI
+    benchmarkCpuPresent();
+#endif
+    bool aligned = ((uintptr_t)frame->getPointer() % LCD_I80_PSRAM_ALIGN) == 0;
+    size_t frameBytes = (size_t)frame->width() * frame->height() * sizeof(uint16_t);
+    dmaPresent = aligned && lcdI80Begin(frame->width(), frame->height(), panel.getRotation(), frameBytes);
+    if (!dmaPresent) {
+      LOG_WARN("DISPLAY", "i80 DMA not available - presenting through TFT_eSPI");
+    }
+#ifdef DISPLAY_FRAME_BENCHMARK
+    if (dmaPresent) benchmarkDmaPresent();
+#endif
+  }
+#elif defined(DISPLAY_FRAME_BENCHMARK)
+  if (frame) benchmarkCpuPresent();
+#endif
+
+  damaged = false;
+  return canvas != &panel;
+}
+
+bool frameBuffered() {
+  return canvas != panelTarget;
+}
+
+void frameAcquire() {
+  if (dmaPresent) lcdI80Wait();
+}
+
+void frameDamage(int32_t x, int32_t y, int32_t w, int32_t h) {
+  if (capturedCanvas || !frameBuffered() || w <= 0 || h <= 0) return;
+  int32_t x1 = x + w;
+  int32_t y1 = y + h;
+  if (!damaged) {
+    damageX0 = x;
+    damageY0 = y;
+    damageX1 = x1;
+    damageY1 = y1;
+    damaged = true;
+    return;
+  }
+  damageX0 = min(damageX0, x);
+  damageY0 = min(damageY0, y);
+  damageX1 = max(damageX1, x1);
+  damageY1 = max(damageY1, y1);
+}
+
+void frameDamageAll() {
+  if (!frameBuffered()) return;
+  frameDamage(0, 0, canvas->width(), canvas->height());
+}
+
+uint32_t framePresent() {
+  if (capturedCanvas || !damaged) return 0;
+  damaged = false;
+
+  int32_t x0 = max<int32_t>(damageX0, 0);
+  int32_t y0 = max<int32_t>(damageY0, 0);
+  int32_t x1 = min<int32_t>(damageX1, frame->width());
+  int32_t y1 = min<int32_t>(damageY1, frame->height());
+  if (x1 <= x0 || y1 <= y0) return 0;
+
+  unsigned long start = micros();
+  if (dmaPresent) {
+    // Full rows are contiguous in the frame; start at the nearest row above
+    // y0 whose address suits the DMA (row 0 always does). Returns once queued
+    const uint16_t *pixels = (const uint16_t *)frame->getPointer();
+    int32_t width = frame->width();
+    while (y0 > 0 && ((uintptr_t)(pixels + y0 * width) % LCD_I80_PSRAM_ALIGN) != 0) y0--;
+    lcdI80Push(y0, y1, pixels + y0 * width);
+    x0 = 0;
+    x1 = width;
+  } else {
+    // One address window for the whole region
+    frame->pushSprite(x0, y0, x0, y0, x1 - x0, y1 - y0);
+  }
+  lastPresentUs = micros() - start;
+  return (uint32_t)(x1 - x0) * (y1 - y0);
+}
+
+void frameCaptureBegin(TFT_eSprite &image) {
+  if (capturedCanvas) return;
+  capturedCanvas = canvas;
+  canvas = &image;
+}
+
+void frameCaptureEnd() {
+  if (!capturedCanvas) return;
+  canvas = capturedCanvas;
+  capturedCanvas = nullptr;
+}
+
+void frameShow(TFT_eSprite &image) {
+  if (!frame) {
+    image.pushSprite(0, 0);
+    return;
+  }
+  frameAcquire();
+  memcpy(frame->getPointer(), image.getPointer(), (size_t)frame->width() * frame->height() * sizeof(uint16_t));
+  frameDamageAll();
+}
+
+unsigned long frameLastPresentUs() {
+  return lastPresentUs;
+}
@@ -0,0 +1,83 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <TFT_eSPI.h>
+
+/**
+ * FrameBuffer.h - Optional off-screen frame in PSRAM
+ *
+ * With -DDISPLAY_FRAMEBUFFER=1 all screens draw into a full-screen RGB565
+ * sprite (170x320, ~109 KB PSRAM) instead of the panel. framePresent()
+ * then sends the changed part of the frame to the panel in one block
+ * transfer, so the panel never shows a half-cleared screen and the
+ * clear/delay sequences for controller glitches are not needed.
+ *
+ * Without the flag, or if the sprite cannot be allocated, canvas is the
+ * panel itself and framePresent() does nothing.
+ *
+ * With -DDISPLAY_I80_DMA=1 as well, presents go out by DMA over the LCD_CAM
+ * i80 bus (LcdI80.h) and return as soon as the transfer is queued; the
+ * next screen waits in frameAcquire() until the panel has read the frame.
+ */
+
+#ifndef DISPLAY_FRAMEBUFFER
+#define DISPLAY_FRAMEBUFFER 0
+#endif
+
+/**
+ * Drawing target of all screens: the frame sprite or the panel.
+ */
+extern TFT_eSPI *canvas;
+
+/**
+ * Allocate the frame for the current panel rotation. Call after
+ * tft.init()/setRotation().
+ * @return true if screens draw off-screen
+ */
+bool frameBufferBegin(TFT_eSPI &panel);
+
+/**
+ * True if canvas is the off-screen frame.
+ */
+bool frameBuffered();
+
+/**
+ * Call before drawing into canvas: waits for a DMA present still reading
+ * the frame. No-op without DISPLAY_I80_DMA.
+ */
+void frameAcquire();
+
+/**
+ * Mark a region as changed since the last present.
+ */
+void frameDamage(int32_t x, int32_t y, int32_t w, int32_t h);
+void frameDamageAll();
+
+/**
+ * Send the changed region (bounding box of all damage) to the panel; does
+ * nothing if nothing changed, so screens can call it unconditionally.
+ * @return Pixels transferred
+ */
+uint32_t framePresent();
+
+/**
+ * Redirect canvas to a full-screen image (ScreenCache.h): screens drawn
+ * until frameCaptureEnd() go into the image, nothing is presented.
+ */
+void frameCaptureBegin(TFT_eSprite &image);
+void frameCaptureEnd();
+
+/**
+ * Show a full-screen image from frameCaptureBegin(): one copy into the
+ * frame (sent with the next framePresent()), or one transfer to the panel
+ * without frame buffer.
+ */
+void frameShow(TFT_eSprite &image);
+
+/**
+ * Duration of the last framePresent() that transferred pixels (with DMA:
+ * the time to queue the transfer).
+ */
+unsigned long frameLastPresentUs();
+
+#endif // FRAME_BUFFER_H
@@ -7,6 +7,16 @@
 
 #include "GlobalState.h"
 
+// Config values of the parsed enums (index = enumerator)
+const char* const orientationValues[4] = {"h", "v", "hi", "vi"};
+const char* const qrFormatValues[2] = {"bech32", "lud17"};
+const char* const specialModeValues[5] = {"standard", "blink", "pulse", "fast-blink", "custom"};
+const char* const screensaverValues[2] = {"off", "backlight"};
+const char* const deepSleepValues[3] = {"off", "light", "freeze"};
+const char* const channelModeValues[3] = {"off", "duo", "quattro"};
+const char* const tickerModeValues[3] = {"off", "always", "selecting"};
+const char* const relayPolicyValues[2] = {"extend", "queue"};
+
 // WiFi & Network Configuration
 WifiConfig wifiConfig;
 
@@ -43,11 +53,5 @@ TouchState touchState;
 // Product Selection & Timeout Tracking
 ProductSelectionState productSelectionState;
 
-// Payment Status
-PaymentStatus paymentStatus;
-
 // Activity Tracking for Screensaver
 ActivityTracking activityTracking;
-
-// Utility Constants
-const char* BECH32_CHARSET = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
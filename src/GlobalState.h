@@ -2,6 +2,7 @@
 #define GLOBAL_STATE_H
 
 #include <Arduino.h>
+#include "RelayScheduler.h"
 
 /**
  * @file GlobalState.h
@@ -11,6 +12,65 @@
  * maintainability, and reduce the cognitive load of tracking scattered state.
  */
 
+// ============================================================================
+// PARSED CONFIGURATION VALUES
+// ============================================================================
+// Choice settings are parsed into these enums once when the config is
+// loaded (ConfigStore), so runtime code never compares Strings. The
+// *Values arrays hold the config.json spelling of each enumerator.
+
+enum class Orientation : uint8_t {
+  HORIZONTAL,          // "h"  - button right
+  VERTICAL,            // "v"  - button bottom
+  HORIZONTAL_INVERSE,  // "hi" - button left
+  VERTICAL_INVERSE     // "vi" - button top
+};
+
+enum class QrFormat : uint8_t {
+  BECH32,  // "bech32"
+  LUD17    // "lud17"
+};
+
+enum class SpecialMode : uint8_t {
+  STANDARD,    // Steady on/off
+  BLINK,       // 1 Hz, 1:1
+  PULSE,       // 2 Hz, 1:4
+  FAST_BLINK,  // 5 Hz, 1:1
+  CUSTOM       // frequency/dutyCycleRatio from config
+};
+
+enum class ScreensaverMode : uint8_t {
+  OFF,
+  BACKLIGHT
+};
+
+enum class DeepSleepMode : uint8_t {
+  OFF,
+  LIGHT,
+  FREEZE
+};
+
+enum class ChannelMode : uint8_t {
+  SINGLE,   // "off" - pin 12 only
+  DUO,      // pins 12, 13
+  QUATTRO   // pins 12, 13, 10, 11
+};
+
+enum class TickerMode : uint8_t {
+  OFF,
+  ALWAYS,
+  SELECTING
+};
+
+extern const char* const orientationValues[4];
+extern const char* const qrFormatValues[2];
+extern const char* const specialModeValues[5];
+extern const char* const screensaverValues[2];
+extern const char* const deepSleepValues[3];
+extern const char* const channelModeValues[3];
+extern const char* const tickerModeValues[3];
+extern const char* const relayPolicyValues[2];
+
 // ============================================================================
 // WIFI & NETWORK CONFIGURATION
 // ============================================================================
@@ -28,9 +88,44 @@ extern WifiConfig wifiConfig;
 // DISPLAY & THEME SETTINGS
 // ============================================================================
 
+struct ScreenPoint {
+  int16_t x;
+  int16_t y;
+};
+
+// Screen geometry for the configured orientation, resolved once by initDisplay()
+struct DisplayLayout {
+  uint8_t rotation = 1;                 // tft.setRotation() value
+  bool vertical = false;                // Portrait (v, vi)
+  bool inverse = false;                 // Rotated by 180° (hi, vi)
+  int16_t centerX = 160;                // Screen centre
+  int16_t centerY = 85;
+  ScreenPoint qr = {12, 12};            // Top-left corner of the QR code
+  int16_t tickerShift = 0;              // Ticker content shift along the long axis
+  int16_t qrBoxY = 168;                 // Vertical: label box below the QR code
+  int16_t thresholdBoxX = 168;          // Horizontal: label box right of the QR code
+  int16_t thresholdTextX = 180;
+  int16_t productBoxX = 163;
+  int16_t productTextX = 177;
+  ScreenPoint helpLabel = {270, 9};     // Non-touch HELP/NEXT labels (ML_DATUM)
+  ScreenPoint nextLabel = {270, 163};
+  ScreenPoint touchHelp = {311, 55};    // Touch HELP (MC_DATUM): word (vertical) or first stacked letter (horizontal)
+};
+
+// Colors of the configured theme, resolved once by initDisplay()
+struct ThemePalette {
+  uint16_t foreground = 0x0000;         // Text and elements
+  uint16_t background = 0xFFFF;
+  uint16_t productForeground = 0x0000;  // Product QR screens
+  uint16_t productBackground = 0xFFFF;
+  bool invertedQr = false;              // zapbox/btcorange-black: product QR screens swap colors
+};
+
 struct DisplayConfig {
-  String orientation = "h";  // "h" for horizontal, "v" for vertical
-  String theme = "zapbox";
+  Orientation orientation = Orientation::HORIZONTAL;
+  String theme = "zapbox";              // Theme name, only used to resolve the palette
+  DisplayLayout layout;
+  ThemePalette palette;
 };
 
 extern DisplayConfig displayConfig;
@@ -55,8 +150,8 @@ extern LightningConfig lightningConfig;
 // ============================================================================
 
 struct PowerConfig {
-  String screensaver = "off";   // Screensaver mode: "off", "on", etc.
-  String deepSleep = "off";     // Deep sleep mode: "off", "on", etc.
+  ScreensaverMode screensaver = ScreensaverMode::OFF;
+  DeepSleepMode deepSleep = DeepSleepMode::OFF;
   String activationTime = "5";  // Activation time in minutes
   unsigned long activationTimeoutMs = 0;  // Calculated timeout in milliseconds
   unsigned long lastWakeUpTime = 0;  // Track when device woke up from screensaver
@@ -93,7 +188,7 @@ extern ExternalButtonState externalButtonState;
 // ============================================================================
 
 struct SpecialModeConfig {
-  String mode = "standard";  // "standard", "frequency", "brightness", etc.
+  SpecialMode mode = SpecialMode::STANDARD;
   float frequency = 1.0;     // Frequency multiplier for waveform mode
   float dutyCycleRatio = 1.0; // Duty cycle for PWM modes
 };
@@ -105,8 +200,9 @@ extern SpecialModeConfig specialModeConfig;
 // ============================================================================
 
 struct MultiChannelConfig {
-  String mode = "off";        // "off", "duo", "quattro"
-  String btcTickerMode = "off"; // "off", "always", "selecting"
+  ChannelMode mode = ChannelMode::SINGLE;
+  RelayPolicy channelPolicy = RELAY_POLICY_EXTEND; // Payment for a channel that is already running
+  TickerMode btcTickerMode = TickerMode::OFF;
   volatile bool btcTickerActive = false; // volatile for multi-threaded WebSocket access
   volatile int currentProduct = -1;    // -1 = selection screen, 1-4 = product number (volatile for multi-context access)
 };
@@ -129,10 +225,13 @@ extern BitcoinData bitcoinData;
 // MULTI-PRODUCT LABELS
 // ============================================================================
 
+// Longest label kept per product (server labels are truncated)
+static constexpr size_t PRODUCT_LABEL_SIZE = 48;
+
 struct ProductLabels {
   // Labels stored in array: index 0=pin10, 1=pin11, 2=pin12, 3=pin13
-  // Use getLabelForPin(pin) and setLabelForPin(pin, label) for access
-  String labels[4] = {"", "", "", ""};
+  // Index with getPinIndex(pin); an empty string means "no label"
+  char labels[4][PRODUCT_LABEL_SIZE] = {};
   unsigned long lastUpdate = 0;
 };
 
@@ -201,16 +300,6 @@ struct ProductSelectionState {
 
 extern ProductSelectionState productSelectionState;
 
-// ============================================================================
-// PAYMENT STATUS
-// ============================================================================
-
-struct PaymentStatus {
-  bool paid = false;  // Whether a payment has been received
-};
-
-extern PaymentStatus paymentStatus;
-
 // ============================================================================
 // ACTIVITY TRACKING FOR SCREENSAVER
 // ============================================================================
@@ -221,10 +310,4 @@ struct ActivityTracking {
 
 extern ActivityTracking activityTracking;
 
-// ============================================================================
-// UTILITY CONSTANTS
-// ============================================================================
-
-extern const char* BECH32_CHARSET;
-
 #endif // GLOBAL_STATE_H
@@ -0,0 +1,73 @@
+#include "GlyphCache.h"
+#include "Log.h"
+
+extern TFT_eSPI tft;
+
+struct Glyph {
+  uint16_t *pixels;           // glyphWidth x glyphHeight, panel byte order (as in a sprite)
+  uint16_t fg, bg;
+  uint8_t size;
+  char c;
+};
+
+static Glyph glyphs[GLYPH_CACHE_SLOTS] = {};
+static uint8_t nextEvict = 0;
+
+static const Glyph *findGlyph(char c, uint8_t size, uint16_t fg, uint16_t bg) {
+  for (const Glyph &glyph : glyphs) {
+    if (glyph.pixels && glyph.c == c && glyph.size == size && glyph.fg == fg && glyph.bg == bg) return &glyph;
+  }
+  return nullptr;
+}
+
+// Draw the cell into a scratch sprite and keep a copy of its pixels
+static const Glyph *rasterize(char c, uint8_t size, uint16_t fg, uint16_t bg) {
+  int16_t w = glyphWidth(size);
+  int16_t h = glyphHeight(size);
+  TFT_eSprite cell(&tft);
+  cell.setColorDepth(16);
+  if (cell.createSprite(w, h) == nullptr) return nullptr;
+  cell.fillSprite(bg);
+  cell.setTextSize(size);
+  cell.setTextColor(fg, bg);
+  cell.drawChar(c, 0, 0, 1);
+
+  size_t bytes = (size_t)w * h * sizeof(uint16_t);
+  uint16_t *pixels = (uint16_t *)malloc(bytes);
+  if (!pixels) {
+    cell.deleteSprite();
+    LOG_WARN("DISPLAY", "No memory for glyph cache");
+    return nullptr;
+  }
+  memcpy(pixels, cell.getPointer(), bytes);
+  cell.deleteSprite();
+
+  Glyph &slot = glyphs[nextEvict];
+  nextEvict = (nextEvict + 1) % GLYPH_CACHE_SLOTS;
+  free(slot.pixels);
+  slot = {pixels, fg, bg, size, c};
+  return &slot;
+}
+
+void glyphCachePrepare(const char *chars, uint8_t size, uint16_t fg, uint16_t bg) {
+  for (const char *p = chars; *p; p++) {
+    if (!findGlyph(*p, size, fg, bg)) rasterize(*p, size, fg, bg);
+  }
+}
+
+void glyphDraw(TFT_eSPI &target, char c, int16_t x, int16_t y, uint8_t size, uint16_t fg, uint16_t bg) {
+  const Glyph *glyph = findGlyph(c, size, fg, bg);
+  if (!glyph) glyph = rasterize(c, size, fg, bg);
+  if (!glyph) {
+    target.fillRect(x, y, glyphWidth(size), glyphHeight(size), bg);
+    target.setTextSize(size);
+    target.setTextColor(fg, bg);
+    target.drawChar(c, x, y, 1);
+    return;
+  }
+  // The pixels are already in panel byte order
+  bool swap = target.getSwapBytes();
+  target.setSwapBytes(false);
+  target.pushImage(x, y, glyphWidth(size), glyphHeight(size), glyph->pixels);
+  target.setSwapBytes(swap);
+}
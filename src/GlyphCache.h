@@ -0,0 +1,38 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <TFT_eSPI.h>
+
+/**
+ * GlyphCache.h - Pre-rasterized character cells of the GLCD font
+ *
+ * All screen text uses the fixed-width GLCD font (font 1): every character
+ * is a 6x8 cell scaled by the text size. A cell is rasterized once per
+ * character, size and colors into an RGB565 block (background included)
+ * and kept; drawing it is then one pushImage() instead of a fillRect() per
+ * font pixel. DisplayScene uses it to redraw only the characters of a text
+ * that changed (a block height tick is one or two cells).
+ */
+
+// Cells kept at once; the oldest is replaced when full
+static constexpr uint8_t GLYPH_CACHE_SLOTS = 48;
+
+/**
+ * Cell size of the GLCD font at a text size.
+ */
+inline int16_t glyphWidth(uint8_t size) { return 6 * size; }
+inline int16_t glyphHeight(uint8_t size) { return 8 * size; }
+
+/**
+ * Rasterize the characters ahead of their first use (e.g. the digits of
+ * the ticker values).
+ */
+void glyphCachePrepare(const char *chars, uint8_t size, uint16_t fg, uint16_t bg);
+
+/**
+ * Draw one opaque character cell with its top left corner at (x, y).
+ * Falls back to drawChar() if the cell cannot be cached.
+ */
+void glyphDraw(TFT_eSPI &target, char c, int16_t x, int16_t y, uint8_t size, uint16_t fg, uint16_t bg);
+
+#endif // GLYPH_CACHE_H
@@ -0,0 +1,353 @@
+#include "HttpsPool.h"
+#include <WiFiClientSecure.h>
+#include "Log.h"
+
+// Open TLS connections at the same time (each holds a TLS context on the heap)
+#ifndef HTTPS_POOL_MAX_OPEN
+#define HTTPS_POOL_MAX_OPEN 2
+#endif
+
+// Close connections idle for longer (just above the 5 minute refresh interval)
+#ifndef HTTPS_IDLE_TIMEOUT_MS
+#define HTTPS_IDLE_TIMEOUT_MS 330000
+#endif
+
+// Unread body bytes skipped to keep a connection; larger rests close it
+static const long MAX_DRAIN_BYTES = 4096;
+
+static const uint16_t HTTPS_PORT = 443;
+
+// Read one header/chunk-size line (CR/LF stripped) before deadline
+static bool readLine(WiFiClientSecure& client, char* line, size_t size, unsigned long deadline) {
+  size_t length = 0;
+  while (true) {
+    int c = client.read();
+    if (c < 0) {
+      if (!client.connected() || (long)(millis() - deadline) >= 0) {
+        line[length] = '\0';
+        return false;
+      }
+      delay(1);
+      continue;
+    }
+    if (c == '\n') break;
+    if (c != '\r' && length + 1 < size) line[length++] = (char)c;
+  }
+  line[length] = '\0';
+  return true;
+}
+
+// Value of "Name: value" if line is that header, otherwise nullptr
+static const char* headerValue(const char* line, const char* name) {
+  size_t nameLength = strlen(name);
+  if (strncasecmp(line, name, nameLength) != 0 || line[nameLength] != ':') return nullptr;
+  const char* value = line + nameLength + 1;
+  while (*value == ' ') value++;
+  return value;
+}
+
+// Response body of one connection: bounded by Content-Length, de-chunked,
+// or (neither) read until the server closes the connection
+class HttpsBodyStream : public Stream {
+public:
+  void begin(WiFiClientSecure* client, long contentLength, bool chunked, uint32_t timeoutMs) {
+    client_ = client;
+    remaining_ = contentLength;
+    chunked_ = chunked;
+    firstChunk_ = true;
+    finished_ = (!chunked && contentLength == 0);
+    timeoutMs_ = timeoutMs;
+    setTimeout(timeoutMs);
+  }
+
+  void reset() {
+    client_ = nullptr;
+    finished_ = true;
+  }
+
+  int available() override {
+    if (finished_ || !client_) return 0;
+    int available = client_->available();
+    if (remaining_ >= 0 && available > remaining_) available = (int)remaining_;
+    return available;
+  }
+
+  int read() override {
+    if (finished_ || !client_) return -1;
+    if (chunked_ && remaining_ == 0 && !nextChunk()) return -1;
+    int c = client_->read();
+    if (c < 0) {
+      if (!client_->connected() && !client_->available()) finished_ = true;
+      return -1;  // Not received yet - Stream::timedRead() waits
+    }
+    if (remaining_ > 0 && --remaining_ == 0 && !chunked_) finished_ = true;
+    return c;
+  }
+
+  int peek() override {
+    if (finished_ || !client_) return -1;
+    if (chunked_ && remaining_ == 0 && !nextChunk()) return -1;
+    return client_->peek();
+  }
+
+  size_t write(uint8_t) override { return 0; }
+
+  // Stops at the end of the body instead of waiting out the timeout
+  using Stream::readBytes;
+  size_t readBytes(char* buffer, size_t length) override {
+    size_t count = 0;
+    while (count < length) {
+      int c = nextByte();
+      if (c < 0) break;
+      buffer[count++] = (char)c;
+    }
+    return count;
+  }
+
+  // Skip the rest of the body; false if the connection cannot be reused
+  bool drain() {
+    if (!client_) return true;
+    if (remaining_ < 0 && !chunked_) return false;  // Body ends with the connection
+    long skipped = 0;
+    while (!finished_ && skipped < MAX_DRAIN_BYTES) {
+      if (nextByte() < 0) return finished_;
+      skipped++;
+    }
+    return finished_;
+  }
+
+private:
+  // Stream::timedRead(), but -1 at once when the body has ended (Content-Length
+  // reached, last chunk read or connection closed)
+  int nextByte() {
+    unsigned long start = millis();
+    do {
+      int c = read();
+      if (c >= 0 || finished_) return c;
+      yield();
+    } while (millis() - start < timeoutMs_);
+    return -1;
+  }
+
+  // Read the next chunk-size line; false at the last chunk or on errors
+  bool nextChunk() {
+    char line[24];
+    unsigned long deadline = millis() + timeoutMs_;
+    // CRLF after the previous chunk's data
+    if (!firstChunk_ && !readLine(*client_, line, sizeof(line), deadline)) {
+      finished_ = true;
+      return false;
+    }
+    firstChunk_ = false;
+    if (!readLine(*client_, line, sizeof(line), deadline)) {
+      finished_ = true;
+      return false;
+    }
+    remaining_ = strtol(line, nullptr, 16);
+    if (remaining_ <= 0) {
+      // Last chunk: skip optional trailers up to the empty line
+      while (readLine(*client_, line, sizeof(line), deadline) && line[0] != '\0') {}
+      remaining_ = 0;
+      finished_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  WiFiClientSecure* client_ = nullptr;
+  long remaining_ = 0;        // Bytes left in body/current chunk, -1 = until close
+  bool chunked_ = false;
+  bool firstChunk_ = true;
+  bool finished_ = true;
+  uint32_t timeoutMs_ = 5000;
+};
+
+struct Connection {
+  WiFiClientSecure client;
+  HttpsBodyStream body;
+  char host[64] = "";
+  bool keepAlive = false;
+  unsigned long lastUsedMs = 0;
+};
+
+static Connection connections[HTTPS_HOST_COUNT];
+static HttpsPoolStats stats = {};
+
+static void closeConnection(Connection& conn) {
+  conn.body.reset();
+  conn.client.stop();
+  conn.host[0] = '\0';
+  conn.keepAlive = false;
+}
+
+static bool isOpen(Connection& conn) {
+  return conn.host[0] != '\0' && conn.client.connected();
+}
+
+// Stay within HTTPS_POOL_MAX_OPEN by closing the least recently used connections
+static void makeRoomFor(const Connection& keep) {
+  while (true) {
+    int open = 0;
+    Connection* oldest = nullptr;
+    for (Connection& conn : connections) {
+      if (&conn == &keep || !isOpen(conn)) continue;
+      open++;
+      if (!oldest || (long)(conn.lastUsedMs - oldest->lastUsedMs) < 0) oldest = &conn;
+    }
+    if (open < HTTPS_POOL_MAX_OPEN || !oldest) return;
+    closeConnection(*oldest);
+  }
+}
+
+static bool openConnection(Connection& conn, const char* host, uint32_t timeoutMs) {
+  closeConnection(conn);
+  makeRoomFor(conn);
+
+  // Same as HTTPClient without a CA: encrypted, server not authenticated
+  conn.client.setInsecure();
+  unsigned long start = millis();
+  if (!conn.client.connect(host, HTTPS_PORT, timeoutMs)) {
+    LOG_WARN("HTTPS", String("Connection to ") + host + " failed");
+    return false;
+  }
+  uint32_t elapsed = millis() - start;
+  stats.handshakes++;
+  stats.handshakeTimeMs += elapsed;
+  LOG_REC_DEBUG(Https, HTTPS_HANDSHAKE, (unsigned)(&conn - connections), elapsed);
+
+  snprintf(conn.host, sizeof(conn.host), "%s", host);
+  return true;
+}
+
+// Send the request and read status line and headers
+static int sendRequest(Connection& conn, const char* path, uint32_t timeoutMs) {
+  char request[384];
+  int length = snprintf(request, sizeof(request),
+                        "GET %s HTTP/1.1\r\n"
+                        "Host: %s\r\n"
+                        "User-Agent: ZapBox/" VERSION "\r\n"
+                        "Accept: application/json\r\n"
+                        "Connection: keep-alive\r\n"
+                        "\r\n",
+                        path, conn.host);
+  if (length <= 0 || length >= (int)sizeof(request)) return HTTPS_ERROR_REQUEST;
+  if (conn.client.write((const uint8_t*)request, length) != (size_t)length) return HTTPS_ERROR_CONNECTION;
+
+  unsigned long deadline = millis() + timeoutMs;
+  char line[160];
+  if (!readLine(conn.client, line, sizeof(line), deadline)) return HTTPS_ERROR_CONNECTION;
+
+  int code = 0;
+  if (sscanf(line, "HTTP/%*d.%*d %d", &code) != 1 || code <= 0) return HTTPS_ERROR_RESPONSE;
+  conn.keepAlive = (strncmp(line, "HTTP/1.1", 8) == 0);
+
+  long contentLength = -1;
+  bool chunked = false;
+  while (true) {
+    if (!readLine(conn.client, line, sizeof(line), deadline)) return HTTPS_ERROR_CONNECTION;
+    if (line[0] == '\0') break;  // End of headers
+
+    const char* value;
+    if ((value = headerValue(line, "Content-Length"))) {
+      contentLength = atol(value);
+    } else if ((value = headerValue(line, "Transfer-Encoding"))) {
+      chunked = (strncasecmp(value, "chunked", 7) == 0);
+    } else if ((value = headerValue(line, "Connection"))) {
+      if (strncasecmp(value, "close", 5) == 0) conn.keepAlive = false;
+      if (strncasecmp(value, "keep-alive", 10) == 0) conn.keepAlive = true;
+    }
+  }
+  if (chunked) contentLength = 0;
+  else if (contentLength < 0) conn.keepAlive = false;
+
+  conn.body.begin(&conn.client, contentLength, chunked, timeoutMs);
+  return code;
+}
+
+int httpsGet(HttpsHost slot, const char* host, const char* path, uint32_t timeoutMs) {
+  Connection& conn = connections[slot];
+  stats.requests++;
+
+  // Previous body not finished with httpsEnd() - the connection is out of sync
+  if (!conn.body.drain()) closeConnection(conn);
+
+  bool reused = isOpen(conn) && strcmp(conn.host, host) == 0;
+  if (!reused && !openConnection(conn, host, timeoutMs)) {
+    stats.failures++;
+    return HTTPS_ERROR_CONNECTION;
+  }
+
+  int code = sendRequest(conn, path, timeoutMs);
+  if (code == HTTPS_ERROR_CONNECTION && reused) {
+    // The server closed the idle connection - once more on a new one
+    LOG_DEBUG("HTTPS", String("Kept-alive connection to ") + host + " was closed, reconnecting");
+    reused = false;
+    if (!openConnection(conn, host, timeoutMs)) {
+      stats.failures++;
+      return HTTPS_ERROR_CONNECTION;
+    }
+    code = sendRequest(conn, path, timeoutMs);
+  }
+
+  if (code < 0) {
+    closeConnection(conn);
+    stats.failures++;
+    return code;
+  }
+  if (reused) stats.reused++;
+  conn.lastUsedMs = millis();
+  return code;
+}
+
+Stream& httpsBody(HttpsHost slot) {
+  return connections[slot].body;
+}
+
+String httpsBodyString(HttpsHost slot, size_t maxLength) {
+  char buffer[129];
+  if (maxLength > sizeof(buffer) - 1) maxLength = sizeof(buffer) - 1;
+  size_t length = connections[slot].body.readBytes(buffer, maxLength);
+  buffer[length] = '\0';
+  return String(buffer);
+}
+
+void httpsEnd(HttpsHost slot) {
+  Connection& conn = connections[slot];
+  if (!conn.body.drain() || !conn.keepAlive) {
+    closeConnection(conn);
+  }
+  conn.body.reset();
+  conn.lastUsedMs = millis();
+}
+
+bool httpsConnected(HttpsHost slot) {
+  return isOpen(connections[slot]);
+}
+
+void httpsPoolMaintain() {
+  unsigned long now = millis();
+  for (Connection& conn : connections) {
+    if (conn.host[0] == '\0') continue;
+    if (!conn.client.connected() || now - conn.lastUsedMs >= HTTPS_IDLE_TIMEOUT_MS) {
+      closeConnection(conn);
+    }
+  }
+}
+
+void httpsPoolCloseAll() {
+  for (Connection& conn : connections) {
+    closeConnection(conn);
+  }
+}
+
+HttpsPoolStats httpsPoolStats() {
+  HttpsPoolStats result = stats;
+  uint32_t averageMs = stats.handshakes ? stats.handshakeTimeMs / stats.handshakes : 0;
+  result.savedTimeMs = stats.reused * averageMs;
+  return result;
+}
+
+void httpsPoolLogStats() {
+  HttpsPoolStats current = httpsPoolStats();
+  LOG_REC_INFO(Https, HTTPS_STATS, current.requests, current.handshakes, current.reused, current.savedTimeMs);
+}
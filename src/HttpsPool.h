@@ -0,0 +1,99 @@
+#ifndef HTTPS_POOL_H
+#define HTTPS_POOL_H
+
+#include <Arduino.h>
+
+/**
+ * HttpsPool.h - Persistent HTTPS connections for the API fetches
+ *
+ * Every API host (LNbits, CoinGecko, mempool.space, blockstream.info) has
+ * one slot holding a WiFiClientSecure that stays connected between requests
+ * (HTTP/1.1 keep-alive), so periodic refreshes skip the TCP connect and the TLS
+ * handshake as long as the server keeps the connection open. A dropped
+ * idle connection is detected on the next request and reopened once.
+ *
+ * At most HTTPS_POOL_MAX_OPEN TLS connections are open at a time (the least
+ * recently used one is closed first; 1 = a single shared TLS context), and
+ * connections idle for HTTPS_IDLE_TIMEOUT_MS are closed to return the heap.
+ *
+ * Usage:
+ *   if (httpsGet(HTTPS_HOST_MEMPOOL, "mempool.space", "/api/blocks/tip/height") == 200) {
+ *     String height = httpsBodyString(HTTPS_HOST_MEMPOOL);
+ *   }
+ *   httpsEnd(HTTPS_HOST_MEMPOOL);   // always, also after errors
+ */
+
+enum HttpsHost : uint8_t {
+  HTTPS_HOST_LNBITS,
+  HTTPS_HOST_COINGECKO,
+  HTTPS_HOST_MEMPOOL,
+  HTTPS_HOST_BLOCKSTREAM,
+  HTTPS_HOST_COUNT
+};
+
+// Negative results of httpsGet()
+static constexpr int HTTPS_ERROR_CONNECTION = -1;   // Connect/TLS failed or connection lost
+static constexpr int HTTPS_ERROR_REQUEST = -2;      // Request line too long
+static constexpr int HTTPS_ERROR_RESPONSE = -3;     // No valid HTTP status line
+
+struct HttpsPoolStats {
+  uint32_t requests;          // httpsGet() calls
+  uint32_t handshakes;        // New TLS connections
+  uint32_t reused;            // Requests sent on a kept-alive connection
+  uint32_t failures;          // Requests that returned an error
+  uint32_t handshakeTimeMs;   // Total connect + handshake time
+  uint32_t savedTimeMs;       // Estimate: reused x average handshake time
+};
+
+/**
+ * Send GET path to host on the slot's connection (reused if still open).
+ * @param slot Connection slot of the API host
+ * @param host Host name, e.g. lnbitsServer.c_str()
+ * @param path Path and query, e.g. "/api/blocks/tip/height"
+ * @param timeoutMs Connect and response timeout
+ * @return HTTP status code, or HTTPS_ERROR_* (< 0)
+ */
+int httpsGet(HttpsHost slot, const char* host, const char* path, uint32_t timeoutMs = 5000);
+
+/**
+ * Body of the last response (Content-Length bounded or de-chunked).
+ * Valid until httpsEnd(); suitable for deserializeJson().
+ */
+Stream& httpsBody(HttpsHost slot);
+
+/**
+ * Read a short body completely (e.g. the block height).
+ */
+String httpsBodyString(HttpsHost slot, size_t maxLength = 64);
+
+/**
+ * Finish the request: skip unread body bytes so the connection can be
+ * reused, or close it if the server asked to.
+ */
+void httpsEnd(HttpsHost slot);
+
+/**
+ * True if the slot holds an open connection (proves the host is reachable
+ * without opening a new one).
+ */
+bool httpsConnected(HttpsHost slot);
+
+/**
+ * Close connections idle for longer than HTTPS_IDLE_TIMEOUT_MS.
+ * Call periodically from the main loop.
+ */
+void httpsPoolMaintain();
+
+/**
+ * Close all connections (WiFi lost, sleep).
+ */
+void httpsPoolCloseAll();
+
+HttpsPoolStats httpsPoolStats();
+
+/**
+ * Print handshake count, reuse count and estimated time saved.
+ */
+void httpsPoolLogStats();
+
+#endif // HTTPS_POOL_H
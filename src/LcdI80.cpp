@@ -0,0 +1,140 @@
+#include "LcdI80.h"
+
+#if DISPLAY_I80_DMA
+
+#include <esp_lcd_panel_io.h>
+#include <esp32s3/rom/cache.h>
+#include <soc/soc_memory_layout.h>
+#include <freertos/semphr.h>
+#include "Log.h"
+
+// ST7789 commands
+#define LCD_CMD_CASET 0x2A
+#define LCD_CMD_RASET 0x2B
+#define LCD_CMD_RAMWR 0x2C
+
+static esp_lcd_i80_bus_handle_t bus = nullptr;
+static esp_lcd_panel_io_handle_t io = nullptr;
+static SemaphoreHandle_t transferDone = nullptr;
+static bool busy = false;    // A transfer was queued and not waited for yet
+static int16_t panelWidth = 0;
+static int16_t panelHeight = 0;
+static uint16_t columnOffset = 0;
+static uint16_t rowOffset = 0;
+
+static bool IRAM_ATTR onTransferDone(esp_lcd_panel_io_handle_t panelIo, esp_lcd_panel_io_event_data_t *event, void *context) {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(transferDone, &woken);
+  return woken == pdTRUE;
+}
+
+bool lcdI80Begin(int16_t width, int16_t height, uint8_t rotation, size_t maxBytes) {
+  panelWidth = width;
+  panelHeight = height;
+  // 170x320 ST7789 RAM offsets per rotation, as in TFT_eSPI's ST7789_Rotation.h
+  bool portrait = (rotation & 1) == 0;
+  columnOffset = portrait ? 35 : 0;
+  rowOffset = portrait ? 0 : 35;
+  if (bus) return true;
+
+  transferDone = xSemaphoreCreateBinary();
+
+  esp_lcd_i80_bus_config_t busConfig = {};
+  busConfig.dc_gpio_num = TFT_DC;
+  busConfig.wr_gpio_num = TFT_WR;
+  busConfig.clk_src = LCD_CLK_SRC_PLL160M;
+  const int dataPins[8] = {TFT_D0, TFT_D1, TFT_D2, TFT_D3, TFT_D4, TFT_D5, TFT_D6, TFT_D7};
+  for (int i = 0; i < 8; i++) busConfig.data_gpio_nums[i] = dataPins[i];
+  busConfig.bus_width = 8;
+  busConfig.max_transfer_bytes = maxBytes;
+  busConfig.psram_trans_align = LCD_I80_PSRAM_ALIGN;
+  busConfig.sram_trans_align = 4;
+  esp_err_t err = esp_lcd_new_i80_bus(&busConfig, &bus);
+  if (err != ESP_OK) {
+    LOG_ERROR("DISPLAY", String("i80 bus init failed: ") + esp_err_to_name(err));
+    bus = nullptr;
+    return false;
+  }
+
+  esp_lcd_panel_io_i80_config_t ioConfig = {};
+  ioConfig.cs_gpio_num = TFT_CS;
+  ioConfig.pclk_hz = DISPLAY_I80_PCLK_HZ;
+  ioConfig.trans_queue_depth = 4;
+  ioConfig.on_color_trans_done = onTransferDone;
+  ioConfig.lcd_cmd_bits = 8;
+  ioConfig.lcd_param_bits = 8;
+  ioConfig.dc_levels.dc_idle_level = 0;
+  ioConfig.dc_levels.dc_cmd_level = 0;
+  ioConfig.dc_levels.dc_dummy_level = 0;
+  ioConfig.dc_levels.dc_data_level = 1;
+  err = esp_lcd_new_panel_io_i80(bus, &ioConfig, &io);
+  if (err != ESP_OK) {
+    LOG_ERROR("DISPLAY", String("i80 panel IO init failed: ") + esp_err_to_name(err));
+    esp_lcd_del_i80_bus(bus);
+    bus = nullptr;
+    return false;
+  }
+
+  LOG_INFO("DISPLAY", "i80 DMA backend, pixel clock " + String(DISPLAY_I80_PCLK_HZ / 1000000) + " MHz");
+  return true;
+}
+
+static void setWindow(uint8_t command, uint16_t start, uint16_t end) {
+  uint8_t range[4] = {(uint8_t)(start >> 8), (uint8_t)start, (uint8_t)(end >> 8), (uint8_t)end};
+  esp_lcd_panel_io_tx_param(io, command, range, sizeof(range));
+}
+
+bool lcdI80Push(int16_t y0, int16_t y1, const uint16_t *pixels) {
+  if (y1 > panelHeight) y1 = panelHeight;
+  if (!io || y1 <= y0) return false;
+  lcdI80Wait();
+  xSemaphoreTake(transferDone, 0);  // Drop a completion that arrived after a timeout
+
+  // Window commands wait for the previous color transfer inside the driver
+  setWindow(LCD_CMD_CASET, columnOffset, columnOffset + panelWidth - 1);
+  setWindow(LCD_CMD_RASET, rowOffset + y0, rowOffset + y1 - 1);
+
+  size_t bytes = (size_t)panelWidth * (y1 - y0) * sizeof(uint16_t);
+  // The DMA reads PSRAM directly: write the frame back from the data cache first
+  if (esp_ptr_external_ram(pixels)) {
+    Cache_WriteBack_Addr((uint32_t)pixels, bytes);
+  }
+  busy = true;
+  if (esp_lcd_panel_io_tx_color(io, LCD_CMD_RAMWR, pixels, bytes) != ESP_OK) {
+    busy = false;
+    return false;
+  }
+  return true;
+}
+
+bool lcdI80Busy() {
+  return busy && uxSemaphoreGetCount(transferDone) == 0;
+}
+
+void lcdI80Wait() {
+  if (!busy) return;
+  // A full frame takes ~11 ms at 10 MHz; the timeout only guards a lost interrupt
+  if (xSemaphoreTake(transferDone, pdMS_TO_TICKS(100)) != pdTRUE) {
+    LOG_WARN("DISPLAY", "i80 transfer timeout");
+  }
+  busy = false;
+}
+
+#else
+
+bool lcdI80Begin(int16_t width, int16_t height, uint8_t rotation, size_t maxBytes) {
+  return false;
+}
+
+bool lcdI80Push(int16_t y0, int16_t y1, const uint16_t *pixels) {
+  return false;
+}
+
+bool lcdI80Busy() {
+  return false;
+}
+
+void lcdI80Wait() {
+}
+
+#endif // DISPLAY_I80_DMA
@@ -0,0 +1,59 @@
+#ifndef LCD_I80_H
+#define LCD_I80_H
+
+#include <Arduino.h>
+
+/**
+ * LcdI80.h - DMA transfers to the ST7789 over the ESP32-S3 LCD_CAM i80 bus
+ *
+ * TFT_eSPI drives the 8-bit parallel bus (TFT_D0..D7, TFT_WR) from the CPU,
+ * one GPIO write per byte. This backend takes over the same pins with the
+ * LCD_CAM peripheral after TFT_eSPI has initialised the panel, and sends
+ * pixel blocks by DMA: lcdI80Push() queues the transfer and returns, the
+ * CPU is free (webSocket.loop(), relays) until the panel has the frame.
+ *
+ * Only used for frame buffer presents (FrameBuffer.cpp); once started,
+ * nothing else may draw to the panel through TFT_eSPI.
+ */
+
+// Present the frame buffer by DMA (needs DISPLAY_FRAMEBUFFER=1)
+#ifndef DISPLAY_I80_DMA
+#define DISPLAY_I80_DMA 0
+#endif
+
+// Pixel clock of the i80 bus; the ST7789 write cycle allows ~15 MHz
+#ifndef DISPLAY_I80_PCLK_HZ
+#define DISPLAY_I80_PCLK_HZ 10000000
+#endif
+
+// DMA from PSRAM reads whole blocks: pixel data must start at a multiple of this
+static constexpr size_t LCD_I80_PSRAM_ALIGN = 64;
+
+/**
+ * Create the i80 bus and panel IO on the TFT_eSPI pins.
+ * @param width, height Panel size in the current rotation
+ * @param rotation tft rotation (0-3), for the panel RAM offsets
+ * @param maxBytes Largest single transfer (the frame size)
+ */
+bool lcdI80Begin(int16_t width, int16_t height, uint8_t rotation, size_t maxBytes);
+
+/**
+ * Queue a transfer of full-width rows y0..y1-1 and return immediately.
+ * Waits for the previous transfer first.
+ * @param pixels Row y0 of a width x height RGB565 frame in panel byte order,
+ *               LCD_I80_PSRAM_ALIGN aligned if in PSRAM
+ * @return false if the transfer could not be queued
+ */
+bool lcdI80Push(int16_t y0, int16_t y1, const uint16_t *pixels);
+
+/**
+ * True while a transfer is running.
+ */
+bool lcdI80Busy();
+
+/**
+ * Wait until the last transfer has finished (the frame may be drawn again).
+ */
+void lcdI80Wait();
+
+#endif // LCD_I80_H
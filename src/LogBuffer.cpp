@@ -0,0 +1,327 @@
+#include "Log.h"
+#include <atomic>
+#include <stdarg.h>
+#ifndef ZAPBOX_HOST
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Ring buffer size in records (power of two, 32 bytes each)
+#ifndef LOG_BUFFER_RECORDS
+#define LOG_BUFFER_RECORDS 128
+#endif
+
+// LOG_BINARY_OUTPUT=1: print records as "#L" hex lines instead of text,
+// decode them on the PC with host/logdecode.py
+#ifndef LOG_BINARY_OUTPUT
+#define LOG_BINARY_OUTPUT 0
+#endif
+
+// Text messages in flight at once, and their length limit
+#ifndef LOG_TEXT_SLOTS
+#define LOG_TEXT_SLOTS 64
+#endif
+#ifndef LOG_TEXT_LENGTH
+#define LOG_TEXT_LENGTH 160
+#endif
+
+static_assert((LOG_BUFFER_RECORDS & (LOG_BUFFER_RECORDS - 1)) == 0, "LOG_BUFFER_RECORDS must be a power of two");
+static_assert(LOG_TEXT_SLOTS > 0 && LOG_TEXT_SLOTS % 32 == 0, "LOG_TEXT_SLOTS must be a multiple of 32");
+
+static const unsigned long DRAIN_INTERVAL_MS = 20;
+
+namespace Log {
+
+struct Record {
+  // Slot ownership of a bounded MPMC queue (D. Vyukov), stored minus the
+  // slot index so the zero-initialized buffer is valid before setup() runs
+  std::atomic<uint32_t> sequence;
+  uint32_t timeMs;
+  uint8_t level;
+  uint8_t tag;
+  uint16_t format;
+  uint8_t argCount;
+  uint32_t args[LOG_RECORD_MAX_ARGS];
+};
+
+static const char* const tagNames[] = {
+#define LOG_TAG(id, name) name,
+#include "LogFormats.def"
+};
+
+static const char* const formatStrings[] = {
+#define LOG_FORMAT(id, format) format,
+#include "LogFormats.def"
+};
+
+// A text message; its record has format FORMAT_TEXT and the slot index as argument
+struct TextSlot {
+  char tag[16];
+  char message[LOG_TEXT_LENGTH];
+};
+
+static const uint16_t FORMAT_TEXT = 0xFFFF;
+
+static TextSlot textSlots[LOG_TEXT_SLOTS];
+static std::atomic<uint32_t> textSlotsBusy[LOG_TEXT_SLOTS / 32];  // Bit per slot, set until the drain has printed it
+
+static Record ring[LOG_BUFFER_RECORDS];
+static std::atomic<uint32_t> writeIndex(0);
+static std::atomic<uint32_t> droppedRecords(0);
+static uint32_t readIndex = 0;  // Only touched by the drain
+
+static uint32_t loadSequence(const Record& record, uint32_t slot) {
+  return record.sequence.load(std::memory_order_acquire) + slot;
+}
+
+static void storeSequence(Record& record, uint32_t slot, uint32_t sequence) {
+  record.sequence.store(sequence - slot, std::memory_order_release);
+}
+
+static bool push(Level lvl, uint8_t tag, uint16_t format, const uint32_t* args, uint8_t argCount) {
+  uint32_t position = writeIndex.load(std::memory_order_relaxed);
+  uint32_t slot;
+  while (true) {
+    slot = position & (LOG_BUFFER_RECORDS - 1);
+    uint32_t sequence = loadSequence(ring[slot], slot);
+    int32_t diff = (int32_t)(sequence - position);
+    if (diff == 0) {
+      if (writeIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      droppedRecords.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = writeIndex.load(std::memory_order_relaxed);
+    }
+  }
+
+  Record* record = &ring[slot];
+  record->timeMs = millis();
+  record->level = (uint8_t)lvl;
+  record->tag = tag;
+  record->format = format;
+  record->argCount = argCount;
+  for (uint8_t i = 0; i < argCount; i++) {
+    record->args[i] = args[i];
+  }
+  storeSequence(*record, slot, position + 1);
+
+#ifdef ZAPBOX_HOST
+  // No drain task on the host - print right away
+  drainRecords();
+#endif
+  return true;
+}
+
+void pushRecord(Level lvl, TagId tag, FormatId format, const uint32_t* args, uint8_t argCount) {
+  push(lvl, (uint8_t)tag, (uint16_t)format, args, argCount);
+}
+
+// Claim a free text slot, -1 if all are waiting for the drain
+static int claimTextSlot() {
+  for (int word = 0; word < LOG_TEXT_SLOTS / 32; word++) {
+    uint32_t busy = textSlotsBusy[word].load(std::memory_order_relaxed);
+    while (busy != 0xFFFFFFFFu) {
+      int bit = __builtin_ctz(~busy);
+      if (textSlotsBusy[word].compare_exchange_weak(busy, busy | (1u << bit), std::memory_order_acquire)) {
+        return word * 32 + bit;
+      }
+    }
+  }
+  droppedRecords.fetch_add(1, std::memory_order_relaxed);
+  return -1;
+}
+
+static void releaseTextSlot(uint32_t index) {
+  textSlotsBusy[index / 32].fetch_and(~(1u << (index % 32)), std::memory_order_release);
+}
+
+static void pushTextSlot(Level lvl, int index) {
+  uint32_t arg = (uint32_t)index;
+  if (!push(lvl, 0, FORMAT_TEXT, &arg, 1)) {
+    releaseTextSlot((uint32_t)index);
+  }
+}
+
+static void copyTag(TextSlot& slot, const char* tag) {
+  strncpy(slot.tag, tag ? tag : "", sizeof(slot.tag) - 1);
+  slot.tag[sizeof(slot.tag) - 1] = '\0';
+}
+
+void pushText(Level lvl, const char* tag, const char* message) {
+  int index = claimTextSlot();
+  if (index < 0) return;
+  TextSlot& slot = textSlots[index];
+  copyTag(slot, tag);
+  strncpy(slot.message, message ? message : "", sizeof(slot.message) - 1);
+  slot.message[sizeof(slot.message) - 1] = '\0';
+  pushTextSlot(lvl, index);
+}
+
+void printFormat(Level lvl, const char* tag, const char* format, ...) {
+  int index = claimTextSlot();
+  if (index < 0) return;
+  TextSlot& slot = textSlots[index];
+  copyTag(slot, tag);
+  va_list args;
+  va_start(args, format);
+  vsnprintf(slot.message, sizeof(slot.message), format, args);
+  va_end(args);
+  pushTextSlot(lvl, index);
+}
+
+// Expand format with the stored 32 bit arguments. Every conversion is
+// handed to snprintf on its own with the matching C type.
+static void formatRecord(char* out, size_t outSize, const char* format, const uint32_t* args, uint8_t argCount) {
+  size_t length = 0;
+  uint8_t argIndex = 0;
+  const char* p = format;
+
+  while (*p && length + 1 < outSize) {
+    if (*p != '%') {
+      out[length++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[length++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // Copy flags, width and precision; drop length modifiers
+    char spec[16];
+    size_t specLength = 0;
+    spec[specLength++] = *p++;
+    while (*p && strchr("-+ #0123456789.", *p) && specLength < sizeof(spec) - 3) {
+      spec[specLength++] = *p++;
+    }
+    while (*p == 'l' || *p == 'h') p++;
+    char conversion = *p ? *p++ : 'd';
+    spec[specLength++] = conversion;
+    spec[specLength] = '\0';
+
+    uint32_t value = argIndex < argCount ? args[argIndex] : 0;
+    argIndex++;
+
+    int written;
+    switch (conversion) {
+      case 'd': case 'i':
+        written = snprintf(out + length, outSize - length, spec, (int)(int32_t)value);
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+        float f;
+        memcpy(&f, &value, sizeof(f));
+        written = snprintf(out + length, outSize - length, spec, (double)f);
+        break;
+      }
+      default: // u, x, X, c
+        written = snprintf(out + length, outSize - length, spec, (unsigned int)value);
+        break;
+    }
+    if (written < 0) break;
+    length += (size_t)written;
+    if (length >= outSize) length = outSize - 1;
+  }
+  out[length] = '\0';
+}
+
+// Text messages print as text in both output modes (logdecode.py passes them through)
+static void printText(const Record& record) {
+  uint32_t index = record.args[0];
+  if (index >= LOG_TEXT_SLOTS) return;
+  const TextSlot& slot = textSlots[index];
+  if (slot.tag[0]) {
+    Serial.printf("[%s][%s] ", levelName((Level)record.level), slot.tag);
+  } else {
+    Serial.printf("[%s] ", levelName((Level)record.level));
+  }
+  Serial.printf("[+%lu.%lus] ", (unsigned long)(record.timeMs / 1000), (unsigned long)((record.timeMs % 1000) / 100));
+  Serial.println(slot.message);
+  releaseTextSlot(index);
+}
+
+static void printRecord(const Record& record) {
+  if (record.format == FORMAT_TEXT) {
+    printText(record);
+    return;
+  }
+#if LOG_BINARY_OUTPUT
+  Serial.printf("#L %08lx %x %02x %04x", (unsigned long)record.timeMs, record.level, record.tag, record.format);
+  for (uint8_t i = 0; i < record.argCount; i++) {
+    Serial.printf(" %08lx", (unsigned long)record.args[i]);
+  }
+  Serial.println();
+#else
+  char message[160];
+  const char* format = record.format < FMT_COUNT ? formatStrings[record.format] : "(unknown format)";
+  formatRecord(message, sizeof(message), format, record.args, record.argCount);
+  Serial.printf("[%s][%s] [+%lu.%lus] %s\n",
+                levelName((Level)record.level),
+                record.tag < TAG_COUNT ? tagNames[record.tag] : "?",
+                (unsigned long)(record.timeMs / 1000), (unsigned long)((record.timeMs % 1000) / 100),
+                message);
+#endif
+}
+
+static std::atomic<bool> draining(false);
+
+void drainRecords() {
+  // One drain at a time: the drain task, or a flush before sleep/config mode
+  if (draining.exchange(true, std::memory_order_acquire)) return;
+
+  while (true) {
+    uint32_t index = readIndex & (LOG_BUFFER_RECORDS - 1);
+    Record& slot = ring[index];
+    if (loadSequence(slot, index) != readIndex + 1) break;
+
+    Record record;
+    record.timeMs = slot.timeMs;
+    record.level = slot.level;
+    record.tag = slot.tag;
+    record.format = slot.format;
+    record.argCount = slot.argCount;
+    for (uint8_t i = 0; i < slot.argCount && i < LOG_RECORD_MAX_ARGS; i++) {
+      record.args[i] = slot.args[i];
+    }
+    // Release the slot before the slow Serial write
+    storeSequence(slot, index, readIndex + LOG_BUFFER_RECORDS);
+    readIndex++;
+
+    printRecord(record);
+  }
+
+  uint32_t dropped = droppedRecords.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0) {
+    Record notice;
+    notice.timeMs = millis();
+    notice.level = WARN;
+    notice.tag = TAG_Log;
+    notice.format = FMT_LOG_DROPPED;
+    notice.argCount = 1;
+    notice.args[0] = dropped;
+    printRecord(notice);
+  }
+  draining.store(false, std::memory_order_release);
+}
+
+#ifdef ZAPBOX_HOST
+
+void beginRecordDrain() {}
+
+#else
+
+static void drainTask(void* parameter) {
+  while (true) {
+    drainRecords();
+    vTaskDelay(pdMS_TO_TICKS(DRAIN_INTERVAL_MS));
+  }
+}
+
+void beginRecordDrain() {
+  // Lowest priority above idle, any core - printing never delays real work
+  xTaskCreate(drainTask, "LogDrain", 4096, nullptr, tskIDLE_PRIORITY + 1, nullptr);
+}
+
+#endif
+
+} // namespace Log
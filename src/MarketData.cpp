@@ -0,0 +1,252 @@
+#include "MarketData.h"
+#include "HttpsPool.h"
+#include "ApiResponse.h"
+#include "Log.h"
+
+struct SourceInfo {
+  const char* name;
+  HttpsHost slot;
+  const char* host;
+};
+
+static const SourceInfo sources[MARKET_SOURCE_COUNT] = {
+  {"coingecko",   HTTPS_HOST_COINGECKO,   "api.coingecko.com"},
+  {"mempool",     HTTPS_HOST_MEMPOOL,     "mempool.space"},
+  {"blockstream", HTTPS_HOST_BLOCKSTREAM, "blockstream.info"},
+};
+
+struct CachedValue {
+  bool valid = false;
+  float value = 0;
+  unsigned long updatedMs = 0;
+  MarketSource source = MARKET_SOURCE_COUNT;
+};
+
+// Tracked currencies (lower case) and their cached prices
+static char currencies[MARKET_MAX_CURRENCIES][6];
+static CachedValue prices[MARKET_MAX_CURRENCIES];
+static uint8_t currencyCount = 0;
+
+static CachedValue blockHeight;
+
+// Source order from the build flags; the last source that answered is moved to the front
+static MarketSource priceOrder[MARKET_SOURCE_COUNT];
+static uint8_t priceOrderCount = 0;
+static MarketSource heightOrder[MARKET_SOURCE_COUNT];
+static uint8_t heightOrderCount = 0;
+static bool initialized = false;
+
+// Parse "name,name" into sources; names not in supported are skipped
+static uint8_t parseSourceList(const char* list, const MarketSource* supported, uint8_t supportedCount,
+                               MarketSource* order) {
+  uint8_t count = 0;
+  const char* name = list;
+  while (*name) {
+    size_t length = strcspn(name, ",");
+    for (uint8_t i = 0; i < supportedCount; i++) {
+      const char* sourceName = sources[supported[i]].name;
+      if (strlen(sourceName) == length && strncasecmp(name, sourceName, length) == 0) {
+        bool duplicate = false;
+        for (uint8_t j = 0; j < count; j++) duplicate |= (order[j] == supported[i]);
+        if (!duplicate) order[count++] = supported[i];
+      }
+    }
+    name += length;
+    if (*name == ',') name++;
+  }
+  // Nothing usable configured - fall back to all supported sources
+  if (count == 0) {
+    memcpy(order, supported, supportedCount * sizeof(MarketSource));
+    count = supportedCount;
+  }
+  return count;
+}
+
+// Index of a tracked currency (any case), added if new; -1 if the list is full
+static int trackCurrency(const char* code, size_t length) {
+  if (length == 0 || length >= sizeof(currencies[0])) return -1;
+  for (uint8_t i = 0; i < currencyCount; i++) {
+    if (strlen(currencies[i]) == length && strncasecmp(currencies[i], code, length) == 0) return i;
+  }
+  if (currencyCount >= MARKET_MAX_CURRENCIES) return -1;
+  for (size_t i = 0; i < length; i++) currencies[currencyCount][i] = tolower((unsigned char)code[i]);
+  currencies[currencyCount][length] = '\0';
+  prices[currencyCount] = CachedValue();
+  return currencyCount++;
+}
+
+static void initialize() {
+  static const MarketSource priceSources[] = {MARKET_SOURCE_COINGECKO, MARKET_SOURCE_MEMPOOL};
+  static const MarketSource heightSources[] = {MARKET_SOURCE_MEMPOOL, MARKET_SOURCE_BLOCKSTREAM};
+  priceOrderCount = parseSourceList(MARKET_PRICE_SOURCES, priceSources, 2, priceOrder);
+  heightOrderCount = parseSourceList(MARKET_HEIGHT_SOURCES, heightSources, 2, heightOrder);
+
+  const char* code = MARKET_CURRENCIES;
+  while (*code) {
+    size_t length = strcspn(code, ",");
+    trackCurrency(code, length);
+    code += length;
+    if (*code == ',') code++;
+  }
+  initialized = true;
+}
+
+static void moveToFront(MarketSource* order, uint8_t index) {
+  MarketSource winner = order[index];
+  memmove(order + 1, order, index * sizeof(MarketSource));
+  order[0] = winner;
+}
+
+// All tracked prices from one source; true if the display currency was among them
+static bool fetchPrices(MarketSource source, int displayIndex) {
+  const SourceInfo& info = sources[source];
+  char keys[MARKET_MAX_CURRENCIES][6];
+  const char* keyList[MARKET_MAX_CURRENCIES];
+  char path[128];
+  const char* objectKey = nullptr;
+
+  if (source == MARKET_SOURCE_COINGECKO) {
+    // simple/price answers every requested currency in one object
+    int length = snprintf(path, sizeof(path), "/api/v3/simple/price?ids=bitcoin&vs_currencies=");
+    for (uint8_t i = 0; i < currencyCount; i++) {
+      length += snprintf(path + length, sizeof(path) - length, "%s%s", i ? "," : "", currencies[i]);
+    }
+    if (length >= (int)sizeof(path)) return false;
+    objectKey = "bitcoin";
+  } else {
+    // mempool.space always returns its full table (USD, EUR, GBP, CAD, CHF, AUD, JPY)
+    snprintf(path, sizeof(path), "/api/v1/prices");
+  }
+  for (uint8_t i = 0; i < currencyCount; i++) {
+    strcpy(keys[i], currencies[i]);
+    if (source == MARKET_SOURCE_MEMPOOL) {
+      for (char* c = keys[i]; *c; c++) *c = toupper((unsigned char)*c);
+    }
+    keyList[i] = keys[i];
+  }
+
+  float fetched[MARKET_MAX_CURRENCIES];
+  uint8_t found = 0;
+  int httpCode = httpsGet(info.slot, info.host, path, 5000);
+  if (httpCode == 200) {
+    found = parseBitcoinPrices(httpsBody(info.slot), objectKey, keyList, currencyCount, fetched);
+  }
+  httpsEnd(info.slot);
+  if (found == 0) {
+    LOG_WARN("BTC", String("No prices from ") + info.name + " (HTTP " + httpCode + ")");
+    return false;
+  }
+
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < currencyCount; i++) {
+    if (isnan(fetched[i])) continue;
+    prices[i].valid = true;
+    prices[i].value = fetched[i];
+    prices[i].updatedMs = now;
+    prices[i].source = source;
+  }
+  LOG_DEBUG("BTC", String(found) + " prices from " + info.name);
+  return displayIndex >= 0 && !isnan(fetched[displayIndex]);
+}
+
+// A lagging source must not move the height back by more than a reorg
+static bool storeBlockHeight(uint32_t height, MarketSource source) {
+  if (height == 0 || (blockHeight.valid && height + 6 < (uint32_t)blockHeight.value)) return false;
+  blockHeight.valid = true;
+  blockHeight.value = (float)height;
+  blockHeight.updatedMs = millis();
+  blockHeight.source = source;
+  return true;
+}
+
+static bool fetchBlockHeight(MarketSource source) {
+  const SourceInfo& info = sources[source];
+  uint32_t height = 0;
+  int httpCode = httpsGet(info.slot, info.host, "/api/blocks/tip/height", 5000);
+  if (httpCode == 200) {
+    String body = httpsBodyString(info.slot);
+    body.trim();
+    char* end = nullptr;
+    height = strtoul(body.c_str(), &end, 10);
+    if (body.length() == 0 || *end != '\0') height = 0;
+  }
+  httpsEnd(info.slot);
+
+  if (!storeBlockHeight(height, source)) {
+    LOG_WARN("BTC", String("No valid block height from ") + info.name + " (HTTP " + httpCode + ")");
+    return false;
+  }
+  return true;
+}
+
+bool marketDataRefreshPrices(const char* displayCurrency) {
+  if (!initialized) initialize();
+  int displayIndex = trackCurrency(displayCurrency, strlen(displayCurrency));
+
+  for (uint8_t i = 0; i < priceOrderCount; i++) {
+    if (fetchPrices(priceOrder[i], displayIndex)) {
+      moveToFront(priceOrder, i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool marketDataRefreshBlockHeight() {
+  if (!initialized) initialize();
+  for (uint8_t i = 0; i < heightOrderCount; i++) {
+    if (fetchBlockHeight(heightOrder[i])) {
+      moveToFront(heightOrder, i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool marketDataRefresh(const char* displayCurrency) {
+  bool priceOk = marketDataRefreshPrices(displayCurrency);
+  bool heightOk = marketDataRefreshBlockHeight();
+  return priceOk && heightOk;
+}
+
+static MarketValue toMarketValue(const CachedValue& cached) {
+  MarketValue result = {false, cached.value, 0, cached.source};
+  if (cached.valid) {
+    result.ageMs = millis() - cached.updatedMs;
+    result.valid = result.ageMs < MARKET_DATA_MAX_AGE_MS;
+  }
+  return result;
+}
+
+MarketValue marketDataPrice(const char* currency) {
+  for (uint8_t i = 0; i < currencyCount; i++) {
+    if (strcasecmp(currencies[i], currency) == 0) return toMarketValue(prices[i]);
+  }
+  return toMarketValue(CachedValue());
+}
+
+MarketValue marketDataBlockHeight() {
+  return toMarketValue(blockHeight);
+}
+
+uint8_t marketDataCurrencies(const char* codes[MARKET_MAX_CURRENCIES]) {
+  if (!initialized) initialize();
+  for (uint8_t i = 0; i < currencyCount; i++) codes[i] = currencies[i];
+  return currencyCount;
+}
+
+void marketDataSetPrice(const char* currency, float price, MarketSource source) {
+  if (!(price > 0)) return;
+  for (uint8_t i = 0; i < currencyCount; i++) {
+    if (strcasecmp(currencies[i], currency) != 0) continue;
+    prices[i].valid = true;
+    prices[i].value = price;
+    prices[i].updatedMs = millis();
+    prices[i].source = source;
+    return;
+  }
+}
+
+bool marketDataSetBlockHeight(uint32_t height, MarketSource source) {
+  return storeBlockHeight(height, source);
+}
@@ -0,0 +1,102 @@
+#ifndef MARKET_DATA_H
+#define MARKET_DATA_H
+
+#include <Arduino.h>
+
+/**
+ * MarketData.h - BTC price and block height service
+ *
+ * One place for all market data fetches (ticker refresh, Internet
+ * recovery, currency change):
+ * - The prices of all tracked currencies (MARKET_CURRENCIES plus the
+ *   current display currency) come from a single request, so a currency
+ *   change from LNbits can be shown from the cache right away.
+ * - Every value has fallback sources (MARKET_PRICE_SOURCES,
+ *   MARKET_HEIGHT_SOURCES). The first source with a valid answer wins and
+ *   is asked first next time, so a failing API costs one timeout only
+ *   until another source has answered.
+ * - Values are cached with the time they were fetched. A failed refresh
+ *   keeps the last good value; it only expires after MARKET_DATA_MAX_AGE_MS.
+ */
+
+// Tracked currencies (lower case, comma separated), besides the display currency
+#ifndef MARKET_CURRENCIES
+#define MARKET_CURRENCIES "usd,eur,chf"
+#endif
+
+// Source order (comma separated): coingecko, mempool
+#ifndef MARKET_PRICE_SOURCES
+#define MARKET_PRICE_SOURCES "coingecko,mempool"
+#endif
+
+// Source order (comma separated): mempool, blockstream
+#ifndef MARKET_HEIGHT_SOURCES
+#define MARKET_HEIGHT_SOURCES "mempool,blockstream"
+#endif
+
+// Cached values older than this are no longer shown
+#ifndef MARKET_DATA_MAX_AGE_MS
+#define MARKET_DATA_MAX_AGE_MS 3600000
+#endif
+
+static constexpr uint8_t MARKET_MAX_CURRENCIES = 8;
+
+enum MarketSource : uint8_t {
+  MARKET_SOURCE_COINGECKO,
+  MARKET_SOURCE_MEMPOOL,
+  MARKET_SOURCE_BLOCKSTREAM,
+  MARKET_SOURCE_COUNT
+};
+
+// A cached value: valid once fetched, ageMs since the fetch
+struct MarketValue {
+  bool valid;
+  float value;
+  unsigned long ageMs;
+  MarketSource source;
+};
+
+/**
+ * Fetch the prices of all tracked currencies and the block height,
+ * each from the first source that answers. Blocks for the requests.
+ * @param displayCurrency Currency shown on the ticker (any case), always fetched
+ * @return true if price and block height were both refreshed
+ */
+bool marketDataRefresh(const char* displayCurrency);
+
+/**
+ * Only the price or only the block height part of marketDataRefresh()
+ * (the other value may be pushed, see MarketFeed.h).
+ */
+bool marketDataRefreshPrices(const char* displayCurrency);
+bool marketDataRefreshBlockHeight();
+
+/**
+ * Cached price of a currency (any case); invalid if never fetched or
+ * older than MARKET_DATA_MAX_AGE_MS.
+ */
+MarketValue marketDataPrice(const char* currency);
+
+/**
+ * Cached block height, same expiry as the prices.
+ */
+MarketValue marketDataBlockHeight();
+
+/**
+ * Tracked currency codes (lower case), for sources that push prices.
+ * @return Number of codes written to codes
+ */
+uint8_t marketDataCurrencies(const char* codes[MARKET_MAX_CURRENCIES]);
+
+/**
+ * Store a pushed price; only currencies in marketDataCurrencies() are kept.
+ */
+void marketDataSetPrice(const char* currency, float price, MarketSource source);
+
+/**
+ * Store a pushed block height.
+ * @return false if rejected (more than a reorg behind the cached height)
+ */
+bool marketDataSetBlockHeight(uint32_t height, MarketSource source);
+
+#endif // MARKET_DATA_H
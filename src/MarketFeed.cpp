@@ -0,0 +1,117 @@
+#include "MarketFeed.h"
+#include <WebSocketsClient.h>
+#include "MarketData.h"
+#include "ApiResponse.h"
+#include "Log.h"
+
+static bool live = false;
+static bool updatePending = false;
+static MarketFeedStats stats = {};
+
+#if MARKET_FEED_ENABLED
+
+// Between reconnect attempts (each one blocks the loop for the TCP/TLS connect)
+static const unsigned long FEED_RECONNECT_MS = 60000;
+
+static WebSocketsClient feedSocket;
+static bool started = false;
+
+static void handleMessage(const char* json, size_t length) {
+  stats.messages++;
+
+  const char* codes[MARKET_MAX_CURRENCIES];
+  uint8_t count = marketDataCurrencies(codes);
+  char keys[MARKET_MAX_CURRENCIES][6];
+  const char* keyList[MARKET_MAX_CURRENCIES];
+  for (uint8_t i = 0; i < count; i++) {
+    // The feed's conversion table uses upper case keys
+    size_t j = 0;
+    for (; codes[i][j] && j < sizeof(keys[i]) - 1; j++) keys[i][j] = toupper((unsigned char)codes[i][j]);
+    keys[i][j] = '\0';
+    keyList[i] = keys[i];
+  }
+
+  uint32_t height;
+  float prices[MARKET_MAX_CURRENCIES];
+  if (!parseMarketFeedMessage(json, length, keyList, count, height, prices)) return;
+
+  if (height != 0 && marketDataSetBlockHeight(height, MARKET_SOURCE_MEMPOOL)) {
+    stats.blocks++;
+    stats.lastPushMs = millis();
+    updatePending = true;
+    LOG_REC_INFO(Feed, FEED_BLOCK, height);
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if (isnan(prices[i])) continue;
+    marketDataSetPrice(codes[i], prices[i], MARKET_SOURCE_MEMPOOL);
+    stats.lastPushMs = millis();
+    updatePending = true;
+  }
+}
+
+static void onFeedEvent(WStype_t type, uint8_t* payload, size_t length) {
+  switch (type) {
+  case WStype_CONNECTED:
+    stats.connects++;
+    live = true;
+    feedSocket.sendTXT("{\"action\":\"want\",\"data\":[\"blocks\"]}");
+    LOG_REC_INFO(Feed, FEED_CONNECTED, stats.connects);
+    break;
+  case WStype_DISCONNECTED:
+    if (live) {
+      LOG_INFO("FEED", "Disconnected - ticker falls back to polling");
+    }
+    live = false;
+    break;
+  case WStype_TEXT:
+    handleMessage((const char*)payload, length);
+    break;
+  default:
+    break;
+  }
+}
+
+void marketFeedLoop(bool networkUp) {
+  if (!networkUp) {
+    if (live) {
+      feedSocket.disconnect();
+      live = false;
+    }
+    return;  // Not serviced: no reconnect attempts while offline
+  }
+  if (!started) {
+#if MARKET_FEED_TLS
+    feedSocket.beginSSL(MARKET_FEED_HOST, MARKET_FEED_PORT, MARKET_FEED_PATH);
+#else
+    feedSocket.begin(MARKET_FEED_HOST, MARKET_FEED_PORT, MARKET_FEED_PATH);
+#endif
+    feedSocket.onEvent(onFeedEvent);
+    feedSocket.setReconnectInterval(FEED_RECONNECT_MS + esp_random() % 10000);
+    // A silently dead connection is dropped after two missed pongs
+    feedSocket.enableHeartbeat(30000, 5000, 2);
+    started = true;
+  }
+  feedSocket.loop();
+}
+
+#else
+
+void marketFeedLoop(bool networkUp) {
+  (void)networkUp;
+}
+
+#endif // MARKET_FEED_ENABLED
+
+bool marketFeedLive() {
+  return live;
+}
+
+bool marketFeedTakeUpdate() {
+  bool pending = updatePending;
+  updatePending = false;
+  return pending;
+}
+
+MarketFeedStats marketFeedStats() {
+  return stats;
+}
@@ -0,0 +1,68 @@
+#ifndef MARKET_FEED_H
+#define MARKET_FEED_H
+
+#include <Arduino.h>
+
+/**
+ * MarketFeed.h - Push-based block height / price feed
+ *
+ * Optional (-DMARKET_FEED_ENABLED=1): holds one WebSocket to a feed that
+ * speaks the mempool.space /api/v1/ws protocol, subscribes to new blocks
+ * and stores every pushed block height (and price table, if the server
+ * sends one) in the MarketData cache. While the feed is connected the
+ * ticker shows a new block within seconds and no longer polls the block
+ * height; the price is still polled at the normal interval unless the
+ * feed pushed a fresher one. When the feed drops, polling takes over again
+ * until it is back.
+ *
+ * Local stand-in for testing: run host/feed_standin.py and build with
+ *   -DMARKET_FEED_HOST='"192.168.1.10"' -DMARKET_FEED_PORT=8999 -DMARKET_FEED_TLS=0
+ */
+
+#ifndef MARKET_FEED_ENABLED
+#define MARKET_FEED_ENABLED 0
+#endif
+
+#ifndef MARKET_FEED_HOST
+#define MARKET_FEED_HOST "mempool.space"
+#endif
+
+#ifndef MARKET_FEED_PORT
+#define MARKET_FEED_PORT 443
+#endif
+
+#ifndef MARKET_FEED_PATH
+#define MARKET_FEED_PATH "/api/v1/ws"
+#endif
+
+#ifndef MARKET_FEED_TLS
+#define MARKET_FEED_TLS 1
+#endif
+
+struct MarketFeedStats {
+  uint32_t connects;          // Successful connections
+  uint32_t messages;          // Text messages received
+  uint32_t blocks;            // Block heights accepted
+  unsigned long lastPushMs;   // millis() of the last accepted value (0 = none)
+};
+
+/**
+ * Service the feed; call every loop() iteration. Connects on the first
+ * call with networkUp, reconnects on its own while networkUp stays true.
+ * @param networkUp Internet reachable and the ticker enabled
+ */
+void marketFeedLoop(bool networkUp);
+
+/**
+ * True while the feed is connected and subscribed (block height is pushed).
+ */
+bool marketFeedLive();
+
+/**
+ * True once after the feed stored a new value in the MarketData cache.
+ */
+bool marketFeedTakeUpdate();
+
+MarketFeedStats marketFeedStats();
+
+#endif // MARKET_FEED_H
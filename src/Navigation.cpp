@@ -33,7 +33,6 @@ extern void showQRScreen();
 extern void showProductQRScreen(String label, int displayPin);
 extern void showSpecialModeQRScreen();
 extern void btctickerScreen();
-extern void deactivateScreensaver();
 extern void configMode();
 extern void reportMode();
 extern void showHelp();
@@ -50,15 +49,15 @@ void navigateToNextProduct() {
   
   LOG_INFO("Navigation", "Navigate button pressed");
   
-  if (multiChannelConfig.mode == "off") {
+  if (multiChannelConfig.mode == ChannelMode::SINGLE) {
     // Single mode behavior depends on multiChannelConfig.btcTickerMode
-    if (multiChannelConfig.btcTickerMode == "always") {
+    if (multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
       // Toggle between ticker and product QR when always mode is on
       if (multiChannelConfig.btcTickerActive) {
         LOG_INFO("Navigation", "Single mode ALWAYS - Switching from ticker to QR");
         multiChannelConfig.btcTickerActive = false;
         ensureQrForPin(12);
-        if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+        if (specialModeConfig.mode != SpecialMode::STANDARD) {
           showSpecialModeQRScreen();
         } else {
           showQRScreen();
@@ -70,13 +69,13 @@ void navigateToNextProduct() {
         multiChannelConfig.btcTickerActive = true;
         productSelectionState.showTime = 0; // Reset timer (ticker has no timeout)
       }
-    } else if (multiChannelConfig.btcTickerMode == "selecting") {
+    } else if (multiChannelConfig.btcTickerMode == TickerMode::SELECTING) {
       if (multiChannelConfig.btcTickerActive) {
         // Already showing ticker - skip back to QR immediately
         LOG_INFO("Navigation", "Single mode SELECTING - Skipping from ticker to QR");
         multiChannelConfig.btcTickerActive = false;
         ensureQrForPin(12);
-        if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+        if (specialModeConfig.mode != SpecialMode::STANDARD) {
           showSpecialModeQRScreen();
         } else {
           showQRScreen();
@@ -104,23 +103,23 @@ void navigateToNextProduct() {
     // If ticker is active, go back to first product
     multiChannelConfig.btcTickerActive = false;
     multiChannelConfig.currentProduct = 1;
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     LOG_INFO("Navigation", "Ticker active - returning to first product");
   } else {
     multiChannelConfig.currentProduct++;
   }
   
   // Determine navigation behavior based on multiChannelConfig.btcTickerMode
-  if (multiChannelConfig.btcTickerMode == "selecting") {
+  if (multiChannelConfig.btcTickerMode == TickerMode::SELECTING) {
     // SELECTING mode: After last product, show BTC ticker (which will auto-return to product selection)
-    if (multiChannelConfig.mode == "duo" && multiChannelConfig.currentProduct > 2) {
+    if (multiChannelConfig.mode == ChannelMode::DUO && multiChannelConfig.currentProduct > 2) {
       multiChannelConfig.currentProduct = 0; // Reset for next navigation
       btctickerScreen();
       multiChannelConfig.btcTickerActive = true;
       productSelectionState.showTime = millis(); // Start timer for auto-return
       LOG_INFO("Navigation", "SELECTING mode - Showing Bitcoin ticker after last product");
       return;
-    } else if (multiChannelConfig.mode == "quattro" && multiChannelConfig.currentProduct > 4) {
+    } else if (multiChannelConfig.mode == ChannelMode::QUATTRO && multiChannelConfig.currentProduct > 4) {
       multiChannelConfig.currentProduct = 0; // Reset for next navigation
       btctickerScreen();
       multiChannelConfig.btcTickerActive = true;
@@ -130,9 +129,9 @@ void navigateToNextProduct() {
     }
   } else {
     // ALWAYS or OFF mode: Loop back to first product
-    if (multiChannelConfig.mode == "duo" && multiChannelConfig.currentProduct > 2) {
+    if (multiChannelConfig.mode == ChannelMode::DUO && multiChannelConfig.currentProduct > 2) {
       multiChannelConfig.currentProduct = 1; // Loop back to first product
-    } else if (multiChannelConfig.mode == "quattro" && multiChannelConfig.currentProduct > 4) {
+    } else if (multiChannelConfig.mode == ChannelMode::QUATTRO && multiChannelConfig.currentProduct > 4) {
       multiChannelConfig.currentProduct = 1; // Loop back to first product
     }
   }
@@ -140,7 +139,7 @@ void navigateToNextProduct() {
   LOG_INFO("Navigation", String("Navigate to product: ") + String(multiChannelConfig.currentProduct));
   
   // IMPORTANT: Disable product selection screen FIRST to prevent concurrent screen updates
-  deviceState.transition(DeviceState::READY);
+  deviceState.dispatch(DeviceEvent::SHOW_READY);
   
   // Small delay to ensure any ongoing display operation completes
   vTaskDelay(pdMS_TO_TICKS(50));
@@ -169,7 +168,7 @@ void navigateToNextProduct() {
     
     // Get label from array, or use fallback
     int pinIndex = getPinIndex(pin);
-    if (pinIndex >= 0 && productLabels.labels[pinIndex].length() > 0) {
+    if (pinIndex >= 0 && productLabels.labels[pinIndex][0] != '\0') {
       label = productLabels.labels[pinIndex];
     } else {
       label = "Pin " + String(pin);
@@ -202,7 +201,7 @@ void handleTouchButton()
       
       // This is the second click - switch from Help to Report
       LOG_INFO("Touch", "Second click during Help -> Switching to Report Mode");
-      deviceState.transition(DeviceState::REPORT_SCREEN); // Abort Help
+      deviceState.dispatch(DeviceEvent::OPEN_REPORT); // Abort Help
       touchState.clickCount = 0; // Reset
       
       // Check for Config mode (display touch)
@@ -212,7 +211,7 @@ void handleTouchButton()
         bool isMainAreaTouch = false;
         
         // Touch area detection based on displayConfig.orientation
-        if (displayConfig.orientation == "v" || displayConfig.orientation == "vi") {
+        if (displayConfig.layout.vertical) {
           isMainAreaTouch = (mainTouchY <= 305);
         } else {
           isMainAreaTouch = (mainTouchX <= 145);
@@ -238,7 +237,7 @@ void handleTouchButton()
   if (deviceState.isInState(DeviceState::REPORT_SCREEN)) {
     if (digitalRead(PIN_TOUCH_INT) == LOW && !touchState.pressed) {
       LOG_INFO("Touch", "Button press during Report - ABORTING");
-      deviceState.transition(DeviceState::READY);
+      deviceState.dispatch(DeviceEvent::SHOW_READY);
       touchState.pressed = true;
     }
     else if (digitalRead(PIN_TOUCH_INT) == HIGH && touchState.pressed) {
@@ -306,8 +305,7 @@ void handleTouchButton()
     // FIRST: Wake from powerConfig.screensaver if active (regardless of touch location)
     if (deviceState.isInState(DeviceState::SCREENSAVER)) {
       LOG_DEBUG("Touch", String("Display touched at X=") + String(touchX) + String(" Y=") + String(touchY) + String(" during screensaver - WAKING UP"));
-      deviceState.transition(DeviceState::READY);
-      deactivateScreensaver();
+      deviceState.dispatch(DeviceEvent::SHOW_READY);
       powerConfig.lastWakeUpTime = millis();
       activityTracking.lastActivityTime = millis();
       // Don't process button click, just wake up
@@ -320,7 +318,7 @@ void handleTouchButton()
       return;
     }
     
-    LOG_DEBUG("Touch", String("Button area touched at X=") + String(touchX) + String(" Y=") + String(touchY) + String(" (orientation=") + displayConfig.orientation + String(")"));
+    LOG_DEBUG("Touch", String("Button area touched at X=") + String(touchX) + String(" Y=") + String(touchY) + String(" (orientation=") + orientationValues[(uint8_t)displayConfig.orientation] + String(")"));
     
     // Touch button pressed
     touchState.pressed = true;
@@ -353,7 +351,7 @@ void handleTouchButton()
     if (touchState.clickCount == 4) {
       // Fourth click within timeout -> Config Mode (IMMEDIATE, no waiting)
       LOG_INFO("Touch", "Fourth click -> Config Mode");
-      deviceState.transition(DeviceState::READY);  // Reset state before entering config
+      deviceState.dispatch(DeviceEvent::SHOW_READY);  // Reset state before entering config
       configMode();
       touchState.clickCount = 0;
     }
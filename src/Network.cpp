@@ -5,22 +5,22 @@
 #include "DeviceState.h"
 #include "GlobalState.h"
 #include "Display.h"
+#include "PaymentQueue.h"
+#include "API.h"
+#include "ConnectivityProbe.h"
 #include "Log.h"
 
 // Externals from main.cpp
 extern StateManager deviceState;
 extern String lnbitsServer;
-extern String payloadStr;
 extern WebSocketsClient webSocket;
 extern byte currentErrorType;
 extern bool needsQRRedraw;
-extern void fetchBitcoinData();
-extern void fetchSwitchLabels();
 
 // WebSocket event handler
 void webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
 {
-  LOG_DEBUG("WebSocket", String("Event Type: ") + String(type) + String(" ConfigMode: ") + String((int)deviceState.isInState(DeviceState::CONFIG_MODE)));
+  LOG_REC_DEBUG(WebSocket, WS_EVENT, type, deviceState.isInState(DeviceState::CONFIG_MODE));
   
   if (!deviceState.isInState(DeviceState::CONFIG_MODE))
   {
@@ -28,6 +28,7 @@ void webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
     {
     case WStype_DISCONNECTED:
       LOG_INFO("WebSocket", "Disconnected");
+      connectivityReportWebSocket(false);
       break;
     case WStype_CONNECTED:
     {
@@ -36,6 +37,7 @@ void webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
       networkStatus.lastPongTime = millis(); // Reset pong timer on connect
       networkStatus.waitingForPong = false;
       networkStatus.confirmed.websocket = true; // Mark WebSocket as confirmed on first connect
+      connectivityReportWebSocket(true);
       LOG_INFO("WebSocket", "Connection confirmed!");
       
       // Fetch switch labels from backend after successful connection
@@ -44,16 +46,18 @@ void webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
     break;
     case WStype_TEXT:
       LOG_DEBUG("WebSocket", String("Received: ") + String((char*)payload));
-      payloadStr = (char *)payload;
-      LOG_DEBUG("WebSocket", String("PayloadStr set to: ") + payloadStr);
-      paymentStatus.paid = true;
-      LOG_INFO("WebSocket", "'paymentStatus.paid' flag set to TRUE");
+      if (paymentQueuePush((const char *)payload, length)) {
+        LOG_REC_INFO(WebSocket, WS_PAYMENT_QUEUED, paymentQueueCount());
+      } else {
+        PaymentQueueStats stats = paymentQueueStats();
+        LOG_REC_ERROR(WebSocket, WS_PAYMENT_DROPPED, stats.overflows, stats.oversized);
+      }
       break;
     case WStype_PING:
-      LOG_DEBUG("WebSocket", "Ping received");
+      LOG_REC_DEBUG(WebSocket, WS_PING);
       break;
     case WStype_PONG:
-      LOG_DEBUG("WebSocket", "Pong received - connection alive");
+      LOG_REC_DEBUG(WebSocket, WS_PONG);
       networkStatus.lastPongTime = millis();
       networkStatus.waitingForPong = false;
       break;
@@ -75,6 +79,7 @@ void webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
 
 // HTTP-based Internet check (doesn't require WebSocket connection)
 // Tries multiple times to account for DNS/DHCP stabilization delays
+// Blocks up to ~10 s - only called by the connectivity probe task
 bool checkInternetConnectivity()
 {
   HTTPClient http;
@@ -111,6 +116,7 @@ bool checkInternetConnectivity()
 }
 
 // TCP-based Server reachability check (test if LNbits server port is open)
+// Blocks up to 2 s - only called by the connectivity probe task
 bool checkServerReachability()
 {
   WiFiClient client;
@@ -158,7 +164,7 @@ void checkAndReconnectWiFi()
     
     if (!deviceState.isInState(DeviceState::ERROR_RECOVERABLE)) {
       // Only show error screen if not already showing one
-      deviceState.transition(DeviceState::ERROR_RECOVERABLE);
+      deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
       currentErrorType = 1; // WiFi error (highest priority)
       wifiReconnectScreen();
     }
@@ -182,14 +188,14 @@ void checkAndReconnectWiFi()
     // WiFi recovered while on error screen
     LOG_INFO("Network", "WiFi recovered");
     networkStatus.confirmed.wifi = true;
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     currentErrorType = 0;
     needsQRRedraw = true;
     activityTracking.lastActivityTime = millis();
     productSelectionState.showTime = millis();
     
     // Force BTC data refresh after WiFi recovery
-    if (multiChannelConfig.btcTickerMode != "off") {
+    if (multiChannelConfig.btcTickerMode != TickerMode::OFF) {
       LOG_INFO("Network", "Forcing BTC data refresh after WiFi recovery");
       bitcoinData.lastUpdate = 0; // Force immediate update
       fetchBitcoinData(); // Fetch data now
@@ -7,7 +7,8 @@
 // WebSocket event handler
 void webSocketEvent(WStype_t type, uint8_t *payload, size_t length);
 
-// Network connectivity checks
+// Network connectivity checks (blocking - run by the probe task in
+// ConnectivityProbe.cpp; everything else reads connectivitySnapshot())
 bool checkInternetConnectivity();
 bool checkServerReachability();
 
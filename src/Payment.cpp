@@ -1,127 +1,58 @@
 #include <Arduino.h>
 #include "GlobalState.h"
 #include "Payment.h"
+#include "Bech32.h"
 #include "Log.h"
-#include <vector>
 
 // Access configuration provided in main.cpp
 extern String lnbitsServer;
 extern String deviceId;
-extern String qrFormat; // "bech32" or "lud17"
+extern QrFormat qrFormat;
 
-// Bech32 encoding helpers (copied from main.cpp to isolate payment logic)
-static uint32_t bech32Polymod(const std::vector<uint8_t>& values) {
-  uint32_t chk = 1;
-  for (size_t i = 0; i < values.size(); ++i) {
-    uint8_t top = chk >> 25;
-    chk = (chk & 0x1ffffff) << 5 ^ values[i];
-    if (top & 1) chk ^= 0x3b6a57b2;
-    if (top & 2) chk ^= 0x26508e6d;
-    if (top & 4) chk ^= 0x1ea119fa;
-    if (top & 8) chk ^= 0x3d4233dd;
-    if (top & 16) chk ^= 0x2a1462b3;
+// Write the QR payload for a pin into out: "lightning:" + bech32 LNURL, or the
+// lnurlp:// URL for LUD17. No heap allocation.
+bool generateLNURLInto(int pin, char* out, size_t outSize) {
+  if (lnbitsServer.length() == 0 || deviceId.length() == 0) {
+    LOG_WARN("LNURL", "Cannot generate - server or deviceId not configured");
+    return false;
   }
-  return chk;
-}
 
-static std::vector<uint8_t> bech32HrpExpand(const String& hrp) {
-  std::vector<uint8_t> ret;
-  ret.reserve(hrp.length() * 2 + 1);
-  for (size_t i = 0; i < hrp.length(); ++i) {
-    ret.push_back(hrp[i] >> 5);
-  }
-  ret.push_back(0);
-  for (size_t i = 0; i < hrp.length(); ++i) {
-    ret.push_back(hrp[i] & 31);
+  // Build URL: https://{server}/bitcoinswitch/api/v1/lnurl/{deviceId}?pin={pin}
+  // (LUD17: lnurlp://... instead of https://...)
+  bool lud17 = (qrFormat == QrFormat::LUD17);
+  char url[200];
+  int urlLen = snprintf(url, sizeof(url), "%s://%s/bitcoinswitch/api/v1/lnurl/%s?pin=%d",
+                        lud17 ? "lnurlp" : "https", lnbitsServer.c_str(), deviceId.c_str(), pin);
+  if (urlLen <= 0 || (size_t)urlLen >= sizeof(url)) {
+    LOG_WARN("LNURL", "URL too long");
+    return false;
   }
-  return ret;
-}
 
-static std::vector<uint8_t> convertBits(const uint8_t* data, size_t len, int frombits, int tobits, bool pad) {
-  std::vector<uint8_t> ret;
-  int acc = 0;
-  int bits = 0;
-  int maxv = (1 << tobits) - 1;
-  for (size_t i = 0; i < len; i++) {
-    int value = data[i];
-    acc = (acc << frombits) | value;
-    bits += frombits;
-    while (bits >= tobits) {
-      bits -= tobits;
-      ret.push_back((acc >> bits) & maxv);
-    }
-  }
-  if (pad) {
-    if (bits > 0) {
-      ret.push_back((acc << (tobits - bits)) & maxv);
+  size_t prefixLen = strlen(wifiConfig.lightningPrefix);
+  if (prefixLen + 1 > outSize) return false;
+  memcpy(out, wifiConfig.lightningPrefix, prefixLen + 1);
+
+  if (!lud17) {
+    // BECH32 format (default)
+    if (bech32Encode("lnurl", (const uint8_t*)url, (size_t)urlLen, out + prefixLen, outSize - prefixLen) > 0) {
+      return true;
     }
-  } else if (bits >= frombits || ((acc << (tobits - bits)) & maxv)) {
-    return std::vector<uint8_t>();
+    LOG_WARN("LNURL", "BECH32 encoding failed, falling back to URL format");
   }
-  return ret;
-}
 
-static String encodeBech32(const String& data) {
-  String hrp = "lnurl";
-  // Convert data to bytes (keep original case)
-  std::vector<uint8_t> dataBytes;
-  for (size_t i = 0; i < data.length(); i++) {
-    dataBytes.push_back((uint8_t)data[i]);
-  }
-  // Convert from 8-bit to 5-bit
-  std::vector<uint8_t> data5bit = convertBits(dataBytes.data(), dataBytes.size(), 8, 5, true);
-  if (data5bit.empty()) {
-    return "";
-  }
-  // Calculate checksum
-  std::vector<uint8_t> combined = bech32HrpExpand(hrp);
-  combined.insert(combined.end(), data5bit.begin(), data5bit.end());
-  combined.insert(combined.end(), 6, 0);
-  uint32_t polymod = bech32Polymod(combined) ^ 1;  // XOR with 1 for Bech32 (not Bech32m)
-  std::vector<uint8_t> checksum;
-  for (int i = 0; i < 6; ++i) {
-    checksum.push_back((polymod >> (5 * (5 - i))) & 31);
-  }
-  // Build final string
-  String result = hrp + "1";
-  for (size_t i = 0; i < data5bit.size(); i++) {
-    result += BECH32_CHARSET[data5bit[i]];
-  }
-  for (size_t i = 0; i < checksum.size(); i++) {
-    result += BECH32_CHARSET[checksum[i]];
-  }
-  // Convert to uppercase for LNURL standard
-  result.toUpperCase();
-  return result;
+  if (prefixLen + (size_t)urlLen + 1 > outSize) return false;
+  memcpy(out + prefixLen, url, (size_t)urlLen + 1);
+  return true;
 }
 
 // Generate LNURL for a given pin
 String generateLNURL(int pin) {
-  if (lnbitsServer.length() == 0 || deviceId.length() == 0) {
-    LOG_WARN("LNURL", "Cannot generate - server or deviceId not configured");
+  char payload[sizeof(lightningConfig.lightning)];
+  if (!generateLNURLInto(pin, payload, sizeof(payload))) {
     return "";
   }
-  // Build URL: https://{server}/bitcoinswitch/api/v1/lnurl/{deviceId}?pin={pin}
-  String url = "https://" + lnbitsServer + "/bitcoinswitch/api/v1/lnurl/" + deviceId + "?pin=" + String(pin);
-  LOG_DEBUG("LNURL", String("Generated for pin ") + String(pin) + String(": ") + url);
-  if (qrFormat == "lud17") {
-    // LUD17 format: replace https: with lnurlp:
-    String result = url;
-    result.replace("https:", "lnurlp:");
-    LOG_DEBUG("LNURL", String("LUD17 format: ") + result);
-    return result;
-  } else {
-    // BECH32 format (default)
-    // Encode the https URL with bech32 and prepend lightning:
-    String encoded = encodeBech32(url);
-    if (encoded.length() == 0) {
-      LOG_WARN("LNURL", "BECH32 encoding failed, falling back to URL format");
-      return String(wifiConfig.lightningPrefix) + url;
-    }
-    String result = String(wifiConfig.lightningPrefix) + encoded;
-    LOG_DEBUG("LNURL", String("BECH32 format: ") + result);
-    return result;
-  }
+  LOG_DEBUG("LNURL", String("Generated for pin ") + String(pin) + String(": ") + payload);
+  return String(payload);
 }
 
 // Update lightning QR with given LNURL
@@ -141,12 +72,47 @@ void updateLightningQR(const String& lnurlStr) {
   LOG_DEBUG("QR", String("Updated lightning QR: ") + lightningConfig.lightning);
 }
 
+// Per-pin LNURL cache (index from getPinIndex()), filled by rebuildLnurlCache()
+static char lnurlCache[4][sizeof(lightningConfig.lightning)];
+static bool lnurlCacheValid[4] = {false, false, false, false};
+
+static void cacheLnurlForPin(int pin) {
+  int pinIndex = getPinIndex(pin);
+  if (pinIndex < 0) return;
+  lnurlCacheValid[pinIndex] = generateLNURLInto(pin, lnurlCache[pinIndex], sizeof(lnurlCache[pinIndex]));
+}
+
+void rebuildLnurlCache() {
+  static const int productPins[] = {12, 13, 10, 11};
+  invalidateLnurlCache();
+  for (int pin : productPins) {
+    cacheLnurlForPin(pin);
+  }
+  LOG_INFO("LNURL", "LNURL cache filled for pins 12, 13, 10, 11");
+}
+
+void invalidateLnurlCache() {
+  for (int i = 0; i < 4; i++) {
+    lnurlCacheValid[i] = false;
+  }
+}
+
+const char* getCachedLnurl(int pin) {
+  int pinIndex = getPinIndex(pin);
+  if (pinIndex < 0 || !lnurlCacheValid[pinIndex]) return nullptr;
+  return lnurlCache[pinIndex];
+}
+
 // Convenience wrapper: Generate LNURL and update QR for given pin
 void ensureQrForPin(int pin) {
-  String lnurlStr = generateLNURL(pin);
-  if (lnurlStr.length() > 0) {
-    updateLightningQR(lnurlStr);
-  } else {
+  // Fast path: product pins are copied from the cache, no encoding or allocation
+  const char* cached = getCachedLnurl(pin);
+  if (cached) {
+    memcpy(lightningConfig.lightning, cached, sizeof(lightningConfig.lightning));
+    return;
+  }
+
+  if (!generateLNURLInto(pin, lightningConfig.lightning, sizeof(lightningConfig.lightning))) {
     LOG_WARN("LNURL", String("Skipping QR update for pin ") + String(pin) + String(" (empty LNURL)"));
   }
 }
@@ -6,10 +6,23 @@
 // Generate LNURL for given product pin using configured server/device
 String generateLNURL(int pin);
 
+// Write the complete QR payload for a pin into out without heap allocation
+bool generateLNURLInto(int pin, char* out, size_t outSize);
+
 // Update global lightning QR payload with given LNURL or URL
 void updateLightningQR(const String& lnurlStr);
 
 // Convenience: generate LNURL and update QR for given pin
+// Product pins (12/13/10/11) are served from the LNURL cache without encoding
 void ensureQrForPin(int pin);
 
+// Generate and cache the LNURLs of all product pins (call after readFiles())
+void rebuildLnurlCache();
+
+// Drop cached LNURLs (call when lnbitsServer, deviceId or qrFormat change)
+void invalidateLnurlCache();
+
+// Cached LNURL/QR payload for a product pin, or nullptr if not cached
+const char* getCachedLnurl(int pin);
+
 #endif // PAYMENT_H
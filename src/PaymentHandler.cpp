@@ -0,0 +1,192 @@
+#include "PaymentHandler.h"
+#include <ArduinoJson.h>
+#include "GlobalState.h"
+#include "DeviceState.h"
+#include "Payment.h"
+#include "RelayScheduler.h"
+#include "Log.h"
+
+extern StateManager deviceState;
+
+static unsigned long thankYouShownAt = 0; // Timestamp of thank you / payment error screen (0 = not showing)
+
+static void noScreen() {}
+static const PaymentScreens noScreens = { noScreen, noScreen, noScreen, noScreen, noScreen, noScreen };
+static const PaymentScreens* screens = &noScreens;
+
+void paymentHandlerSetScreens(const PaymentScreens* newScreens)
+{
+  screens = newScreens ? newScreens : &noScreens;
+}
+
+void paymentHandlerCancel()
+{
+  thankYouShownAt = 0;
+}
+
+// Show the thank you screen; handleThankYouTimeout() returns to the QR screen afterwards
+static void showThankYou()
+{
+  screens->thankYou();
+  activityTracking.lastActivityTime = millis();
+  if (deviceState.isInState(DeviceState::SCREENSAVER)) {
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
+  }
+  thankYouShownAt = millis();
+}
+
+// Relay scheduler callback: runs from loop() once an activation has switched off
+void onRelayActivationComplete(int pin)
+{
+  LOG_REC_INFO(Relay, RELAY_COMPLETED, pin);
+  if (!relayAnyActive()) {
+    showThankYou();
+  }
+}
+
+// A paid activation was not started: tell the customer instead of leaving
+// ACTION TIME up; handleThankYouTimeout() restores the previous screen
+static void showActivationError(int pin, int duration)
+{
+  LOG_REC_ERROR(Payment, PAYMENT_NOT_ACTIVATED, pin, duration);
+  activityTracking.lastActivityTime = millis();
+  if (deviceState.isInState(DeviceState::SCREENSAVER)) {
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
+  }
+  screens->activationError();
+  thankYouShownAt = millis();
+}
+
+// Activation started: ACTION TIME until onRelayActivationComplete()
+static void showActionTime()
+{
+  // Pause product timeout while ACTION TIME is active
+  productSelectionState.showTime = 0;
+  thankYouShownAt = 0;
+
+  activityTracking.lastActivityTime = millis();
+  if (deviceState.isInState(DeviceState::SCREENSAVER)) {
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
+  }
+  screens->actionTime();
+}
+
+// Leave the thank you (or payment error) screen once it has been shown long enough
+void handleThankYouTimeout()
+{
+  if (thankYouShownAt == 0 || (millis() - thankYouShownAt) < THANK_YOU_DURATION_MS) {
+    return;
+  }
+  thankYouShownAt = 0;
+
+  // An error shown during a running activation goes back to ACTION TIME
+  if (relayAnyActive()) {
+    screens->actionTime();
+    return;
+  }
+
+  // Reset timer AFTER thank you screen so full PRODUCT_TIMEOUT runs from now
+  productSelectionState.showTime = millis();
+
+  if (lightningConfig.thresholdKey.length() > 0) {
+    screens->thresholdQr();
+    LOG_INFO("THRESHOLD", "Ready for next payment");
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
+    return;
+  }
+
+  // Force QR display (not ticker) after payment in ALWAYS mode
+  multiChannelConfig.btcTickerActive = false;
+  ensureQrForPin(12);
+  if (specialModeConfig.mode != SpecialMode::STANDARD) {
+    screens->specialModeQr();
+  } else {
+    screens->qr();
+  }
+  LOG_INFO("NORMAL", "Ready for next payment");
+}
+
+static void processThresholdPayment(const JsonDocument& doc)
+{
+  JsonVariantConst payment = doc["payment"];
+  int payment_amount = payment["amount"].as<int>(); // in mSats
+  int payment_sats = payment_amount / 1000; // Convert to sats
+  int threshold_sats = lightningConfig.thresholdAmount.toInt();
+
+  LOG_INFOF("THRESHOLD", "Payment received: %d sats (%d mSats)", payment_sats, payment_amount);
+  LOG_INFOF("THRESHOLD", "Threshold: %d sats", threshold_sats);
+
+  // Check if payment meets or exceeds threshold
+  if (payment_sats >= threshold_sats) {
+    int pin = lightningConfig.thresholdPin.toInt();
+    int duration = lightningConfig.thresholdTime.toInt();
+
+    LOG_INFO("THRESHOLD", "*** PAYMENT >= THRESHOLD! Triggering GPIO! ***");
+    LOG_INFOF("THRESHOLD", "Switching GPIO %d for %d ms", pin, duration);
+
+    // Non-blocking: onRelayActivationComplete() shows the thank you screen
+    bool started;
+    if (specialModeConfig.mode != SpecialMode::STANDARD) {
+      LOG_INFOF("THRESHOLD", "Using special mode: %s", specialModeValues[(uint8_t)specialModeConfig.mode]);
+      started = relayActivateWaveform(pin, duration, specialModeConfig.frequency, specialModeConfig.dutyCycleRatio);
+    } else {
+      LOG_INFO("THRESHOLD", "Using standard mode");
+      started = relayActivate(pin, duration);
+    }
+    if (started) {
+      showActionTime();
+    } else {
+      showActivationError(pin, duration);
+    }
+  } else {
+    LOG_INFOF("THRESHOLD", "Payment too small (%d < %d sats) - ignoring",
+              payment_sats, threshold_sats);
+  }
+}
+
+static void processNormalPayment(int pin, int duration)
+{
+  LOG_INFOF("RELAY", "Pin: %d, Duration: %d ms", pin, duration);
+
+  // In Single mode pin 13 follows pin 12 in parallel
+  int mirrorPin = (multiChannelConfig.mode == ChannelMode::SINGLE && pin == 12) ? 13 : -1;
+
+  // Non-blocking: onRelayActivationComplete() shows the thank you screen
+  bool started;
+  if (specialModeConfig.mode != SpecialMode::STANDARD) {
+    LOG_INFOF("NORMAL", "Using special mode: %s", specialModeValues[(uint8_t)specialModeConfig.mode]);
+    started = relayActivateWaveform(pin, duration, specialModeConfig.frequency, specialModeConfig.dutyCycleRatio, mirrorPin);
+  } else {
+    LOG_INFO("NORMAL", "Using standard mode");
+    started = relayActivate(pin, duration, mirrorPin);
+  }
+  if (started) {
+    showActionTime();
+  } else {
+    showActivationError(pin, duration);
+  }
+}
+
+void processPaymentEvent(const PaymentEvent& event)
+{
+  LOG_INFO("PAYMENT", "Payment detected!");
+  LOG_INFOF("PAYMENT", "Payload: %s (queued %lu ms ago)", event.payload, millis() - event.receivedAt);
+
+  if (lightningConfig.thresholdKey.length() > 0) {
+    LOG_INFO("THRESHOLD", "Processing payment in threshold mode...");
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, event.payload, event.length);
+    if (error) {
+      LOG_ERRORF("THRESHOLD", "JSON parse error: %s", error.c_str());
+      return;
+    }
+    processThresholdPayment(doc);
+  } else {
+    LOG_INFO("NORMAL", "Processing payment in normal mode...");
+    // Payload format: "<pin>-<duration>"
+    char* end = nullptr;
+    int pin = (int)strtol(event.payload, &end, 10);
+    int duration = (end && *end == '-') ? (int)strtol(end + 1, nullptr, 10) : 0;
+    processNormalPayment(pin, duration);
+  }
+}
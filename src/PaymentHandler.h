@@ -0,0 +1,58 @@
+#ifndef PAYMENT_HANDLER_H
+#define PAYMENT_HANDLER_H
+
+#include <Arduino.h>
+#include "PaymentQueue.h"
+
+/**
+ * PaymentHandler.h - What happens after a payment event has been queued
+ *
+ * processPaymentEvent() parses the event (threshold JSON or "<pin>-<duration>"),
+ * starts the relay activation and shows ACTION TIME; the relay scheduler's
+ * completion callback shows the thank you screen and handleThankYouTimeout()
+ * returns to the QR screen. A rejected activation shows an error instead.
+ *
+ * Screens are drawn through PaymentScreens so the handler has no display
+ * dependency and runs in the native build; main.cpp installs the display
+ * functions with paymentHandlerSetScreens().
+ */
+
+// Thank you (or payment error) screen is shown this long
+static constexpr unsigned long THANK_YOU_DURATION_MS = 2000;
+
+struct PaymentScreens {
+  void (*actionTime)();
+  void (*thankYou)();
+  void (*activationError)();   // Paid activation could not be started
+  void (*thresholdQr)();       // Ready for the next payment (threshold mode)
+  void (*specialModeQr)();     // Ready for the next payment (special mode)
+  void (*qr)();                // Ready for the next payment
+};
+
+/**
+ * Replace the screen functions (nullptr installs no-ops).
+ */
+void paymentHandlerSetScreens(const PaymentScreens* screens);
+
+/**
+ * Handle one queued payment event. Never blocks.
+ */
+void processPaymentEvent(const PaymentEvent& event);
+
+/**
+ * Relay scheduler completion callback (see relayOnComplete()).
+ */
+void onRelayActivationComplete(int pin);
+
+/**
+ * Leave the thank you / error screen after THANK_YOU_DURATION_MS.
+ * Called from loop().
+ */
+void handleThankYouTimeout();
+
+/**
+ * Forget a pending thank you / error screen (e.g. config mode was opened).
+ */
+void paymentHandlerCancel();
+
+#endif // PAYMENT_HANDLER_H
@@ -0,0 +1,84 @@
+#include "PaymentQueue.h"
+#include <atomic>
+#include <string.h>
+
+static_assert((PAYMENT_QUEUE_CAPACITY & (PAYMENT_QUEUE_CAPACITY - 1)) == 0,
+              "PAYMENT_QUEUE_CAPACITY must be a power of two");
+
+static PaymentEvent records[PAYMENT_QUEUE_CAPACITY];
+
+// head is only written by the producer, tail only by the consumer.
+// Both count up freely; the index is taken modulo the capacity.
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> tail(0);
+
+// Producer-owned counters
+static std::atomic<uint32_t> pushedCount(0);
+static std::atomic<uint32_t> overflowCount(0);
+static std::atomic<uint32_t> oversizedCount(0);
+static std::atomic<uint32_t> highWaterMark(0);
+
+// Consumer-owned counter
+static std::atomic<uint32_t> poppedCount(0);
+
+bool paymentQueuePush(const char* payload, size_t length) {
+  if (length >= PAYMENT_PAYLOAD_MAX) {
+    oversizedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  uint32_t h = head.load(std::memory_order_relaxed);
+  uint32_t t = tail.load(std::memory_order_acquire);
+  if (h - t >= PAYMENT_QUEUE_CAPACITY) {
+    overflowCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  PaymentEvent& record = records[h & (PAYMENT_QUEUE_CAPACITY - 1)];
+  memcpy(record.payload, payload, length);
+  record.payload[length] = '\0';
+  record.length = (uint16_t)length;
+  record.receivedAt = millis();
+
+  // Publish the record to the consumer
+  head.store(h + 1, std::memory_order_release);
+  pushedCount.fetch_add(1, std::memory_order_relaxed);
+
+  uint32_t depth = h + 1 - t;
+  if (depth > highWaterMark.load(std::memory_order_relaxed)) {
+    highWaterMark.store(depth, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+bool paymentQueuePop(PaymentEvent& out) {
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  uint32_t h = head.load(std::memory_order_acquire);
+  if (t == h) {
+    return false;
+  }
+
+  const PaymentEvent& record = records[t & (PAYMENT_QUEUE_CAPACITY - 1)];
+  out.receivedAt = record.receivedAt;
+  out.length = record.length;
+  memcpy(out.payload, record.payload, record.length + 1);
+
+  // Hand the record back to the producer
+  tail.store(t + 1, std::memory_order_release);
+  poppedCount.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t paymentQueueCount() {
+  return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+PaymentQueueStats paymentQueueStats() {
+  PaymentQueueStats stats;
+  stats.pushed = pushedCount.load(std::memory_order_relaxed);
+  stats.popped = poppedCount.load(std::memory_order_relaxed);
+  stats.overflows = overflowCount.load(std::memory_order_relaxed);
+  stats.oversized = oversizedCount.load(std::memory_order_relaxed);
+  stats.highWater = highWaterMark.load(std::memory_order_relaxed);
+  return stats;
+}
@@ -0,0 +1,58 @@
+#ifndef PAYMENT_QUEUE_H
+#define PAYMENT_QUEUE_H
+
+#include <Arduino.h>
+
+/**
+ * PaymentQueue.h - Lock-free payment event queue
+ *
+ * Fixed-capacity single-producer/single-consumer ring buffer between
+ * webSocketEvent() (producer) and the payment processor in loop()
+ * (consumer). Records are pre-sized and the queue never allocates, so
+ * payments arriving back-to-back are kept in order instead of
+ * overwriting each other.
+ */
+
+// Number of records, must be a power of two
+static constexpr size_t PAYMENT_QUEUE_CAPACITY = 8;
+
+// Largest websocket text frame that can be stored (threshold mode sends the full payment JSON)
+static constexpr size_t PAYMENT_PAYLOAD_MAX = 1536;
+
+struct PaymentEvent {
+  unsigned long receivedAt = 0;         // millis() when the frame arrived
+  uint16_t length = 0;                  // Payload length without terminator
+  char payload[PAYMENT_PAYLOAD_MAX];    // Null-terminated frame text
+};
+
+struct PaymentQueueStats {
+  uint32_t pushed = 0;      // Events accepted
+  uint32_t popped = 0;      // Events handed to the processor
+  uint32_t overflows = 0;   // Events dropped because the queue was full
+  uint32_t oversized = 0;   // Events dropped because the payload did not fit
+  uint32_t highWater = 0;   // Maximum number of events waiting at once
+};
+
+/**
+ * Producer side: copy a frame into the next free record.
+ * @return false if the event was dropped (queue full or payload too large)
+ */
+bool paymentQueuePush(const char* payload, size_t length);
+
+/**
+ * Consumer side: copy the oldest event into out and release its record.
+ * @return false if the queue is empty
+ */
+bool paymentQueuePop(PaymentEvent& out);
+
+/**
+ * Number of events waiting to be processed.
+ */
+size_t paymentQueueCount();
+
+/**
+ * Snapshot of the queue counters.
+ */
+PaymentQueueStats paymentQueueStats();
+
+#endif // PAYMENT_QUEUE_H
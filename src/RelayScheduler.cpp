@@ -0,0 +1,291 @@
+#include "RelayScheduler.h"
+#include "GlobalState.h"
+#include "Waveform.h"
+#include "PaymentQueue.h"
+#include "Log.h"
+#include <esp_timer.h>
+
+struct RelaySlot {
+  bool active = false;      // Slot is in use (pin on, or in gap before next queued run)
+  bool on = false;          // Pin is currently HIGH
+  int pin = -1;
+  int mirrorPin = -1;
+  bool waveform = false;    // Special mode: pin follows a timer-driven waveform while on
+  float freq = 0;
+  float ratio = 0;
+  unsigned long startedAt = 0;
+  unsigned long durationMs = 0;
+  unsigned long queued[RELAY_QUEUE_DEPTH] = {};
+  int queuedCount = 0;
+  esp_timer_handle_t offTimer = nullptr;
+  volatile bool offPending = false;   // Switched off by the timer, not yet handled by relaySchedulerTick()
+  unsigned long offAt = 0;            // millis() when the timer switched the pin off
+};
+
+static_assert(RELAY_MAX_SLOTS <= WAVEFORM_MAX_CHANNELS, "every relay slot needs a waveform channel");
+static_assert(RELAY_QUEUE_DEPTH >= (int)PAYMENT_QUEUE_CAPACITY, "a full payment queue for one channel must fit the relay queue");
+
+static RelaySlot slots[RELAY_MAX_SLOTS];
+static RelayPolicy policy = RELAY_POLICY_EXTEND;
+static RelayCompleteCallback completeCallback = nullptr;
+// Slot state shared between loop() and the esp_timer task
+static portMUX_TYPE relayMux = portMUX_INITIALIZER_UNLOCKED;
+
+static int slotIndex(const RelaySlot& slot) {
+  return (int)(&slot - slots);
+}
+
+static void writeSlot(const RelaySlot& slot, uint8_t level) {
+  if (slot.waveform) {
+    if (level == HIGH) {
+      waveformStart(slotIndex(slot), slot.pin, slot.mirrorPin, slot.freq, slot.ratio);
+    } else {
+      waveformStop(slotIndex(slot));
+    }
+    return;
+  }
+  digitalWrite(slot.pin, level);
+  if (slot.mirrorPin >= 0) {
+    digitalWrite(slot.mirrorPin, level);
+  }
+}
+
+static RelaySlot* findSlot(int pin) {
+  for (auto& slot : slots) {
+    if (slot.active && slot.pin == pin) return &slot;
+  }
+  return nullptr;
+}
+
+// Channel pins prefer their own slot (getPinIndex), otherwise take any free one
+static RelaySlot* allocSlot(int pin) {
+  int index = getPinIndex(pin);
+  if (index >= 0 && index < RELAY_MAX_SLOTS && !slots[index].active) {
+    return &slots[index];
+  }
+  for (auto& slot : slots) {
+    if (!slot.active) return &slot;
+  }
+  return nullptr;
+}
+
+// esp_timer task: the off edge does not wait for loop(), which may be inside
+// a blocking HTTPS fetch. Bookkeeping and callbacks stay in relaySchedulerTick()
+static void offTimerCallback(void* arg) {
+  RelaySlot& slot = slots[(int)(intptr_t)arg];
+  portENTER_CRITICAL(&relayMux);
+  bool switchOff = slot.active && slot.on;
+  if (switchOff) {
+    slot.on = false;
+    slot.offAt = millis();
+    slot.offPending = true;
+  }
+  portEXIT_CRITICAL(&relayMux);
+  if (switchOff) {
+    writeSlot(slot, LOW);
+  }
+}
+
+// Arm the off edge durationMs from now (restarts a running timer)
+static void armOffTimer(RelaySlot& slot, unsigned long durationMs) {
+  if (!slot.offTimer) {
+    esp_timer_create_args_t args = {};
+    args.callback = offTimerCallback;
+    args.arg = (void*)(intptr_t)slotIndex(slot);
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "relay";
+    if (esp_timer_create(&args, &slot.offTimer) != ESP_OK) {
+      // relaySchedulerTick() still switches the pin off, on loop() timing
+      slot.offTimer = nullptr;
+      return;
+    }
+  }
+  esp_timer_stop(slot.offTimer);
+  esp_timer_start_once(slot.offTimer, (uint64_t)durationMs * 1000);
+}
+
+static void stopOffTimer(RelaySlot& slot) {
+  if (slot.offTimer) {
+    esp_timer_stop(slot.offTimer);
+  }
+}
+
+static void startSlot(RelaySlot& slot, unsigned long durationMs, unsigned long now) {
+  slot.startedAt = now;
+  slot.durationMs = durationMs;
+  slot.on = true;
+  writeSlot(slot, HIGH);
+  armOffTimer(slot, durationMs);
+  if (slot.waveform) {
+    LOG_REC_INFO(Relay, RELAY_WAVEFORM_ON, slot.pin, slot.freq, slot.ratio, durationMs);
+  } else {
+    LOG_REC_INFO(Relay, RELAY_ON, slot.pin, durationMs);
+  }
+  if (slot.mirrorPin >= 0) {
+    LOG_REC_INFO(Relay, RELAY_MIRROR_ON, slot.mirrorPin, slot.pin);
+  }
+}
+
+// freq == 0 means a steady HIGH activation
+static bool activate(int pin, unsigned long durationMs, int mirrorPin, float freq, float ratio) {
+  unsigned long now = millis();
+
+  RelaySlot* slot = findSlot(pin);
+  if (slot) {
+    if (policy == RELAY_POLICY_QUEUE) {
+      if (slot->queuedCount >= RELAY_QUEUE_DEPTH) {
+        LOG_REC_ERROR(Relay, RELAY_QUEUE_FULL, pin);
+        return false;
+      }
+      slot->queued[slot->queuedCount++] = durationMs;
+      LOG_REC_INFO(Relay, RELAY_QUEUED, pin, durationMs, slot->queuedCount);
+      return true;
+    }
+
+    // Extend: add the paid time to what is left of the current run. Stop the off
+    // timer first so it cannot switch the pin off before it is re-armed
+    stopOffTimer(*slot);
+    portENTER_CRITICAL(&relayMux);
+    bool on = slot->on;
+    portEXIT_CRITICAL(&relayMux);
+    if (!on) {
+      // In the gap between two queued runs - start the next run now
+      startSlot(*slot, durationMs, now);
+      return true;
+    }
+    unsigned long elapsed = now - slot->startedAt;
+    unsigned long remaining = (elapsed < slot->durationMs) ? slot->durationMs - elapsed : 0;
+    slot->durationMs = elapsed + remaining + durationMs;
+    remaining += durationMs;
+    armOffTimer(*slot, remaining);
+    LOG_REC_INFO(Relay, RELAY_EXTENDED, pin, remaining);
+    return true;
+  }
+
+  slot = allocSlot(pin);
+  if (!slot) {
+    LOG_REC_ERROR(Relay, RELAY_NO_SLOT, pin);
+    return false;
+  }
+
+  slot->active = true;
+  slot->pin = pin;
+  slot->mirrorPin = mirrorPin;
+  slot->waveform = freq > 0;
+  slot->freq = freq;
+  slot->ratio = ratio;
+  slot->queuedCount = 0;
+
+  pinMode(pin, OUTPUT);
+  if (mirrorPin >= 0) pinMode(mirrorPin, OUTPUT);
+  startSlot(*slot, durationMs, now);
+  return true;
+}
+
+bool relayActivate(int pin, unsigned long durationMs, int mirrorPin) {
+  return activate(pin, durationMs, mirrorPin, 0, 0);
+}
+
+bool relayActivateWaveform(int pin, unsigned long durationMs, float freq, float ratio, int mirrorPin) {
+  return activate(pin, durationMs, mirrorPin, freq, ratio);
+}
+
+// Pin went LOW (timer or tick): start the gap before a queued run, or free the slot
+static void finishRun(RelaySlot& slot, unsigned long offAt) {
+  LOG_REC_INFO(Relay, RELAY_OFF, slot.pin, offAt - slot.startedAt);
+  if (slot.queuedCount > 0) {
+    // Keep the slot, next run starts after RELAY_QUEUE_GAP_MS
+    slot.startedAt = offAt;
+  } else {
+    slot.active = false;
+  }
+  if (completeCallback) {
+    completeCallback(slot.pin);
+  }
+}
+
+void relaySchedulerTick(unsigned long now) {
+  for (auto& slot : slots) {
+    portENTER_CRITICAL(&relayMux);
+    bool switchedOff = slot.offPending;
+    slot.offPending = false;
+    bool on = slot.on;
+    portEXIT_CRITICAL(&relayMux);
+
+    if (switchedOff) {
+      if (on) {
+        // Restarted (extend during the gap) before the tick saw the off edge
+        LOG_REC_INFO(Relay, RELAY_OFF, slot.pin, slot.offAt - slot.startedAt);
+      } else {
+        finishRun(slot, slot.offAt);
+      }
+      continue;
+    }
+    if (!slot.active) continue;
+
+    if (!on) {
+      // Gap between two queued runs
+      if ((now - slot.startedAt) < RELAY_QUEUE_GAP_MS) continue;
+      unsigned long next = slot.queued[0];
+      for (int i = 1; i < slot.queuedCount; i++) {
+        slot.queued[i - 1] = slot.queued[i];
+      }
+      slot.queuedCount--;
+      startSlot(slot, next, now);
+      continue;
+    }
+
+    // Fallback if the off timer could not be armed
+    if ((now - slot.startedAt) < slot.durationMs) continue;
+
+    portENTER_CRITICAL(&relayMux);
+    bool switchOff = slot.on;
+    slot.on = false;
+    portEXIT_CRITICAL(&relayMux);
+    if (!switchOff) continue;
+    stopOffTimer(slot);
+    writeSlot(slot, LOW);
+    finishRun(slot, now);
+  }
+}
+
+void relayCancelAll() {
+  for (auto& slot : slots) {
+    stopOffTimer(slot);
+    portENTER_CRITICAL(&relayMux);
+    bool active = slot.active;
+    slot.active = false;
+    slot.on = false;
+    slot.offPending = false;
+    slot.queuedCount = 0;
+    portEXIT_CRITICAL(&relayMux);
+    if (!active) continue;
+    writeSlot(slot, LOW);
+    LOG_REC_WARN(Relay, RELAY_CANCELLED, slot.pin);
+  }
+}
+
+bool relayIsActive(int pin) {
+  return findSlot(pin) != nullptr;
+}
+
+bool relayAnyActive() {
+  for (const auto& slot : slots) {
+    if (slot.active) return true;
+  }
+  return false;
+}
+
+int relayQueuedCount(int pin) {
+  RelaySlot* slot = findSlot(pin);
+  return slot ? slot->queuedCount : 0;
+}
+
+void relaySetPolicy(RelayPolicy newPolicy) {
+  policy = newPolicy;
+  LOG_INFO("Relay", String("Busy channel policy: ") + (policy == RELAY_POLICY_QUEUE ? "queue" : "extend"));
+}
+
+void relayOnComplete(RelayCompleteCallback callback) {
+  completeCallback = callback;
+}
@@ -0,0 +1,98 @@
+#ifndef RELAY_SCHEDULER_H
+#define RELAY_SCHEDULER_H
+
+#include <Arduino.h>
+
+/**
+ * RelayScheduler.h - Non-blocking relay activation scheduler
+ *
+ * Owns the on/off deadlines of all relay pins. Payment handlers start an
+ * activation and return immediately; a one-shot esp_timer switches the pin
+ * off at its deadline, so webSocket.loop(), pings and ticker updates keep
+ * running while a relay is on and a blocking call in loop() cannot delay the
+ * off edge. relaySchedulerTick() is called from loop() for the bookkeeping
+ * (queued runs, completion callback).
+ *
+ * Every channel (pins 12, 13, 10, 11 in Duo/Quattro mode) has its own timer,
+ * so payments for different products run in parallel. A payment for a
+ * channel that is already running is handled by the RelayPolicy.
+ */
+
+// Maximum number of pins that can be switched at the same time
+static constexpr int RELAY_MAX_SLOTS = 4;
+
+// Maximum number of queued activations per channel (RELAY_POLICY_QUEUE).
+// Paid events must not be dropped: every event the payment queue can hold
+// may be for the same channel, plus headroom for events arriving meanwhile
+static constexpr int RELAY_QUEUE_DEPTH = 16;
+
+// Pin stays LOW this long between two queued activations so the
+// connected device sees a separate trigger for each payment
+static constexpr unsigned long RELAY_QUEUE_GAP_MS = 500;
+
+// What happens when a payment arrives for a channel that is already on
+enum RelayPolicy {
+  RELAY_POLICY_EXTEND, // Add the new duration to the running one (default)
+  RELAY_POLICY_QUEUE   // Run the new activation after the current one
+};
+
+// Called once per activation after its pin(s) have been switched off
+typedef void (*RelayCompleteCallback)(int pin);
+
+/**
+ * Switch a pin HIGH and schedule it to go LOW after durationMs.
+ * @param pin GPIO pin to switch
+ * @param durationMs On-time in milliseconds
+ * @param mirrorPin Optional second pin switched in parallel (-1 = none)
+ * @return false if no free slot or queue entry was available
+ */
+bool relayActivate(int pin, unsigned long durationMs, int mirrorPin = -1);
+
+/**
+ * Like relayActivate(), but the pin follows a special mode waveform
+ * (see Waveform.h) instead of staying HIGH for the whole duration.
+ * @param freq Frequency in Hz
+ * @param ratio ON/OFF time ratio
+ */
+bool relayActivateWaveform(int pin, unsigned long durationMs, float freq, float ratio, int mirrorPin = -1);
+
+/**
+ * Finish activations the off timer has switched off (or whose deadline has
+ * passed), start queued activations and call the completion callback.
+ * Never blocks.
+ * @param now Current time in milliseconds (normally millis())
+ */
+void relaySchedulerTick(unsigned long now);
+
+/**
+ * Switch off all active pins immediately and drop queued activations
+ * (completion callback is not called).
+ */
+void relayCancelAll();
+
+/**
+ * Check whether the given pin has a running or queued activation.
+ */
+bool relayIsActive(int pin);
+
+/**
+ * Check whether any activation is running or queued.
+ */
+bool relayAnyActive();
+
+/**
+ * Number of activations waiting behind the running one on this pin.
+ */
+int relayQueuedCount(int pin);
+
+/**
+ * Select how payments for an already running channel are handled.
+ */
+void relaySetPolicy(RelayPolicy policy);
+
+/**
+ * Register the callback invoked when an activation has finished.
+ */
+void relayOnComplete(RelayCompleteCallback callback);
+
+#endif // RELAY_SCHEDULER_H
@@ -0,0 +1,61 @@
+#include "ScreenCache.h"
+#include "FrameBuffer.h"
+#include "Log.h"
+
+static TFT_eSPI *cachePanel = nullptr;
+static TFT_eSprite *images[SCREEN_CACHE_SLOTS] = {};
+static uint32_t cacheKey = 0;
+static bool allocationFailed = false;
+
+static void dropImages() {
+  for (uint8_t i = 0; i < SCREEN_CACHE_SLOTS; i++) {
+    if (!images[i]) continue;
+    images[i]->deleteSprite();
+    delete images[i];
+    images[i] = nullptr;
+  }
+  allocationFailed = false;
+}
+
+bool screenCacheBegin(TFT_eSPI &panel, uint32_t key) {
+#if DISPLAY_SCREEN_CACHE
+  if (!psramFound()) return false;
+  if (cachePanel != &panel || key != cacheKey) {
+    dropImages();
+  }
+  cachePanel = &panel;
+  cacheKey = key;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool screenCacheBuild(uint8_t id, ScreenDrawFn draw) {
+  if (!cachePanel || id >= SCREEN_CACHE_SLOTS) return false;
+  if (images[id]) return true;
+  if (allocationFailed) return false;
+
+  TFT_eSprite *image = new TFT_eSprite(cachePanel);
+  image->setColorDepth(16);
+  // TFT_eSprite allocates from PSRAM when it is available
+  if (image->createSprite(cachePanel->width(), cachePanel->height()) == nullptr) {
+    delete image;
+    // Later slots would fail the same way
+    allocationFailed = true;
+    LOG_WARN("DISPLAY", "Screen cache full - screen " + String(id) + " is drawn directly");
+    return false;
+  }
+
+  frameCaptureBegin(*image);
+  draw();
+  frameCaptureEnd();
+  images[id] = image;
+  return true;
+}
+
+bool screenCacheShow(uint8_t id) {
+  if (id >= SCREEN_CACHE_SLOTS || !images[id]) return false;
+  frameShow(*images[id]);
+  return true;
+}
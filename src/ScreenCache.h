@@ -0,0 +1,49 @@
+#ifndef SCREEN_CACHE_H
+#define SCREEN_CACHE_H
+
+#include <TFT_eSPI.h>
+
+/**
+ * ScreenCache.h - Pre-rendered static screens in PSRAM
+ *
+ * Screens that only depend on theme and orientation (help steps, reconnect
+ * faults, ACTION TIME, thank you) are drawn once into full-screen sprites
+ * after initDisplay(). Showing one is then a single copy into the frame
+ * buffer, or a single transfer to the panel, instead of rasterizing fonts
+ * and rectangles again.
+ *
+ * The images are tied to a key (theme colors, rotation); screenCacheBegin()
+ * with a different key drops them so they are rebuilt. Without PSRAM, or
+ * when an image cannot be allocated, screenCacheShow() returns false and
+ * the screen is drawn as before.
+ */
+
+// Pre-render static screens into PSRAM (~109 KB each)
+#ifndef DISPLAY_SCREEN_CACHE
+#define DISPLAY_SCREEN_CACHE 1
+#endif
+
+static constexpr uint8_t SCREEN_CACHE_SLOTS = 24;
+
+typedef void (*ScreenDrawFn)();
+
+/**
+ * Set the panel and key the images are valid for. Call after
+ * frameBufferBegin(); a changed key drops all images.
+ * @return true if images can be kept (PSRAM available)
+ */
+bool screenCacheBegin(TFT_eSPI &panel, uint32_t key);
+
+/**
+ * Render a screen into slot id (< SCREEN_CACHE_SLOTS) unless it is cached.
+ * draw() runs with canvas pointing to the image.
+ */
+bool screenCacheBuild(uint8_t id, ScreenDrawFn draw);
+
+/**
+ * Show the image of slot id (see frameShow()); call framePresent() after.
+ * @return false if the slot has no image
+ */
+bool screenCacheShow(uint8_t id);
+
+#endif // SCREEN_CACHE_H
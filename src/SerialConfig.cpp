@@ -7,6 +7,7 @@
 #include "DeviceState.h"
 #include "GlobalState.h"
 #include "PinConfig.h"
+#include "ConfigStore.h"
 
 // Global reference to touch controller (set from main.cpp)
 void* touchControllerPtr = nullptr;
@@ -231,15 +232,26 @@ void executeCommand(String commandName, String commandData)
     Serial.println("- Unknown command");
 }
 
+// The binary config blob is an import of config.json - re-import on next boot
+static void invalidateStoredConfig(const String &path)
+{
+    if (path == "config.json")
+    {
+        configStoreInvalidate();
+    }
+}
+
 void removeFile(String path)
 {
     Serial.println("- Remove file: " + path);
     FFat.remove("/" + path);
+    invalidateStoredConfig(path);
 }
 
 void appendToFile(String path, String data)
 {
     Serial.println("- Append to file: " + path);
+    invalidateStoredConfig(path);
     File file = FFat.open("/" + path, FILE_APPEND);
     if (!file)
     {
@@ -0,0 +1,64 @@
+#include "SpanBitmap.h"
+#include "Log.h"
+
+static SpanBitmap assets[SPAN_BITMAP_SLOTS] = {};
+
+static inline bool bitmapPixel(const uint8_t *bitmap, int16_t w, int16_t i, int16_t j) {
+  return bitmap[j * ((w + 7) / 8) + i / 8] & (128 >> (i & 7));
+}
+
+// Runs of set pixels, row by row; writes them to runs when given
+static uint16_t encodeRuns(const uint8_t *bitmap, int16_t w, int16_t h, BitmapRun *runs) {
+  uint16_t count = 0;
+  for (int16_t j = 0; j < h; j++) {
+    int16_t i = 0;
+    while (i < w) {
+      if (!bitmapPixel(bitmap, w, i, j)) {
+        i++;
+        continue;
+      }
+      int16_t start = i;
+      while (i < w && bitmapPixel(bitmap, w, i, j)) i++;
+      if (runs) runs[count] = {(uint16_t)j, (uint16_t)start, (uint16_t)(i - start)};
+      count++;
+    }
+  }
+  return count;
+}
+
+const SpanBitmap *spanBitmapFor(const uint8_t *bitmap, int16_t w, int16_t h) {
+  SpanBitmap *slot = nullptr;
+  for (SpanBitmap &asset : assets) {
+    if (asset.bitmap == bitmap && asset.width == w && asset.height == h) return &asset;
+    if (!asset.bitmap && !slot) slot = &asset;
+  }
+  if (!slot) return nullptr;
+
+  uint16_t count = encodeRuns(bitmap, w, h, nullptr);
+  BitmapRun *runs = (BitmapRun *)malloc(count * sizeof(BitmapRun));
+  if (count && !runs) {
+    LOG_WARN("DISPLAY", "No memory for bitmap runs");
+    return nullptr;
+  }
+  encodeRuns(bitmap, w, h, runs);
+  *slot = {bitmap, w, h, count, runs};
+  LOG_DEBUG("DISPLAY", "Bitmap " + String(w) + "x" + String(h) + " encoded as " + String(count) + " runs");
+  return slot;
+}
+
+void spanBitmapDraw(TFT_eSPI &target, const uint8_t *bitmap, int16_t x, int16_t y, int16_t w, int16_t h,
+                    uint16_t color, uint8_t scale) {
+  const SpanBitmap *asset = spanBitmapFor(bitmap, w, h);
+  if (!asset) {
+    for (int16_t j = 0; j < h; j++) {
+      for (int16_t i = 0; i < w; i++) {
+        if (bitmapPixel(bitmap, w, i, j)) target.fillRect(x + i * scale, y + j * scale, scale, scale, color);
+      }
+    }
+    return;
+  }
+  for (uint16_t r = 0; r < asset->runCount; r++) {
+    const BitmapRun &run = asset->runs[r];
+    target.fillRect(x + run.x * scale, y + run.row * scale, run.length * scale, scale, color);
+  }
+}
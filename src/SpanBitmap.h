@@ -0,0 +1,49 @@
+#ifndef SPAN_BITMAP_H
+#define SPAN_BITMAP_H
+
+#include <TFT_eSPI.h>
+
+/**
+ * SpanBitmap.h - Run-length renderer for 1-bpp assets (logos, icons)
+ *
+ * A 1-bpp bitmap (rows padded to whole bytes, MSB first, as drawBitmap())
+ * is encoded once into horizontal runs of set pixels. Drawing it is then
+ * one fillRect() per run at any scale, instead of one drawPixel() or
+ * fillRect() per set pixel; the 64x64 bitcoin logo has 1770 set pixels
+ * but only 109 runs.
+ *
+ * Assets are encoded on first use and kept (keyed by the bitmap pointer),
+ * so callers simply pass the PROGMEM array.
+ */
+
+// Encoded assets kept at once
+static constexpr uint8_t SPAN_BITMAP_SLOTS = 8;
+
+struct BitmapRun {
+  uint16_t row;
+  uint16_t x;
+  uint16_t length;
+};
+
+struct SpanBitmap {
+  const uint8_t *bitmap;      // Source asset (key)
+  int16_t width;
+  int16_t height;
+  uint16_t runCount;
+  BitmapRun *runs;
+};
+
+/**
+ * The runs of a bitmap, encoded on first use.
+ * @return nullptr if it cannot be encoded (no memory, slots used up)
+ */
+const SpanBitmap *spanBitmapFor(const uint8_t *bitmap, int16_t w, int16_t h);
+
+/**
+ * Draw the set pixels of a bitmap in color, each scaled to a scale x scale
+ * block; falls back to per-pixel drawing if the bitmap has no runs.
+ */
+void spanBitmapDraw(TFT_eSPI &target, const uint8_t *bitmap, int16_t x, int16_t y, int16_t w, int16_t h,
+                    uint16_t color, uint8_t scale = 1);
+
+#endif // SPAN_BITMAP_H
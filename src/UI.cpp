@@ -4,6 +4,7 @@
 #include "DeviceState.h"
 #include "Display.h"
 #include "Payment.h"
+#include "RelayScheduler.h"
 #include "Log.h"
 #include <Arduino.h>
 #include <WiFi.h>
@@ -27,8 +28,6 @@ extern void showThresholdQRScreen();
 extern void btctickerScreen();
 extern void productSelectionScreen();
 extern void showSpecialModeQRScreen();
-extern void deactivateScreensaver();
-extern void activateScreensaver(String mode);
 extern void prepareDeepSleep();
 extern void setupDeepSleepWakeup(String mode);
 extern void bootUpScreen();
@@ -60,8 +59,7 @@ bool wakeFromPowerSavingMode() {
   // If screensaver or deep sleep was active, deactivate and return true
   if (deviceState.isInState(DeviceState::SCREENSAVER) || deviceState.isInState(DeviceState::DEEP_SLEEP)) {
     LOG_INFO("Wake", "Waking from power saving mode");
-    deviceState.transition(DeviceState::READY);
-    deactivateScreensaver();
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     powerConfig.lastWakeUpTime = millis();
     activityTracking.lastActivityTime = millis();
     return true; // Indicate we just woke up
@@ -113,33 +111,33 @@ void redrawQRScreen() {
   }
 
   // Multi-Channel-Control mode
-  if (multiChannelConfig.mode != "off") {
+  if (multiChannelConfig.mode != ChannelMode::SINGLE) {
     // Behavior depends on btcTickerMode and currentProduct
     if (multiChannelConfig.currentProduct == -1) {
       // Special value: product selection screen
       productSelectionScreen();
-      deviceState.transition(DeviceState::PRODUCT_SELECTION);
+      deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
       multiChannelConfig.btcTickerActive = false;
       LOG_DEBUG("Display", "Product selection screen displayed");
-      deviceState.transition(DeviceState::READY);
+      deviceState.dispatch(DeviceEvent::SHOW_READY);
       return;
     } else if (multiChannelConfig.currentProduct == 0) {
       // Bitcoin ticker screen (only if ticker mode allows it)
-      if (multiChannelConfig.btcTickerMode == "off") {
+      if (multiChannelConfig.btcTickerMode == TickerMode::OFF) {
         // Should not show ticker if OFF, show product selection instead
         multiChannelConfig.currentProduct = -1;
         productSelectionScreen();
-        deviceState.transition(DeviceState::PRODUCT_SELECTION);
+        deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
         multiChannelConfig.btcTickerActive = false;
         LOG_DEBUG("Display", "BTC-Ticker OFF - Showing product selection screen");
-        deviceState.transition(DeviceState::READY);
+        deviceState.dispatch(DeviceEvent::SHOW_READY);
         return;
       } else {
         // Show ticker for "always" or "selecting" modes
         btctickerScreen();
         multiChannelConfig.btcTickerActive = true;
         LOG_DEBUG("Display", "Bitcoin ticker screen displayed");
-        deviceState.transition(DeviceState::READY);
+        deviceState.dispatch(DeviceEvent::SHOW_READY);
         return;
       }
     } else {
@@ -158,7 +156,7 @@ void redrawQRScreen() {
 
       // Get label from array, or use fallback
       int pinIndex = getPinIndex(displayPin);
-      if (pinIndex >= 0 && productLabels.labels[pinIndex].length() > 0) {
+      if (pinIndex >= 0 && productLabels.labels[pinIndex][0] != '\0') {
         label = productLabels.labels[pinIndex];
       } else {
         label = "Pin " + String(displayPin);
@@ -168,28 +166,28 @@ void redrawQRScreen() {
       showProductQRScreen(label, displayPin);
       multiChannelConfig.btcTickerActive = false;
       LOG_DEBUG("Display", String("Product ") + String(multiChannelConfig.currentProduct) + String(" QR screen displayed"));
-      deviceState.transition(DeviceState::READY);
+      deviceState.dispatch(DeviceEvent::SHOW_READY);
       return;
     }
   }
 
   // Single mode (1-channel)
-  if (specialModeConfig.mode != "standard") {
+  if (specialModeConfig.mode != SpecialMode::STANDARD) {
     // SPECIAL MODE: ensure LNURL for pin 12 is up-to-date, then show special QR
     ensureQrForPin(12);
     showSpecialModeQRScreen();
     multiChannelConfig.btcTickerActive = false;
     LOG_DEBUG("Display", "Special mode QR screen displayed (single mode)");
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     return;
   }
 
-  if (multiChannelConfig.btcTickerMode == "always") {
+  if (multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
     // ALWAYS: show BTC ticker
     btctickerScreen();
     multiChannelConfig.btcTickerActive = true;
     LOG_DEBUG("Display", "Bitcoin ticker screen displayed (single mode, ALWAYS)");
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     return;
   }
 
@@ -197,13 +195,13 @@ void redrawQRScreen() {
   if (multiChannelConfig.btcTickerActive) {
     btctickerScreen();
     LOG_DEBUG("Display", "Bitcoin ticker screen refreshed (single mode, SELECTING active)");
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     return;
   } else {
     ensureQrForPin(12);
     showQRScreen();
     LOG_DEBUG("Display", "QR screen displayed (single mode)");
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     return;
   }
 }
@@ -216,20 +214,20 @@ void showInitialScreenAfterConnections() {
   // Threshold mode has priority
   if (lightningConfig.thresholdKey.length() > 0) {
     showThresholdQRScreen();
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     return;
   }
 
   // Single mode
-  if (multiChannelConfig.mode == "off") {
-    if (multiChannelConfig.btcTickerMode == "always") {
+  if (multiChannelConfig.mode == ChannelMode::SINGLE) {
+    if (multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
       btctickerScreen();
       multiChannelConfig.btcTickerActive = true;
       productSelectionState.showTime = millis();
     } else {
       // SELECTING or OFF: show normal/special QR
       ensureQrForPin(12);
-      if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+      if (specialModeConfig.mode != SpecialMode::STANDARD) {
         showSpecialModeQRScreen();
       } else {
         showQRScreen();
@@ -237,27 +235,27 @@ void showInitialScreenAfterConnections() {
       multiChannelConfig.btcTickerActive = false;
       productSelectionState.showTime = 0;
     }
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     return;
   }
 
   // Multi-Channel-Control (duo/quattro)
-  if (multiChannelConfig.btcTickerMode == "off") {
+  if (multiChannelConfig.btcTickerMode == TickerMode::OFF) {
     multiChannelConfig.currentProduct = -1; // product selection
     productSelectionScreen();
-    deviceState.transition(DeviceState::PRODUCT_SELECTION);
+    deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
     multiChannelConfig.btcTickerActive = false;
     productSelectionState.showTime = millis();
-  } else if (multiChannelConfig.btcTickerMode == "always") {
+  } else if (multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
     multiChannelConfig.currentProduct = 0; // ticker
     btctickerScreen();
     multiChannelConfig.btcTickerActive = true;
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     productSelectionState.showTime = millis();
-  } else if (multiChannelConfig.btcTickerMode == "selecting") {
+  } else if (multiChannelConfig.btcTickerMode == TickerMode::SELECTING) {
     multiChannelConfig.currentProduct = -1; // product selection
     productSelectionScreen();
-    deviceState.transition(DeviceState::PRODUCT_SELECTION);
+    deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
     multiChannelConfig.btcTickerActive = false;
     productSelectionState.showTime = millis();
   }
@@ -269,7 +267,7 @@ void showInitialScreenAfterConnections() {
  */
 void handlePowerSavingChecks() {
   // Screensaver mode activation
-  if (!deviceState.isInState(DeviceState::SCREENSAVER) && !deviceState.isInState(DeviceState::DEEP_SLEEP) && powerConfig.screensaver != "off" && powerConfig.deepSleep == "off") {
+  if (!deviceState.isInState(DeviceState::SCREENSAVER) && !deviceState.isInState(DeviceState::DEEP_SLEEP) && powerConfig.screensaver != ScreensaverMode::OFF && powerConfig.deepSleep == DeepSleepMode::OFF) {
     unsigned long currentTime = millis();
     unsigned long elapsedTime = currentTime - activityTracking.lastActivityTime;
 
@@ -282,14 +280,14 @@ void handlePowerSavingChecks() {
 
     if (elapsedTime >= powerConfig.activationTimeoutMs) {
       LOG_INFO("Screensaver", "Timeout reached, activating screensaver");
-      deviceState.transition(DeviceState::SCREENSAVER);
-      activateScreensaver(powerConfig.screensaver);
+      // Entry handler of SCREENSAVER activates the configured screensaver
+      deviceState.dispatch(DeviceEvent::IDLE_TIMEOUT);
       // Continue with payment loop - screensaver only turns off backlight
     }
   }
 
-  // Deep sleep activation
-  if (!deviceState.isInState(DeviceState::DEEP_SLEEP) && powerConfig.deepSleep != "off" && powerConfig.screensaver == "off") {
+  // Deep sleep activation (never while a relay is switched on - it would stay on until wake-up)
+  if (!deviceState.isInState(DeviceState::DEEP_SLEEP) && powerConfig.deepSleep != DeepSleepMode::OFF && powerConfig.screensaver == ScreensaverMode::OFF && !relayAnyActive()) {
     unsigned long currentTime = millis();
     unsigned long elapsedTime = currentTime - activityTracking.lastActivityTime;
 
@@ -302,79 +300,87 @@ void handlePowerSavingChecks() {
 
     if (elapsedTime >= powerConfig.activationTimeoutMs) {
       LOG_INFO("DeepSleep", "Timeout reached, preparing for deep sleep");
-      deviceState.transition(DeviceState::DEEP_SLEEP);
-
-      // Flush serial output before sleep
-      Serial.flush();
-
-      // Prepare display for sleep
-      prepareDeepSleep();
-
-      // Give more time for display operations to complete
-      vTaskDelay(pdMS_TO_TICKS(1000));
-
-      // Final serial flush
-      LOG_INFO("DeepSleep", "Entering sleep mode now...");
-      Serial.flush();
-
-      // Enter deep sleep (will not return in freeze mode)
-      setupDeepSleepWakeup(powerConfig.deepSleep);
-
-      // Execution continues here after wake-up from light sleep
-      // (Deep sleep/freeze mode will restart the device instead)
-
-      // CRITICAL: Light sleep disconnects USB-Serial hardware
-      // We need to reinitialize USB-CDC to make Serial work again
-      LOG_INFO("WakeUp", "Device woke from light sleep");
-
-      // Reinitialize USB-CDC peripheral after light sleep
-      Serial.end();
-      delay(100);
-      Serial.setRxBufferSize(2048); // Same as in setup()
-      Serial.begin(115200);
-      delay(200); // Give USB-CDC time to enumerate
-
-      LOG_INFO("WakeUp", "USB-Serial reinitialized after light sleep");
-      Serial.flush();
-
-      // Show boot-up screen first
-      bootUpScreen();
-      LOG_INFO("WakeUp", "Boot screen displayed");
-
-      // Turn backlight back on
-      pinMode(PIN_LCD_BL, OUTPUT);
-      digitalWrite(PIN_LCD_BL, HIGH);
-      LOG_INFO("WakeUp", "Backlight restored");
-
-      // Check WiFi connection status
-      LOG_INFO("WakeUp", "Checking WiFi connection...");
-      int wifiCheckCount = 0;
-      while (WiFi.status() != WL_CONNECTED && wifiCheckCount < 30) {
-        delay(100);
-        wifiCheckCount++;
-        if (wifiCheckCount % 10 == 0) {
-          LOG_DEBUG("WakeUp", String("Waiting for WiFi... (") + String(wifiCheckCount) + String("/30)"));
-        }
-      }
+      // Entry handler of DEEP_SLEEP (enterPowerSavingSleep) sleeps and, after a light sleep, wakes up again
+      deviceState.dispatch(DeviceEvent::SLEEP_TIMEOUT);
+    }
+  }
+}
 
-      if (WiFi.status() == WL_CONNECTED) {
-        LOG_INFO("WakeUp", "WiFi connected");
-      } else {
-        LOG_WARN("WakeUp", "WiFi not connected after wake-up, will retry in loop");
-        // WiFi reconnection will be handled by checkAndReconnectWiFi() in main loop
-      }
+/**
+ * Puts the device to sleep; entry handler of DEEP_SLEEP.
+ * Deep sleep and freeze restart the device; after a light sleep the device
+ * wakes up here, reconnects the serial port and returns to the QR screen.
+ */
+void enterPowerSavingSleep() {
+  // Flush serial output before sleep
+  Serial.flush();
+
+  // Prepare display for sleep
+  prepareDeepSleep();
+
+  // Give more time for display operations to complete
+  vTaskDelay(pdMS_TO_TICKS(1000));
+
+  // Final serial flush
+  LOG_INFO("DeepSleep", "Entering sleep mode now...");
+  Serial.flush();
+
+  // Enter deep sleep (will not return in freeze mode)
+  setupDeepSleepWakeup(powerConfig.deepSleep);
+
+  // Execution continues here after wake-up from light sleep
+  // (Deep sleep/freeze mode will restart the device instead)
+
+  // CRITICAL: Light sleep disconnects USB-Serial hardware
+  // We need to reinitialize USB-CDC to make Serial work again
+  LOG_INFO("WakeUp", "Device woke from light sleep");
+
+  // Reinitialize USB-CDC peripheral after light sleep
+  Serial.end();
+  delay(100);
+  Serial.setRxBufferSize(2048); // Same as in setup()
+  Serial.begin(115200);
+  delay(200); // Give USB-CDC time to enumerate
+
+  LOG_INFO("WakeUp", "USB-Serial reinitialized after light sleep");
+  Serial.flush();
+
+  // Show boot-up screen first
+  bootUpScreen();
+  LOG_INFO("WakeUp", "Boot screen displayed");
+
+  // Turn backlight back on
+  pinMode(PIN_LCD_BL, OUTPUT);
+  digitalWrite(PIN_LCD_BL, HIGH);
+  LOG_INFO("WakeUp", "Backlight restored");
+
+  // Check WiFi connection status
+  LOG_INFO("WakeUp", "Checking WiFi connection...");
+  int wifiCheckCount = 0;
+  while (WiFi.status() != WL_CONNECTED && wifiCheckCount < 30) {
+    delay(100);
+    wifiCheckCount++;
+    if (wifiCheckCount % 10 == 0) {
+      LOG_DEBUG("WakeUp", String("Waiting for WiFi... (") + String(wifiCheckCount) + String("/30)"));
+    }
+  }
+
+  if (WiFi.status() == WL_CONNECTED) {
+    LOG_INFO("WakeUp", "WiFi connected");
+  } else {
+    LOG_WARN("WakeUp", "WiFi not connected after wake-up, will retry in loop");
+    // WiFi reconnection will be handled by checkAndReconnectWiFi() in main loop
+  }
 
-      // Reset activity time and clear sleep flag
-      activityTracking.lastActivityTime = millis();
-      powerConfig.lastWakeUpTime = millis();
-      deviceState.transition(DeviceState::READY);
+  // Reset activity time and clear sleep flag (applied once this handler returns)
+  activityTracking.lastActivityTime = millis();
+  powerConfig.lastWakeUpTime = millis();
+  deviceState.dispatch(DeviceEvent::SHOW_READY);
 
-      // Small delay before redrawing screen
-      delay(500);
+  // Small delay before redrawing screen
+  delay(500);
 
-      // Redraw the appropriate QR screen
-      redrawQRScreen();
-      LOG_INFO("WakeUp", "Ready for payments");
-    }
-  }
+  // Redraw the appropriate QR screen
+  redrawQRScreen();
+  LOG_INFO("WakeUp", "Ready for payments");
 }
@@ -21,4 +21,7 @@ void showInitialScreenAfterConnections();
 // Handle screensaver and deep sleep checks inside the payment loop
 void handlePowerSavingChecks();
 
+// Sleep until wake-up (entry handler of DEEP_SLEEP)
+void enterPowerSavingSleep();
+
 #endif // UI_H
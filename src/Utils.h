@@ -12,14 +12,4 @@
  */
 String getValue(String data, char separator, int index);
 
-/**
- * Execute special mode with PWM-like control.
- * Controls specified pin with configurable frequency and duty cycle ratio.
- * @param pin GPIO pin to control
- * @param duration_ms Total duration in milliseconds
- * @param freq Frequency in Hz
- * @param ratio ON/OFF time ratio
- */
-void executeSpecialMode(int pin, unsigned long duration_ms, float freq, float ratio);
-
 #endif // UTILS_H
@@ -0,0 +1,148 @@
+#include "Waveform.h"
+#include <esp_timer.h>
+
+struct WaveformChannel {
+  volatile bool running = false;
+  int pin = -1;
+  int mirrorPin = -1;
+  WaveformTiming timing = {0, 0};
+  bool level = false;
+  int64_t nextEdgeUs = 0;  // Absolute time of the next edge
+  uint32_t generation = 0; // Bumped by every start/stop
+};
+
+static WaveformChannel channels[WAVEFORM_MAX_CHANNELS];
+static portMUX_TYPE waveformMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ---- ESP32 backend ----
+
+// Consecutive generations alternate between two timers, so a callback of the
+// previous generation still reads its own generation when it runs late
+static esp_timer_handle_t timers[WAVEFORM_MAX_CHANNELS * 2] = {};
+static volatile uint32_t timerGeneration[WAVEFORM_MAX_CHANNELS * 2] = {};
+
+static void espTimerCallback(void* arg) {
+  int index = (int)(intptr_t)arg;
+  waveformOnTimer(index / 2, timerGeneration[index]);
+}
+
+static void espWritePin(int pin, uint8_t level) {
+  digitalWrite(pin, level);
+}
+
+static int64_t espNowUs() {
+  return esp_timer_get_time();
+}
+
+static void espArmTimer(int channel, uint64_t delayUs, uint32_t generation) {
+  int index = channel * 2 + (generation & 1);
+  if (!timers[index]) {
+    esp_timer_create_args_t args = {};
+    args.callback = espTimerCallback;
+    args.arg = (void*)(intptr_t)index;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "waveform";
+    if (esp_timer_create(&args, &timers[index]) != ESP_OK) {
+      return;
+    }
+  }
+  timerGeneration[index] = generation;
+  esp_timer_start_once(timers[index], delayUs);
+}
+
+static void espCancelTimer(int channel) {
+  for (int index = channel * 2; index < channel * 2 + 2; index++) {
+    if (timers[index]) {
+      esp_timer_stop(timers[index]);
+    }
+  }
+}
+
+static const WaveformHal espHal = { espWritePin, espNowUs, espArmTimer, espCancelTimer };
+static const WaveformHal* hal = &espHal;
+
+// ---- Engine ----
+
+static void writeChannel(const WaveformChannel& ch, uint8_t level) {
+  hal->writePin(ch.pin, level);
+  if (ch.mirrorPin >= 0) {
+    hal->writePin(ch.mirrorPin, level);
+  }
+}
+
+WaveformTiming waveformTiming(float freq, float ratio) {
+  if (freq < 0.1f) freq = 0.1f;
+  if (ratio < 0.1f) ratio = 0.1f;
+  uint32_t periodUs = (uint32_t)(1000000.0f / freq);
+  uint32_t onUs = (uint32_t)(periodUs / (1.0f + 1.0f / ratio));
+  WaveformTiming timing = { onUs, periodUs - onUs };
+  return timing;
+}
+
+bool waveformStart(int channel, int pin, int mirrorPin, float freq, float ratio) {
+  if (channel < 0 || channel >= WAVEFORM_MAX_CHANNELS) return false;
+
+  WaveformChannel& ch = channels[channel];
+  hal->cancelTimer(channel);
+
+  portENTER_CRITICAL(&waveformMux);
+  ch.pin = pin;
+  ch.mirrorPin = mirrorPin;
+  ch.timing = waveformTiming(freq, ratio);
+  ch.level = true;
+  ch.nextEdgeUs = hal->nowUs() + ch.timing.onUs;
+  ch.running = true;
+  uint32_t generation = ++ch.generation;
+  writeChannel(ch, HIGH);
+  portEXIT_CRITICAL(&waveformMux);
+
+  hal->armTimer(channel, ch.timing.onUs, generation);
+  return true;
+}
+
+void waveformStop(int channel) {
+  if (channel < 0 || channel >= WAVEFORM_MAX_CHANNELS) return;
+
+  WaveformChannel& ch = channels[channel];
+  portENTER_CRITICAL(&waveformMux);
+  bool wasRunning = ch.running;
+  ch.running = false;
+  ch.generation++;
+  if (wasRunning) {
+    writeChannel(ch, LOW);
+  }
+  portEXIT_CRITICAL(&waveformMux);
+
+  hal->cancelTimer(channel);
+}
+
+bool waveformIsRunning(int channel) {
+  return channel >= 0 && channel < WAVEFORM_MAX_CHANNELS && channels[channel].running;
+}
+
+void waveformOnTimer(int channel, uint32_t generation) {
+  if (channel < 0 || channel >= WAVEFORM_MAX_CHANNELS) return;
+
+  WaveformChannel& ch = channels[channel];
+  int64_t delayUs;
+
+  portENTER_CRITICAL(&waveformMux);
+  // Stale callback from before the last stop/start
+  if (!ch.running || generation != ch.generation) {
+    portEXIT_CRITICAL(&waveformMux);
+    return;
+  }
+  ch.level = !ch.level;
+  writeChannel(ch, ch.level ? HIGH : LOW);
+  // Schedule from the planned edge, not from now, so late callbacks don't accumulate drift
+  ch.nextEdgeUs += ch.level ? ch.timing.onUs : ch.timing.offUs;
+  delayUs = ch.nextEdgeUs - hal->nowUs();
+  // Re-arm before leaving the critical section, so a stop/start cannot slip in
+  // between the generation check and arming the timer
+  hal->armTimer(channel, delayUs > 0 ? (uint64_t)delayUs : 0, generation);
+  portEXIT_CRITICAL(&waveformMux);
+}
+
+void waveformSetHal(const WaveformHal* newHal) {
+  hal = newHal ? newHal : &espHal;
+}
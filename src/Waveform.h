@@ -0,0 +1,79 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <Arduino.h>
+
+/**
+ * Waveform.h - Timer-driven waveform engine for special modes
+ *
+ * Generates the blink/pulse/fast-blink/custom patterns from
+ * specialModeConfig without blocking the main loop. Every edge is
+ * scheduled on an absolute timeline (start + n periods), so timing does not
+ * drift with loop load, and nothing is logged per cycle.
+ *
+ * Pin writes, the clock and the timer go through WaveformHal. The default
+ * backend uses digitalWrite(), esp_timer_get_time() and two esp_timers per
+ * channel; a simulation can install its own backend with waveformSetHal().
+ *
+ * Every start and stop begins a new generation of the channel. A timer is
+ * armed with the generation it belongs to and waveformOnTimer() ignores any
+ * other, so a callback that was already dispatched when the channel was
+ * stopped or restarted cannot toggle the pin or re-arm itself.
+ */
+
+// One channel per relay slot
+static constexpr int WAVEFORM_MAX_CHANNELS = 4;
+
+struct WaveformTiming {
+  uint32_t onUs;   // HIGH time per period in microseconds
+  uint32_t offUs;  // LOW time per period in microseconds
+};
+
+struct WaveformHal {
+  void (*writePin)(int pin, uint8_t level);
+  int64_t (*nowUs)();
+  // Call waveformOnTimer(channel, generation) once after delayUs. Re-arming
+  // from waveformOnTimer() happens inside a critical section: no allocation
+  // or blocking there (the timer of that generation already exists)
+  void (*armTimer)(int channel, uint64_t delayUs, uint32_t generation);
+  void (*cancelTimer)(int channel);
+};
+
+/**
+ * Convert frequency and ON/OFF ratio into HIGH/LOW times.
+ * @param freq Frequency in Hz (0.1 - 10)
+ * @param ratio ON/OFF time ratio (0.25 = 1:4, 1.0 = 1:1)
+ */
+WaveformTiming waveformTiming(float freq, float ratio);
+
+/**
+ * Start a waveform on a channel, beginning with a HIGH phase.
+ * @param channel Channel index (0 - WAVEFORM_MAX_CHANNELS-1)
+ * @param pin GPIO pin to drive
+ * @param mirrorPin Optional second pin driven in parallel (-1 = none)
+ * @return false if the channel index is invalid
+ */
+bool waveformStart(int channel, int pin, int mirrorPin, float freq, float ratio);
+
+/**
+ * Stop the waveform on a channel and leave its pin(s) LOW.
+ */
+void waveformStop(int channel);
+
+/**
+ * Check whether a channel is generating a waveform.
+ */
+bool waveformIsRunning(int channel);
+
+/**
+ * Timer backend entry point: toggles the channel and arms the next edge.
+ * Does nothing if generation is not the channel's current one.
+ */
+void waveformOnTimer(int channel, uint32_t generation);
+
+/**
+ * Replace the hardware backend (nullptr restores the ESP32 default).
+ */
+void waveformSetHal(const WaveformHal* hal);
+
+#endif // WAVEFORM_H
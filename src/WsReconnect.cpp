@@ -0,0 +1,130 @@
+#include "WsReconnect.h"
+#include "Log.h"
+
+static ReconnectTarget* target = nullptr;
+static WsReconnectStats stats = {};
+static unsigned long dueAt = 0;           // BACKOFF: start the next attempt
+static unsigned long attemptStartedAt = 0;
+static unsigned long lostAt = 0;
+static bool held = false;                 // Network was down during BACKOFF
+static uint32_t jitterState = 1;
+
+// xorshift32 - only needs to differ between devices, not be secure
+static uint32_t nextRandom() {
+  jitterState ^= jitterState << 13;
+  jitterState ^= jitterState >> 17;
+  jitterState ^= jitterState << 5;
+  return jitterState;
+}
+
+// Random delay in [ceiling/2, ceiling]
+static unsigned long jitteredDelay(unsigned long ceiling) {
+  unsigned long half = ceiling / 2;
+  return half + nextRandom() % (ceiling - half + 1);
+}
+
+// Backoff ceiling after the given number of failed attempts
+static unsigned long backoffCeiling(uint8_t failures) {
+  unsigned long ceiling = WS_RECONNECT_BASE_MS;
+  for (uint8_t i = 0; i < failures && ceiling < WS_RECONNECT_MAX_MS; i++) {
+    ceiling *= 2;
+  }
+  return ceiling < WS_RECONNECT_MAX_MS ? ceiling : WS_RECONNECT_MAX_MS;
+}
+
+static void enterBackoff(unsigned long now) {
+  stats.state = WS_RECONNECT_BACKOFF;
+  stats.nextDelayMs = jitteredDelay(backoffCeiling(stats.consecutiveFailures));
+  dueAt = now + stats.nextDelayMs;
+  LOG_REC_INFO(WebSocket, WS_BACKOFF, stats.consecutiveFailures, stats.nextDelayMs);
+}
+
+static void enterConnected(unsigned long now) {
+  if (stats.state != WS_RECONNECT_CONNECTED) {
+    unsigned long outage = now - lostAt;
+    if (outage > stats.longestOutageMs) stats.longestOutageMs = outage;
+    stats.reconnects++;
+    LOG_REC_INFO(WebSocket, WS_RECONNECTED, stats.consecutiveFailures, outage);
+  }
+  stats.state = WS_RECONNECT_CONNECTED;
+  stats.consecutiveFailures = 0;
+  held = false;
+}
+
+void wsReconnectBegin(ReconnectTarget* socket, uint32_t seed, unsigned long now) {
+  target = socket;
+  stats = {};
+  jitterState = seed ? seed : 1;
+  held = false;
+  if (target->isConnected()) {
+    stats.state = WS_RECONNECT_CONNECTED;
+  } else {
+    lostAt = now;
+    enterBackoff(now);
+  }
+}
+
+void wsReconnectTick(unsigned long now, bool networkUp) {
+  if (!target) return;
+  bool connected = target->isConnected();
+
+  switch (stats.state) {
+  case WS_RECONNECT_CONNECTED:
+    if (!connected) {
+      stats.disconnects++;
+      lostAt = now;
+      target->disconnect();
+      enterBackoff(now);
+    }
+    break;
+
+  case WS_RECONNECT_BACKOFF:
+    if (connected) {
+      enterConnected(now);
+    } else if (!networkUp) {
+      held = true;
+    } else {
+      if (held) {
+        // Network is back: every device sees this at about the same time,
+        // so never attempt sooner than one more random base delay
+        held = false;
+        unsigned long earliest = now + nextRandom() % (WS_RECONNECT_BASE_MS + 1);
+        if ((long)(dueAt - earliest) < 0) dueAt = earliest;
+      }
+      if ((long)(now - dueAt) >= 0) {
+        stats.state = WS_RECONNECT_CONNECTING;
+        stats.attempts++;
+        attemptStartedAt = now;
+        target->connect();
+      }
+    }
+    break;
+
+  case WS_RECONNECT_CONNECTING:
+    if (connected) {
+      enterConnected(now);
+    } else if (now - attemptStartedAt >= WS_RECONNECT_ATTEMPT_MS || !networkUp) {
+      target->disconnect();
+      if (networkUp) {
+        stats.failures++;
+        if (stats.consecutiveFailures < 255) stats.consecutiveFailures++;
+      } else {
+        held = true;  // Not the server's fault - retry without growing the delay
+      }
+      enterBackoff(now);
+    }
+    break;
+  }
+}
+
+bool wsReconnectSocketActive() {
+  return stats.state != WS_RECONNECT_BACKOFF;
+}
+
+WsReconnectStats wsReconnectStats() {
+  return stats;
+}
+
+void wsReconnectLogStats() {
+  LOG_REC_INFO(WebSocket, WS_RECONNECT_STATS, stats.attempts, stats.failures, stats.reconnects, stats.longestOutageMs);
+}
@@ -0,0 +1,100 @@
+#ifndef WS_RECONNECT_H
+#define WS_RECONNECT_H
+
+#include <Arduino.h>
+
+/**
+ * WsReconnect.h - Non-blocking WebSocket reconnect state machine
+ *
+ * Replaces the blocking disconnect/beginSSL/wait retry loop. wsReconnectTick()
+ * is called from loop(); it never waits, it only decides when the next
+ * connection attempt is started:
+ *
+ *   CONNECTED --lost--> BACKOFF --due--> CONNECTING --connected--> CONNECTED
+ *                          ^                  |
+ *                          +----timed out-----+
+ *
+ * The delay before attempt n is drawn from [ceiling/2, ceiling] with
+ * ceiling = min(WS_RECONNECT_MAX_MS, WS_RECONNECT_BASE_MS * 2^n) ("equal
+ * jitter"), so devices that lost the server at the same moment spread out
+ * instead of reconnecting in lockstep when it comes back. No attempts are
+ * made (and none are counted as failures) while WiFi or the server is down.
+ *
+ * While waiting in BACKOFF the socket must not be serviced (the library
+ * would reconnect on its own interval), see wsReconnectSocketActive().
+ */
+
+// First backoff ceiling
+#ifndef WS_RECONNECT_BASE_MS
+#define WS_RECONNECT_BASE_MS 2000
+#endif
+
+// Backoff ceiling cap
+#ifndef WS_RECONNECT_MAX_MS
+#define WS_RECONNECT_MAX_MS 120000
+#endif
+
+// An attempt that has not connected after this long counts as failed
+static constexpr unsigned long WS_RECONNECT_ATTEMPT_MS = 8000;
+
+// Failed attempts in a row before the WebSocket error screen is shown
+static constexpr uint8_t WS_RECONNECT_ERROR_AFTER = 3;
+
+/**
+ * The socket driven by the state machine (WebSocketsClient on the device,
+ * a fake in host builds).
+ */
+class ReconnectTarget {
+public:
+  virtual ~ReconnectTarget() {}
+  virtual bool isConnected() = 0;
+  // Start a connection attempt; must return without waiting for it
+  virtual void connect() = 0;
+  virtual void disconnect() = 0;
+};
+
+enum WsReconnectState : uint8_t {
+  WS_RECONNECT_CONNECTED,
+  WS_RECONNECT_BACKOFF,
+  WS_RECONNECT_CONNECTING
+};
+
+struct WsReconnectStats {
+  WsReconnectState state;
+  uint32_t attempts;              // Connection attempts started
+  uint32_t failures;              // Attempts that timed out
+  uint32_t reconnects;            // Attempts that connected
+  uint32_t disconnects;           // Connection losses
+  uint8_t consecutiveFailures;    // Failed attempts since the last connect
+  unsigned long nextDelayMs;      // Last drawn backoff delay
+  unsigned long longestOutageMs;  // Longest time from loss to reconnect
+};
+
+/**
+ * Take over the socket. Starts in CONNECTED if it is already connected,
+ * otherwise the first attempt follows after a short random delay.
+ * @param seed Jitter seed, must differ between devices (esp_random())
+ */
+void wsReconnectBegin(ReconnectTarget* target, uint32_t seed, unsigned long now);
+
+/**
+ * Advance the state machine. Never blocks.
+ * @param now Current time in milliseconds (normally millis())
+ * @param networkUp WiFi and server reachable - attempts are held otherwise
+ */
+void wsReconnectTick(unsigned long now, bool networkUp);
+
+/**
+ * True while the socket is connected or connecting and has to be serviced
+ * (webSocket.loop()); false while waiting out a backoff delay.
+ */
+bool wsReconnectSocketActive();
+
+WsReconnectStats wsReconnectStats();
+
+/**
+ * Print attempt, failure and reconnect counts.
+ */
+void wsReconnectLogStats();
+
+#endif // WS_RECONNECT_H
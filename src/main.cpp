@@ -1,7 +1,6 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WebSocketsClient.h>
-#include <HTTPClient.h>
 #include <OneButton.h>
 #include <ArduinoJson.h>
 #include "FS.h"
@@ -22,6 +21,14 @@
 #include "Utils.h"
 #include "API.h"
 #include "Navigation.h"
+#include "RelayScheduler.h"
+#include "PaymentQueue.h"
+#include "PaymentHandler.h"
+#include "ConfigStore.h"
+#include "HttpsPool.h"
+#include "ConnectivityProbe.h"
+#include "WsReconnect.h"
+#include "MarketFeed.h"
 #include "Log.h"
 
 #define FORMAT_ON_FAIL true
@@ -29,7 +36,7 @@
 
 TaskHandle_t Task1;
 
-String qrFormat = "bech32"; // "bech32" or "lud17"
+QrFormat qrFormat = QrFormat::BECH32;
 
 // External LED button (PIN_LED_BUTTON_LED / PIN_LED_BUTTON_SW)
 bool readyLedState = false; // Track current LED state to avoid redundant writes
@@ -45,14 +52,13 @@ TouchCST816S touch(Wire, PIN_IIC_SDA, PIN_IIC_SCL, PIN_TOUCH_RES, PIN_TOUCH_INT)
 // Variables that remain here (not migrated to GlobalState)
 String currency = "USD"; // Currency from config, default USD
 bool labelsLoadedSuccessfully = false; // Track if labels were successfully fetched
-String payloadStr;
 String lnbitsServer;
 String deviceId;
 unsigned long configModeStartTime = 0; // Track when config mode started for touch exit
 bool firstLoop = true; // Track first loop iteration
 byte currentErrorType = 0; // 0=none, 1=WiFi (highest), 2=Internet, 3=Server, 4=WebSocket (lowest)
 bool onErrorScreen = false; // Track if error screen is displayed (synchronized with DeviceState)
-unsigned long lastInternetCheck = 0; // Track when we last checked Internet connectivity
+unsigned long lastInternetCheck = 0; // Timestamp of the last Internet probe result handled by the loop
 byte consecutiveWebSocketFailures = 0; // Track consecutive WebSocket failures to detect Internet issues
 bool needsQRRedraw = false; // Flag to trigger QR redraw after WiFi recovery
 bool gestureHandledThisTouch = false; // Track if gesture was already handled in current touch session
@@ -93,336 +99,152 @@ StateManager deviceState;  // Global state machine instance
 
 WebSocketsClient webSocket;
 
+// Lets WsReconnect open and close the LNbits WebSocket
+class LnbitsWebSocketTarget : public ReconnectTarget {
+public:
+  bool isConnected() override { return webSocket.isConnected(); }
+
+  void connect() override {
+    // Only sets up the connection - webSocket.loop() connects
+    if (lightningConfig.thresholdKey.length() > 0) {
+      webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + lightningConfig.thresholdKey);
+    } else {
+      webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + deviceId);
+    }
+    webSocket.onEvent(webSocketEvent);
+    // At most one library connect per attempt; WsReconnect times the retries
+    webSocket.setReconnectInterval(WS_RECONNECT_ATTEMPT_MS);
+  }
+
+  void disconnect() override { webSocket.disconnect(); }
+};
+
+static LnbitsWebSocketTarget webSocketTarget;
+
 //////////////////FORWARD DECLARATIONS///////////////////
 
 void reportMode();
 void configMode();
 void showHelp();
+void registerStateHandlers();
 
 //////////////////HELPERS///////////////////
 
 void readFiles()
 {
-  File paramFile = FFat.open(PARAM_FILE, "r");
-  if (paramFile)
-  {
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, paramFile.readString());
-
-    const JsonObject maRoot0 = doc[0];
-    const char *maRoot0Char = maRoot0["value"];
-    wifiConfig.ssid = maRoot0Char;
-    LOG_DEBUG("Config", "SSID: " + wifiConfig.ssid);
-
-    const JsonObject maRoot1 = doc[1];
-    const char *maRoot1Char = maRoot1["value"];
-    wifiConfig.wifiPassword = maRoot1Char;
-    LOG_DEBUG("Config", "WiFi pass: " + wifiConfig.wifiPassword);
-
-    const JsonObject maRoot2 = doc[2];
-    const char *maRoot2Char = maRoot2["value"];
-    wifiConfig.switchStr = maRoot2Char;
-    
-    // Parse WebSocket URL (works with both ws:// and wss://)
-    int protocolIndex = wifiConfig.switchStr.indexOf("://");
-    LOG_DEBUG("Config", String("switchStr='") + wifiConfig.switchStr + String("', protocolIndex=") + String(protocolIndex));
-    
-    if (protocolIndex == -1) {
-      LOG_ERROR("Config", "Invalid switchStr: " + wifiConfig.switchStr);
-      lnbitsServer = "";
-      deviceId = "";
-    } else {
-      int domainIndex = wifiConfig.switchStr.indexOf("/", protocolIndex + 3);
-      LOG_DEBUG("Config", String("domainIndex=") + String(domainIndex));
-      
-      if (domainIndex == -1) {
-        LOG_ERROR("Config", "Invalid switchStr: " + wifiConfig.switchStr);
-        lnbitsServer = "";
-        deviceId = "";
-      } else {
-        int uidLength = 22; // Length of device ID
-        lnbitsServer = wifiConfig.switchStr.substring(protocolIndex + 3, domainIndex);
-        deviceId = wifiConfig.switchStr.substring(wifiConfig.switchStr.length() - uidLength);
-        
-        LOG_DEBUG("Config", String("Extracted server from index ") + String(protocolIndex + 3) + String(" to ") + String(domainIndex));
-      }
-    }
-
-    LOG_INFO("Config", "Socket: " + wifiConfig.switchStr);
-    LOG_INFO("Config", "LNbits server: " + lnbitsServer);
-    LOG_INFO("Config", "Switch device ID: " + deviceId);
-
-    const JsonObject maRoot3 = doc[3];
-    const char *maRoot3Char = maRoot3["value"];
-    qrFormat = String(maRoot3Char);
-    qrFormat.trim();
-    if (qrFormat.length() == 0) {
-      qrFormat = "bech32"; // Default
-    }
-    LOG_INFO("Config", "QR Format: " + qrFormat);
-
-    // Screen displayConfig.orientation configuration (maRoot4)
-    // Available options:
-    // "h"  = horizontal (button right)
-    // "v"  = vertical (button bottom)
-    // "hi" = horizontal inverse (button left)
-    // "vi" = vertical inverse (button top)
-    const JsonObject maRoot4 = doc[4];
-    const char *maRoot4Char = maRoot4["value"];
-    displayConfig.orientation = maRoot4Char;
-    LOG_INFO("Config", "Screen orientation: " + displayConfig.orientation);
-
-    const JsonObject maRoot5 = doc[5];
-    if (!maRoot5.isNull()) {
-      const char *maRoot5Char = maRoot5["value"];
-      displayConfig.theme = maRoot5Char;
-    }
-    LOG_INFO("Config", "Theme: " + displayConfig.theme);
-
-    // Read threshold configuration (optional)
-    const JsonObject maRoot6 = doc[6];
-    if (!maRoot6.isNull()) {
-      const char *maRoot6Char = maRoot6["value"];
-      lightningConfig.thresholdKey = maRoot6Char;
-    }
-
-    const JsonObject maRoot7 = doc[7];
-    if (!maRoot7.isNull()) {
-      const char *maRoot7Char = maRoot7["value"];
-      lightningConfig.thresholdAmount = maRoot7Char;
-    }
-
-    const JsonObject maRoot8 = doc[8];
-    if (!maRoot8.isNull()) {
-      const char *maRoot8Char = maRoot8["value"];
-      lightningConfig.thresholdPin = maRoot8Char;
-    }
-
-    const JsonObject maRoot9 = doc[9];
-    if (!maRoot9.isNull()) {
-      const char *maRoot9Char = maRoot9["value"];
-      lightningConfig.thresholdTime = maRoot9Char;
-    }
-
-    const JsonObject maRoot10 = doc[10];
-    if (!maRoot10.isNull()) {
-      const char *maRoot10Char = maRoot10["value"];
-      lightningConfig.thresholdLnurl = maRoot10Char;
-    }
-
-    // Read special mode configuration (Index 11-13)
-    const JsonObject maRoot11 = doc[11];
-    if (!maRoot11.isNull()) {
-      const char *maRoot11Char = maRoot11["value"];
-      specialModeConfig.mode = maRoot11Char;
-    }
-
-    const JsonObject maRoot12 = doc[12];
-    if (!maRoot12.isNull()) {
-      const char *maRoot12Char = maRoot12["value"];
-      specialModeConfig.frequency = String(maRoot12Char).toFloat();
-      if (specialModeConfig.frequency < 0.1) specialModeConfig.frequency = 0.1;  // Min 0.1 Hz
-      if (specialModeConfig.frequency > 10.0) specialModeConfig.frequency = 10.0; // Max 10 Hz
-    }
-
-    const JsonObject maRoot13 = doc[13];
-    if (!maRoot13.isNull()) {
-      const char *maRoot13Char = maRoot13["value"];
-      specialModeConfig.dutyCycleRatio = String(maRoot13Char).toFloat();
-      if (specialModeConfig.dutyCycleRatio < 0.1) specialModeConfig.dutyCycleRatio = 0.1;   // Min 1:10
-      if (specialModeConfig.dutyCycleRatio > 10.0) specialModeConfig.dutyCycleRatio = 10.0; // Max 10:1
-    }
-
-    // Read powerConfig.screensaver and deep sleep configuration (optional, indices 14-16)
-    const JsonObject maRoot14 = doc[14];
-    if (!maRoot14.isNull()) {
-      const char *maRoot14Char = maRoot14["value"];
-      powerConfig.screensaver = maRoot14Char;
-    }
-
-    const JsonObject maRoot15 = doc[15];
-    if (!maRoot15.isNull()) {
-      const char *maRoot15Char = maRoot15["value"];
-      powerConfig.deepSleep = maRoot15Char;
-    }
-
-    const JsonObject maRoot16 = doc[16];
-    if (!maRoot16.isNull()) {
-      const char *maRoot16Char = maRoot16["value"];
-      powerConfig.activationTime = maRoot16Char;
-      // Validate activation time (1-120 minutes)
-      int actTime = String(powerConfig.activationTime).toInt();
-      if (actTime < 1) powerConfig.activationTime = "1";
-      if (actTime > 120) powerConfig.activationTime = "120";
-    }
+  ConfigSource source = configStoreLoad(PARAM_FILE);
+  const ConfigData &config = configStoreData();
 
-    // Read multi-channel-control configuration (index 17)
-    const JsonObject maRoot17 = doc[17];
-    if (!maRoot17.isNull()) {
-      const char *maRoot17Char = maRoot17["value"];
-      multiChannelConfig.mode = maRoot17Char;
-    }
-
-    // Read BTC-Ticker configuration (index 18)
-    const JsonObject maRoot18 = doc[18];
-    if (!maRoot18.isNull()) {
-      const char *maRoot18Char = maRoot18["value"];
-      multiChannelConfig.btcTickerMode = maRoot18Char;
-      // Normalize human-friendly values from installer
-      String modeNorm = multiChannelConfig.btcTickerMode;
-      modeNorm.trim();
-      modeNorm.toLowerCase();
-      // Strip all non-letter characters to be robust against UI formatting
-      String lettersOnly = "";
-      for (size_t i = 0; i < modeNorm.length(); ++i) {
-        char c = modeNorm.charAt(i);
-        if ((c >= 'a' && c <= 'z')) lettersOnly += c;
-      }
-      // Map variants to canonical values
-      if (lettersOnly.indexOf("always") != -1) {
-        multiChannelConfig.btcTickerMode = "always";
-      } else if (lettersOnly.indexOf("selecting") != -1 || lettersOnly.indexOf("select") != -1) {
-        multiChannelConfig.btcTickerMode = "selecting";
-      } else if (lettersOnly == "off") {
-        multiChannelConfig.btcTickerMode = "off";
-      } // else keep original (unknown value)
-      LOG_INFO("Config", "BTC-Ticker mode normalized: " + multiChannelConfig.btcTickerMode);
-    } else {
-      LOG_WARN("Config", "Index 18 (btcTickerMode) not found in config - using default: " + multiChannelConfig.btcTickerMode);
-    }
+  if (source == CONFIG_SOURCE_BLOB) {
+    LOG_INFO("Config", "Loaded stored config in " + String(configStoreLoadTimeUs()) + " us");
+  } else if (source == CONFIG_SOURCE_JSON) {
+    LOG_INFO("Config", "Imported " + String(PARAM_FILE) + " in " + String(configStoreLoadTimeUs()) + " us (stored for next boot)");
+  } else {
+    LOG_WARN("Config", "Config file not found - using defaults");
+  }
 
-    // Read external LED button configuration (index 20)
-    const JsonObject maRoot20 = doc[20];
-    if (!maRoot20.isNull()) {
-      const char *maRoot20Char = maRoot20["value"];
-      String buttonSetting = String(maRoot20Char);
-      buttonSetting.toLowerCase();
-      buttonSetting.trim();
-      externalButtonState.enabled = (buttonSetting == "yes");
-      LOG_INFO("Config", String("External LED button: ") + (externalButtonState.enabled ? "ENABLED" : "DISABLED"));
-    }
+  wifiConfig.ssid = config.ssid;
+  wifiConfig.wifiPassword = config.wifiPassword;
+  wifiConfig.switchStr = config.switchStr;
+  lnbitsServer = config.lnbitsServer;
+  deviceId = config.deviceId;
+  qrFormat = (QrFormat)config.qrFormat;
+  displayConfig.orientation = (Orientation)config.orientation;
+  displayConfig.theme = config.theme;
+  lightningConfig.thresholdKey = config.thresholdKey;
+  lightningConfig.thresholdAmount = config.thresholdAmount;
+  lightningConfig.thresholdPin = config.thresholdPin;
+  lightningConfig.thresholdTime = config.thresholdTime;
+  lightningConfig.thresholdLnurl = config.thresholdLnurl;
+  specialModeConfig.mode = (SpecialMode)config.specialMode;
+  specialModeConfig.frequency = config.frequency;
+  specialModeConfig.dutyCycleRatio = config.dutyCycleRatio;
+  powerConfig.screensaver = (ScreensaverMode)config.screensaver;
+  powerConfig.deepSleep = (DeepSleepMode)config.deepSleep;
+  powerConfig.activationTime = String(config.activationTime);
+  powerConfig.activationTimeoutMs = config.activationTime * 60 * 1000UL;
+  multiChannelConfig.mode = (ChannelMode)config.multiControl;
+  multiChannelConfig.btcTickerMode = (TickerMode)config.btcTicker;
+  multiChannelConfig.channelPolicy = (RelayPolicy)config.channelPolicy;
+  currency = config.currency;
+  externalButtonState.enabled = config.externalButton;
+
+  if (source == CONFIG_SOURCE_DEFAULTS) {
+    strcpy(lightningConfig.lightning, "LIGHTNING:lnurl1dp68gurn8ghj7ctsdyhxkmmvwp5jucm0d9hkuegpr4r33");
+    LOG_INFO("Config", "=== NORMAL MODE ===");
+    return;
+  }
 
-    // Read currency configuration (index 19)
-    const JsonObject maRoot19 = doc[19];
-    if (!maRoot19.isNull()) {
-      const char *maRoot19Char = maRoot19["value"];
-      currency = String(maRoot19Char);
-      LOG_DEBUG("Config", "Read currency from config (before processing): " + currency);
-      currency.toUpperCase(); // Ensure uppercase
-      if (currency.length() == 0 || currency.length() > 3) {
-        LOG_WARN("Config", "Invalid currency length, using default USD");
-        currency = "USD"; // Default fallback
-      }
-      LOG_INFO("Config", "Final currency value: " + currency);
-    } else {
-      LOG_DEBUG("Config", "Index 19 (currency) not found in config - using default: " + currency);
-    }
-    // Indices 18-20 removed (lnurl13, lnurl10, lnurl11 - now auto-generated)
-
-    // Apply predefined mode settings
-    if (specialModeConfig.mode == "blink") {
-      specialModeConfig.frequency = 1.0;
-      specialModeConfig.dutyCycleRatio = 1.0;
-      LOG_INFO("Config", "Applied 'blink' preset: 1 Hz, 1:1");
-    } else if (specialModeConfig.mode == "pulse") {
-      specialModeConfig.frequency = 2.0;
-      specialModeConfig.dutyCycleRatio = 0.25; // 1:4 = 0.25
-      LOG_INFO("Config", "Applied 'pulse' preset: 2 Hz, 1:4");
-    } else if (specialModeConfig.mode == "fast-blink") {
-      specialModeConfig.frequency = 5.0;
-      specialModeConfig.dutyCycleRatio = 1.0;
-      LOG_INFO("Config", "Applied 'fast-blink' preset: 5 Hz, 1:1");
+  LOG_DEBUG("Config", "SSID: " + wifiConfig.ssid);
+  LOG_INFO("Config", "Socket: " + wifiConfig.switchStr);
+  LOG_INFO("Config", "LNbits server: " + lnbitsServer);
+  LOG_INFO("Config", "Switch device ID: " + deviceId);
+  LOG_INFO("Config", String("QR Format: ") + qrFormatValues[config.qrFormat]);
+  LOG_INFO("Config", String("Screen orientation: ") + orientationValues[config.orientation]);
+  LOG_INFO("Config", "Theme: " + displayConfig.theme);
+  LOG_INFO("Config", String("External LED button: ") + (externalButtonState.enabled ? "ENABLED" : "DISABLED"));
+  LOG_INFO("Config", String("Channel policy: ") + relayPolicyValues[config.channelPolicy]);
+
+  LOG_INFO("Config", String("Special Mode: ") + specialModeValues[config.specialMode]);
+  LOG_INFO("Config", String("Frequency: ") + String(specialModeConfig.frequency) + String(" Hz"));
+  LOG_INFO("Config", String("Duty Cycle Ratio: ") + String(specialModeConfig.dutyCycleRatio));
+
+  // Display Multi-Channel-Control configuration
+  LOG_INFO("Config", String("Multi-Channel-Control Mode: ") + (multiChannelConfig.mode == ChannelMode::SINGLE ? "Single (Pin 12 only)" : (multiChannelConfig.mode == ChannelMode::DUO ? "Duo (Pins 12, 13)" : "Quattro (Pins 12, 13, 10, 11)")));
+
+  // Display BTC-Ticker configuration
+  LOG_INFO("Config", "=== BTC-TICKER CONFIGURATION ===");
+  LOG_INFO("Config", String("BTC-Ticker Mode: ") + tickerModeValues[config.btcTicker]);
+  LOG_INFO("Config", "Currency: " + currency);
+  LOG_INFO("Config", "===================================");
+
+  // Display mode based on threshold configuration
+  LOG_INFO("Config", "=== MODE CONFIGURATION ===");
+  if (lightningConfig.thresholdKey.length() > 0) {
+    LOG_INFO("Config", "THRESHOLD MODE");
+    LOG_INFO("Config", "Threshold Key: " + lightningConfig.thresholdKey);
+    LOG_INFO("Config", "Threshold Amount: " + lightningConfig.thresholdAmount + " sats");
+    LOG_INFO("Config", "GPIO Pin: " + lightningConfig.thresholdPin);
+    LOG_INFO("Config", "Control Time: " + lightningConfig.thresholdTime + " ms");
+
+    // Threshold QR ("lightning:" prefix added on import)
+    if (config.thresholdQr[0] != '\0') {
+      strlcpy(lightningConfig.lightning, config.thresholdQr, sizeof(lightningConfig.lightning));
+      LOG_INFO("Config", "Threshold LNURL: " + lightningConfig.thresholdLnurl);
+      LOG_INFOF("Config", "Threshold QR: %s", lightningConfig.lightning);
     }
-    
-    LOG_INFO("Config", "Special Mode: " + specialModeConfig.mode);
-    LOG_INFO("Config", String("Frequency: ") + String(specialModeConfig.frequency) + String(" Hz"));
-    LOG_INFO("Config", String("Duty Cycle Ratio: ") + String(specialModeConfig.dutyCycleRatio));
-
-    // Display Multi-Channel-Control configuration
-    LOG_INFO("Config", String("Multi-Channel-Control Mode: ") + (multiChannelConfig.mode == "off" ? "Single (Pin 12 only)" : (multiChannelConfig.mode == "duo" ? "Duo (Pins 12, 13)" : "Quattro (Pins 12, 13, 10, 11)")));
+  } else {
+    LOG_INFO("Config", "NORMAL MODE");
+  }
 
-    // Display BTC-Ticker configuration
-    LOG_INFO("Config", "=== BTC-TICKER CONFIGURATION ===");
-    LOG_INFO("Config", "BTC-Ticker Mode: " + multiChannelConfig.btcTickerMode);
-    LOG_INFO("Config", "Currency: " + currency);
-    LOG_INFO("Config", "===================================");
+  // Display powerConfig.screensaver and deep sleep configuration
+  LOG_INFO("Config", "=== POWER SAVING CONFIGURATION ===");
+  LOG_INFO("Config", String("Screensaver: ") + screensaverValues[config.screensaver]);
+  LOG_INFO("Config", String("Deep Sleep: ") + deepSleepValues[config.deepSleep]);
+  LOG_INFO("Config", "Activation Time: " + powerConfig.activationTime + " minutes");
+  LOG_INFO("Config", "Activation Timeout: " + String(powerConfig.activationTimeoutMs) + " ms");
+
+  // Determine and display active power saving mode
+  if (powerConfig.screensaver != ScreensaverMode::OFF && powerConfig.deepSleep == DeepSleepMode::OFF) {
+    LOG_INFO("Config", "⚡ POWER SAVING MODE: SCREENSAVER");
+    LOG_INFO("Config", "   Display backlight will turn off after " + powerConfig.activationTime + " minutes");
+    LOG_INFO("Config", "   Press BOOT or IO14 button to wake up");
+  } else if (powerConfig.deepSleep != DeepSleepMode::OFF && powerConfig.screensaver == ScreensaverMode::OFF) {
+    LOG_INFO("Config", String("⚡ POWER SAVING MODE: DEEP SLEEP (") + deepSleepValues[config.deepSleep] + ")");
+    LOG_INFO("Config", String("   Device will enter ") + deepSleepValues[config.deepSleep] + " sleep after " + powerConfig.activationTime + " minutes");
+    LOG_INFO("Config", "   Press BOOT or IO14 button to wake up");
+    LOG_INFO("Config", "Deep Sleep enabled - configuring GPIO wake-up sources");
+    // Wake-up sources will be configured in setupDeepSleepWakeup() when sleep is triggered
+  } else {
+    LOG_INFO("Config", "⚡ POWER SAVING MODE: DISABLED");
+    LOG_INFO("Config", "   Device will stay active continuously");
+  }
 
-    // Display mode based on threshold configuration
-    LOG_INFO("Config", "=== MODE CONFIGURATION ===");
-    if (lightningConfig.thresholdKey.length() > 0) {
-      LOG_INFO("Config", "THRESHOLD MODE");
-      LOG_INFO("Config", "Threshold Key: " + lightningConfig.thresholdKey);
-      LOG_INFO("Config", "Threshold Amount: " + lightningConfig.thresholdAmount + " sats");
-      LOG_INFO("Config", "GPIO Pin: " + lightningConfig.thresholdPin);
-      LOG_INFO("Config", "Control Time: " + lightningConfig.thresholdTime + " ms");
-      
-      // Process threshold LNURL (add lightning: prefix if not present)
-      if (lightningConfig.thresholdLnurl.length() > 0) {
-        lightningConfig.thresholdLnurl.trim(); // Remove leading/trailing whitespace
-        
-        if (lightningConfig.thresholdLnurl.startsWith("lightning:") || lightningConfig.thresholdLnurl.startsWith("LIGHTNING:")) {
-          // Already has prefix, convert to lowercase lightning:
-          if (lightningConfig.thresholdLnurl.startsWith("LIGHTNING:")) {
-            strcpy(lightningConfig.lightning, "lightning:");
-            strcat(lightningConfig.lightning, lightningConfig.thresholdLnurl.c_str() + 10);
-          } else {
-            strcpy(lightningConfig.lightning, lightningConfig.thresholdLnurl.c_str());
-          }
-        } else {
-          // No prefix, add it (lowercase)
-          strcpy(lightningConfig.lightning, "lightning:");
-          strcat(lightningConfig.lightning, lightningConfig.thresholdLnurl.c_str());
-        }
-        Serial.print("Threshold LNURL: ");
-        Serial.println(lightningConfig.thresholdLnurl);
-        Serial.print("Threshold QR: ");
-        Serial.println(lightningConfig.lightning);
-      }
-    } else {
-      LOG_INFO("Config", "NORMAL MODE");
-    }
+  // Initialize last activity time
+  activityTracking.lastActivityTime = millis();
+  LOG_DEBUG("Config", "Last Activity Time initialized: " + String(activityTracking.lastActivityTime) + " ms");
 
-    // Display powerConfig.screensaver and deep sleep configuration
-    LOG_INFO("Config", "=== POWER SAVING CONFIGURATION ===");
-    LOG_INFO("Config", "Screensaver: " + powerConfig.screensaver);
-    LOG_INFO("Config", "Deep Sleep: " + powerConfig.deepSleep);
-    LOG_INFO("Config", "Activation Time: " + powerConfig.activationTime + " minutes");
-    
-    // Convert activation time from minutes to milliseconds
-    int activationTimeMinutes = String(powerConfig.activationTime).toInt();
-    powerConfig.activationTimeoutMs = activationTimeMinutes * 60 * 1000UL;
-    LOG_INFO("Config", "Activation Timeout: " + String(powerConfig.activationTimeoutMs) + " ms");
-    
-    // Determine and display active power saving mode
-    if (powerConfig.screensaver != "off" && powerConfig.deepSleep == "off") {
-      LOG_INFO("Config", "⚡ POWER SAVING MODE: SCREENSAVER");
-      LOG_INFO("Config", "   Display backlight will turn off after " + powerConfig.activationTime + " minutes");
-      LOG_INFO("Config", "   Press BOOT or IO14 button to wake up");
-    } else if (powerConfig.deepSleep != "off" && powerConfig.screensaver == "off") {
-      LOG_INFO("Config", "⚡ POWER SAVING MODE: DEEP SLEEP (" + powerConfig.deepSleep + ")");
-      LOG_INFO("Config", "   Device will enter " + powerConfig.deepSleep + " sleep after " + powerConfig.activationTime + " minutes");
-      LOG_INFO("Config", "   Press BOOT or IO14 button to wake up");
-      LOG_INFO("Config", "Deep Sleep enabled - configuring GPIO wake-up sources");
-      // Wake-up sources will be configured in setupDeepSleepWakeup() when sleep is triggered
-    } else {
-      LOG_INFO("Config", "⚡ POWER SAVING MODE: DISABLED");
-      LOG_INFO("Config", "   Device will stay active continuously");
-    }
-    
-    // Initialize last activity time
-    activityTracking.lastActivityTime = millis();
-    LOG_DEBUG("Config", "Last Activity Time initialized: " + String(activityTracking.lastActivityTime) + " ms");
-    
-    LOG_INFO("Config", "===================================");
-  }
-  else
-  {
-    Serial.println("Config file not found - using defaults");
-    displayConfig.orientation = "h";
-    strcpy(lightningConfig.lightning, "LIGHTNING:lnurl1dp68gurn8ghj7ctsdyhxkmmvwp5jucm0d9hkuegpr4r33");
-    LOG_INFO("Config", "=== NORMAL MODE ===");
-  }
-  paramFile.close();
+  LOG_INFO("Config", "===================================");
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -438,64 +260,12 @@ void showHelp()
   }
 
   LOG_INFO("Help", "Help button pressed");
-  deviceState.transition(DeviceState::HELP_SCREEN); // Set flag to interrupt WiFi reconnect loop
-
-  // Disable product selection timer during help mode
-  productSelectionState.showTime = 0;
-
-  stepOneScreen();
-
-  // Check for button press during first screen
-  unsigned long screenStart = millis();
-  while (millis() - screenStart < 1000 && deviceState.isInState(DeviceState::HELP_SCREEN)) { // TEST: 1s (default: 3000ms)
-    vTaskDelay(pdMS_TO_TICKS(50));
-    if (!deviceState.isInState(DeviceState::HELP_SCREEN)) break; // Button pressed in handleTouchButton()
-  }
-  if (!deviceState.isInState(DeviceState::HELP_SCREEN)) return; // Exit Help early
-
-  stepTwoScreen();
-
-  // Check for button press during second screen
-  screenStart = millis();
-  while (millis() - screenStart < 1000 && deviceState.isInState(DeviceState::HELP_SCREEN)) { // TEST: 1s (default: 3000ms)
-    vTaskDelay(pdMS_TO_TICKS(50));
-    if (!deviceState.isInState(DeviceState::HELP_SCREEN)) break;
-  }
-  if (!deviceState.isInState(DeviceState::HELP_SCREEN)) return; // Exit Help early
-
-  stepThreeScreen();
-
-  // Check for button press during third screen
-  screenStart = millis();
-  while (millis() - screenStart < 1000 && deviceState.isInState(DeviceState::HELP_SCREEN)) { // TEST: 1s (default: 3000ms)
-    vTaskDelay(pdMS_TO_TICKS(50));
-    if (!deviceState.isInState(DeviceState::HELP_SCREEN)) break;
-  }
-
-  deviceState.transition(DeviceState::READY); // Clear flag
-
-  // Return to error screen if one was active, otherwise show QR screen
-  if (deviceState.isInState(DeviceState::ERROR_RECOVERABLE)) {
-    // Check which error is active and show corresponding screen
-    if (WiFi.status() != WL_CONNECTED) {
-      wifiReconnectScreen();
-    } else if (networkStatus.waitingForPong && (millis() - networkStatus.lastPingTime > 10000)) {
-      internetReconnectScreen();
-    } else if (!webSocket.isConnected()) {
-      websocketReconnectScreen();
-    }
-  } else {
-    // No error active, show QR screen
-    redrawQRScreen();
-    // Reset product selection timer
-    productSelectionState.showTime = millis();
-    deviceState.transition(DeviceState::READY);
-  }
+  deviceState.dispatch(DeviceEvent::OPEN_HELP); // Pages are shown by loop() (onEnterOverlay)
 }
 
 void configMode()
 {
-  Serial.println("[BUTTON] Config mode button pressed");
+  LOG_INFO("BUTTON", "Config mode button pressed");
   
   // CRITICAL: Ensure serial is ready after deep sleep wake-up
   Serial.flush();
@@ -506,8 +276,7 @@ void configMode()
   Serial.flush();
   delay(50);
   
-  configModeScreen(); // Draw config screen IMMEDIATELY
-  deviceState.transition(DeviceState::CONFIG_MODE); // Then set flag
+  deviceState.dispatch(DeviceEvent::OPEN_CONFIG); // Entry handler draws the config screen
   configModeStartTime = millis(); // Track start to enforce 2s guard for exit
   updateReadyLed();
   
@@ -521,6 +290,7 @@ void configMode()
   
   bool hasExistingData = (wifiConfig.ssid.length() > 0);
   LOG_INFO("Config", String("Has existing data: ") + (hasExistingData ? "YES" : "NO"));
+  Log::drainRecords(); // Print queued log lines before the serial config dialog starts
   Serial.flush();
   
   configOverSerialPort(wifiConfig.ssid, wifiConfig.wifiPassword, hasExistingData);
@@ -540,63 +310,178 @@ void reportMode()
     return;
   }
   
-  Serial.println("[BUTTON] Report mode button pressed");
-  deviceState.transition(DeviceState::REPORT_SCREEN); // Set flag to interrupt WiFi reconnect loop
-  
-  // Disable product selection timer during report mode
-  productSelectionState.showTime = 0;
-  deviceState.transition(DeviceState::READY);
-  
-  Serial.println("[REPORT] Showing error report screen");
+  LOG_INFO("BUTTON", "Report mode button pressed");
+  deviceState.dispatch(DeviceEvent::OPEN_REPORT); // Pages are shown by loop() (onEnterOverlay)
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// HELP / REPORT PAGES
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+// One page of the help or report sequence
+struct OverlayPage {
+  const char *name;
+  void (*show)();
+  unsigned long durationMs;
+};
+
+static void showErrorReportPage()
+{
   errorReportScreen(networkStatus.errors.wifi, networkStatus.errors.internet, networkStatus.errors.server, networkStatus.errors.websocket);
-  Serial.println("[REPORT] Error report shown, waiting 2s");
-  vTaskDelay(pdMS_TO_TICKS(2000)); // First screen: 2 seconds
-  
-  Serial.println("[REPORT] Showing WiFi screen");
-  wifiReconnectScreen();
-  vTaskDelay(pdMS_TO_TICKS(1000)); // 1 second
-  
-  Serial.println("[REPORT] Showing Internet screen");
-  internetReconnectScreen();
-  vTaskDelay(pdMS_TO_TICKS(1000)); // 1 second
-  
-  Serial.println("[REPORT] Showing Server screen");
-  serverReconnectScreen();
-  vTaskDelay(pdMS_TO_TICKS(1000)); // 1 second
-  
-  Serial.println("[REPORT] Showing WebSocket screen");
-  websocketReconnectScreen();
-  vTaskDelay(pdMS_TO_TICKS(1000)); // 1 second
-  
-  Serial.println("[REPORT] Determining final screen to show");
-  // Show appropriate screen based on current error state
-  if (deviceState.isInState(DeviceState::ERROR_RECOVERABLE)) {
-    // Check which error is active and show corresponding screen (priority order)
-    Serial.printf("[REPORT] Error active (type %d) - showing error screen\n", currentErrorType);
-    if (WiFi.status() != WL_CONNECTED) {
-      Serial.println("[REPORT] WiFi down - showing WiFi screen");
+}
+
+static void showReconnectReportPage()
+{
+  WsReconnectStats reconnect = wsReconnectStats();
+  reconnectReportScreen(reconnect.attempts, reconnect.failures, reconnect.reconnects, reconnect.nextDelayMs);
+  wsReconnectLogStats();
+}
+
+static const OverlayPage helpPages[] = {
+  {"step one", stepOneScreen, 1000},     // TEST: 1s (default: 3000ms)
+  {"step two", stepTwoScreen, 1000},
+  {"step three", stepThreeScreen, 1000},
+};
+
+static const OverlayPage reportPages[] = {
+  {"error report", showErrorReportPage, 2000},
+  {"WebSocket reconnect counters", showReconnectReportPage, 2000},
+  {"WiFi", wifiReconnectScreen, 1000},
+  {"Internet", internetReconnectScreen, 1000},
+  {"Server", serverReconnectScreen, 1000},
+  {"WebSocket", websocketReconnectScreen, 1000},
+};
+
+// Sequence on screen: set by the HELP/REPORT entry handler, advanced by
+// handleOverlayPages() in loop(); nullptr pages = none running
+static struct {
+  const OverlayPage *pages;
+  uint8_t count;
+  uint8_t index;
+  unsigned long shownMs;
+  bool fromError;             // Opened over a connection error screen
+} overlay = {};
+
+static void showOverlayPage(uint8_t index)
+{
+  overlay.index = index;
+  overlay.shownMs = millis();
+  LOG_INFOF("Overlay", "Showing %s", overlay.pages[index].name);
+  overlay.pages[index].show();
+}
+
+// Last page shown: back to the error screen the overlay was opened over, or to the QR screen
+static void finishOverlay()
+{
+  bool report = (overlay.pages == reportPages);
+  bool fromError = overlay.fromError;
+  overlay.pages = nullptr;   // The exit handler leaves the next screen to us
+
+  if (fromError) {
+    deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
+    // Show the screen of the error that is still active (priority order)
+    ConnectivitySnapshot health = connectivitySnapshot();
+    if (!health.wifi) {
       wifiReconnectScreen();
-    } else if (!checkInternetConnectivity()) {
-      Serial.println("[REPORT] Internet down - showing Internet screen");
+    } else if (!health.internet) {
       internetReconnectScreen();
     } else if (networkStatus.waitingForPong && (millis() - networkStatus.lastPingTime > 10000)) {
-      Serial.println("[REPORT] Server down - showing Server screen");
       serverReconnectScreen();
-    } else if (!webSocket.isConnected()) {
-      Serial.println("[REPORT] WebSocket down - showing WebSocket screen");
+    } else {
       websocketReconnectScreen();
     }
+    LOG_INFOF("Overlay", "Done - back to error screen (type %d)", currentErrorType);
   } else {
-    // No error active, show QR screen
-    Serial.println("[REPORT] No errors - showing QR screen");
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
+    redrawQRScreen();
+    productSelectionState.showTime = millis(); // Reset product selection timer
+    LOG_INFO("Overlay", "Done - QR screen shown");
+  }
+
+  if (report) {
+    deviceState.printTrace();
+  }
+}
+
+// Called from loop(): next page once the current one has been shown long enough
+static void handleOverlayPages()
+{
+  if (!overlay.pages || millis() - overlay.shownMs < overlay.pages[overlay.index].durationMs) return;
+  if (overlay.index + 1 < overlay.count) {
+    showOverlayPage(overlay.index + 1);
+  } else {
+    finishOverlay();
+  }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════════
+// STATE HANDLERS
+// ═══════════════════════════════════════════════════════════════════════════════════
+
+static void onEnterScreensaver(DeviceState)
+{
+  activateScreensaver(powerConfig.screensaver);
+}
+
+static void onExitScreensaver(DeviceState)
+{
+  deactivateScreensaver();
+}
+
+static void onEnterConfigMode(DeviceState)
+{
+  configModeScreen();
+}
+
+// Help and report pages pause the product selection timeout; loop() shows
+// the following pages (handleOverlayPages), so no task waits for them
+static void onEnterOverlay(DeviceState state)
+{
+  productSelectionState.showTime = 0;
+
+  // Help -> report keeps where the help was opened from
+  DeviceState from = deviceState.getPreviousState();
+  if (from != DeviceState::HELP_SCREEN && from != DeviceState::REPORT_SCREEN) {
+    overlay.fromError = (from == DeviceState::ERROR_RECOVERABLE);
+  }
+
+  bool help = (state == DeviceState::HELP_SCREEN);
+  overlay.pages = help ? helpPages : reportPages;
+  overlay.count = help ? sizeof(helpPages) / sizeof(helpPages[0]) : sizeof(reportPages) / sizeof(reportPages[0]);
+  showOverlayPage(0);
+}
+
+// Left before the last page (button press, config mode, sleep)
+static void onExitOverlay(DeviceState)
+{
+  if (!overlay.pages) return;
+  overlay.pages = nullptr;
+  // An abort back to READY needs the payment screen; other states draw their own
+  if (deviceState.isInState(DeviceState::READY)) {
     redrawQRScreen();
-    Serial.println("[REPORT] QR screen drawn successfully");
-    // Reset product selection timer
     productSelectionState.showTime = millis();
   }
-  
-  Serial.println("[REPORT] Report mode complete, clearing flag");
-  deviceState.transition(DeviceState::READY); // Clear flag AFTER showing final screen
+}
+
+static void onEnterDeepSleep(DeviceState)
+{
+  enterPowerSavingSleep();
+}
+
+// Screens of the payment flow (PaymentHandler)
+static const PaymentScreens paymentScreens = {
+  actionTimeScreen, thankYouScreen, paymentErrorScreen, showThresholdQRScreen, showSpecialModeQRScreen, showQRScreen
+};
+
+// Screen work that belongs to entering/leaving a state lives in these handlers;
+// they run in loop(), which applies every DeviceEvent
+void registerStateHandlers()
+{
+  deviceState.setStateHandlers(DeviceState::SCREENSAVER, onEnterScreensaver, onExitScreensaver);
+  deviceState.setStateHandlers(DeviceState::CONFIG_MODE, onEnterConfigMode, nullptr);
+  deviceState.setStateHandlers(DeviceState::HELP_SCREEN, onEnterOverlay, onExitOverlay);
+  deviceState.setStateHandlers(DeviceState::REPORT_SCREEN, onEnterOverlay, onExitOverlay);
+  deviceState.setStateHandlers(DeviceState::DEEP_SLEEP, onEnterDeepSleep, nullptr);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════════
@@ -637,6 +522,7 @@ void setup()
 {
   Serial.setRxBufferSize(2048); // Increased for long JSON with LNURL
   Serial.begin(115200);
+  Log::beginRecordDrain();
 
   int timer = 0;
 
@@ -648,22 +534,43 @@ void setup()
   digitalWrite(PIN_LED_BUTTON_LED, LOW); // LED off until device is ready
   pinMode(PIN_LED_BUTTON_SW, INPUT_PULLUP);
 
+  // Event queue must exist before Task1 can post WiFi events
+  deviceState.begin();
+
   FFat.begin(FORMAT_ON_FAIL);
   readFiles(); // get the saved details and store in global variables
 
-  Serial.println("\n[SETUP] readFiles() completed");
-  Serial.println("[SETUP] currency = " + currency);
-  Serial.println("[SETUP] multiChannelConfig.btcTickerMode = " + multiChannelConfig.btcTickerMode);
+  // Encode LNURLs and QR matrices of all product pins once - navigation only copies them
+  clearQRCodeCache();
+  rebuildLnurlCache();
+  static const int productPins[] = {12, 13, 10, 11};
+  for (int pin : productPins) {
+    precacheQRCode(getCachedLnurl(pin));
+  }
+  precacheQRCode(lightningConfig.lightning); // Threshold LNURL (empty in normal mode)
+
+  // Relay activations run in the background, ticked from loop()
+  paymentHandlerSetScreens(&paymentScreens);
+  relayOnComplete(onRelayActivationComplete);
+  relaySetPolicy(multiChannelConfig.channelPolicy);
+
+  LOG_INFO("SETUP", "readFiles() completed");
+  LOG_INFO("SETUP", "currency = " + currency);
+  LOG_INFOF("SETUP", "multiChannelConfig.btcTickerMode = %s", tickerModeValues[(uint8_t)multiChannelConfig.btcTickerMode]);
 
   initDisplay();
+#ifdef DISPLAY_FRAME_BENCHMARK
+  displayFrameBenchmark();
+#endif
+  registerStateHandlers();
   startupScreen();
 
   // Initialize touch controller (independent of WiFi)
   touchState.available = touch.begin();
   if (touchState.available) {
-    Serial.println("[TOUCH] ✓ Touch controller initialized successfully!");
+    LOG_INFO("TOUCH", "✓ Touch controller initialized successfully!");
   } else {
-    Serial.println("[TOUCH] ✗ Touch controller NOT available (non-touch version)");
+    LOG_INFO("TOUCH", "✗ Touch controller NOT available (non-touch version)");
   }
 
   // CRITICAL: Start button task BEFORE WiFi setup so config mode works during reconnect!
@@ -686,7 +593,7 @@ void setup()
       &Task1,    /* Task handle. */
       0);        /* Core where the task should run */
 
-  Serial.println("Button task created - config mode available");
+  LOG_INFO("SETUP", "Button task created - config mode available");
 
   // Start WiFi connection BEFORE showing startup screen (parallel execution!)
   WiFi.mode(WIFI_STA); // Set to Station mode
@@ -698,26 +605,28 @@ void setup()
   // Guard: only start WiFi if SSID is present and valid length (<= 32)
   if (wifiConfig.ssid.length() > 0 && wifiConfig.ssid.length() <= 32) {
     WiFi.begin(wifiConfig.ssid.c_str(), wifiConfig.wifiPassword.c_str());
-    Serial.println("[STARTUP] WiFi connection started in background (Power Save: OFF)");
+    LOG_INFO("STARTUP", "WiFi connection started in background (Power Save: OFF)");
+    connectivityProbeBegin(); // Internet/server checks run in their own task from now on
   } else {
-    Serial.println("[STARTUP] Skipping WiFi.begin(): SSID missing or invalid length");
+    LOG_INFO("STARTUP", "Skipping WiFi.begin(): SSID missing or invalid length");
     ssidMissingOrInvalid = true;
   }
 
   // Show startup screen for 5 seconds
-  Serial.println("[STARTUP] Showing startup screen for 5 seconds...");
+  LOG_INFO("STARTUP", "Showing startup screen for 5 seconds...");
   for (int i = 0; i < 50; i++) { // 50 * 100ms = 5 seconds
     vTaskDelay(pdMS_TO_TICKS(100));
+    deviceState.processEvents(); // Button task events (e.g. config mode) are applied here until loop() runs
     if (deviceState.isInState(DeviceState::CONFIG_MODE)) {
-      Serial.println("[STARTUP] Config mode triggered during startup");
+      LOG_INFO("STARTUP", "Config mode triggered during startup");
       return;
     }
   }
-  Serial.println("[STARTUP] Startup screen completed, switching to initialization screen");
+  LOG_INFO("STARTUP", "Startup screen completed, switching to initialization screen");
 
   // If WiFi was intentionally skipped (no SSID configured), enter Config mode immediately
   if (ssidMissingOrInvalid) {
-    Serial.println("[STARTUP] No SSID configured - entering CONFIG mode");
+    LOG_INFO("STARTUP", "No SSID configured - entering CONFIG mode");
     configMode();
     return;
   }
@@ -727,7 +636,7 @@ void setup()
 
   // Continue initialization for max 20 more seconds (total 25s)
   // Exit early if all connections are successful
-  Serial.println("[STARTUP] Showing initialization screen (max 20s more) while connections establish...");
+  LOG_INFO("STARTUP", "Showing initialization screen (max 20s more) while connections establish...");
 
   const int MAX_INIT_TIME = 200; // 200 * 100ms = 20 seconds (5s startup + 20s init = 25s total)
   bool allConnectionsReady = false;
@@ -739,52 +648,53 @@ void setup()
   
   for (int i = 0; i < MAX_INIT_TIME; i++) {
     vTaskDelay(pdMS_TO_TICKS(100));
+    deviceState.processEvents();
     
     // Check for config mode
     if (deviceState.isInState(DeviceState::CONFIG_MODE)) {
-      Serial.println("[STARTUP] Config mode triggered during startup");
+      LOG_INFO("STARTUP", "Config mode triggered during startup");
       return;
     }
     
+    ConnectivitySnapshot health = connectivitySnapshot();
+
     // Step 1: Check WiFi (runs continuously until connected)
-    if (!networkStatus.confirmed.wifi && WiFi.status() == WL_CONNECTED) {
+    if (!networkStatus.confirmed.wifi && health.wifi) {
       networkStatus.confirmed.wifi = true;
       wifiConnectTime = millis(); // Record when WiFi connected
-      Serial.println("[STARTUP] WiFi connected!");
+      LOG_INFO("STARTUP", "WiFi connected!");
     }
     
-    // Step 2: Check Internet (once WiFi is connected, DNS is configured, and not yet checked)
-    // Wait 2+ seconds after WiFi connect to allow DNS/DHCP/gateway to stabilize
-    if (networkStatus.confirmed.wifi && !internetChecked && (millis() - wifiConnectTime > 2000)) {
-      Serial.println("[STARTUP] Checking Internet...");
-      bool hasInternet = checkInternetConnectivity();
+    // Step 2: Internet result (the probe task checks 2 s after WiFi connect,
+    // once DNS/DHCP/gateway are stable) - only results newer than the WiFi connect count
+    if (networkStatus.confirmed.wifi && !internetChecked && health.internetCheckedMs != 0 &&
+        (long)(health.internetCheckedMs - wifiConnectTime) >= 0) {
       internetChecked = true;
-      if (hasInternet) {
+      if (health.internet) {
         networkStatus.confirmed.internet = true;
-        Serial.println("[STARTUP] Internet OK!");
+        LOG_INFO("STARTUP", "Internet OK!");
       } else {
-        Serial.println("[STARTUP] No Internet connection");
+        LOG_INFO("STARTUP", "No Internet connection");
         if (networkStatus.errors.internet < 99) networkStatus.errors.internet++;
       }
     }
     
-    // Step 3: Check Server (once Internet is confirmed and not yet checked)
-    if (networkStatus.confirmed.internet && !serverChecked) {
-      Serial.println("[STARTUP] Checking Server...");
-      bool serverReachable = checkServerReachability();
+    // Step 3: Server result (probed right after a successful Internet check)
+    if (networkStatus.confirmed.internet && !serverChecked && health.serverCheckedMs != 0 &&
+        (long)(health.serverCheckedMs - health.internetCheckedMs) >= 0) {
       serverChecked = true;
-      if (serverReachable) {
+      if (health.server) {
         networkStatus.confirmed.server = true;
-        Serial.println("[STARTUP] Server OK!");
+        LOG_INFO("STARTUP", "Server OK!");
       } else {
-        Serial.println("[STARTUP] Server not reachable");
+        LOG_INFO("STARTUP", "Server not reachable");
         if (networkStatus.errors.server < 99) networkStatus.errors.server++;
       }
     }
     
     // Step 4: Start WebSocket (once Server is confirmed and not yet started)
     if (networkStatus.confirmed.server && !websocketStarted) {
-      Serial.println("[STARTUP] Starting WebSocket connection...");
+      LOG_INFO("STARTUP", "Starting WebSocket connection...");
       if (lightningConfig.thresholdKey.length() > 0) {
         webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + lightningConfig.thresholdKey);
       } else {
@@ -800,37 +710,37 @@ void setup()
       webSocket.loop(); // Process events
       if (webSocket.isConnected()) {
         networkStatus.confirmed.websocket = true;
-        Serial.println("[STARTUP] WebSocket connected!");
+        LOG_INFO("STARTUP", "WebSocket connected!");
       }
     }
     
     // Check if all connections are ready
     if (networkStatus.confirmed.wifi && networkStatus.confirmed.internet && networkStatus.confirmed.server && networkStatus.confirmed.websocket) {
       allConnectionsReady = true;
-      Serial.printf("[STARTUP] All connections ready after %.1f seconds!\n", (i + 1) * 0.1);
+      LOG_INFOF("STARTUP", "All connections ready after %.1f seconds!", (i + 1) * 0.1);
       break; // Exit startup screen early
     }
     
     // Progress indicator every 5 seconds
     if ((i + 1) % 50 == 0) {
-      Serial.printf("[STARTUP] Progress: %.1fs - WiFi:%d Internet:%d Server:%d WS:%d\n", 
+      LOG_INFOF("STARTUP", "Progress: %.1fs - WiFi:%d Internet:%d Server:%d WS:%d", 
                     (i + 1) * 0.1, networkStatus.confirmed.wifi, networkStatus.confirmed.internet, networkStatus.confirmed.server, networkStatus.confirmed.websocket);
     }
   }
   
-  Serial.println("[STARTUP] Startup screen completed");
+  LOG_INFO("STARTUP", "Startup screen completed");
   
   // Determine what to show after startup screen
   if (allConnectionsReady) {
-    Serial.println("[STARTUP] All connections successful - ready to show QR code");
-    deviceState.transition(DeviceState::READY);
+    LOG_INFO("STARTUP", "All connections successful - ready to show QR code");
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     currentErrorType = 0;
   } else {
     // Show appropriate error screen based on what failed (priority order)
     if (!networkStatus.confirmed.wifi) {
-      Serial.println("[STARTUP] WiFi failed - showing WiFi error");
+      LOG_INFO("STARTUP", "WiFi failed - showing WiFi error");
       wifiReconnectScreen();
-      deviceState.transition(DeviceState::ERROR_RECOVERABLE);
+      deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
       currentErrorType = 1;
       if (networkStatus.errors.wifi < 99) networkStatus.errors.wifi++;
       
@@ -842,77 +752,69 @@ void setup()
       // Don't call checkAndReconnectWiFi here - it will be called below
       // This allows the loop to continue and handle touch/buttons
     } else if (!networkStatus.confirmed.internet) {
-      Serial.println("[STARTUP] Internet failed - showing Internet error");
+      LOG_INFO("STARTUP", "Internet failed - showing Internet error");
       internetReconnectScreen();
-      deviceState.transition(DeviceState::ERROR_RECOVERABLE);
+      deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
       currentErrorType = 2;
     } else if (!networkStatus.confirmed.server) {
-      Serial.println("[STARTUP] Server failed - showing Server error");
+      LOG_INFO("STARTUP", "Server failed - showing Server error");
       serverReconnectScreen();
-      deviceState.transition(DeviceState::ERROR_RECOVERABLE);
+      deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
       currentErrorType = 3;
     } else if (!networkStatus.confirmed.websocket) {
-      Serial.println("[STARTUP] WebSocket failed - showing WebSocket error");
+      LOG_INFO("STARTUP", "WebSocket failed - showing WebSocket error");
       websocketReconnectScreen();
-      deviceState.transition(DeviceState::ERROR_RECOVERABLE);
+      deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
       currentErrorType = 4;
       if (networkStatus.errors.websocket < 99) networkStatus.errors.websocket++;
-      
-      // Start WebSocket if not yet started
-      if (!websocketStarted) {
-        if (lightningConfig.thresholdKey.length() > 0) {
-          webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + lightningConfig.thresholdKey);
-        } else {
-          webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + deviceId);
-        }
-        webSocket.onEvent(webSocketEvent);
-        webSocket.setReconnectInterval(1000);
-      }
     }
   }
 
+  // From now on WsReconnect (re)starts the WebSocket - also if startup never got that far
+  wsReconnectBegin(&webSocketTarget, esp_random(), millis());
+
   // Button task already created earlier (before WiFi setup)
   
   // Set maxProducts based on multiChannelConfig.mode mode
-  if (multiChannelConfig.mode == "quattro") {
+  if (multiChannelConfig.mode == ChannelMode::QUATTRO) {
     maxProducts = 4;
-    Serial.println("[MULTI-CHANNEL-CONTROL] Quattro mode - 4 products available");
-  } else if (multiChannelConfig.mode == "duo") {
+    LOG_INFO("MULTI-CHANNEL-CONTROL", "Quattro mode - 4 products available");
+  } else if (multiChannelConfig.mode == ChannelMode::DUO) {
     maxProducts = 2;
-    Serial.println("[MULTI-CHANNEL-CONTROL] Duo mode - 2 products available");
+    LOG_INFO("MULTI-CHANNEL-CONTROL", "Duo mode - 2 products available");
   } else {
     maxProducts = 1;
-    Serial.println("[MULTI-CHANNEL-CONTROL] Single mode - 1 product");
+    LOG_INFO("MULTI-CHANNEL-CONTROL", "Single mode - 1 product");
   }
   
   // Initialize product navigation
   multiChannelConfig.currentProduct = 0; // Start at selection screen
 
   // Fetch initial Bitcoin data after setup is complete
-  Serial.println("[BTC] Fetching initial Bitcoin data...");
+  LOG_INFO("BTC", "Fetching initial Bitcoin data...");
   fetchBitcoinData();
-  Serial.println("[BTC] Initial fetch complete");
+  LOG_INFO("BTC", "Initial fetch complete");
   
   // Single mode: show BTC ticker immediately after setup (no product selection exists)
-  Serial.printf("[DEBUG_SETUP] mode=%s, tickerMode=%s, special=%s, thresholdKeyLen=%d, errorState=%d\n",
-                multiChannelConfig.mode.c_str(),
-                multiChannelConfig.btcTickerMode.c_str(),
-                specialModeConfig.mode.c_str(),
+  LOG_DEBUGF("SETUP", "mode=%s, tickerMode=%s, special=%s, thresholdKeyLen=%d, errorState=%d",
+                channelModeValues[(uint8_t)multiChannelConfig.mode],
+                tickerModeValues[(uint8_t)multiChannelConfig.btcTickerMode],
+                specialModeValues[(uint8_t)specialModeConfig.mode],
                 (int)lightningConfig.thresholdKey.length(),
                 deviceState.isInState(DeviceState::ERROR_RECOVERABLE));
   if (lightningConfig.thresholdKey.length() == 0 &&
-      multiChannelConfig.mode == "off" &&
+      multiChannelConfig.mode == ChannelMode::SINGLE &&
       !deviceState.isInState(DeviceState::ERROR_RECOVERABLE)) {
-    if (multiChannelConfig.btcTickerMode == "always") {
-      Serial.println("[STARTUP] Single mode (ALWAYS) - showing Bitcoin ticker immediately");
+    if (multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
+      LOG_INFO("STARTUP", "Single mode (ALWAYS) - showing Bitcoin ticker immediately");
       btctickerScreen();
       multiChannelConfig.btcTickerActive = true;
       productSelectionState.showTime = millis();
     } else {
-      Serial.println("[STARTUP] Single mode (SELECTING/OFF) - showing QR screen");
+      LOG_INFO("STARTUP", "Single mode (SELECTING/OFF) - showing QR screen");
       // Show normal or special QR for single mode
       ensureQrForPin(12);
-      if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+      if (specialModeConfig.mode != SpecialMode::STANDARD) {
         showSpecialModeQRScreen();
       } else {
         showQRScreen();
@@ -920,17 +822,18 @@ void setup()
       multiChannelConfig.btcTickerActive = false;
       productSelectionState.showTime = 0; // No ticker timeout active
     }
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
   }
   
   // Setup complete - device state already set appropriately above
 }
 
-// Punkt 3: forward declaration for modularized payment handler
-void processPaymentEvent(String &payloadStr);
-
 void loop()
 {
+  // Apply state events posted by Task1 (core 0) here on core 1
+  deviceState.processEvents();
+  handleOverlayPages();
+
   // Wait for setup to complete before running loop
   if (deviceState.getState() == DeviceState::INITIALIZING)
   {
@@ -938,6 +841,14 @@ void loop()
     return;
   }
 
+  // Config mode stops every activation, special mode waveforms included
+  if (deviceState.isInState(DeviceState::CONFIG_MODE) && relayAnyActive()) {
+    relayCancelAll();
+    paymentHandlerCancel();
+  }
+  relaySchedulerTick(millis());
+  handleThankYouTimeout();
+
   // Update ready LED state regularly
   updateReadyLed();
 
@@ -951,41 +862,34 @@ void loop()
   static bool firstLoopStatusShown = false;
   if (!firstLoopStatusShown) {
     firstLoopStatusShown = true;
-    Serial.println("\n================================");
-    Serial.println("   POWER SAVING STATUS");
-    Serial.println("================================");
-    
     // Display powerConfig.screensaver status with clear description
-    if (powerConfig.screensaver == "backlight") {
-      Serial.println("Screensaver: backlight off");
+    if (powerConfig.screensaver == ScreensaverMode::BACKLIGHT) {
+      LOG_INFO("Power", "Screensaver: backlight off");
     } else {
-      Serial.println("Screensaver: " + powerConfig.screensaver);
+      LOG_INFOF("Power", "Screensaver: %s", screensaverValues[(uint8_t)powerConfig.screensaver]);
     }
     
     // Display deep sleep status with clear description
-    if (powerConfig.deepSleep == "light") {
-      Serial.println("Deep Sleep: light sleep mode");
-    } else if (powerConfig.deepSleep == "freeze") {
-      Serial.println("Deep Sleep: deep sleep (freeze) mode");
+    if (powerConfig.deepSleep == DeepSleepMode::LIGHT) {
+      LOG_INFO("Power", "Deep Sleep: light sleep mode");
+    } else if (powerConfig.deepSleep == DeepSleepMode::FREEZE) {
+      LOG_INFO("Power", "Deep Sleep: deep sleep (freeze) mode");
     } else {
-      Serial.println("Deep Sleep: " + powerConfig.deepSleep);
+      LOG_INFOF("Power", "Deep Sleep: %s", deepSleepValues[(uint8_t)powerConfig.deepSleep]);
     }
     
-    Serial.println("Activation Time: " + String(powerConfig.activationTimeoutMs / 60000) + " minutes (" + String(powerConfig.activationTimeoutMs) + " ms)");
-    Serial.println("screensaverActive: " + String(deviceState.isInState(DeviceState::SCREENSAVER)));
-    Serial.println("deepSleepActive: " + String(deviceState.isInState(DeviceState::DEEP_SLEEP)));
-    Serial.println("activityTracking.lastActivityTime: " + String(activityTracking.lastActivityTime));
+    LOG_INFOF("Power", "Activation Time: %lu minutes (%lu ms)", powerConfig.activationTimeoutMs / 60000, powerConfig.activationTimeoutMs);
+    LOG_INFOF("Power", "screensaverActive: %d, deepSleepActive: %d, lastActivityTime: %lu",
+              deviceState.isInState(DeviceState::SCREENSAVER), deviceState.isInState(DeviceState::DEEP_SLEEP),
+              activityTracking.lastActivityTime);
     
-    if (powerConfig.screensaver != "off" && powerConfig.deepSleep == "off") {
-      Serial.println("\n⚡ MODE: SCREENSAVER ENABLED");
-      Serial.println("   Backlight will turn off after inactivity");
-    } else if (powerConfig.deepSleep != "off" && powerConfig.screensaver == "off") {
-      Serial.println("\n⚡ MODE: DEEP SLEEP ENABLED (" + powerConfig.deepSleep + ")");
-      Serial.println("   Device will sleep after inactivity");
+    if (powerConfig.screensaver != ScreensaverMode::OFF && powerConfig.deepSleep == DeepSleepMode::OFF) {
+      LOG_INFO("Power", "MODE: SCREENSAVER ENABLED - backlight will turn off after inactivity");
+    } else if (powerConfig.deepSleep != DeepSleepMode::OFF && powerConfig.screensaver == ScreensaverMode::OFF) {
+      LOG_INFOF("Power", "MODE: DEEP SLEEP ENABLED (%s) - device will sleep after inactivity", deepSleepValues[(uint8_t)powerConfig.deepSleep]);
     } else {
-      Serial.println("\n⚡ MODE: POWER SAVING DISABLED");
+      LOG_INFO("Power", "MODE: POWER SAVING DISABLED");
     }
-    Serial.println("================================\n");
   }
   
   // Screensaver and deep sleep checks are now inside the payment wait loop
@@ -999,42 +903,39 @@ void loop()
   }
   
   checkAndReconnectWiFi();
-  Serial.println("[DEBUG] Returned from checkAndReconnectWiFi()");
+  LOG_REC_DEBUG(Loop, LOOP_WIFI_CHECKED);
   if (deviceState.isInState(DeviceState::CONFIG_MODE)) return; // Exit if we entered config mode
   
   // Handle QR redraw after WiFi recovery (outside of deep call stack)
   if (needsQRRedraw) {
-    Serial.println("[RECOVERY] Redrawing QR screen after WiFi recovery");
+    LOG_INFO("RECOVERY", "Redrawing QR screen after WiFi recovery");
     redrawQRScreen();
     needsQRRedraw = false;
-    Serial.println("[RECOVERY] QR screen redrawn successfully");
+    LOG_INFO("RECOVERY", "QR screen redrawn successfully");
   }
 
-  payloadStr = "";
-  Serial.println("[DEBUG] About to check connections...");
-  
   // CRITICAL: Only show QR screen ONCE on first loop if ALL connections confirmed
   bool allConnectionsConfirmed = networkStatus.confirmed.wifi && networkStatus.confirmed.internet && networkStatus.confirmed.server && networkStatus.confirmed.websocket;
-  Serial.printf("[DEBUG] allConnectionsConfirmed: %d, firstLoop: %d\n", allConnectionsConfirmed, firstLoop);
+  LOG_REC_DEBUG(Loop, LOOP_CONNECTIONS, allConnectionsConfirmed, firstLoop);
   
   // If ticker is already active from setup in Single mode, don't override it
-  if (firstLoop && multiChannelConfig.mode == "off" && multiChannelConfig.btcTickerActive && !deviceState.isInState(DeviceState::REPORT_SCREEN)) {
-    Serial.println("[FIRSTLOOP] Ticker already active in single-mode - skipping redraw");
+  if (firstLoop && multiChannelConfig.mode == ChannelMode::SINGLE && multiChannelConfig.btcTickerActive && !deviceState.isInState(DeviceState::REPORT_SCREEN)) {
+    LOG_INFO("FIRSTLOOP", "Ticker already active in single-mode - skipping redraw");
     productSelectionState.showTime = millis();
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
   }
   else if (firstLoop && allConnectionsConfirmed && !deviceState.isInState(DeviceState::REPORT_SCREEN) && !(powerConfig.lastWakeUpTime > 0 && (millis() - powerConfig.lastWakeUpTime) < GRACE_PERIOD_MS)) {
-    Serial.println("[SCREEN] All connections confirmed - selecting initial screen");
+    LOG_INFO("SCREEN", "All connections confirmed - selecting initial screen");
     showInitialScreenAfterConnections();
     currentErrorType = 0;
     // Clear error screen flag once QR is shown
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
     currentErrorType = 0;
     // Start product selection timer
     productSelectionState.showTime = millis();
-    deviceState.transition(DeviceState::READY);
+    deviceState.dispatch(DeviceEvent::SHOW_READY);
   } else if (firstLoop && !allConnectionsConfirmed) {
-    Serial.printf("[SCREEN] First loop - waiting for all connections (WiFi:%d, Internet:%d, Server:%d, WS:%d)\n", 
+    LOG_INFOF("SCREEN", "First loop - waiting for all connections (WiFi:%d, Internet:%d, Server:%d, WS:%d)", 
                   networkStatus.confirmed.wifi, networkStatus.confirmed.internet, networkStatus.confirmed.server, networkStatus.confirmed.websocket);
   }
   
@@ -1045,9 +946,9 @@ void loop()
   unsigned long loopCount = 0;
   // Don't reset onErrorScreen/currentErrorType - they should persist across loop iterations
   
-  Serial.println("[LOOP] Entering payment wait loop...");
-  Serial.printf("[LOOP] Initial paymentStatus.paid state: %d\n", paymentStatus.paid);
-  Serial.printf("[LOOP] Error state: onErrorScreen=%d, currentErrorType=%d\n", deviceState.isInState(DeviceState::ERROR_RECOVERABLE), currentErrorType);
+  LOG_INFO("LOOP", "Entering payment wait loop...");
+  LOG_INFOF("LOOP", "Payment events waiting: %u", (unsigned)paymentQueueCount());
+  LOG_INFOF("LOOP", "Error state: onErrorScreen=%d, currentErrorType=%d", deviceState.isInState(DeviceState::ERROR_RECOVERABLE), currentErrorType);
   
   // Initialize ping/pong tracking
   networkStatus.lastPongTime = millis();
@@ -1057,20 +958,20 @@ void loop()
   static unsigned long loopIterations = 0;
   static unsigned long lastLoopDebugPrint = 0;
   
-  while (paymentStatus.paid == false)
+  while (true)
   {
     loopIterations++;
     
     // Print debug info every 10 seconds
     if (millis() - lastLoopDebugPrint > 10000) {
-      Serial.printf("[LOOP_DEBUG] Iterations: %lu, touchState.available: %d, inConfigMode: %d, onErrorScreen: %d\n", 
-                    loopIterations, touchState.available, deviceState.isInState(DeviceState::CONFIG_MODE), deviceState.isInState(DeviceState::ERROR_RECOVERABLE));
+      LOG_REC_DEBUG(Loop, LOOP_ITERATIONS, loopIterations, touchState.available,
+                    deviceState.isInState(DeviceState::CONFIG_MODE), deviceState.isInState(DeviceState::ERROR_RECOVERABLE));
       lastLoopDebugPrint = millis();
     }
     // Check if config mode was triggered during payment wait
     if (deviceState.isInState(DeviceState::CONFIG_MODE))
     {
-      Serial.println("[LOOP] Config mode detected, exiting payment loop");
+      LOG_INFO("LOOP", "Config mode detected, exiting payment loop");
       return;
     }
     
@@ -1088,14 +989,13 @@ void loop()
       
       // Debug: Print touch interrupt state every 5 seconds during powerConfig.screensaver
       if (deviceState.isInState(DeviceState::SCREENSAVER) && (millis() - lastTouchDebugPrint > 5000)) {
-        Serial.printf("[TOUCH_DEBUG] Screensaver active, PIN_TOUCH_INT=%d\n", touchIntState);
+        LOG_REC_DEBUG(Touch, TOUCH_SCREENSAVER_INT, touchIntState);
         lastTouchDebugPrint = millis();
       }
       
       if (touchIntState == LOW && deviceState.isInState(DeviceState::SCREENSAVER)) {
-        Serial.println("[TOUCH] Touch interrupt detected during powerConfig.screensaver - WAKING UP");
-        deviceState.transition(DeviceState::READY);
-        deactivateScreensaver();
+        LOG_INFO("TOUCH", "Touch interrupt detected during powerConfig.screensaver - WAKING UP");
+        deviceState.dispatch(DeviceEvent::SHOW_READY);
         powerConfig.lastWakeUpTime = millis();
         activityTracking.lastActivityTime = millis();
         // Give touch controller time to process and continue to next iteration
@@ -1126,26 +1026,24 @@ void loop()
         
         // Log any detected gesture (except LONG_PRESS which spams continuously)
         if (gesture != GESTURE_NONE && gesture != GESTURE_LONG_PRESS) {
-          Serial.printf("[TOUCH] Detected - Gesture: 0x%02X, X: %d, Y: %d", gesture, x, y);
-          
           // Show gesture name
-          if (gesture == GESTURE_SWIPE_LEFT) Serial.print(" (SWIPE LEFT)");
-          else if (gesture == GESTURE_SWIPE_RIGHT) Serial.print(" (SWIPE RIGHT)");
-          else if (gesture == GESTURE_SWIPE_UP) Serial.print(" (SWIPE UP)");
-          else if (gesture == GESTURE_SWIPE_DOWN) Serial.print(" (SWIPE DOWN)");
-          else if (gesture == GESTURE_SINGLE_CLICK) Serial.print(" (SINGLE CLICK)");
-          else if (gesture == GESTURE_DOUBLE_CLICK) Serial.print(" (DOUBLE CLICK)");
-          Serial.println();
+          const char *gestureName = "";
+          if (gesture == GESTURE_SWIPE_LEFT) gestureName = " (SWIPE LEFT)";
+          else if (gesture == GESTURE_SWIPE_RIGHT) gestureName = " (SWIPE RIGHT)";
+          else if (gesture == GESTURE_SWIPE_UP) gestureName = " (SWIPE UP)";
+          else if (gesture == GESTURE_SWIPE_DOWN) gestureName = " (SWIPE DOWN)";
+          else if (gesture == GESTURE_SINGLE_CLICK) gestureName = " (SINGLE CLICK)";
+          else if (gesture == GESTURE_DOUBLE_CLICK) gestureName = " (DOUBLE CLICK)";
+          LOG_INFOF("TOUCH", "Detected - Gesture: 0x%02X, X: %d, Y: %d%s", gesture, x, y, gestureName);
         }
         
         // SPECIAL: If on error screen, wake from powerConfig.screensaver but don't allow navigation
         if (deviceState.isInState(DeviceState::ERROR_RECOVERABLE)) {
-          Serial.println("[TOUCH] Touch detected on error screen");
+          LOG_INFO("TOUCH", "Touch detected on error screen");
           // Wake from powerConfig.screensaver if active
           if (deviceState.isInState(DeviceState::SCREENSAVER)) {
-            Serial.println("[TOUCH] Waking from powerConfig.screensaver (error screen)");
-            deviceState.transition(DeviceState::READY);
-            deactivateScreensaver();
+            LOG_INFO("TOUCH", "Waking from powerConfig.screensaver (error screen)");
+            deviceState.dispatch(DeviceEvent::SHOW_READY);
             powerConfig.lastWakeUpTime = millis();
           }
           // Update activity timer to prevent powerConfig.screensaver from activating again
@@ -1157,8 +1055,8 @@ void loop()
         
         // Handle touch on product selection screen OR Bitcoin ticker (selecting/always) OR Single mode QR with selecting
         if (deviceState.isInState(DeviceState::PRODUCT_SELECTION) || 
-            (multiChannelConfig.btcTickerActive && (multiChannelConfig.btcTickerMode == "selecting" || multiChannelConfig.btcTickerMode == "always")) ||
-            (multiChannelConfig.mode == "off" && multiChannelConfig.btcTickerMode == "selecting" && !multiChannelConfig.btcTickerActive)) {
+            (multiChannelConfig.btcTickerActive && (multiChannelConfig.btcTickerMode == TickerMode::SELECTING || multiChannelConfig.btcTickerMode == TickerMode::ALWAYS)) ||
+            (multiChannelConfig.mode == ChannelMode::SINGLE && multiChannelConfig.btcTickerMode == TickerMode::SELECTING && !multiChannelConfig.btcTickerActive)) {
           bool navigateBack = false;
           String actionName = "";
           
@@ -1197,40 +1095,32 @@ void loop()
           else if (gesture == GESTURE_SINGLE_CLICK || gesture == GESTURE_LONG_PRESS) {
             // Display: 170x320 native, rotated to 320x170 (rotation=1)
             // Touch coordinates are NOT rotated: X=0-170, Y=0-320
-            Serial.printf("[TOUCH] %s detected at X=%d, Y=%d - ", 
-                         gesture == GESTURE_SINGLE_CLICK ? "SINGLE CLICK" : "LONG PRESS", x, y);
-            
             // With rotation=1: Touch Y maps to Display X
             // Left side of display (low Display X) = low Touch Y (< 160)
             // Right side of display (high Display X) = high Touch Y (> 160)
             if (y < 160) {
-              Serial.println("LEFT SIDE");
               actionName = "TOUCH LEFT";
               navigateBack = true;
             } else if (y > 160) {
-              Serial.println("RIGHT SIDE");
               actionName = "TOUCH RIGHT";
               navigateBack = true;
-            } else {
-              Serial.println("CENTER (ignored)");
             }
+            LOG_INFOF("TOUCH", "%s detected at X=%d, Y=%d - %s",
+                      gesture == GESTURE_SINGLE_CLICK ? "SINGLE CLICK" : "LONG PRESS", x, y,
+                      y < 160 ? "LEFT SIDE" : (y > 160 ? "RIGHT SIDE" : "CENTER (ignored)"));
           }
           // Also accept quick touch without gesture (GESTURE_NONE)
           // BUT only on NEW touch to prevent continuous triggering
           else if (gesture == GESTURE_NONE && isTouched && !wasTouched) {
-            Serial.printf("[TOUCH] QUICK TOUCH at X=%d, Y=%d - ", x, y);
-            
             if (y < 160) {
-              Serial.println("LEFT SIDE");
               actionName = "QUICK TOUCH LEFT";
               navigateBack = true;
             } else if (y > 160) {
-              Serial.println("RIGHT SIDE");
               actionName = "QUICK TOUCH RIGHT";
               navigateBack = true;
-            } else {
-              Serial.println("CENTER (ignored)");
             }
+            LOG_INFOF("TOUCH", "QUICK TOUCH at X=%d, Y=%d - %s", x, y,
+                      y < 160 ? "LEFT SIDE" : (y > 160 ? "RIGHT SIDE" : "CENTER (ignored)"));
           }
           
           if (navigateBack) {
@@ -1241,43 +1131,44 @@ void loop()
             bool timeoutExpired = (now - lastNavigationTime >= 500); // 500ms timeout for new swipe
             
             if (!gestureHandledThisTouch || timeoutExpired) {
-              Serial.printf("[TOUCH] >>> %s - ", actionName.c_str());
               if (timeoutExpired && gestureHandledThisTouch) {
-                Serial.printf("(timeout reset after %lu ms) - ", now - lastNavigationTime);
+                LOG_INFOF("TOUCH", ">>> %s (timeout reset after %lu ms)", actionName.c_str(), now - lastNavigationTime);
+              } else {
+                LOG_INFOF("TOUCH", ">>> %s", actionName.c_str());
               }
               gestureHandledThisTouch = true; // Mark gesture as handled
               lastNavigationTime = now; // Update navigation timestamp
             } else {
-              Serial.printf("[TOUCH] >>> %s IGNORED (only %lu ms since last navigation)\n", actionName.c_str(), now - lastNavigationTime);
+              LOG_INFOF("TOUCH", ">>> %s IGNORED (only %lu ms since last navigation)", actionName.c_str(), now - lastNavigationTime);
               wasTouched = isTouched;
               continue;
             }
             
-            deviceState.transition(DeviceState::READY);
+            deviceState.dispatch(DeviceEvent::SHOW_READY);
             
             // Multi-Channel-Control Mode with SELECTING: Show ticker on demand
-            if (multiChannelConfig.mode != "off" && lightningConfig.thresholdKey.length() == 0 && multiChannelConfig.btcTickerMode == "selecting") {
+            if (multiChannelConfig.mode != ChannelMode::SINGLE && lightningConfig.thresholdKey.length() == 0 && multiChannelConfig.btcTickerMode == TickerMode::SELECTING) {
               if (multiChannelConfig.btcTickerActive) {
                 // Already showing ticker - skip back to product
-                Serial.println("Skip from ticker to product");
+                LOG_INFO("TOUCH", "Skip from ticker to product");
                 multiChannelConfig.btcTickerActive = false;
                 navigateToNextProduct();
               } else {
                 // Show ticker for 10 seconds
-                Serial.println("Show Bitcoin ticker for 10 seconds");
+                LOG_INFO("TOUCH", "Show Bitcoin ticker for 10 seconds");
                 btctickerScreen();
                 multiChannelConfig.btcTickerActive = true;
                 productSelectionState.showTime = millis();
               }
             }
             // Single Mode with SELECTING: Show ticker on demand
-            else if (multiChannelConfig.mode == "off" && multiChannelConfig.btcTickerMode == "selecting") {
+            else if (multiChannelConfig.mode == ChannelMode::SINGLE && multiChannelConfig.btcTickerMode == TickerMode::SELECTING) {
               if (multiChannelConfig.btcTickerActive) {
                 // Already showing ticker - skip back to QR
-                Serial.println("Skip from ticker to QR (Single mode)");
+                LOG_INFO("TOUCH", "Skip from ticker to QR (Single mode)");
                 multiChannelConfig.btcTickerActive = false;
                 ensureQrForPin(12);
-                if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+                if (specialModeConfig.mode != SpecialMode::STANDARD) {
                   showSpecialModeQRScreen();
                 } else {
                   showQRScreen();
@@ -1285,20 +1176,20 @@ void loop()
                 productSelectionState.showTime = 0;
               } else {
                 // Show ticker for 10 seconds
-                Serial.println("Show Bitcoin ticker for 10 seconds (Single mode)");
+                LOG_INFO("TOUCH", "Show Bitcoin ticker for 10 seconds (Single mode)");
                 btctickerScreen();
                 multiChannelConfig.btcTickerActive = true;
                 productSelectionState.showTime = millis();
               }
             }
             // Single Mode with ALWAYS: Show QR on touch, return to ticker after timeout
-            else if (multiChannelConfig.mode == "off" && multiChannelConfig.btcTickerMode == "always") {
+            else if (multiChannelConfig.mode == ChannelMode::SINGLE && multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
               if (multiChannelConfig.btcTickerActive) {
                 // Showing ticker - switch to QR on touch
-                Serial.println("Touch detected - switching from ticker to QR (ALWAYS mode)");
+                LOG_INFO("TOUCH", "Touch detected - switching from ticker to QR (ALWAYS mode)");
                 multiChannelConfig.btcTickerActive = false;
                 ensureQrForPin(12);
-                if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+                if (specialModeConfig.mode != SpecialMode::STANDARD) {
                   showSpecialModeQRScreen();
                 } else {
                   showQRScreen();
@@ -1310,15 +1201,15 @@ void loop()
               }
             }
             // Multi-Channel-Control Mode: Navigate to next product
-            else if (multiChannelConfig.mode != "off" && lightningConfig.thresholdKey.length() == 0) {
+            else if (multiChannelConfig.mode != ChannelMode::SINGLE && lightningConfig.thresholdKey.length() == 0) {
               multiChannelConfig.btcTickerActive = false; // Exit ticker on navigation
-              Serial.println("Navigate to next product");
+              LOG_INFO("TOUCH", "Navigate to next product");
               navigateToNextProduct();
               // Reset timer for product navigation
               productSelectionState.showTime = millis();
             } else {
               // Normal/Special/Threshold Mode: Return to QR screen
-              Serial.println("Returning to QR screen");
+              LOG_INFO("TOUCH", "Returning to QR screen");
               redrawQRScreen();
               // Reset timer for normal mode
               productSelectionState.showTime = millis();
@@ -1327,7 +1218,7 @@ void loop()
         }
         // Handle touch on product QR screen (Multi-Channel-Control mode only)
         // Allow navigation when showing product QR code
-        else if (multiChannelConfig.mode != "off" && lightningConfig.thresholdKey.length() == 0 && !deviceState.isInState(DeviceState::PRODUCT_SELECTION)) {
+        else if (multiChannelConfig.mode != ChannelMode::SINGLE && lightningConfig.thresholdKey.length() == 0 && !deviceState.isInState(DeviceState::PRODUCT_SELECTION)) {
           bool navigate = false;
           String actionName = "";
           
@@ -1369,16 +1260,17 @@ void loop()
             bool timeoutExpired = (now - lastNavigationTime >= 500); // 500ms timeout for new swipe
             
             if (!gestureHandledThisTouch || timeoutExpired) {
-              Serial.printf("[TOUCH] >>> %s on product screen - Navigate to next product", actionName.c_str());
               if (timeoutExpired && gestureHandledThisTouch) {
-                Serial.printf(" (timeout reset after %lu ms)", now - lastNavigationTime);
+                LOG_INFOF("TOUCH", ">>> %s on product screen - Navigate to next product (timeout reset after %lu ms)",
+                          actionName.c_str(), now - lastNavigationTime);
+              } else {
+                LOG_INFOF("TOUCH", ">>> %s on product screen - Navigate to next product", actionName.c_str());
               }
-              Serial.println();
               navigateToNextProduct();
               gestureHandledThisTouch = true; // Mark gesture as handled
               lastNavigationTime = now; // Update navigation timestamp
             } else {
-              Serial.printf("[TOUCH] >>> %s IGNORED (only %lu ms since last navigation)\n", actionName.c_str(), now - lastNavigationTime);
+              LOG_INFOF("TOUCH", ">>> %s IGNORED (only %lu ms since last navigation)", actionName.c_str(), now - lastNavigationTime);
             }
           }
         }
@@ -1413,12 +1305,12 @@ void loop()
     // Check if it's time to show/hide Bitcoin ticker screen
     // Behavior depends on multiChannelConfig.btcTickerMode
     if (!deviceState.isInState(DeviceState::ERROR_RECOVERABLE) && lightningConfig.thresholdKey.length() == 0) {
-      if (multiChannelConfig.btcTickerMode == "always") {
-        if (multiChannelConfig.mode != "off") {
+      if (multiChannelConfig.btcTickerMode == TickerMode::ALWAYS) {
+        if (multiChannelConfig.mode != ChannelMode::SINGLE) {
           // ALWAYS mode Duo/Quattro: Show ticker after PRODUCT_SELECTION_DELAY on products
           if (!multiChannelConfig.btcTickerActive && productSelectionState.showTime > 0 && 
               (millis() - productSelectionState.showTime) >= PRODUCT_SELECTION_DELAY) {
-            Serial.println("[SCREEN] Showing Bitcoin ticker screen after timeout (ALWAYS mode - Duo/Quattro)");
+            LOG_INFO("SCREEN", "Showing Bitcoin ticker screen after timeout (ALWAYS mode - Duo/Quattro)");
             btctickerScreen();
             multiChannelConfig.btcTickerActive = true;
             productSelectionState.showTime = 0; // Reset timer - ticker has no timeout in ALWAYS mode
@@ -1427,35 +1319,35 @@ void loop()
           // ALWAYS mode Single: Return to ticker after PRODUCT_TIMEOUT on QR
           if (!multiChannelConfig.btcTickerActive && productSelectionState.showTime > 0 && 
               (millis() - productSelectionState.showTime) >= PRODUCT_SELECTION_DELAY) {
-            Serial.println("[SCREEN] Returning to ticker after timeout (ALWAYS mode - Single)");
+            LOG_INFO("SCREEN", "Returning to ticker after timeout (ALWAYS mode - Single)");
             btctickerScreen();
             multiChannelConfig.btcTickerActive = true;
             productSelectionState.showTime = 0; // Reset timer
           }
         }
-      } else if (multiChannelConfig.btcTickerMode == "off" && multiChannelConfig.mode != "off") {
+      } else if (multiChannelConfig.btcTickerMode == TickerMode::OFF && multiChannelConfig.mode != ChannelMode::SINGLE) {
         // OFF mode with Duo/Quattro: Return to product selection after timeout on product
         if (productSelectionState.showTime > 0 && 
             (millis() - productSelectionState.showTime) >= PRODUCT_SELECTION_DELAY) {
           // Check if we're on a product screen
           if (multiChannelConfig.currentProduct > 0) {
-            Serial.println("[SCREEN] Timeout reached - returning to product selection screen (OFF mode - Duo/Quattro)");
+            LOG_INFO("SCREEN", "Timeout reached - returning to product selection screen (OFF mode - Duo/Quattro)");
             multiChannelConfig.currentProduct = -1;
-            deviceState.transition(DeviceState::PRODUCT_SELECTION);
+            deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
             productSelectionScreen();
             productSelectionState.showTime = 0; // Reset timer
           }
         }
-      } else if (multiChannelConfig.btcTickerMode == "selecting") {
-        if (multiChannelConfig.mode == "off") {
+      } else if (multiChannelConfig.btcTickerMode == TickerMode::SELECTING) {
+        if (multiChannelConfig.mode == ChannelMode::SINGLE) {
           // Single mode: Hide ticker after BTC_TICKER_TIMEOUT_DELAY (10 seconds)
           if (multiChannelConfig.btcTickerActive && productSelectionState.showTime > 0 && 
               (millis() - productSelectionState.showTime) >= BTC_TICKER_TIMEOUT_DELAY) {
-            Serial.println("[SCREEN] Hiding Bitcoin ticker after ticker timeout (SELECTING mode - Single)");
+            LOG_INFO("SCREEN", "Hiding Bitcoin ticker after ticker timeout (SELECTING mode - Single)");
             multiChannelConfig.btcTickerActive = false;
             // Show normal QR screen
             ensureQrForPin(12);
-            if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
+            if (specialModeConfig.mode != SpecialMode::STANDARD) {
               showSpecialModeQRScreen();
             } else {
               showQRScreen();
@@ -1467,7 +1359,7 @@ void loop()
           if (productSelectionState.showTime > 0) {
             if (multiChannelConfig.btcTickerActive && (millis() - productSelectionState.showTime) >= BTC_TICKER_TIMEOUT_DELAY) {
               // Ticker showing: Hide ticker after BTC_TICKER_TIMEOUT_DELAY and return to last product
-              Serial.println("[SCREEN] Hiding ticker after ticker timeout (SELECTING mode - Duo/Quattro)");
+              LOG_INFO("SCREEN", "Hiding ticker after ticker timeout (SELECTING mode - Duo/Quattro)");
               multiChannelConfig.btcTickerActive = false;
               // Show last product again
               if (multiChannelConfig.currentProduct >= 1) {
@@ -1475,16 +1367,16 @@ void loop()
               } else {
                 // Fallback: show product selection
                 multiChannelConfig.currentProduct = -1;
-                deviceState.transition(DeviceState::PRODUCT_SELECTION);
+                deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
                 productSelectionScreen();
               }
               productSelectionState.showTime = 0; // Reset timer
             } else if (multiChannelConfig.currentProduct > 0 && !deviceState.isInState(DeviceState::PRODUCT_SELECTION) && 
                       (millis() - productSelectionState.showTime) >= PRODUCT_SELECTION_DELAY) {
               // Product showing: Return to product selection after PRODUCT_SELECTION_DELAY
-              Serial.println("[SCREEN] Timeout reached - returning to product selection screen (SELECTING mode - Duo/Quattro)");
+              LOG_INFO("SCREEN", "Timeout reached - returning to product selection screen (SELECTING mode - Duo/Quattro)");
               multiChannelConfig.currentProduct = -1;
-              deviceState.transition(DeviceState::PRODUCT_SELECTION);
+              deviceState.dispatch(DeviceEvent::SHOW_PRODUCT_SELECTION);
               productSelectionScreen();
               productSelectionState.showTime = 0; // Reset timer
             }
@@ -1496,41 +1388,58 @@ void loop()
     // Power saving checks (screensaver/deep sleep)
     handlePowerSavingChecks();
     
-    webSocket.loop();
+    // Reconnect with backoff; the socket is left alone while a backoff delay runs
+    ConnectivitySnapshot health = connectivitySnapshot();
+    wsReconnectTick(millis(), health.wifi && health.server && !deviceState.isInState(DeviceState::CONFIG_MODE));
+    if (wsReconnectSocketActive()) {
+      webSocket.loop();
+    }
     loopCount++;
 
-    // Update Bitcoin ticker (checks interval internally, non-blocking)
+    // Apply queued state events, advance the help/report pages, switch off expired relay activations
+    // and leave the thank you screen (non-blocking)
+    deviceState.processEvents();
+    handleOverlayPages();
+    relaySchedulerTick(millis());
+    handleThankYouTimeout();
+
+    // Block/price feed (optional, MarketFeed.h) and Bitcoin ticker (checks interval internally, non-blocking)
+    marketFeedLoop(health.internet && multiChannelConfig.btcTickerMode != TickerMode::OFF && !deviceState.isInState(DeviceState::CONFIG_MODE));
     updateBitcoinTicker();
     
     // Update switch labels periodically (checks interval internally, non-blocking)
     updateSwitchLabels();
+
+    // Close idle HTTPS connections to give their TLS memory back
+    httpsPoolMaintain();
     
     // Log status every 200000 loops (roughly every 10-20 minutes)
     if (loopCount % 200000 == 0)
     {
-      Serial.printf("[LOOP] Still waiting... WiFi: %d, WS Connected: %d, paymentStatus.paid: %d\n", 
-                    WiFi.status() == WL_CONNECTED, webSocket.isConnected(), paymentStatus.paid);
+      PaymentQueueStats queueStats = paymentQueueStats();
+      LOG_REC_INFO(Loop, LOOP_STILL_WAITING, WiFi.status() == WL_CONNECTED, webSocket.isConnected(),
+                   queueStats.popped, queueStats.overflows + queueStats.oversized);
     }
     
-    // Check Internet connectivity every 30 seconds (independent of WebSocket)
-    if (millis() - lastInternetCheck > 30000 && !deviceState.isInState(DeviceState::CONFIG_MODE))
+    // Handle each new Internet result of the probe task (about every 30 seconds, independent of WebSocket)
+    if (health.internetCheckedMs != lastInternetCheck && !deviceState.isInState(DeviceState::CONFIG_MODE))
     {
       // CRITICAL: Check WiFi first! Don't show "No Internet" if WiFi is down
-      if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("[INTERNET] Skipping Internet check - WiFi is down");
-        lastInternetCheck = millis();
-      } else if (WiFi.status() == WL_CONNECTED) {
-        bool hasInternet = checkInternetConnectivity();
+      if (!health.wifi) {
+        LOG_INFO("INTERNET", "Skipping Internet check - WiFi is down");
+        lastInternetCheck = health.internetCheckedMs;
+      } else {
+        bool hasInternet = health.internet;
         if (!hasInternet) {
           if (!deviceState.isInState(DeviceState::ERROR_RECOVERABLE) || currentErrorType > 2) {
-            Serial.println("[INTERNET] Internet connection lost!");
+            LOG_INFO("INTERNET", "Internet connection lost!");
             if (networkStatus.errors.internet < 99) networkStatus.errors.internet++;
-            Serial.printf("[ERROR] Internet error count: %d\n", networkStatus.errors.internet);
+            LOG_ERRORF("Network", "Internet error count: %d", networkStatus.errors.internet);
             internetReconnectScreen();
-            deviceState.transition(DeviceState::ERROR_RECOVERABLE);
+            deviceState.dispatch(DeviceEvent::CONNECTION_LOST);
             currentErrorType = 2; // Internet error
             // Reset product selection screen
-            deviceState.transition(DeviceState::READY);
+            deviceState.dispatch(DeviceEvent::SHOW_READY);
           }
           networkStatus.confirmed.internet = false; // Clear confirmation
           networkStatus.confirmed.server = false; // Also clear server/websocket (they depend on Internet)
@@ -1539,62 +1448,28 @@ void loop()
         } else {
           // Internet OK - set confirmation
           if (!networkStatus.confirmed.internet) {
-            Serial.println("[CONFIRMED] Internet connection confirmed!");
+            LOG_INFO("CONFIRMED", "Internet connection confirmed!");
             networkStatus.confirmed.internet = true;
             
             // Always fetch Bitcoin data when Internet is restored (if ticker is active)
             // BUT: Don't update bitcoinData.lastUpdate so the regular timer continues
             if (multiChannelConfig.btcTickerActive) {
-              Serial.println("[RECOVERY] Internet restored - fetching Bitcoin data for ticker...");
-              HTTPClient http;
-
-              // Fetch BTC price using configured currency
-              String currencyLower = currency;
-              currencyLower.toLowerCase();
-              String apiUrl = "https://api.coingecko.com/api/v3/simple/price?ids=bitcoin&vs_currencies=" + currencyLower;
-              http.begin(apiUrl);
-              http.setTimeout(5000);
-              int httpCode = http.GET();
-              if (httpCode == 200) {
-                String payload = http.getString();
-                JsonDocument doc;
-                DeserializationError error = deserializeJson(doc, payload);
-                if (!error && doc["bitcoin"].is<JsonObject>()) {
-                  float price = doc["bitcoin"][currencyLower];
-                  bitcoinData.price = String((int)price);
-                  Serial.println("[BTC] Recovery price updated: " + bitcoinData.price + " " + currency);
-                }
-              }
-              http.end();
+              LOG_INFO("RECOVERY", "Internet restored - fetching Bitcoin data for ticker...");
+              fetchBitcoinData(false);
+              LOG_INFO("BTC", "Recovery fetch completed (timer NOT reset)");
               
-              delay(100);
-              
-              // Fetch block height
-              http.begin("https://mempool.space/api/blocks/tip/height");
-              http.setTimeout(5000);
-              httpCode = http.GET();
-              if (httpCode == 200) {
-                bitcoinData.blockHigh = http.getString();
-                bitcoinData.blockHigh.trim();
-                Serial.println("[BTC] Recovery block height updated: " + bitcoinData.blockHigh);
-              }
-              http.end();
-              
-              // DON'T update bitcoinData.lastUpdate - let the regular update cycle continue
-              Serial.println("[BTC] Recovery fetch completed (timer NOT reset)");
-              
-              // Redraw ticker screen if it was active
-              if (!deviceState.isInState(DeviceState::ERROR_RECOVERABLE)) {
+              // Redraw ticker screen if it was active (not over ACTION TIME)
+              if (!deviceState.isInState(DeviceState::ERROR_RECOVERABLE) && !relayAnyActive()) {
                 btctickerScreen();
               }
             }
             
             // If recovering from Internet error screen, clear error and refresh display
             if (deviceState.isInState(DeviceState::ERROR_RECOVERABLE) && currentErrorType == 2) {
-              Serial.println("[RECOVERY] Clearing Internet error screen...");
-              deviceState.transition(DeviceState::READY);
+              LOG_INFO("RECOVERY", "Clearing Internet error screen...");
+              deviceState.dispatch(DeviceEvent::SHOW_READY);
               currentErrorType = 0;
-              deviceState.transition(DeviceState::READY);
+              deviceState.dispatch(DeviceEvent::SHOW_READY);
               
               // Redraw appropriate screen
               if (multiChannelConfig.btcTickerActive) {
@@ -1605,7 +1480,7 @@ void loop()
             }
           }
         }
-        lastInternetCheck = millis();
+        lastInternetCheck = health.internetCheckedMs;
       }
     }
     
@@ -1613,7 +1488,7 @@ void loop()
     // Only if WebSocket is connected!
     if (webSocket.isConnected() && millis() - networkStatus.lastPingTime > 60000 && !deviceState.isInState(DeviceState::CONFIG_MODE))
     {
-      Serial.println("[PING] Sending WebSocket ping to verify connection...");
+      LOG_INFO("PING", "Sending WebSocket ping to verify connection...");
       webSocket.sendPing();
       networkStatus.lastPingTime = millis();
       networkStatus.waitingForPong = true;
@@ -1623,28 +1498,30 @@ void loop()
     // Note: Internet is checked separately every 30 seconds
     if (millis() - lastWiFiCheck > 5000)
     {
-      // Check connection status step by step
-      bool wifiOk = (WiFi.status() == WL_CONNECTED);
+      // Check connection status step by step (probe task results, never blocks)
+      health = connectivitySnapshot();
+      bool wifiOk = health.wifi;
       bool serverOk = true;
       bool websocketOk = webSocket.isConnected();
       
       // Step 1: WiFi check (HIGHEST PRIORITY - check immediately)
       if (!wifiOk) {
         // WiFi down - highest priority, skip all other checks immediately
-        Serial.println("[CHECK] WiFi is down - triggering WiFi reconnect");
+        LOG_INFO("CHECK", "WiFi is down - triggering WiFi reconnect");
         currentErrorType = 1; // WiFi error (highest priority)
         networkStatus.confirmed.wifi = false; // Clear all confirmations when WiFi is down
         networkStatus.confirmed.internet = false;
         networkStatus.confirmed.server = false;
         networkStatus.confirmed.websocket = false;
+        httpsPoolCloseAll(); // Kept-alive connections did not survive the WiFi loss
         checkAndReconnectWiFi();
         if (deviceState.isInState(DeviceState::CONFIG_MODE)) return;
         return; // Exit immediately after WiFi check
       }
       // Step 2: WebSocket NOT connected - check Server
       else if (!websocketOk) {
-        // WiFi OK but WebSocket not connected - check if Server is reachable
-        serverOk = checkServerReachability();
+        // WiFi OK but WebSocket not connected - check if Server is reachable (probed every 5 s)
+        serverOk = health.server;
         if (!serverOk) {
           // Server down - WebSocket can't connect (that's expected)
           websocketOk = false;
@@ -1663,22 +1540,22 @@ void loop()
         if (onErrorScreen && currentErrorType == 2)
         {
           // Internet error has higher priority - don't show Server error
-          Serial.println("Server check skipped - Internet error has higher priority");
+          LOG_INFO("Network", "Server check skipped - Internet error has higher priority");
           return;
         }
         
         // Only show/update Server error if no higher priority error
         if (!onErrorScreen || currentErrorType >= 3)
         {
-          Serial.println("Server not reachable (TCP port 443 closed/timeout)");
+          LOG_WARN("Network", "Server not reachable (TCP port 443 closed/timeout)");
           if (networkStatus.errors.server < 99) networkStatus.errors.server++;
-          Serial.printf("[ERROR] Server error count: %d\n", networkStatus.errors.server);
-          Serial.println("[SCREEN] Showing Server error screen (type 3)");
+          LOG_ERRORF("Network", "Server error count: %d", networkStatus.errors.server);
+          LOG_INFO("SCREEN", "Showing Server error screen (type 3)");
           serverReconnectScreen();
           onErrorScreen = true;
           currentErrorType = 3; // Server error
           // Reset product selection screen (transition to READY as base state)
-          deviceState.transition(DeviceState::READY);
+          deviceState.dispatch(DeviceEvent::SHOW_READY);
         }
         // Clear server/websocket confirmations
         networkStatus.confirmed.server = false;
@@ -1692,7 +1569,7 @@ void loop()
       // Server OK but still on Server error screen → Move to WebSocket error check
       if (wifiOk && serverOk && onErrorScreen && currentErrorType == 3 && !deviceState.isInState(DeviceState::CONFIG_MODE))
       {
-        Serial.println("[RECOVERY] Server OK - moving to WebSocket error check");
+        LOG_INFO("RECOVERY", "Server OK - moving to WebSocket error check");
         networkStatus.confirmed.server = true;
         currentErrorType = 4; // Move to WebSocket error check
         // Don't return - let WebSocket check run below
@@ -1705,70 +1582,29 @@ void loop()
         if (onErrorScreen && currentErrorType < 4)
         {
           // Higher priority error (WiFi/Internet/Server) - don't show WebSocket error
-          Serial.println("WebSocket check skipped - higher priority error active");
+          LOG_INFO("Network", "WebSocket check skipped - higher priority error active");
           return;
         }
         
-        // Only show/update WebSocket error if no higher priority error
-        if (!onErrorScreen || currentErrorType >= 4)
-        {
-          Serial.println("WebSocket disconnected, attempting reconnect...");
-          // Reset product selection screen (transition to READY as base state)
-          deviceState.transition(DeviceState::READY);
-        }
-        
-        // Try to reconnect WebSocket (up to 3 attempts)
-        int reconnectAttempts = 0;
-        int sslErrorCount = 0; // Count SSL connection errors (detected by error events)
-        
-        while (!webSocket.isConnected() && reconnectAttempts < 3 && !deviceState.isInState(DeviceState::CONFIG_MODE))
-        {
-          if (WiFi.status() != WL_CONNECTED || deviceState.isInState(DeviceState::CONFIG_MODE)) return;
-          
-          webSocket.disconnect();
-          vTaskDelay(pdMS_TO_TICKS(500));
-          
-          reconnectAttempts++;
-          Serial.printf("WebSocket reconnect attempt %d/3\n", reconnectAttempts);
-          
-          if (lightningConfig.thresholdKey.length() > 0) {
-            webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + lightningConfig.thresholdKey);
-          } else {
-            webSocket.beginSSL(lnbitsServer, 443, "/api/v1/ws/" + deviceId);
-          }
-          
-          // Wait for connection to establish (2 seconds)
-          vTaskDelay(pdMS_TO_TICKS(2000));
-        }
-        
-        if (webSocket.isConnected())
+        // Reconnect attempts run in wsReconnectTick() with backoff - only show the
+        // error screen once several attempts in a row have failed, then update it per failed attempt
+        static uint32_t reportedFailures = 0;
+        WsReconnectStats reconnect = wsReconnectStats();
+        if (reconnect.consecutiveFailures >= WS_RECONNECT_ERROR_AFTER && reconnect.failures != reportedFailures)
         {
-          Serial.println("WebSocket reconnected successfully");
-          networkStatus.confirmed.websocket = true; // Set confirmation
-          onErrorScreen = false;
-          currentErrorType = 0;
-          
-          // Fetch switch labels after successful reconnection
-          Serial.println("[RECOVERY] Fetching switch labels after WebSocket reconnection...");
-          fetchSwitchLabels();
-          
-          return;
-        }
-        else
-        {
-          // WebSocket reconnect failed after 3 attempts
-          Serial.printf("WebSocket reconnect failed after %d attempts\n", reconnectAttempts);
+          reportedFailures = reconnect.failures;
+          LOG_WARNF("Network", "WebSocket reconnect failed after %d attempts", reconnect.consecutiveFailures);
           if (networkStatus.errors.websocket < 99) networkStatus.errors.websocket++;
-          Serial.printf("[ERROR] WebSocket error count: %d\n", networkStatus.errors.websocket);
-          Serial.println("[SCREEN] Showing WebSocket error screen (type 4)");
+          LOG_ERRORF("Network", "WebSocket error count: %d", networkStatus.errors.websocket);
+          LOG_INFO("SCREEN", "Showing WebSocket error screen (type 4)");
           websocketReconnectScreen();
           networkStatus.confirmed.websocket = false; // Clear confirmation
           currentErrorType = 4;
           onErrorScreen = true;
           // Reset product selection screen (transition to READY as base state)
-          deviceState.transition(DeviceState::READY);
-          return;
+          deviceState.dispatch(DeviceEvent::SHOW_READY);
         }
+        return;
       }
       
       // Auto-recovery: All connections restored - set confirmation flags
@@ -1777,21 +1613,21 @@ void loop()
         // Set all confirmation flags (so QR screen can be shown)
         if (!networkStatus.confirmed.wifi) {
           networkStatus.confirmed.wifi = true;
-          Serial.println("[CONFIRMED] WiFi connection confirmed!");
+          LOG_INFO("CONFIRMED", "WiFi connection confirmed!");
         }
         if (!networkStatus.confirmed.server) {
           networkStatus.confirmed.server = true;
-          Serial.println("[CONFIRMED] Server connection confirmed!");
+          LOG_INFO("CONFIRMED", "Server connection confirmed!");
         }
         if (!networkStatus.confirmed.websocket) {
           networkStatus.confirmed.websocket = true;
-          Serial.println("[CONFIRMED] WebSocket connection confirmed!");
+          LOG_INFO("CONFIRMED", "WebSocket connection confirmed!");
         }
         
         // Clear error state and redraw QR screen
         if (onErrorScreen) {
-          Serial.printf("[RECOVERY] All connections recovered (was error type %d)\n", currentErrorType);
-          Serial.println("[SCREEN] Clearing error screen and redrawing QR code");
+          LOG_INFOF("RECOVERY", "All connections recovered (was error type %d)", currentErrorType);
+          LOG_INFO("SCREEN", "Clearing error screen and redrawing QR code");
           onErrorScreen = false;
           currentErrorType = 0;
           consecutiveWebSocketFailures = 0; // Reset failure counter
@@ -1799,172 +1635,21 @@ void loop()
           
           // Redraw QR screen immediately
           redrawQRScreen();
-          Serial.println("[SCREEN] QR screen displayed after recovery");
+          LOG_INFO("SCREEN", "QR screen displayed after recovery");
           // Reset product selection timer
           productSelectionState.showTime = millis();
-          deviceState.transition(DeviceState::READY);
+          deviceState.dispatch(DeviceEvent::SHOW_READY);
         }
         return;
       }
       
       lastWiFiCheck = millis();
     }
-    if (paymentStatus.paid) {
-      processPaymentEvent(payloadStr);
+    // Drain all queued payment events (static: records are too large for the loop stack)
+    static PaymentEvent paymentEvent;
+    while (paymentQueuePop(paymentEvent)) {
+      processPaymentEvent(paymentEvent);
     }
   }
-  Serial.println("[LOOP] Exiting payment wait loop");
-}
-
-// --- Punkt 3: Modularized payment handling ---
-static void processThresholdPayment(const JsonDocument &doc)
-{
-  JsonVariantConst payment = doc["payment"];
-  int payment_amount = payment["amount"].as<int>(); // in mSats
-  int payment_sats = payment_amount / 1000; // Convert to sats
-  int threshold_sats = lightningConfig.thresholdAmount.toInt();
-
-  Serial.printf("[THRESHOLD] Payment received: %d sats (%d mSats)\n", payment_sats, payment_amount);
-  Serial.printf("[THRESHOLD] Threshold: %d sats\n", threshold_sats);
-
-  // Check if payment meets or exceeds threshold
-  if (payment_sats >= threshold_sats) {
-    Serial.println("[THRESHOLD] *** PAYMENT >= THRESHOLD! Triggering GPIO! ***");
-    Serial.printf("[THRESHOLD] Switching GPIO %d for %d ms\n",
-                  lightningConfig.thresholdPin.toInt(), lightningConfig.thresholdTime.toInt());
-
-    // Pause product timeout while ACTION TIME is active
-    productSelectionState.showTime = 0;
-
-    int pin = lightningConfig.thresholdPin.toInt();
-    int duration = lightningConfig.thresholdTime.toInt();
-
-    if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
-      Serial.println("[THRESHOLD] Using special mode: " + specialModeConfig.mode);
-      if (deviceState.isInState(DeviceState::SCREENSAVER)) {
-        deviceState.transition(DeviceState::READY);
-        deactivateScreensaver();
-      }
-      activityTracking.lastActivityTime = millis();
-      actionTimeScreen();
-      executeSpecialMode(pin, duration, specialModeConfig.frequency, specialModeConfig.dutyCycleRatio);
-    } else {
-      Serial.println("[THRESHOLD] Using standard mode");
-      if (deviceState.isInState(DeviceState::SCREENSAVER)) {
-        deviceState.transition(DeviceState::READY);
-        deactivateScreensaver();
-      }
-      activityTracking.lastActivityTime = millis();
-      actionTimeScreen();
-      pinMode(pin, OUTPUT);
-      digitalWrite(pin, HIGH);
-      Serial.printf("[RELAY] Pin %d set HIGH\n", pin);
-      delay(duration);
-      digitalWrite(pin, LOW);
-      Serial.printf("[RELAY] Pin %d set LOW\n", pin);
-    }
-
-    thankYouScreen();
-    activityTracking.lastActivityTime = millis();
-    delay(2000);
-    // Reset timer AFTER thank you screen so full PRODUCT_TIMEOUT runs from now
-    productSelectionState.showTime = millis();
-    showThresholdQRScreen();
-    Serial.println("[THRESHOLD] Ready for next payment");
-    deviceState.transition(DeviceState::READY);
-  } else {
-    Serial.printf("[THRESHOLD] Payment too small (%d < %d sats) - ignoring\n",
-                  payment_sats, threshold_sats);
-  }
-}
-
-static void processNormalPayment(int pin, int duration)
-{
-  Serial.printf("[RELAY] Pin: %d, Duration: %d ms\n", pin, duration);
-
-  // Pause product timeout while ACTION TIME is active
-  productSelectionState.showTime = 0;
-
-  if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
-    Serial.println("[NORMAL] Using special mode: " + specialModeConfig.mode);
-    activityTracking.lastActivityTime = millis();
-    if (deviceState.isInState(DeviceState::SCREENSAVER)) {
-      deactivateScreensaver();
-      deviceState.transition(DeviceState::READY);
-    }
-    actionTimeScreen();
-    executeSpecialMode(pin, duration, specialModeConfig.frequency, specialModeConfig.dutyCycleRatio);
-  } else {
-    Serial.println("[NORMAL] Using standard mode");
-    activityTracking.lastActivityTime = millis();
-    if (deviceState.isInState(DeviceState::SCREENSAVER)) {
-      deactivateScreensaver();
-      deviceState.transition(DeviceState::READY);
-    }
-    actionTimeScreen();
-    pinMode(pin, OUTPUT);
-    digitalWrite(pin, HIGH);
-    Serial.printf("[RELAY] Pin %d set HIGH\n", pin);
-
-    if (multiChannelConfig.mode == "off" && pin == 12) {
-      pinMode(13, OUTPUT);
-      digitalWrite(13, HIGH);
-      Serial.println("[RELAY] Pin 13 set HIGH (parallel to Pin 12 in Single mode)");
-    }
-
-    delay(duration);
-
-    digitalWrite(pin, LOW);
-    Serial.printf("[RELAY] Pin %d set LOW\n", pin);
-
-    if (multiChannelConfig.mode == "off" && pin == 12) {
-      digitalWrite(13, LOW);
-      Serial.println("[RELAY] Pin 13 set LOW (parallel to Pin 12 in Single mode)");
-    }
-  }
-
-  thankYouScreen();
-  activityTracking.lastActivityTime = millis();
-  if (deviceState.isInState(DeviceState::SCREENSAVER)) {
-    deactivateScreensaver();
-    deviceState.transition(DeviceState::READY);
-  }
-  delay(2000);
-  // Reset timer AFTER thank you screen so full PRODUCT_TIMEOUT runs from now
-  productSelectionState.showTime = millis();
-  // Force QR display (not ticker) after payment in ALWAYS mode
-  multiChannelConfig.btcTickerActive = false;
-  ensureQrForPin(12);
-  if (specialModeConfig.mode != "standard" && specialModeConfig.mode != "") {
-    showSpecialModeQRScreen();
-  } else {
-    showQRScreen();
-  }
-  Serial.println("[NORMAL] Ready for next payment");
-}
-
-void processPaymentEvent(String &payloadStr)
-{
-  Serial.println("[PAYMENT] Payment detected!");
-  Serial.printf("[PAYMENT] PayloadStr: %s\n", payloadStr.c_str());
-
-  if (lightningConfig.thresholdKey.length() > 0) {
-    Serial.println("[THRESHOLD] Processing payment in threshold mode...");
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payloadStr);
-    if (error) {
-      Serial.print("[THRESHOLD] JSON parse error: ");
-      Serial.println(error.c_str());
-      paymentStatus.paid = false;
-      return;
-    }
-    processThresholdPayment(doc);
-    paymentStatus.paid = false;
-  } else {
-    Serial.println("[NORMAL] Processing payment in normal mode...");
-    int pin = getValue(payloadStr, '-', 0).toInt();
-    int duration = getValue(payloadStr, '-', 1).toInt();
-    processNormalPayment(pin, duration);
-    paymentStatus.paid = false;
-  }
+  LOG_INFO("LOOP", "Exiting payment wait loop");
 }
@@ -0,0 +1,124 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include <string>
+#include "ApiResponse.h"
+
+/**
+ * Streaming parsers of the LNbits, price and mempool feed responses.
+ */
+
+// In-memory body, read like an HTTP stream
+class BodyStream : public Stream {
+public:
+  explicit BodyStream(const char* body) : body_(body) {}
+  int available() override { return (int)(body_.size() - position_); }
+  int read() override { return position_ < body_.size() ? (uint8_t)body_[position_++] : -1; }
+  int peek() override { return position_ < body_.size() ? (uint8_t)body_[position_] : -1; }
+
+private:
+  std::string body_;
+  size_t position_ = 0;
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_switch_labels() {
+  BodyStream body("{\"id\":\"abc\",\"currency\":\"eur\",\"switches\":["
+                  "{\"amount\":1.5,\"duration\":1000,\"pin\":12,\"label\":\"Coffee\"},"
+                  "{\"amount\":2,\"duration\":2000,\"pin\":10,\"label\":\"Tea\"},"
+                  "{\"amount\":3,\"duration\":3000,\"pin\":99,\"label\":\"Unknown pin\"}]}");
+  SwitchLabelsResponse response;
+  TEST_ASSERT_TRUE(parseSwitchLabels(body, response));
+  TEST_ASSERT_EQUAL_STRING("eur", response.currency);
+  TEST_ASSERT_EQUAL(3, response.switchCount);
+  TEST_ASSERT_EQUAL_STRING("Coffee", response.labels[getPinIndex(12)]);
+  TEST_ASSERT_EQUAL_STRING("Tea", response.labels[getPinIndex(10)]);
+  TEST_ASSERT_EQUAL_STRING("", response.labels[getPinIndex(13)]);
+  TEST_ASSERT_EQUAL_STRING("", response.labels[getPinIndex(11)]);
+}
+
+void test_switch_labels_cut_long_label_at_utf8_boundary() {
+  std::string label(PRODUCT_LABEL_SIZE - 2, 'a');
+  label += "\xc3\xa4\xc3\xa4";   // Two 2-byte characters across the limit
+  std::string json = "{\"switches\":[{\"pin\":13,\"label\":\"" + label + "\"}]}";
+  BodyStream body(json.c_str());
+  SwitchLabelsResponse response;
+  TEST_ASSERT_TRUE(parseSwitchLabels(body, response));
+  TEST_ASSERT_EQUAL_STRING("", response.currency);
+  TEST_ASSERT_EQUAL(PRODUCT_LABEL_SIZE - 2, strlen(response.labels[getPinIndex(13)]));
+}
+
+void test_switch_labels_invalid_json() {
+  BodyStream body("{\"switches\":[{\"pin\":12,");
+  SwitchLabelsResponse response;
+  TEST_ASSERT_FALSE(parseSwitchLabels(body, response));
+}
+
+void test_coingecko_prices() {
+  BodyStream body("{\"bitcoin\":{\"usd\":64000.5,\"eur\":59000}}");
+  const char* const currencies[] = {"usd", "eur", "chf"};
+  float prices[3];
+  TEST_ASSERT_EQUAL(2, parseBitcoinPrices(body, "bitcoin", currencies, 3, prices));
+  TEST_ASSERT_EQUAL_FLOAT(64000.5f, prices[0]);
+  TEST_ASSERT_EQUAL_FLOAT(59000.0f, prices[1]);
+  TEST_ASSERT_TRUE(isnan(prices[2]));
+}
+
+void test_mempool_prices_skip_invalid_values() {
+  BodyStream body("{\"time\":1700000000,\"USD\":64000,\"EUR\":0,\"GBP\":\"n/a\"}");
+  const char* const currencies[] = {"USD", "EUR", "GBP"};
+  float prices[3];
+  TEST_ASSERT_EQUAL(1, parseBitcoinPrices(body, nullptr, currencies, 3, prices));
+  TEST_ASSERT_EQUAL_FLOAT(64000.0f, prices[0]);
+  TEST_ASSERT_TRUE(isnan(prices[1]));
+  TEST_ASSERT_TRUE(isnan(prices[2]));
+}
+
+void test_feed_block_and_conversions() {
+  const char* message = "{\"block\":{\"height\":870001,\"tx_count\":3000},\"conversions\":{\"USD\":64000,\"EUR\":59000}}";
+  const char* const currencies[] = {"EUR"};
+  uint32_t height = 0;
+  float prices[1];
+  TEST_ASSERT_TRUE(parseMarketFeedMessage(message, strlen(message), currencies, 1, height, prices));
+  TEST_ASSERT_EQUAL_UINT32(870001, height);
+  TEST_ASSERT_EQUAL_FLOAT(59000.0f, prices[0]);
+}
+
+void test_feed_initial_blocks_take_highest() {
+  const char* message = "{\"blocks\":[{\"height\":869998},{\"height\":870000},{\"height\":869999}]}";
+  const char* const currencies[] = {"USD"};
+  uint32_t height = 0;
+  float prices[1];
+  TEST_ASSERT_TRUE(parseMarketFeedMessage(message, strlen(message), currencies, 1, height, prices));
+  TEST_ASSERT_EQUAL_UINT32(870000, height);
+  TEST_ASSERT_TRUE(isnan(prices[0]));
+}
+
+void test_feed_other_messages_and_errors() {
+  const char* const currencies[] = {"USD"};
+  uint32_t height = 1;
+  float prices[1];
+  const char* other = "{\"mempoolInfo\":{\"size\":1234}}";
+  TEST_ASSERT_TRUE(parseMarketFeedMessage(other, strlen(other), currencies, 1, height, prices));
+  TEST_ASSERT_EQUAL_UINT32(0, height);
+  const char* broken = "{\"block\":";
+  TEST_ASSERT_FALSE(parseMarketFeedMessage(broken, strlen(broken), currencies, 1, height, prices));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_switch_labels);
+  RUN_TEST(test_switch_labels_cut_long_label_at_utf8_boundary);
+  RUN_TEST(test_switch_labels_invalid_json);
+  RUN_TEST(test_coingecko_prices);
+  RUN_TEST(test_mempool_prices_skip_invalid_values);
+  RUN_TEST(test_feed_block_and_conversions);
+  RUN_TEST(test_feed_initial_blocks_take_highest);
+  RUN_TEST(test_feed_other_messages_and_errors);
+  return UNITY_END();
+}
@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "Bech32.h"
+
+/**
+ * bech32Encode() against the valid BIP-173 test vectors and the LUD-01
+ * LNURL example. The encoder takes bytes, so the vectors are used whose
+ * 5-bit data is a whole number of bytes (zero padding); the output is
+ * uppercase and compared case-insensitively.
+ */
+
+static void assertEncodes(const char* hrp, const uint8_t* data, size_t dataLen, const char* expected) {
+  char out[256];
+  size_t length = bech32Encode(hrp, data, dataLen, out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(expected), length);
+  TEST_ASSERT_EQUAL(bech32EncodedLength(strlen(hrp), dataLen), length);
+  char upper[256];
+  for (size_t i = 0; i <= length; i++) {
+    upper[i] = bech32ToUpper(expected[i]);
+  }
+  TEST_ASSERT_EQUAL_STRING(upper, out);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_bip173_empty_data() {
+  assertEncodes("A", nullptr, 0, "A12UEL5L");
+  assertEncodes("a", nullptr, 0, "a12uel5l");
+  assertEncodes("?", nullptr, 0, "?1ezyfcl");
+  assertEncodes("an83characterlonghumanreadablepartthatcontainsthenumber1andtheexcludedcharactersbio", nullptr, 0,
+                "an83characterlonghumanreadablepartthatcontainsthenumber1andtheexcludedcharactersbio1tt5tgs");
+}
+
+void test_bip173_full_charset() {
+  // Data part "qpzry9x8gf2tvdw0s3jn54khce6mua7l": every charset value once
+  static const uint8_t data[] = {0x00, 0x44, 0x32, 0x14, 0xc7, 0x42, 0x54, 0xb6, 0x35, 0xcf,
+                                 0x84, 0x65, 0x3a, 0x56, 0xd7, 0xc6, 0x75, 0xbe, 0x77, 0xdf};
+  assertEncodes("abcdef", data, sizeof(data), "abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw");
+}
+
+void test_bip173_zero_data_with_padding() {
+  // 51 bytes are 82 groups of 5 bits, the last one padded
+  static const uint8_t data[51] = {};
+  assertEncodes("1", data, sizeof(data),
+                "11qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqc8247j");
+}
+
+void test_bip173_split() {
+  static const uint8_t data[] = {0xc5, 0xf3, 0x8b, 0x70, 0x30, 0x5f, 0x51, 0x9b, 0xf6, 0x6d,
+                                 0x85, 0xfb, 0x6c, 0xf0, 0x30, 0x58, 0xf3, 0xdd, 0xe4, 0x63,
+                                 0xec, 0xd7, 0x91, 0x8f, 0x2d, 0xc7, 0x43, 0x91, 0x8f, 0x2d};
+  assertEncodes("split", data, sizeof(data), "split1checkupstagehandshakeupstreamerranterredcaperred2y9e3w");
+}
+
+void test_lud01_lnurl_example() {
+  const char* url = "https://service.com/api?q=3fc3645b439ce8e7f2553a69e5267081d96dcd340693afabe04be7b0ccd178df";
+  assertEncodes("lnurl", (const uint8_t*)url, strlen(url),
+                "LNURL1DP68GURN8GHJ7UM9WFMXJCM99E3K7MF0V9CXJ0M385EKVCENXC6R2C35XVUKXEFCV5MKVV34X5EKZD3EV56NYD3HXQURZEPEX"
+                "EJXXEPNXSCRVWFNV9NXZCN9XQ6XYEFHVGCXXCMYXYMNSERXFQ5FNS");
+}
+
+void test_buffer_too_small() {
+  char out[8];
+  // "A12UEL5L" needs 9 bytes with its terminator
+  TEST_ASSERT_EQUAL(0, bech32Encode("A", nullptr, 0, out, sizeof(out)));
+  char fits[9];
+  TEST_ASSERT_EQUAL(8, bech32Encode("A", nullptr, 0, fits, sizeof(fits)));
+  TEST_ASSERT_EQUAL(0, bech32Encode("", nullptr, 0, fits, sizeof(fits)));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bip173_empty_data);
+  RUN_TEST(test_bip173_full_charset);
+  RUN_TEST(test_bip173_zero_data_with_padding);
+  RUN_TEST(test_bip173_split);
+  RUN_TEST(test_lud01_lnurl_example);
+  RUN_TEST(test_buffer_too_small);
+  return UNITY_END();
+}
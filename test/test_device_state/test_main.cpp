@@ -0,0 +1,175 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "DeviceState.h"
+
+/**
+ * StateManager: every transition comes from a DeviceEvent applied by the
+ * task that called begin() (loop() on the device). Checks ordering, the
+ * event and transition tables, and when entry/exit handlers run.
+ */
+
+static StateManager* machine = nullptr;
+static std::vector<std::string> calls;
+
+static void onEnter(DeviceState state) {
+  calls.push_back(std::string("enter ") + machine->getDeviceStateName(state));
+}
+
+static void onExit(DeviceState state) {
+  calls.push_back(std::string("exit ") + machine->getDeviceStateName(state));
+}
+
+// Entry handler that wakes up again, like the light sleep handler
+static void onEnterSleepAndWake(DeviceState state) {
+  onEnter(state);
+  machine->dispatch(DeviceEvent::SHOW_READY);
+  calls.push_back(std::string("still ") + machine->getDeviceStateName(machine->getState()));
+}
+
+void setUp() {
+  hostRunAs(0, 1);
+  machine = new StateManager();
+  machine->begin();
+  calls.clear();
+}
+
+void tearDown() {
+  hostRunAs(0, 1);
+  delete machine;
+  machine = nullptr;
+}
+
+void test_dispatch_in_consumer_task_applies_at_once() {
+  machine->setStateHandlers(DeviceState::HELP_SCREEN, onEnter, onExit);
+  TEST_ASSERT_TRUE(machine->dispatch(DeviceEvent::OPEN_HELP));
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::HELP_SCREEN));
+  TEST_ASSERT_TRUE(machine->dispatch(DeviceEvent::SHOW_READY));
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::READY));
+  TEST_ASSERT_EQUAL(DeviceState::HELP_SCREEN, machine->getPreviousState());
+
+  TEST_ASSERT_EQUAL(2, calls.size());
+  TEST_ASSERT_EQUAL_STRING("enter HELP_SCREEN", calls[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("exit HELP_SCREEN", calls[1].c_str());
+}
+
+void test_posted_events_wait_for_process_events_in_order() {
+  TEST_ASSERT_TRUE(machine->postEvent(DeviceEvent::SHOW_READY));
+  TEST_ASSERT_TRUE(machine->postEvent(DeviceEvent::OPEN_REPORT));
+  TEST_ASSERT_TRUE(machine->postEvent(DeviceEvent::SHOW_PRODUCT_SELECTION));
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::INITIALIZING));
+
+  machine->processEvents();
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::PRODUCT_SELECTION));
+  TEST_ASSERT_EQUAL(DeviceState::REPORT_SCREEN, machine->getPreviousState());
+}
+
+void test_dispatch_is_applied_behind_queued_events() {
+  machine->postEvent(DeviceEvent::OPEN_HELP);
+  machine->dispatch(DeviceEvent::SHOW_READY);
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::READY));
+  TEST_ASSERT_EQUAL(DeviceState::HELP_SCREEN, machine->getPreviousState());
+}
+
+void test_event_ignored_in_state() {
+  machine->dispatch(DeviceEvent::OPEN_HELP);
+  // WiFi loss does not interrupt the help pages
+  TEST_ASSERT_FALSE(machine->dispatch(DeviceEvent::WIFI_LOST));
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::HELP_SCREEN));
+
+  machine->dispatch(DeviceEvent::SHOW_READY);
+  machine->dispatch(DeviceEvent::WIFI_LOST);
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::CONNECTING_WIFI));
+  machine->dispatch(DeviceEvent::WIFI_RESTORED);
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::READY));
+}
+
+void test_transition_table_rejects_sleep_from_overlay() {
+  machine->setStateHandlers(DeviceState::DEEP_SLEEP, onEnter, nullptr);
+  machine->dispatch(DeviceEvent::OPEN_HELP);
+  TEST_ASSERT_FALSE(machine->dispatch(DeviceEvent::SLEEP_TIMEOUT));
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::HELP_SCREEN));
+  TEST_ASSERT_TRUE(calls.empty());
+}
+
+void test_event_from_entry_handler_runs_after_it() {
+  machine->setStateHandlers(DeviceState::DEEP_SLEEP, onEnterSleepAndWake, nullptr);
+  machine->setStateHandlers(DeviceState::READY, onEnter, onExit);
+  machine->dispatch(DeviceEvent::SHOW_READY);
+  calls.clear();
+
+  TEST_ASSERT_TRUE(machine->dispatch(DeviceEvent::SLEEP_TIMEOUT));
+  // Light sleep wake-up: DEEP_SLEEP -> READY once the entry handler has returned
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::READY));
+  TEST_ASSERT_EQUAL(4, calls.size());
+  TEST_ASSERT_EQUAL_STRING("exit READY", calls[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("enter DEEP_SLEEP", calls[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("still DEEP_SLEEP", calls[2].c_str());
+  TEST_ASSERT_EQUAL_STRING("enter READY", calls[3].c_str());
+}
+
+void test_full_queue_drops_event() {
+  for (int i = 0; i < STATE_EVENT_QUEUE_LENGTH; i++) {
+    TEST_ASSERT_TRUE(machine->postEvent(DeviceEvent::SHOW_READY));
+  }
+  TEST_ASSERT_FALSE(machine->postEvent(DeviceEvent::OPEN_HELP));
+  machine->processEvents();
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::READY));
+}
+
+static StateTraceEntry lastTraceEntry() {
+  StateTraceEntry entries[STATE_TRACE_LENGTH];
+  uint8_t count = machine->copyTrace(entries);
+  return count > 0 ? entries[count - 1] : StateTraceEntry{};
+}
+
+void test_dispatch_from_other_task_only_queues() {
+  // A button callback in Task1 (core 0) returns at once, loop() applies the event later
+  hostRunAs(1, 0);
+  TEST_ASSERT_TRUE(machine->dispatch(DeviceEvent::OPEN_HELP));
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::INITIALIZING));
+
+  hostRunAs(0, 1);
+  machine->processEvents();
+  TEST_ASSERT_TRUE(machine->isInState(DeviceState::HELP_SCREEN));
+}
+
+void test_trace_records_core_of_raising_task() {
+  hostRunAs(1, 0);
+  machine->postEvent(DeviceEvent::SHOW_READY);
+  hostRunAs(0, 1);
+  machine->processEvents();
+  StateTraceEntry entry = lastTraceEntry();
+  TEST_ASSERT_EQUAL(DeviceState::READY, entry.to);
+  TEST_ASSERT_EQUAL(0, entry.core);
+
+  machine->dispatch(DeviceEvent::OPEN_REPORT);
+  entry = lastTraceEntry();
+  TEST_ASSERT_EQUAL(DeviceState::REPORT_SCREEN, entry.to);
+  TEST_ASSERT_EQUAL(1, entry.core);
+}
+
+void test_dispatch_before_begin_applies_directly() {
+  StateManager early;
+  TEST_ASSERT_TRUE(early.dispatch(DeviceEvent::OPEN_CONFIG));
+  TEST_ASSERT_TRUE(early.isInState(DeviceState::CONFIG_MODE));
+  // Config mode cannot fall back to the WiFi connect screen
+  TEST_ASSERT_FALSE(early.dispatch(DeviceEvent::WIFI_LOST));
+  TEST_ASSERT_TRUE(early.isInState(DeviceState::CONFIG_MODE));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dispatch_in_consumer_task_applies_at_once);
+  RUN_TEST(test_posted_events_wait_for_process_events_in_order);
+  RUN_TEST(test_dispatch_is_applied_behind_queued_events);
+  RUN_TEST(test_event_ignored_in_state);
+  RUN_TEST(test_transition_table_rejects_sleep_from_overlay);
+  RUN_TEST(test_event_from_entry_handler_runs_after_it);
+  RUN_TEST(test_full_queue_drops_event);
+  RUN_TEST(test_dispatch_from_other_task_only_queues);
+  RUN_TEST(test_trace_records_core_of_raising_task);
+  RUN_TEST(test_dispatch_before_begin_applies_directly);
+  return UNITY_END();
+}
@@ -0,0 +1,219 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "GlobalState.h"
+#include "PaymentHandler.h"
+#include "RelayScheduler.h"
+
+/**
+ * Payment path from a queued event to the relay and the screens: normal and
+ * threshold payloads, special modes, Single mode mirroring, and paid
+ * activations the relay scheduler rejects. Runs on the simulated clock with
+ * the screens recorded instead of drawn.
+ */
+
+static std::vector<std::string> shown;
+
+static void showActionTime() { shown.push_back("actionTime"); }
+static void showThankYou() { shown.push_back("thankYou"); }
+static void showError() { shown.push_back("error"); }
+static void showThresholdQr() { shown.push_back("thresholdQr"); }
+static void showSpecialModeQr() { shown.push_back("specialModeQr"); }
+static void showQr() { shown.push_back("qr"); }
+
+static const PaymentScreens testScreens = {
+  showActionTime, showThankYou, showError, showThresholdQr, showSpecialModeQr, showQr
+};
+
+static void postPayment(const char* payload) {
+  static PaymentEvent event;
+  event.receivedAt = millis();
+  event.length = (uint16_t)strlen(payload);
+  strcpy(event.payload, payload);
+  processPaymentEvent(event);
+}
+
+// loop() passes for ms milliseconds
+static void runLoop(unsigned long ms) {
+  for (unsigned long i = 0; i < ms; i += 10) {
+    relaySchedulerTick(millis());
+    handleThankYouTimeout();
+    delay(10);
+  }
+}
+
+static const std::string& lastShown() {
+  static const std::string none;
+  return shown.empty() ? none : shown.back();
+}
+
+void setUp() {
+  hostUseManualClock(true);
+  relayCancelAll();
+  relaySetPolicy(RELAY_POLICY_EXTEND);
+  relayOnComplete(onRelayActivationComplete);
+  paymentHandlerSetScreens(&testScreens);
+  paymentHandlerCancel();
+  lightningConfig = LightningConfig();
+  specialModeConfig.mode = SpecialMode::STANDARD;
+  multiChannelConfig.mode = ChannelMode::QUATTRO;
+  multiChannelConfig.btcTickerActive = false;
+  productSelectionState.showTime = millis();
+  shown.clear();
+}
+
+void tearDown() {
+  relayCancelAll();
+  paymentHandlerSetScreens(nullptr);
+}
+
+void test_normal_payment_runs_relay_then_thank_you() {
+  postPayment("12-1000");
+  TEST_ASSERT_EQUAL(HIGH, hostPinLevel(12));
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(13));
+  TEST_ASSERT_EQUAL_STRING("actionTime", lastShown().c_str());
+  // Product timeout paused while ACTION TIME is up
+  TEST_ASSERT_EQUAL(0, productSelectionState.showTime);
+
+  runLoop(1100);
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(12));
+  TEST_ASSERT_EQUAL_STRING("thankYou", lastShown().c_str());
+
+  runLoop(THANK_YOU_DURATION_MS + 20);
+  TEST_ASSERT_EQUAL_STRING("qr", lastShown().c_str());
+  TEST_ASSERT_GREATER_THAN(0, productSelectionState.showTime);
+  TEST_ASSERT_EQUAL(3, shown.size());
+}
+
+void test_single_mode_mirrors_pin_13() {
+  multiChannelConfig.mode = ChannelMode::SINGLE;
+  postPayment("12-500");
+  TEST_ASSERT_EQUAL(HIGH, hostPinLevel(12));
+  TEST_ASSERT_EQUAL(HIGH, hostPinLevel(13));
+  runLoop(600);
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(12));
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(13));
+}
+
+void test_special_mode_returns_to_special_qr() {
+  specialModeConfig.mode = SpecialMode::BLINK;
+  specialModeConfig.frequency = 1.0f;
+  specialModeConfig.dutyCycleRatio = 1.0f;
+  postPayment("10-2000");
+  TEST_ASSERT_EQUAL(HIGH, hostPinLevel(10));
+  // 1 Hz 1:1 - LOW between 500 and 1000 ms
+  runLoop(700);
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(10));
+  TEST_ASSERT_TRUE(relayAnyActive());
+  runLoop(1400 + THANK_YOU_DURATION_MS);
+  TEST_ASSERT_FALSE(relayAnyActive());
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(10));
+  TEST_ASSERT_EQUAL_STRING("specialModeQr", lastShown().c_str());
+}
+
+void test_thank_you_waits_for_all_relays() {
+  postPayment("12-500");
+  postPayment("13-1500");
+  runLoop(700);
+  // Pin 12 done, pin 13 still on: ACTION TIME stays
+  TEST_ASSERT_EQUAL_STRING("actionTime", lastShown().c_str());
+  runLoop(1000);
+  TEST_ASSERT_EQUAL_STRING("thankYou", lastShown().c_str());
+}
+
+void test_threshold_payment_above_threshold() {
+  lightningConfig.thresholdKey = "key";
+  lightningConfig.thresholdAmount = "100";
+  lightningConfig.thresholdPin = "11";
+  lightningConfig.thresholdTime = "800";
+  postPayment("{\"payment\":{\"amount\":150000,\"memo\":\"zap\"}}");
+  TEST_ASSERT_EQUAL(HIGH, hostPinLevel(11));
+  TEST_ASSERT_EQUAL_STRING("actionTime", lastShown().c_str());
+  runLoop(900 + THANK_YOU_DURATION_MS);
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(11));
+  TEST_ASSERT_EQUAL_STRING("thresholdQr", lastShown().c_str());
+}
+
+void test_threshold_payment_below_threshold_is_ignored() {
+  lightningConfig.thresholdKey = "key";
+  lightningConfig.thresholdAmount = "100";
+  lightningConfig.thresholdPin = "11";
+  lightningConfig.thresholdTime = "800";
+  postPayment("{\"payment\":{\"amount\":99000}}");
+  TEST_ASSERT_FALSE(relayAnyActive());
+  TEST_ASSERT_EQUAL(0, shown.size());
+}
+
+void test_threshold_payment_invalid_json_is_ignored() {
+  lightningConfig.thresholdKey = "key";
+  lightningConfig.thresholdAmount = "1";
+  lightningConfig.thresholdPin = "11";
+  lightningConfig.thresholdTime = "800";
+  postPayment("{\"payment\":{\"amount\":");
+  TEST_ASSERT_FALSE(relayAnyActive());
+  TEST_ASSERT_EQUAL(0, shown.size());
+}
+
+void test_queue_mode_keeps_every_paid_event() {
+  relaySetPolicy(RELAY_POLICY_QUEUE);
+  // A full payment queue for one channel
+  for (size_t i = 0; i < PAYMENT_QUEUE_CAPACITY; i++) {
+    postPayment("12-100");
+  }
+  TEST_ASSERT_EQUAL((int)PAYMENT_QUEUE_CAPACITY - 1, relayQueuedCount(12));
+  for (const std::string& screen : shown) {
+    TEST_ASSERT_EQUAL_STRING("actionTime", screen.c_str());
+  }
+}
+
+void test_rejected_activation_shows_error_and_returns() {
+  relaySetPolicy(RELAY_POLICY_QUEUE);
+  postPayment("12-5000");
+  for (int i = 0; i < RELAY_QUEUE_DEPTH; i++) {
+    postPayment("12-100");
+  }
+  TEST_ASSERT_EQUAL(RELAY_QUEUE_DEPTH, relayQueuedCount(12));
+  shown.clear();
+
+  postPayment("12-100");
+  TEST_ASSERT_EQUAL_STRING("error", lastShown().c_str());
+  TEST_ASSERT_EQUAL(RELAY_QUEUE_DEPTH, relayQueuedCount(12));
+
+  // Back to ACTION TIME while the earlier activations still run
+  runLoop(THANK_YOU_DURATION_MS + 20);
+  TEST_ASSERT_EQUAL_STRING("actionTime", lastShown().c_str());
+  TEST_ASSERT_EQUAL(2, shown.size());
+}
+
+void test_rejected_activation_without_running_relays_returns_to_qr() {
+  // Every slot busy with another pin
+  postPayment("12-5000");
+  postPayment("13-5000");
+  postPayment("10-5000");
+  postPayment("11-5000");
+  shown.clear();
+  postPayment("21-1000");
+  TEST_ASSERT_EQUAL_STRING("error", lastShown().c_str());
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(21));
+
+  relayCancelAll();
+  runLoop(THANK_YOU_DURATION_MS + 20);
+  TEST_ASSERT_EQUAL_STRING("qr", lastShown().c_str());
+  TEST_ASSERT_GREATER_THAN(0, productSelectionState.showTime);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_normal_payment_runs_relay_then_thank_you);
+  RUN_TEST(test_single_mode_mirrors_pin_13);
+  RUN_TEST(test_special_mode_returns_to_special_qr);
+  RUN_TEST(test_thank_you_waits_for_all_relays);
+  RUN_TEST(test_threshold_payment_above_threshold);
+  RUN_TEST(test_threshold_payment_below_threshold_is_ignored);
+  RUN_TEST(test_threshold_payment_invalid_json_is_ignored);
+  RUN_TEST(test_queue_mode_keeps_every_paid_event);
+  RUN_TEST(test_rejected_activation_shows_error_and_returns);
+  RUN_TEST(test_rejected_activation_without_running_relays_returns_to_qr);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "PaymentQueue.h"
+
+/**
+ * PaymentQueue under load: thousands of back-to-back events arrive in order
+ * without loss, and every event that is refused shows up in exactly one
+ * overflow counter. Counters are cumulative, so tests compare deltas.
+ */
+
+static PaymentEvent event;
+
+static size_t formatEvent(char* buffer, size_t size, uint32_t seq) {
+  return (size_t)snprintf(buffer, size, "12-%lu", (unsigned long)seq);
+}
+
+static uint32_t eventSeq(const PaymentEvent& e) {
+  return (uint32_t)strtoul(e.payload + 3, nullptr, 10);
+}
+
+static void drain() {
+  while (paymentQueuePop(event)) {
+  }
+}
+
+void setUp() {
+  drain();
+}
+
+void tearDown() {
+}
+
+void test_back_to_back_bursts_arrive_in_order() {
+  const uint32_t total = 5000;
+  PaymentQueueStats before = paymentQueueStats();
+  char buffer[32];
+  uint32_t next = 0;
+  uint32_t expected = 0;
+  while (expected < total) {
+    // A full burst between two loop() passes
+    for (size_t i = 0; i < PAYMENT_QUEUE_CAPACITY && next < total; i++) {
+      size_t length = formatEvent(buffer, sizeof(buffer), next);
+      TEST_ASSERT_TRUE(paymentQueuePush(buffer, length));
+      next++;
+    }
+    while (paymentQueuePop(event)) {
+      TEST_ASSERT_EQUAL_UINT32(expected, eventSeq(event));
+      TEST_ASSERT_EQUAL(strlen(event.payload), event.length);
+      expected++;
+    }
+  }
+  PaymentQueueStats after = paymentQueueStats();
+  TEST_ASSERT_EQUAL_UINT32(total, after.pushed - before.pushed);
+  TEST_ASSERT_EQUAL_UINT32(total, after.popped - before.popped);
+  TEST_ASSERT_EQUAL_UINT32(0, after.overflows - before.overflows);
+  TEST_ASSERT_EQUAL_UINT32(0, after.oversized - before.oversized);
+  TEST_ASSERT_EQUAL_UINT32(PAYMENT_QUEUE_CAPACITY, after.highWater);
+}
+
+void test_overflow_counts_every_refused_event() {
+  const uint32_t extra = 1000;
+  PaymentQueueStats before = paymentQueueStats();
+  char buffer[32];
+  for (uint32_t i = 0; i < PAYMENT_QUEUE_CAPACITY + extra; i++) {
+    size_t length = formatEvent(buffer, sizeof(buffer), i);
+    TEST_ASSERT_EQUAL(i < PAYMENT_QUEUE_CAPACITY, paymentQueuePush(buffer, length));
+  }
+  TEST_ASSERT_EQUAL(PAYMENT_QUEUE_CAPACITY, paymentQueueCount());
+
+  // The accepted events are the oldest ones, untouched by the refused pushes
+  for (uint32_t i = 0; i < PAYMENT_QUEUE_CAPACITY; i++) {
+    TEST_ASSERT_TRUE(paymentQueuePop(event));
+    TEST_ASSERT_EQUAL_UINT32(i, eventSeq(event));
+  }
+  TEST_ASSERT_FALSE(paymentQueuePop(event));
+
+  PaymentQueueStats after = paymentQueueStats();
+  TEST_ASSERT_EQUAL_UINT32(PAYMENT_QUEUE_CAPACITY, after.pushed - before.pushed);
+  TEST_ASSERT_EQUAL_UINT32(PAYMENT_QUEUE_CAPACITY, after.popped - before.popped);
+  TEST_ASSERT_EQUAL_UINT32(extra, after.overflows - before.overflows);
+  TEST_ASSERT_EQUAL_UINT32(0, after.oversized - before.oversized);
+}
+
+void test_oversized_payload_is_counted_not_queued() {
+  static char big[PAYMENT_PAYLOAD_MAX + 1];
+  memset(big, 'x', sizeof(big));
+  PaymentQueueStats before = paymentQueueStats();
+
+  TEST_ASSERT_FALSE(paymentQueuePush(big, PAYMENT_PAYLOAD_MAX));
+  TEST_ASSERT_EQUAL(0, paymentQueueCount());
+  // The largest payload that still fits next to its terminator
+  TEST_ASSERT_TRUE(paymentQueuePush(big, PAYMENT_PAYLOAD_MAX - 1));
+  TEST_ASSERT_TRUE(paymentQueuePop(event));
+  TEST_ASSERT_EQUAL(PAYMENT_PAYLOAD_MAX - 1, event.length);
+  TEST_ASSERT_EQUAL('\0', event.payload[PAYMENT_PAYLOAD_MAX - 1]);
+
+  PaymentQueueStats after = paymentQueueStats();
+  TEST_ASSERT_EQUAL_UINT32(1, after.oversized - before.oversized);
+  TEST_ASSERT_EQUAL_UINT32(0, after.overflows - before.overflows);
+  TEST_ASSERT_EQUAL_UINT32(1, after.pushed - before.pushed);
+}
+
+// Producer and consumer on their own threads, like webSocketEvent() and loop()
+void test_concurrent_producer_and_consumer_lose_nothing() {
+  const uint32_t total = 200000;
+  PaymentQueueStats before = paymentQueueStats();
+  std::atomic<uint32_t> refused(0);
+  std::atomic<bool> outOfOrder(false);
+
+  std::thread producer([&] {
+    char buffer[32];
+    for (uint32_t seq = 0; seq < total;) {
+      size_t length = formatEvent(buffer, sizeof(buffer), seq);
+      if (paymentQueuePush(buffer, length)) {
+        seq++;
+      } else {
+        // Full: the sender retries, the refusal is counted as an overflow
+        refused.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  static PaymentEvent received;
+  uint32_t expected = 0;
+  while (expected < total) {
+    if (!paymentQueuePop(received)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (eventSeq(received) != expected || received.length != strlen(received.payload)) {
+      outOfOrder = true;
+    }
+    expected++;
+  }
+  producer.join();
+
+  TEST_ASSERT_FALSE(outOfOrder.load());
+  TEST_ASSERT_EQUAL(0, paymentQueueCount());
+  PaymentQueueStats after = paymentQueueStats();
+  TEST_ASSERT_EQUAL_UINT32(total, after.pushed - before.pushed);
+  TEST_ASSERT_EQUAL_UINT32(total, after.popped - before.popped);
+  TEST_ASSERT_EQUAL_UINT32(refused.load(), after.overflows - before.overflows);
+  TEST_ASSERT_LESS_OR_EQUAL(PAYMENT_QUEUE_CAPACITY, after.highWater);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_back_to_back_bursts_arrive_in_order);
+  RUN_TEST(test_overflow_counts_every_refused_event);
+  RUN_TEST(test_oversized_payload_is_counted_not_queued);
+  RUN_TEST(test_concurrent_producer_and_consumer_lose_nothing);
+  return UNITY_END();
+}
@@ -0,0 +1,154 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "RelayScheduler.h"
+
+/**
+ * RelayScheduler on the simulated host clock: loop() keeps running while a
+ * relay is on, and the off edge comes from the timer even when loop() is
+ * stuck in a blocking call (e.g. an HTTPS fetch).
+ */
+
+struct PinEdge {
+  uint8_t pin;
+  uint8_t level;
+  uint64_t atUs;
+};
+
+static std::vector<PinEdge> edges;
+static int completions = 0;
+static uint64_t startUs = 0;
+
+static void recordEdge(uint8_t pin, uint8_t level, uint64_t timeUs) {
+  edges.push_back({pin, level, timeUs - startUs});
+}
+
+static void countCompletion(int) {
+  completions++;
+}
+
+// One pass of the device loop: the scheduler tick, then blockMs of other work
+static void loopOnce(unsigned long blockMs) {
+  relaySchedulerTick(millis());
+  delay(blockMs);
+}
+
+static const PinEdge* findEdge(uint8_t pin, uint8_t level, int nth = 0) {
+  for (const PinEdge& edge : edges) {
+    if (edge.pin == pin && edge.level == level && nth-- == 0) return &edge;
+  }
+  return nullptr;
+}
+
+void setUp() {
+  hostUseManualClock(true);
+  relayCancelAll();
+  relaySetPolicy(RELAY_POLICY_EXTEND);
+  relayOnComplete(countCompletion);
+  edges.clear();
+  completions = 0;
+  hostOnPinWrite(recordEdge);
+  startUs = micros();
+}
+
+void tearDown() {
+  hostOnPinWrite(nullptr);
+  relayCancelAll();
+}
+
+void test_activate_returns_immediately() {
+  unsigned long before = millis();
+  TEST_ASSERT_TRUE(relayActivate(12, 2000));
+  TEST_ASSERT_EQUAL(before, millis());
+  TEST_ASSERT_EQUAL(HIGH, hostPinLevel(12));
+  TEST_ASSERT_TRUE(relayAnyActive());
+}
+
+void test_loop_keeps_running_during_activation() {
+  TEST_ASSERT_TRUE(relayActivate(12, 2000));
+  int loopRuns = 0;
+  while (relayAnyActive() && loopRuns < 1000) {
+    loopOnce(10);
+    loopRuns++;
+  }
+  // 10 ms per pass: about 200 passes while the relay was on
+  TEST_ASSERT_GREATER_OR_EQUAL(199, loopRuns);
+  TEST_ASSERT_LESS_OR_EQUAL(202, loopRuns);
+  const PinEdge* off = findEdge(12, LOW);
+  TEST_ASSERT_NOT_NULL(off);
+  TEST_ASSERT_UINT64_WITHIN(1000, 2000000, off->atUs);
+  TEST_ASSERT_EQUAL(1, completions);
+}
+
+void test_blocking_loop_does_not_delay_off_edge() {
+  TEST_ASSERT_TRUE(relayActivate(12, 1000));
+  // Every pass blocks for 3 s, three times the on-time
+  loopOnce(3000);
+  const PinEdge* off = findEdge(12, LOW);
+  TEST_ASSERT_NOT_NULL(off);
+  TEST_ASSERT_UINT64_WITHIN(1000, 1000000, off->atUs);
+  TEST_ASSERT_EQUAL(LOW, hostPinLevel(12));
+
+  // Bookkeeping happens on the next tick
+  TEST_ASSERT_EQUAL(0, completions);
+  loopOnce(0);
+  TEST_ASSERT_EQUAL(1, completions);
+  TEST_ASSERT_FALSE(relayAnyActive());
+}
+
+void test_mirror_pin_switches_off_with_pin() {
+  TEST_ASSERT_TRUE(relayActivate(12, 500, 13));
+  loopOnce(2000);
+  const PinEdge* off = findEdge(12, LOW);
+  const PinEdge* mirrorOff = findEdge(13, LOW);
+  TEST_ASSERT_NOT_NULL(off);
+  TEST_ASSERT_NOT_NULL(mirrorOff);
+  TEST_ASSERT_UINT64_WITHIN(1000, 500000, off->atUs);
+  TEST_ASSERT_UINT64_WITHIN(1000, 500000, mirrorOff->atUs);
+}
+
+void test_extend_rearms_off_timer() {
+  TEST_ASSERT_TRUE(relayActivate(12, 1000));
+  loopOnce(500);
+  TEST_ASSERT_TRUE(relayActivate(12, 1000));
+  loopOnce(3000);
+  const PinEdge* off = findEdge(12, LOW);
+  TEST_ASSERT_NOT_NULL(off);
+  TEST_ASSERT_UINT64_WITHIN(1000, 2000000, off->atUs);
+  TEST_ASSERT_NULL(findEdge(12, LOW, 1));
+}
+
+void test_queued_runs_keep_gap() {
+  relaySetPolicy(RELAY_POLICY_QUEUE);
+  TEST_ASSERT_TRUE(relayActivate(12, 500));
+  TEST_ASSERT_TRUE(relayActivate(12, 500));
+  TEST_ASSERT_EQUAL(1, relayQueuedCount(12));
+  for (int i = 0; i < 300 && relayAnyActive(); i++) {
+    loopOnce(10);
+  }
+  TEST_ASSERT_FALSE(relayAnyActive());
+  TEST_ASSERT_EQUAL(2, completions);
+
+  const PinEdge* firstOff = findEdge(12, LOW, 0);
+  const PinEdge* secondOn = findEdge(12, HIGH, 1);
+  const PinEdge* secondOff = findEdge(12, LOW, 1);
+  TEST_ASSERT_NOT_NULL(firstOff);
+  TEST_ASSERT_NOT_NULL(secondOn);
+  TEST_ASSERT_NOT_NULL(secondOff);
+  TEST_ASSERT_UINT64_WITHIN(1000, 500000, firstOff->atUs);
+  // The gap is timed by the tick, so it can be one loop pass longer
+  TEST_ASSERT_GREATER_OR_EQUAL(firstOff->atUs + RELAY_QUEUE_GAP_MS * 1000, secondOn->atUs);
+  TEST_ASSERT_LESS_OR_EQUAL(firstOff->atUs + (RELAY_QUEUE_GAP_MS + 20) * 1000, secondOn->atUs);
+  TEST_ASSERT_UINT64_WITHIN(1000, secondOn->atUs + 500000, secondOff->atUs);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_activate_returns_immediately);
+  RUN_TEST(test_loop_keeps_running_during_activation);
+  RUN_TEST(test_blocking_loop_does_not_delay_off_edge);
+  RUN_TEST(test_mirror_pin_switches_off_with_pin);
+  RUN_TEST(test_extend_rearms_off_timer);
+  RUN_TEST(test_queued_runs_keep_gap);
+  return UNITY_END();
+}
@@ -0,0 +1,211 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "Waveform.h"
+
+/**
+ * Waveform engine behind a simulated WaveformHal: edges stay on the absolute
+ * timeline within 1 ms even when every timer callback runs late, stop leaves
+ * the pins LOW, and callbacks of an older generation are ignored.
+ */
+
+struct Edge {
+  int pin;
+  uint8_t level;
+  int64_t atUs;
+};
+
+struct PendingTimer {
+  int channel;
+  int64_t dueUs;
+  uint32_t generation;
+};
+
+static int64_t simNowUs = 0;
+static uint32_t callbackLatencyUs = 0;   // Added to every callback (timer task busy)
+static uint32_t jitterSeed = 1;
+static std::vector<Edge> edges;
+static std::vector<PendingTimer> pending;
+
+static void simWritePin(int pin, uint8_t level) {
+  edges.push_back({pin, level, simNowUs});
+}
+
+static int64_t simNowUsFn() {
+  return simNowUs;
+}
+
+static void simArmTimer(int channel, uint64_t delayUs, uint32_t generation) {
+  pending.push_back({channel, simNowUs + (int64_t)delayUs, generation});
+}
+
+static void simCancelTimer(int channel) {
+  for (size_t i = 0; i < pending.size();) {
+    if (pending[i].channel == channel) {
+      pending.erase(pending.begin() + i);
+    } else {
+      i++;
+    }
+  }
+}
+
+static const WaveformHal simHal = { simWritePin, simNowUsFn, simArmTimer, simCancelTimer };
+
+// 0 .. callbackLatencyUs, deterministic
+static uint32_t nextLatency() {
+  if (callbackLatencyUs == 0) return 0;
+  jitterSeed = jitterSeed * 1103515245u + 12345u;
+  return (jitterSeed >> 8) % (callbackLatencyUs + 1);
+}
+
+// Deliver due callbacks in order until untilUs
+static void runUntil(int64_t untilUs) {
+  for (;;) {
+    size_t next = pending.size();
+    for (size_t i = 0; i < pending.size(); i++) {
+      if (next == pending.size() || pending[i].dueUs < pending[next].dueUs) next = i;
+    }
+    if (next == pending.size() || pending[next].dueUs > untilUs) break;
+    PendingTimer timer = pending[next];
+    pending.erase(pending.begin() + next);
+    simNowUs = timer.dueUs + nextLatency();
+    waveformOnTimer(timer.channel, timer.generation);
+  }
+  simNowUs = untilUs;
+}
+
+static std::vector<Edge> edgesOf(int pin) {
+  std::vector<Edge> result;
+  for (const Edge& edge : edges) {
+    if (edge.pin == pin) result.push_back(edge);
+  }
+  return result;
+}
+
+// Edge n of a waveform starting HIGH at startUs is at n/2 periods (+ onUs if odd)
+static void assertTimeline(int pin, int64_t startUs, WaveformTiming timing, int64_t toleranceUs) {
+  std::vector<Edge> pinEdges = edgesOf(pin);
+  TEST_ASSERT_GREATER_THAN(2, pinEdges.size());
+  int64_t periodUs = (int64_t)timing.onUs + timing.offUs;
+  for (size_t n = 0; n < pinEdges.size(); n++) {
+    int64_t expectedUs = startUs + (int64_t)(n / 2) * periodUs + ((n & 1) ? timing.onUs : 0);
+    TEST_ASSERT_EQUAL((n & 1) ? LOW : HIGH, pinEdges[n].level);
+    TEST_ASSERT_INT_WITHIN(toleranceUs, expectedUs, pinEdges[n].atUs);
+  }
+}
+
+void setUp() {
+  waveformSetHal(&simHal);
+  simNowUs = 1000000;
+  callbackLatencyUs = 0;
+  jitterSeed = 1;
+  edges.clear();
+  pending.clear();
+}
+
+void tearDown() {
+  for (int channel = 0; channel < WAVEFORM_MAX_CHANNELS; channel++) {
+    waveformStop(channel);
+  }
+  waveformSetHal(nullptr);
+}
+
+void test_timing_from_frequency_and_ratio() {
+  WaveformTiming blink = waveformTiming(1.0f, 1.0f);
+  TEST_ASSERT_EQUAL_UINT32(500000, blink.onUs);
+  TEST_ASSERT_EQUAL_UINT32(500000, blink.offUs);
+  WaveformTiming pulse = waveformTiming(2.0f, 0.25f);
+  TEST_ASSERT_EQUAL_UINT32(100000, pulse.onUs);
+  TEST_ASSERT_EQUAL_UINT32(400000, pulse.offUs);
+}
+
+void test_blink_edges_on_time() {
+  int64_t startUs = simNowUs;
+  TEST_ASSERT_TRUE(waveformStart(0, 12, -1, 1.0f, 1.0f));
+  runUntil(startUs + 10000000 - 1);
+  assertTimeline(12, startUs, waveformTiming(1.0f, 1.0f), 0);
+  TEST_ASSERT_EQUAL(20, edgesOf(12).size());
+}
+
+void test_late_callbacks_do_not_drift() {
+  // Every callback up to 900 us late, for 60 s of fast blink
+  callbackLatencyUs = 900;
+  int64_t startUs = simNowUs;
+  TEST_ASSERT_TRUE(waveformStart(1, 10, -1, 5.0f, 1.0f));
+  runUntil(startUs + 60000000 - 50000);
+  assertTimeline(10, startUs, waveformTiming(5.0f, 1.0f), 1000);
+  TEST_ASSERT_EQUAL(600, edgesOf(10).size());
+}
+
+void test_pulse_with_mirror_pin() {
+  int64_t startUs = simNowUs;
+  TEST_ASSERT_TRUE(waveformStart(0, 12, 13, 2.0f, 0.25f));
+  runUntil(startUs + 5000000);
+  WaveformTiming timing = waveformTiming(2.0f, 0.25f);
+  assertTimeline(12, startUs, timing, 1000);
+  assertTimeline(13, startUs, timing, 1000);
+}
+
+void test_stop_leaves_pins_low() {
+  TEST_ASSERT_TRUE(waveformStart(0, 12, 13, 1.0f, 1.0f));
+  runUntil(simNowUs + 250000);
+  waveformStop(0);
+  TEST_ASSERT_FALSE(waveformIsRunning(0));
+  TEST_ASSERT_EQUAL(LOW, edgesOf(12).back().level);
+  TEST_ASSERT_EQUAL(LOW, edgesOf(13).back().level);
+  size_t count = edges.size();
+  runUntil(simNowUs + 5000000);
+  TEST_ASSERT_EQUAL(count, edges.size());
+}
+
+void test_stale_callback_after_restart_is_ignored() {
+  TEST_ASSERT_TRUE(waveformStart(0, 12, -1, 1.0f, 1.0f));
+  TEST_ASSERT_EQUAL(1, pending.size());
+  // The callback was already dispatched when the channel was stopped and restarted
+  PendingTimer stale = pending[0];
+  waveformStop(0);
+  runUntil(simNowUs + 100000);
+  int64_t restartUs = simNowUs;
+  TEST_ASSERT_TRUE(waveformStart(0, 12, -1, 1.0f, 1.0f));
+  TEST_ASSERT_EQUAL(1, pending.size());
+
+  size_t count = edges.size();
+  simNowUs = stale.dueUs;
+  waveformOnTimer(stale.channel, stale.generation);
+  // No toggle, no second timer
+  TEST_ASSERT_EQUAL(count, edges.size());
+  TEST_ASSERT_EQUAL(1, pending.size());
+
+  // The restarted waveform keeps its own timeline
+  edges.clear();
+  simNowUs = restartUs;
+  runUntil(restartUs + 3000000);
+  WaveformTiming timing = waveformTiming(1.0f, 1.0f);
+  std::vector<Edge> pinEdges = edgesOf(12);
+  TEST_ASSERT_EQUAL(6, pinEdges.size());
+  TEST_ASSERT_INT_WITHIN(1000, restartUs + timing.onUs, pinEdges[0].atUs);
+}
+
+void test_stale_callback_after_stop_is_ignored() {
+  TEST_ASSERT_TRUE(waveformStart(2, 11, -1, 1.0f, 1.0f));
+  PendingTimer stale = pending[0];
+  waveformStop(2);
+  size_t count = edges.size();
+  simNowUs = stale.dueUs;
+  waveformOnTimer(stale.channel, stale.generation);
+  TEST_ASSERT_EQUAL(count, edges.size());
+  TEST_ASSERT_EQUAL(0, pending.size());
+  TEST_ASSERT_FALSE(waveformIsRunning(2));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_timing_from_frequency_and_ratio);
+  RUN_TEST(test_blink_edges_on_time);
+  RUN_TEST(test_late_callbacks_do_not_drift);
+  RUN_TEST(test_pulse_with_mirror_pin);
+  RUN_TEST(test_stop_leaves_pins_low);
+  RUN_TEST(test_stale_callback_after_restart_is_ignored);
+  RUN_TEST(test_stale_callback_after_stop_is_ignored);
+  return UNITY_END();
+}